@@ -32,6 +32,13 @@ namespace pleep
             if (data.behaviors.use_fixed_update)
             {
                 data.behaviors.drivetrain->on_fixed_update(deltaTime, data.behaviors, data.entity, data.owner, m_sharedBroker);
+
+                // drivetrains disable themselves by clearing their flag
+                std::shared_ptr<Cosmos> cosmos = data.owner.lock();
+                if (!data.behaviors.use_fixed_update && cosmos)
+                {
+                    cosmos->mark_component_changed<BehaviorsComponent>(data.entity);
+                }
             }
             
             //on_frame_update()
@@ -25,7 +25,8 @@ namespace pleep
 
         for (Entity const& entity : m_entities)
         {
-            BehaviorsComponent& behaviors = cosmos->get_component<BehaviorsComponent>(entity);
+            // drivetrains flag the components they change themselves (BehaviorsDynamo flags this one if they toggle it)
+            BehaviorsComponent& behaviors = cosmos->get_component_unmarked<BehaviorsComponent>(entity);
 
             m_attachedBehaviorsDynamo->submit(BehaviorsPacket{ behaviors, entity, m_ownerCosmos });
         }
@@ -63,4 +64,13 @@ namespace pleep
     {
         m_attachedBehaviorsDynamo = contextDynamo;
     }
+    
+    StageAccess BehaviorsSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedBehaviorsDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // only reads, BehaviorsDynamo runs behaviors after all synchros
+            access.reads.set(cosmos.get_component_type<BehaviorsComponent>());
+        });
+    }
 }
\ No newline at end of file
@@ -20,6 +20,8 @@ namespace pleep
 
         Signature derive_signature() override;
 
+        StageAccess derive_access() override;
+
         // synchro needs a BehaviorsDynamo to operate on
         void attach_dynamo(std::shared_ptr<BehaviorsDynamo> contextDynamo);
 
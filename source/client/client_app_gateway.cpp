@@ -4,7 +4,7 @@
 
 namespace pleep
 {
-    ClientAppGateway::ClientAppGateway() 
+    ClientAppGateway::ClientAppGateway(bool pipelined, bool parallelStages) 
     {
         PLEEPLOG_TRACE("Constructing Client App Gateway");
         // build apis for my specific context
@@ -14,7 +14,8 @@ namespace pleep
         // be strict and LOUD with misuse?
         assert(!m_context);
         PLEEPLOG_TRACE("Start constructing client context");
-        m_context = std::make_unique<ClientCosmosContext>(m_windowApi);
+        m_context = std::make_unique<ClientCosmosContext>(m_windowApi, pipelined);
+        m_context->set_parallel_stages(parallelStages);
         PLEEPLOG_TRACE("Done constructing client context");
     }
     
@@ -10,7 +10,9 @@ namespace pleep
     class ClientAppGateway : public I_AppGateway
     {
     public:
-        ClientAppGateway();
+        // pipelined -> context simulates on its own thread while this one renders
+        // parallelStages -> see I_CosmosContext::set_parallel_stages
+        ClientAppGateway(bool pipelined = true, bool parallelStages = true);
         ~ClientAppGateway();
 
         void run() override;
@@ -18,7 +20,7 @@ namespace pleep
     private:
         // only 1 context (1 can be displayed at a time anyway)
         std::unique_ptr<I_CosmosContext> m_context = nullptr;
-        // any need for the client context to run on a seperate thread?
+        // context may simulate on a seperate thread, but run() always renders on this one (which owns the window)
     };
 }
 
@@ -5,10 +5,16 @@
 #include "staging/client_focal_entity.h"
 #include "staging/client_local_entities.h"
 #include "staging/hard_config_cosmos.h"
+#include "rendering/model_cache.h"
 
 namespace pleep
 {
-    ClientCosmosContext::ClientCosmosContext(GLFWwindow* windowApi)
+    // frame time given to caching (and uploading) finished async imports each frame
+    constexpr double CLIENT_ASSET_UPLOAD_SECONDS = 0.004;
+    // longest the render thread waits for simulation to publish a frame before polling the window again
+    constexpr double CLIENT_FRAME_WAIT_SECONDS = 0.01;
+
+    ClientCosmosContext::ClientCosmosContext(GLFWwindow* windowApi, bool pipelined)
         : I_CosmosContext()
     {
         // I_CosmosContext() has setup broker
@@ -20,6 +26,16 @@ namespace pleep
         m_dynamoCluster.physicser = std::make_shared<PhysicsDynamo>(m_eventBroker);
         m_dynamoCluster.renderer  = std::make_shared<RenderDynamo>(m_eventBroker, windowApi);
 
+        // this thread keeps the window and gl context, simulation gets its own thread in run()
+        m_isPipelined = pipelined;
+        if (m_isPipelined)
+        {
+            m_dynamoCluster.inputter->set_external_polling(true);
+            m_dynamoCluster.renderer->set_pipelined(true);
+            ModelCache::set_gl_thread();
+        }
+        PLEEPLOG_INFO(std::string("Client simulation and rendering ") + (m_isPipelined ? "on separate threads" : "on one thread"));
+
         // build and populate starting cosmos
         _build_cosmos();
         // TODO: use network dynamo to get cosmos config from server (some loading cosmos while waiting?)
@@ -49,16 +65,54 @@ namespace pleep
     {
         // TODO: give each dynamo a run "fixed" & variable method so we don't need to explicitly
         //   know which dynamos to call fixed and which to call on frametime
-        m_dynamoCluster.inputter->run_relays(fixedTime);
-        m_dynamoCluster.networker->run_relays(fixedTime);
-        m_dynamoCluster.behaver->run_relays(fixedTime);
-        m_dynamoCluster.physicser->run_relays(fixedTime);
+        this->_run_dynamos({
+            m_dynamoCluster.inputter.get(),
+            m_dynamoCluster.networker.get(),
+            m_dynamoCluster.behaver.get(),
+            m_dynamoCluster.physicser.get()
+        }, fixedTime);
     }
     
     void ClientCosmosContext::_on_frame(double deltaTime) 
     {
+        if (m_isPipelined)
+        {
+            // render thread draws it in _on_render
+            if (m_dynamoCluster.renderer->publish_frame(m_currentCosmos ? m_currentCosmos->get_coherency() : 0))
+            {
+                this->_report_dropped_frame();
+            }
+            return;
+        }
+
+        // upload assets imported in the background before drawing with them
+        ModelCache::process_async_imports(CLIENT_ASSET_UPLOAD_SECONDS);
+
         m_dynamoCluster.renderer->run_relays(deltaTime);
 
+        this->_draw_ui(m_currentCosmos->get_coherency());
+    }
+
+    bool ClientCosmosContext::_on_render(double deltaTime)
+    {
+        // window callbacks post their events for simulation's thread to dispatch
+        m_dynamoCluster.inputter->poll_window();
+
+        // upload assets imported in the background (or waited on by simulation) before drawing with them
+        ModelCache::process_async_imports(CLIENT_ASSET_UPLOAD_SECONDS);
+
+        if (!m_dynamoCluster.renderer->draw_published_frame(deltaTime, CLIENT_FRAME_WAIT_SECONDS))
+        {
+            return false;
+        }
+
+        this->_draw_ui(m_dynamoCluster.renderer->get_drawn_coherency());
+        m_dynamoCluster.renderer->flush_frame();
+        return true;
+    }
+
+    void ClientCosmosContext::_draw_ui(uint16_t coherency)
+    {
         // ***** Post Processing *****
         // top ui layer in context for debug
         // TODO: abstract this to ui layer
@@ -89,6 +143,7 @@ namespace pleep
             // Create a window and append into it.
             ImGui::Begin("Client Context Debug", &p_open, overlayFlags);
 
+            // NOTE: this reads simulation state directly, which is only safe with --single-thread
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
             // Report Cosmos info
@@ -103,7 +158,7 @@ namespace pleep
                 std::string focalEntityString = "Focal entity: " + std::to_string(m_currentCosmos->get_focal_entity());
                 ImGui::Text(focalEntityString.c_str());
 
-                ImGui::Text(("Update count: " + std::to_string(m_currentCosmos->get_coherency())).c_str());
+                ImGui::Text(("Update count: " + std::to_string(coherency)).c_str());
             }
             
             // Display some text (you can use a format strings too)
@@ -190,7 +245,7 @@ namespace pleep
 
             ImGui::Begin("Client Context Debug", &p_open, overlayFlags);
 
-            int tFrame = m_currentCosmos->get_coherency();
+            int tFrame = coherency;
 
             std::string tSeconds = std::to_string((tFrame / pleep::FRAMERATE) % 60);
             tSeconds.insert(0, 2 - tSeconds.length(), '0');
@@ -222,7 +277,7 @@ namespace pleep
         m_dynamoCluster.networker->reset_relays();
         m_dynamoCluster.behaver->reset_relays();
         m_dynamoCluster.physicser->reset_relays();
-        m_dynamoCluster.renderer->reset_relays();   // render dynamo will flush framebuffer
+        m_dynamoCluster.renderer->reset_relays();   // render dynamo will flush framebuffer (unless pipelined)
     }
 
     
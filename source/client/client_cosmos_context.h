@@ -19,7 +19,9 @@ namespace pleep
         // Accept all apis to use for lifetime,
         // (apis provide shared system resource for dynamos)
         // on construction we will build all the dynamos from these apis
-        ClientCosmosContext(GLFWwindow* windowApi);
+        // pipelined -> simulate on a seperate thread, with the constructing thread (which has the gl context)
+        // polling the window and rendering published frames while run() is called on it
+        ClientCosmosContext(GLFWwindow* windowApi, bool pipelined = true);
         ~ClientCosmosContext();
 
     protected:
@@ -27,6 +29,10 @@ namespace pleep
         void _on_fixed(double fixedTime) override;
         void _on_frame(double deltaTime) override;
         void _clean_frame() override;
+        bool _on_render(double deltaTime) override;
+
+        // draw ui layer on top of the rendered frame, showing time of coherency
+        void _draw_ui(uint16_t coherency);
         
         // populate the cosmos
         // for now this has no parameters (scene filename in future?)
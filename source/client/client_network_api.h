@@ -11,7 +11,7 @@ namespace pleep
     {
     public:
         ClientNetworkApi()
-            : net::I_Client<EventId>()
+            : net::I_Client<EventId>(true)
         {}
 
         // no callbacks required
@@ -5,6 +5,7 @@
 
 #include "staging/client_focal_entity.h"
 #include "staging/client_local_entities.h"
+#include "physics/transform_component.h"
 
 namespace pleep
 {
@@ -32,8 +33,6 @@ namespace pleep
 
     void ClientNetworkDynamo::run_relays(double deltaTime) 
     {
-        UNREFERENCED_PARAMETER(deltaTime);
-
         if (!m_networkApi.is_ready()) return;
 
         std::shared_ptr<Cosmos> cosmos = m_workingCosmos.lock();
@@ -49,17 +48,22 @@ namespace pleep
         if (cosmos)
         {
             Entity focalEntity = cosmos->get_focal_entity();
+            // input for this update is read, remember it (and the state it will act on) to replay
+            m_predictor.record(cosmos, deltaTime);
+
             if (focalEntity != NULL_ENTITY)
             {
-                EventMessage focalUpdate(events::cosmos::ENTITY_UPDATE);
+                // stamped so the server can tell us which of our inputs its state has seen
+                EventMessage focalUpdate(events::cosmos::ENTITY_UPDATE, cosmos->get_coherency());
                 events::cosmos::ENTITY_UPDATE_params focalInfo = {
                     focalEntity, 
                     cosmos->get_entity_signature(focalEntity) & cosmos->get_category_signature(ComponentCategory::upstream),
                     ComponentCategory::upstream
                 };
-                cosmos->serialize_entity_components(focalInfo.entity, focalInfo.sign, focalUpdate);
+                cosmos->serialize_entity_components(focalInfo.entity, focalInfo.sign, focalUpdate, focalInfo.category);
                 focalUpdate << focalInfo;
-                m_networkApi.send_message(focalUpdate);
+                // sent every frame with the full upstream state, so a lost one doesn't matter
+                m_networkApi.send_unreliable_message(focalUpdate, focalEntity);
             }
         }
 
@@ -129,6 +133,19 @@ namespace pleep
                 {
                     // read update into Cosmos
                     cosmos->deserialize_entity_components(updateInfo.entity, updateInfo.sign, msg, updateInfo.category);
+
+                    // our focal entity's update is stamped with our newest input the server had applied,
+                    // check our prediction against it instead of jumping back a round trip
+                    if (updateInfo.entity == cosmos->get_focal_entity())
+                    {
+                        m_predictor.reconcile(cosmos, msg.header.coherency, updateInfo.sign);
+                    }
+                    // snapshots are less frequent than our updates, smooth remote entities between them
+                    else if (updateInfo.sign.test(cosmos->get_component_type<TransformComponent>()))
+                    {
+                        const TransformComponent& transform = cosmos->read_component<TransformComponent>(updateInfo.entity);
+                        m_interpolator.add_snapshot(updateInfo.entity, msg.header.coherency, transform.origin, transform.orientation);
+                    }
                 }
                 else
                 {
@@ -155,6 +172,9 @@ namespace pleep
 
                 // use condemn event to avoid double deletion
                 cosmos->condemn_entity(removeInfo.entity);
+                m_interpolator.remove_entity(removeInfo.entity);
+                // updates are keyed by entity, stop tracking the newest one for it
+                if (m_networkApi.get_datagram_channel()) m_networkApi.get_datagram_channel()->forget_key(removeInfo.entity);
             }
             break;
             case events::network::NEW_CLIENT:
@@ -237,6 +257,9 @@ namespace pleep
             break;
             }
         }
+
+        // after all snapshots for this update are received
+        if (cosmos) m_interpolator.apply(cosmos);
     }
 
     void ClientNetworkDynamo::reset_relays() 
@@ -267,6 +290,9 @@ namespace pleep
     void ClientNetworkDynamo::restart_connection(const std::string& address, uint16_t port)
     {
         m_networkApi.disconnect();
+        // snapshots from another server are unrelated
+        m_interpolator.clear();
+        m_predictor.clear();
         m_networkApi.connect(address, port);
     }
 }
\ No newline at end of file
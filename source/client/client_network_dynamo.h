@@ -9,6 +9,8 @@
 
 // Access network interface
 #include "client/client_network_api.h"
+#include "client/snapshot_interpolator.h"
+#include "client/focal_predictor.h"
 
 namespace pleep
 {
@@ -51,6 +53,11 @@ namespace pleep
 
         // Store most recently connected server app info
         events::network::APP_INFO_params m_serverInfo;
+
+        // smooths remote entities between server snapshots
+        SnapshotInterpolator m_interpolator;
+        // runs our focal entity ahead of the server
+        FocalPredictor m_predictor;
     };
 }
 
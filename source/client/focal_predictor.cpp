@@ -0,0 +1,243 @@
+#include "focal_predictor.h"
+
+#include "logging/pleep_log.h"
+#include "behaviors/behaviors_component.h"
+#include "rendering/renderable_component.h"
+
+namespace pleep
+{
+    // differences smaller than this are quantization/timing noise, not misprediction
+    constexpr float PREDICTION_POSITION_TOLERANCE = 0.05f;
+    constexpr float PREDICTION_VELOCITY_TOLERANCE = 0.25f;
+
+    FocalPredictor::FocalPredictor()
+        : m_replayBroker(std::make_shared<EventBroker>())
+        , m_behaver(m_replayBroker)
+        , m_physicser(m_replayBroker)
+    {
+    }
+
+    void FocalPredictor::record(std::shared_ptr<Cosmos> cosmos, double deltaTime)
+    {
+        const Entity focalEntity = cosmos->get_focal_entity();
+        const uint16_t coherency = cosmos->get_coherency();
+
+        // records must be consecutive to replay through them
+        if (focalEntity != m_focalEntity || (m_hasCurrent && coherency != static_cast<uint16_t>(m_currentCoherency + 1U)))
+        {
+            this->clear();
+            m_focalEntity = focalEntity;
+        }
+        if (focalEntity == NULL_ENTITY) return;
+
+        // only entities we can simulate can be predicted
+        if (!cosmos->has_component<SpacialInputComponent>(focalEntity)
+            || !cosmos->has_component<TransformComponent>(focalEntity)
+            || !cosmos->has_component<PhysicsComponent>(focalEntity)
+            || !cosmos->has_component<BehaviorsComponent>(focalEntity))
+        {
+            this->clear();
+            return;
+        }
+
+        Record& record = m_records[coherency % FOCAL_PREDICTION_HISTORY];
+        record.valid = true;
+        record.coherency = coherency;
+        record.deltaTime = deltaTime;
+        record.input = cosmos->read_component<SpacialInputComponent>(focalEntity);
+        _save_state(cosmos, record);
+
+        m_currentCoherency = coherency;
+        m_hasCurrent = true;
+    }
+
+    void FocalPredictor::reconcile(std::shared_ptr<Cosmos> cosmos, uint16_t inputCoherency, Signature sign)
+    {
+        // nothing predicted, server state stands
+        if (!m_hasCurrent || cosmos->get_focal_entity() != m_focalEntity) return;
+        // server removed something we simulate, its state stands until record stops predicting
+        if (!cosmos->has_component<SpacialInputComponent>(m_focalEntity)
+            || !cosmos->has_component<TransformComponent>(m_focalEntity)
+            || !cosmos->has_component<PhysicsComponent>(m_focalEntity))
+        {
+            return;
+        }
+
+        const Record& current = m_records[m_currentCoherency % FOCAL_PREDICTION_HISTORY];
+        Record& acknowledged = m_records[inputCoherency % FOCAL_PREDICTION_HISTORY];
+        const int16_t age = static_cast<int16_t>(m_currentCoherency - inputCoherency);
+        if (age < 0 || age >= FOCAL_PREDICTION_HISTORY || !acknowledged.valid || acknowledged.coherency != inputCoherency)
+        {
+            // not an input we remember, our prediction is newer than anything it can tell us
+            _load_state(cosmos, current);
+            return;
+        }
+        m_inputRoundTrip = static_cast<uint16_t>(age);
+
+        // compare only what the server sent
+        float positionError = 0.0f;
+        float velocityError = 0.0f;
+        if (sign.test(cosmos->get_component_type<TransformComponent>()))
+        {
+            positionError = glm::length(cosmos->read_component<TransformComponent>(m_focalEntity).origin - acknowledged.transform.origin);
+        }
+        if (sign.test(cosmos->get_component_type<PhysicsComponent>()))
+        {
+            velocityError = glm::length(cosmos->read_component<PhysicsComponent>(m_focalEntity).velocity - acknowledged.physics.velocity);
+        }
+
+        if (positionError <= PREDICTION_POSITION_TOLERANCE && velocityError <= PREDICTION_VELOCITY_TOLERANCE)
+        {
+            _load_state(cosmos, current);
+            return;
+        }
+
+        PLEEPLOG_TRACE("Focal entity {} mispredicted at {} by {} (velocity {}), replaying {} updates", m_focalEntity, inputCoherency, positionError, velocityError, age);
+        m_correctionCount++;
+
+        // server's state (with what we had recorded then for anything it didn't send) is where we should have been
+        const Signature serverSign = sign & _get_simulated_signature(cosmos);
+        EventMessage serverState;
+        cosmos->serialize_entity_components(m_focalEntity, serverSign, serverState, ComponentCategory::partial);
+        _load_state(cosmos, acknowledged);
+        cosmos->deserialize_entity_components(m_focalEntity, serverSign, serverState, ComponentCategory::partial);
+        _save_state(cosmos, acknowledged);
+
+        // hold other colliders where they are now (they are simulated/interpolated separately)
+        m_colliderEntities.clear();
+        m_otherPhysics.clear();
+        const ComponentType colliderType = cosmos->get_component_type<ColliderComponent>();
+        const ComponentType transformType = cosmos->get_component_type<TransformComponent>();
+        const ComponentType physicsType = cosmos->get_component_type<PhysicsComponent>();
+        for (auto& signIt : cosmos->get_signatures_ref())
+        {
+            if (signIt.first == m_focalEntity) continue;
+            if (!signIt.second.test(colliderType) || !signIt.second.test(transformType)) continue;
+
+            m_colliderEntities.push_back(signIt.first);
+            // collision responses would push them each replayed update
+            if (signIt.second.test(physicsType))
+            {
+                m_otherPhysics.push_back({ signIt.first, cosmos->read_component<PhysicsComponent>(signIt.first) });
+            }
+        }
+
+        SpacialInputComponent& input = cosmos->get_component<SpacialInputComponent>(m_focalEntity);
+        for (uint16_t coherency = inputCoherency; coherency != m_currentCoherency; coherency++)
+        {
+            const Record& replayed = m_records[coherency % FOCAL_PREDICTION_HISTORY];
+            input = replayed.input;
+            _step(cosmos, replayed.deltaTime);
+
+            // following predictions should now be compared against the corrected ones
+            _save_state(cosmos, m_records[static_cast<uint16_t>(coherency + 1U) % FOCAL_PREDICTION_HISTORY]);
+        }
+        input = current.input;
+
+        for (auto& physicsIt : m_otherPhysics)
+        {
+            cosmos->get_component<PhysicsComponent>(physicsIt.first) = physicsIt.second;
+        }
+    }
+
+    void FocalPredictor::clear()
+    {
+        for (Record& record : m_records)
+        {
+            record.valid = false;
+        }
+        m_hasCurrent = false;
+    }
+
+    uint16_t FocalPredictor::get_input_round_trip() const
+    {
+        return m_inputRoundTrip;
+    }
+
+    size_t FocalPredictor::get_correction_count() const
+    {
+        return m_correctionCount;
+    }
+
+    Signature FocalPredictor::_get_simulated_signature(std::shared_ptr<Cosmos> cosmos)
+    {
+        Signature sign = cosmos->get_entity_signature(m_focalEntity);
+        sign.reset(cosmos->get_component_type<SpacialInputComponent>());
+        sign.reset(cosmos->get_component_type<RenderableComponent>());
+        return sign;
+    }
+
+    void FocalPredictor::_save_state(std::shared_ptr<Cosmos> cosmos, Record& record)
+    {
+        record.transform = cosmos->read_component<TransformComponent>(m_focalEntity);
+        record.physics = cosmos->read_component<PhysicsComponent>(m_focalEntity);
+
+        // drivetrains keep state in their own components too (cooldowns, grounded, legs, animation)
+        // which replay would otherwise advance again on top of the present
+        record.stateSign = _get_simulated_signature(cosmos);
+        record.state.body.clear();
+        record.state.header.size = 0;
+        cosmos->serialize_entity_components(m_focalEntity, record.stateSign, record.state, ComponentCategory::partial);
+    }
+
+    void FocalPredictor::_load_state(std::shared_ptr<Cosmos> cosmos, const Record& record)
+    {
+        cosmos->get_component<SpacialInputComponent>(m_focalEntity) = record.input;
+
+        // partial keeps any component added since the record
+        m_loadScratch = record.state;
+        cosmos->deserialize_entity_components(m_focalEntity, record.stateSign, m_loadScratch, ComponentCategory::partial);
+    }
+
+    void FocalPredictor::_step(std::shared_ptr<Cosmos> cosmos, double deltaTime)
+    {
+        // the packets the synchros would have submitted, for only our entity
+        TransformComponent& transform = cosmos->get_component<TransformComponent>(m_focalEntity);
+        PhysicsComponent& physics = cosmos->get_component<PhysicsComponent>(m_focalEntity);
+        BehaviorsComponent& behaviors = cosmos->get_component<BehaviorsComponent>(m_focalEntity);
+
+        m_behaver.submit(BehaviorsPacket{ behaviors, m_focalEntity, cosmos });
+        m_physicser.submit(PhysicsPacket{ transform, physics });
+
+        if (cosmos->has_component<ColliderComponent>(m_focalEntity))
+        {
+            ColliderComponent& collider = cosmos->get_component<ColliderComponent>(m_focalEntity);
+            for (int i = 0; i < COLLIDERS_PER_ENTITY; i++)
+            {
+                if (!collider.colliders[i].isActive) continue;
+                collider.colliders[i].reset();
+                m_physicser.submit(ColliderPacket{ transform, collider.colliders[i], m_focalEntity, cosmos });
+            }
+        }
+
+        // fresh copies each update, static resolution moves them
+        // (filled completely before submitting so references stay valid)
+        m_replayTransforms.clear();
+        m_replayColliders.clear();
+        m_replayEntities.clear();
+        for (Entity entity : m_colliderEntities)
+        {
+            const ColliderComponent& collider = cosmos->read_component<ColliderComponent>(entity);
+            for (int i = 0; i < COLLIDERS_PER_ENTITY; i++)
+            {
+                if (!collider.colliders[i].isActive) continue;
+                m_replayTransforms.push_back(cosmos->read_component<TransformComponent>(entity));
+                m_replayColliders.push_back(collider.colliders[i]);
+                m_replayColliders.back().reset();
+                // their reactions already happened (or will) in the real simulation
+                m_replayColliders.back().useBehaviorsResponse = false;
+                m_replayEntities.push_back(entity);
+            }
+        }
+        for (size_t i = 0; i < m_replayEntities.size(); i++)
+        {
+            m_physicser.submit(ColliderPacket{ m_replayTransforms[i], m_replayColliders[i], m_replayEntities[i], cosmos });
+        }
+
+        // same order as the context runs them
+        m_behaver.run_relays(deltaTime);
+        m_physicser.run_relays(deltaTime);
+        m_behaver.reset_relays();
+        m_physicser.reset_relays();
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef FOCAL_PREDICTOR_H
+#define FOCAL_PREDICTOR_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <array>
+#include <vector>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+#include "ecs/ecs_types.h"
+#include "core/cosmos.h"
+#include "events/event_broker.h"
+#include "behaviors/behaviors_dynamo.h"
+#include "physics/physics_dynamo.h"
+#include "physics/transform_component.h"
+#include "physics/physics_component.h"
+#include "physics/collider_component.h"
+#include "inputting/spacial_input_component.h"
+
+// updates of input & state remembered for replay (must cover a round trip)
+#define FOCAL_PREDICTION_HISTORY 128
+
+namespace pleep
+{
+    // Lets our focal entity respond to input immediately instead of a round trip later
+    // Every update the focal entity's input and (not yet simulated) state are recorded by coherency,
+    // which is sent upstream with the input. The server echoes back the coherency of the newest input
+    // it had applied with each authoritative state of our focal entity, so that state can be compared
+    // to what we predicted for the same input. If they disagree we rewind to the server's state and
+    // replay the remembered inputs since then, through our own behaviors & physics dynamos.
+    class FocalPredictor
+    {
+    public:
+        FocalPredictor();
+
+        // remember cosmos' focal entity input and state for the current coherency
+        // call once per update, after input is read but before behaviors & physics run
+        void record(std::shared_ptr<Cosmos> cosmos, double deltaTime);
+
+        // the focal entity's sign components were just overwritten with the server's state
+        // as of inputCoherency, keep our current prediction if it agreed or re-predict from it
+        void reconcile(std::shared_ptr<Cosmos> cosmos, uint16_t inputCoherency, Signature sign);
+
+        // forget all records (eg. new connection)
+        void clear();
+
+        // updates between recording an input and the server's state for it arriving
+        uint16_t get_input_round_trip() const;
+        // rewinds since constructed
+        size_t get_correction_count() const;
+
+    private:
+        struct Record
+        {
+            bool valid = false;
+            uint16_t coherency = 0;
+            double deltaTime = 0.0;
+            SpacialInputComponent input;
+
+            // compared against the server's state
+            TransformComponent transform;
+            PhysicsComponent physics;
+            // every component replay can write (see _get_simulated_signature), serialized exactly
+            Signature stateSign;
+            EventMessage state;
+        };
+
+        // components of the focal entity which behaviors & physics may write
+        // (everything except input, which is recorded separately, and renderables, which they never change)
+        Signature _get_simulated_signature(std::shared_ptr<Cosmos> cosmos);
+
+        void _save_state(std::shared_ptr<Cosmos> cosmos, Record& record);
+        void _load_state(std::shared_ptr<Cosmos> cosmos, const Record& record);
+
+        // run one update of behaviors & physics for only the focal entity
+        // other entities' colliders are collided against as they are now, without being affected
+        void _step(std::shared_ptr<Cosmos> cosmos, double deltaTime);
+
+        // indexed by coherency
+        std::array<Record, FOCAL_PREDICTION_HISTORY> m_records;
+        Entity m_focalEntity = NULL_ENTITY;
+        // coherency of newest record, and whether there is one
+        uint16_t m_currentCoherency = 0;
+        bool m_hasCurrent = false;
+
+        uint16_t m_inputRoundTrip = 0;
+        size_t m_correctionCount = 0;
+
+        // events sent during replay have already been sent (or were never real), nobody listens here
+        std::shared_ptr<EventBroker> m_replayBroker;
+        BehaviorsDynamo m_behaver;
+        PhysicsDynamo m_physicser;
+
+        // copies of other entities' colliders to collide against during replay (reused)
+        std::vector<Entity> m_colliderEntities;
+        std::vector<TransformComponent> m_replayTransforms;
+        std::vector<Collider> m_replayColliders;
+        std::vector<Entity> m_replayEntities;
+        // physics of other entities, restored after replay
+        std::vector<std::pair<Entity, PhysicsComponent>> m_otherPhysics;
+        // deserializing pops, so records are loaded from a copy (reused)
+        EventMessage m_loadScratch;
+    };
+}
+
+#endif // FOCAL_PREDICTOR_H
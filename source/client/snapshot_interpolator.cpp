@@ -0,0 +1,100 @@
+#include "snapshot_interpolator.h"
+
+#include <algorithm>
+
+#include "physics/transform_component.h"
+
+namespace pleep
+{
+    // render this many snapshot intervals behind the newest snapshot
+    // (>1 so one late or lost snapshot doesn't leave nothing to interpolate towards)
+    constexpr float INTERPOLATION_DELAY_INTERVALS = 2.0f;
+    // how quickly the measured interval follows new gaps between snapshots
+    constexpr float INTERVAL_SMOOTHING = 0.2f;
+    // how quickly the render point is pulled towards its target delay each update
+    constexpr float RENDER_LAG_CORRECTION = 0.1f;
+    // gaps longer than this (in updates) are outages, not the send rate
+    constexpr float MAX_SNAPSHOT_INTERVAL = 64.0f;
+    constexpr size_t MAX_SNAPSHOTS = 16;
+
+    void SnapshotInterpolator::add_snapshot(Entity entity, uint16_t coherency, const glm::vec3& origin, const glm::quat& orientation)
+    {
+        History& history = m_histories[entity];
+
+        if (!history.snapshots.empty())
+        {
+            // coherency is circular
+            const int16_t gap = static_cast<int16_t>(coherency - history.snapshots.back().coherency);
+            if (gap < 0) return;
+            if (gap == 0)
+            {
+                history.snapshots.back() = { coherency, origin, orientation };
+                return;
+            }
+
+            history.interval += (std::min(static_cast<float>(gap), MAX_SNAPSHOT_INTERVAL) - history.interval) * INTERVAL_SMOOTHING;
+            // the newest snapshot moved forward, the render point didn't
+            history.renderLag += gap;
+        }
+
+        history.snapshots.push_back({ coherency, origin, orientation });
+        if (history.snapshots.size() > MAX_SNAPSHOTS) history.snapshots.pop_front();
+    }
+
+    void SnapshotInterpolator::remove_entity(Entity entity)
+    {
+        m_histories.erase(entity);
+    }
+
+    void SnapshotInterpolator::clear()
+    {
+        m_histories.clear();
+    }
+
+    void SnapshotInterpolator::apply(std::shared_ptr<Cosmos> cosmos)
+    {
+        const Entity focalEntity = cosmos->get_focal_entity();
+
+        for (auto historyIt = m_histories.begin(); historyIt != m_histories.end();)
+        {
+            const Entity entity = historyIt->first;
+            History& history = historyIt->second;
+            if (entity == focalEntity
+                || !cosmos->entity_exists(entity)
+                || !cosmos->has_component<TransformComponent>(entity))
+            {
+                historyIt = m_histories.erase(historyIt);
+                continue;
+            }
+            historyIt++;
+
+            // time passes, then ease towards the target delay (never past the newest snapshot)
+            const float targetLag = INTERPOLATION_DELAY_INTERVALS * history.interval;
+            history.renderLag -= 1.0f;
+            history.renderLag += (targetLag - history.renderLag) * RENDER_LAG_CORRECTION;
+            history.renderLag = std::max(history.renderLag, 0.0f);
+
+            // updates behind newest snapshot
+            const uint16_t newest = history.snapshots.back().coherency;
+            auto lag_of = [newest](const Snapshot& snapshot)
+            {
+                return static_cast<float>(static_cast<int16_t>(newest - snapshot.coherency));
+            };
+
+            // drop snapshots which are entirely behind the render point
+            while (history.snapshots.size() > 2 && lag_of(history.snapshots[1]) >= history.renderLag)
+            {
+                history.snapshots.pop_front();
+            }
+
+            const Snapshot& from = history.snapshots.front();
+            const Snapshot& to = history.snapshots.size() > 1 ? history.snapshots[1] : from;
+            const float span = lag_of(from) - lag_of(to);
+            const float t = span > 0.0f ? std::min(std::max((lag_of(from) - history.renderLag) / span, 0.0f), 1.0f) : 1.0f;
+
+            TransformComponent& transform = cosmos->get_component<TransformComponent>(entity);
+            transform.origin = glm::mix(from.origin, to.origin, t);
+            transform.orientation = glm::slerp(from.orientation, to.orientation, t);
+        }
+    }
+}
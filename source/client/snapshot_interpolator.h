@@ -0,0 +1,59 @@
+#ifndef SNAPSHOT_INTERPOLATOR_H
+#define SNAPSHOT_INTERPOLATOR_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "ecs/ecs_types.h"
+#include "core/cosmos.h"
+
+namespace pleep
+{
+    // Smooths remote entities between the snapshots the server sends (less often than we simulate)
+    // Each received transform is buffered with its (server) coherency, and every update the entity's
+    // transform is set to the buffered values interpolated at a point a little behind the newest one,
+    // so there is (usually) a snapshot on either side of it.
+    // That delay adapts to how often each entity's snapshots actually arrive,
+    // and is measured from received snapshots only, so our own coherency can drift/resync freely.
+    class SnapshotInterpolator
+    {
+    public:
+        // record entity's transform (as just received) at coherency
+        void add_snapshot(Entity entity, uint16_t coherency, const glm::vec3& origin, const glm::quat& orientation);
+
+        // stop smoothing entity (eg. it was removed)
+        void remove_entity(Entity entity);
+        void clear();
+
+        // advance one simulation update and overwrite transforms of all buffered entities
+        // with their interpolated state (except our focal entity, which we simulate ourselves)
+        void apply(std::shared_ptr<Cosmos> cosmos);
+
+    private:
+        struct Snapshot
+        {
+            uint16_t coherency;
+            glm::vec3 origin;
+            glm::quat orientation;
+        };
+
+        struct History
+        {
+            // oldest to newest
+            std::deque<Snapshot> snapshots;
+            // smoothed updates between arriving snapshots
+            float interval = 1.0f;
+            // updates the interpolated point is behind the newest snapshot
+            float renderLag = 0.0f;
+        };
+
+        std::unordered_map<Entity, History> m_histories;
+    };
+}
+
+#endif // SNAPSHOT_INTERPOLATOR_H
@@ -10,6 +10,7 @@
 #include "build_config.h"
 #include "logging/pleep_log.h"
 #include "client/client_app_gateway.h"
+#include "rendering/model_cache.h"
 
 int main(int argc, char** argv)
 {
@@ -32,14 +33,38 @@ int main(int argc, char** argv)
     for (int i = 1; i < argc; i++)
         args.push_back(argv[i]);
 
-    if (!args.empty())
+    // read and write baked model files in (existing) directory, instead of importing models with Assimp every run:
+    //   --asset-cache <directory>
+    // simulate and render on the main thread instead of on separate threads:
+    //   --single-thread
+    // update synchros one at a time in registration order:
+    //   --serial-stages
+    bool pipelined = true;
+    bool parallelStages = true;
+    std::string ignoredArgs;
+    for (size_t i = 0; i < args.size(); i++)
     {
-        // just echo for now
-        std::string concat;
-        for (std::string a : args)
-            concat.append(a + " ");
+        if (args[i] == "--asset-cache" && i + 1 < args.size())
+        {
+            pleep::ModelCache::set_bake_directory(args[++i]);
+        }
+        else if (args[i] == "--single-thread")
+        {
+            pipelined = false;
+        }
+        else if (args[i] == "--serial-stages")
+        {
+            parallelStages = false;
+        }
+        else
+        {
+            ignoredArgs.append(args[i] + " ");
+        }
+    }
 
-        PLEEPLOG_WARN("Ignored cmd args: " + concat);
+    if (!ignoredArgs.empty())
+    {
+        PLEEPLOG_WARN("Ignored cmd args: " + ignoredArgs);
     }
 
     // TODO: Parse serialized cosmos (world) data and meta-data
@@ -56,13 +81,14 @@ int main(int argc, char** argv)
     try
     {
         // pass config resources to build context and initial state
-        intercessionClientApp = new pleep::ClientAppGateway();
+        intercessionClientApp = new pleep::ClientAppGateway(pipelined, parallelStages);
     }
     catch (const std::exception& e)
     {
         UNREFERENCED_PARAMETER(e);
         PLEEPLOG_ERROR("The following uncaught exception occurred during ClientAppGateway startup: ");
         PLEEPLOG_ERROR(e.what());
+        DEINIT_PLEEPLOG();
         return 1;
     }
 
@@ -76,11 +102,14 @@ int main(int argc, char** argv)
         UNREFERENCED_PARAMETER(e);
         PLEEPLOG_ERROR("Uncaught exception during ClientAppGateway running");
         PLEEPLOG_ERROR(e.what());
+        DEINIT_PLEEPLOG();
         return 1;
     }
 
     // cleanup
     delete intercessionClientApp;
 
+    // flush any queued log messages
+    DEINIT_PLEEPLOG();
     return 0;
 }
@@ -1,18 +1,37 @@
 #include "cosmos.h"
 
+#include <atomic>
+#include <algorithm>
+
 #include "logging/pleep_log.h"
 
 namespace pleep
 {
     // ECS methods are provided inline in cosmos.h
 
+    // unique per cosmos for the lifetime of the process (addresses can be reused)
+    static size_t next_cosmos_instance_id()
+    {
+        static std::atomic<size_t> nextId{ 0 };
+        return nextId++;
+    }
+
+    // flushing can record more creations (onCreated callbacks creating entities)
+    // which are applied in further passes, but don't let a feedback loop hang the frame
+    constexpr size_t MAX_FLUSH_PASSES = 8;
+
     Cosmos::Cosmos(std::shared_ptr<EventBroker> sharedBroker, const TimesliceId localTimesliceIndex)
         : m_hostId(localTimesliceIndex)
+        , m_instanceId(next_cosmos_instance_id())
     {
         m_entityRegistry    = std::make_unique<EntityRegistry>(localTimesliceIndex);
         m_componentRegistry = std::make_unique<ComponentRegistry>();
         m_synchroRegistry   = std::make_unique<SynchroRegistry>();
 
+        m_wireEncodings.fill(WireEncoding::exact);
+        this->set_wire_encoding(ComponentCategory::downstream, WireEncoding::quantized);
+        this->set_wire_encoding(ComponentCategory::upstream, WireEncoding::quantized);
+
         m_sharedBroker = sharedBroker;
         // setup handlers?
         m_sharedBroker->add_listener(METHOD_LISTENER(events::cosmos::CONDEMN_ALL, Cosmos::_condemn_all_handler));
@@ -28,6 +47,9 @@ namespace pleep
     
     void Cosmos::update() 
     {
+        // apply structural changes recorded (from any thread) since last update, including condemned entities
+        this->_flush_command_buffers();
+
         // delete all condemned entities
         for (auto condemned : m_condemned)
         {
@@ -35,37 +57,187 @@ namespace pleep
         }
         m_condemned.clear();
 
-        // get synchro map from registry
-        auto synchroIter = m_synchroRegistry->get_synchros_ref().begin();
-        auto synchroEnd  = m_synchroRegistry->get_synchros_ref().end();
-
         // update all registered synchros
-        for (synchroIter; synchroIter != synchroEnd; synchroIter++)
+        // we can only call I_Synchro methods
+        // otherwise Context will have to keep and call each specialized synchro
+        // context should only need to manage its dynamos
+        // synchros which don't touch the same components/dynamos are updated concurrently,
+        // conflicting ones are updated in registration order
+        m_synchroScheduler.clear_stages();
+        for (auto& synchroEntry : m_synchroRegistry->get_registration_order_ref())
         {
-            // we can only call I_Synchro methods
-            // otherwise Context will have to keep and call each specialized synchro
-            // context should only need to manage its dynamos
-            synchroIter->second->update();
+            I_Synchro* synchro = synchroEntry.second.get();
+            m_synchroScheduler.add_stage(synchroEntry.first, synchro->derive_access(), [synchro]() { synchro->update(); });
         }
+        m_synchroScheduler.run();
+    }
+
+    void Cosmos::set_parallel_synchros(bool parallel)
+    {
+        m_synchroScheduler.set_parallel(parallel);
     }
 
-    void Cosmos::serialize_entity_components(Entity entity, Signature sign, EventMessage& msg)
+    const StageScheduleReport& Cosmos::get_synchro_schedule_report() const
+    {
+        return m_synchroScheduler.get_last_report();
+    }
+
+    void Cosmos::_flush_command_buffers()
+    {
+        m_flushBatch.clear();
+
+        // creations first (in recorded order) so entities exist for the sorted pass,
+        // onCreated callbacks record their components into the buffers, so take again until nothing new is created
+        size_t createsScanned = 0;
+        for (size_t pass = 0; pass < MAX_FLUSH_PASSES; pass++)
+        {
+            {
+                std::lock_guard<std::mutex> buffersLock(m_commandBuffersMutex);
+                for (auto& threadBuffer : m_commandBuffers)
+                {
+                    threadBuffer.second->take(m_flushBatch);
+                }
+            }
+
+            bool created = false;
+            for (; createsScanned < m_flushBatch.commands.size(); createsScanned++)
+            {
+                const EntityCommandBuffer::Command& cmd = m_flushBatch.commands[createsScanned];
+                if (cmd.type != EntityCommandBuffer::CommandType::create) continue;
+
+                created = true;
+                Entity entity = this->create_entity(cmd.isTemporal, cmd.source);
+                if (entity != NULL_ENTITY && cmd.payloadOffset != SIZE_MAX)
+                {
+                    // (may record into m_flushBatch's source buffers, not m_flushBatch itself)
+                    m_flushBatch.onCreated[cmd.payloadOffset](entity);
+                }
+            }
+            if (!created) break;
+            if (pass + 1 == MAX_FLUSH_PASSES)
+            {
+                PLEEPLOG_WARN("Entities were still being created after {} flush passes, leaving the rest for next update", MAX_FLUSH_PASSES);
+            }
+        }
+
+        // everything else in one pass, sorted (stable) so each entity's changes are together and keep their recorded order
+        std::vector<const EntityCommandBuffer::Command*> changes;
+        changes.reserve(m_flushBatch.commands.size());
+        for (const EntityCommandBuffer::Command& cmd : m_flushBatch.commands)
+        {
+            if (cmd.type != EntityCommandBuffer::CommandType::create) changes.push_back(&cmd);
+        }
+        std::stable_sort(changes.begin(), changes.end(),
+            [](const EntityCommandBuffer::Command* lhs, const EntityCommandBuffer::Command* rhs)
+            {
+                return lhs->entity < rhs->entity;
+            }
+        );
+
+        size_t groupStart = 0;
+        while (groupStart < changes.size())
+        {
+            const Entity entity = changes[groupStart]->entity;
+            size_t groupEnd = groupStart;
+            bool condemned = false;
+            while (groupEnd < changes.size() && changes[groupEnd]->entity == entity)
+            {
+                if (changes[groupEnd]->type == EntityCommandBuffer::CommandType::condemn)
+                {
+                    m_condemned.insert({ entity, changes[groupEnd]->source });
+                    condemned = true;
+                }
+                groupEnd++;
+            }
+
+            // destroyed right after, no point changing its components
+            if (condemned || !this->entity_exists(entity))
+            {
+                groupStart = groupEnd;
+                continue;
+            }
+
+            // change components directly, then update signature & synchros only once
+            Signature sign = m_entityRegistry->get_signature(entity);
+            for (size_t i = groupStart; i < groupEnd; i++)
+            {
+                const EntityCommandBuffer::Command& cmd = *changes[i];
+                if (cmd.type == EntityCommandBuffer::CommandType::add)
+                {
+                    if (!sign.test(cmd.component))
+                    {
+                        m_componentRegistry->add_component(entity, cmd.component);
+                        sign.set(cmd.component, true);
+                    }
+                    if (cmd.payloadSize > 0)
+                    {
+                        m_flushBatch.load_payload(cmd, m_commandScratch);
+                        m_componentRegistry->deserialize_single_component(entity, cmd.component, m_commandScratch);
+                    }
+                }
+                else if (sign.test(cmd.component))
+                {
+                    m_componentRegistry->remove_component(entity, cmd.component);
+                    sign.set(cmd.component, false);
+                }
+            }
+
+            if (sign != m_entityRegistry->get_signature(entity))
+            {
+                m_entityRegistry->set_signature(entity, sign);
+                m_synchroRegistry->change_entity_signature(entity, sign);
+            }
+
+            groupStart = groupEnd;
+        }
+    }
+
+    EntityCommandBuffer& Cosmos::_get_command_buffer()
+    {
+        // remember the last cosmos this thread recorded into so recording doesn't need the lock
+        thread_local size_t cachedInstanceId = SIZE_MAX;
+        thread_local EntityCommandBuffer* cachedBuffer = nullptr;
+        if (cachedInstanceId == m_instanceId)
+        {
+            return *cachedBuffer;
+        }
+
+        std::lock_guard<std::mutex> buffersLock(m_commandBuffersMutex);
+        const std::thread::id threadId = std::this_thread::get_id();
+        auto threadBufferIt = std::find_if(m_commandBuffers.begin(), m_commandBuffers.end(),
+            [&threadId](const std::pair<std::thread::id, std::unique_ptr<EntityCommandBuffer>>& threadBuffer)
+            {
+                return threadBuffer.first == threadId;
+            }
+        );
+        if (threadBufferIt == m_commandBuffers.end())
+        {
+            m_commandBuffers.emplace_back(threadId, std::make_unique<EntityCommandBuffer>());
+            threadBufferIt = std::prev(m_commandBuffers.end());
+        }
+
+        cachedInstanceId = m_instanceId;
+        cachedBuffer = threadBufferIt->second.get();
+        return *cachedBuffer;
+    }
+
+    void Cosmos::serialize_entity_components(Entity entity, Signature sign, EventMessage& msg, ComponentCategory category)
     {
         Signature entitySign = this->get_entity_signature(entity);
         // get components ONLY in sign
         if (((entitySign ^ sign) & sign).any())
         {
-            PLEEPLOG_ERROR("Requested serialized signature (" + sign.to_string() + ") which is a superset of entity (" + std::to_string(entity) + ") signature (" + entitySign.to_string() + ")");
+            PLEEPLOG_ERROR("Requested serialized signature ({}) which is a superset of entity ({}) signature ({})", sign.to_string(), entity, entitySign.to_string());
             throw std::range_error("Signature mismatch for requested serialization");
         }
-        m_componentRegistry->serialize_entity_components(entity, sign, msg);
+        m_componentRegistry->serialize_entity_components(entity, sign, msg, this->get_wire_encoding(category));
     }
 
     void Cosmos::deserialize_entity_components(Entity entity, Signature sign, EventMessage& msg, ComponentCategory category)
     {
         if (!entity_exists(entity))
         {
-            PLEEPLOG_WARN("Tried to deserialize entity " + std::to_string(entity) + " which does not exist?");
+            PLEEPLOG_WARN("Tried to deserialize entity {} which does not exist?", entity);
             return;
         }
 
@@ -86,7 +258,7 @@ namespace pleep
         // find components ONLY in sign AND category
         if (((entitySign ^ sign) & sign & categorySign).any())
         {
-            PLEEPLOG_ERROR("Requested deserialized signature (" + (sign&categorySign).to_string() + ") which is a superset of entity (" + std::to_string(entity) + ") signature (" + entitySign.to_string() + ")");
+            PLEEPLOG_ERROR("Requested deserialized signature ({}) which is a superset of entity ({}) signature ({})", (sign&categorySign).to_string(), entity, entitySign.to_string());
             throw std::range_error("Signature mismatch for requested deserialization");
         }
         m_componentRegistry->deserialize_entity_components(entity, sign, msg, categorySign);
@@ -96,7 +268,7 @@ namespace pleep
     {
         if (!entity_exists(entity))
         {
-            PLEEPLOG_WARN("Tried to deserialize entity " + std::to_string(entity) + " which does not exist?");
+            PLEEPLOG_WARN("Tried to deserialize entity {} which does not exist?", entity);
             return;
         }
 
@@ -107,9 +279,19 @@ namespace pleep
         m_componentRegistry->deserialize_single_component(entity, type, msg);
     }
     
-    void Cosmos::discard_single_component(ComponentType type, EventMessage& msg)
+    void Cosmos::discard_single_component(ComponentType type, EventMessage& msg, WireEncoding encoding)
+    {
+        m_componentRegistry->discard_single_component(type, msg, encoding);
+    }
+
+    void Cosmos::set_wire_encoding(ComponentCategory category, WireEncoding encoding)
+    {
+        m_wireEncodings.at(static_cast<size_t>(category)) = encoding;
+    }
+
+    WireEncoding Cosmos::get_wire_encoding(ComponentCategory category) const
     {
-        m_componentRegistry->discard_single_component(type, msg);
+        return m_wireEncodings.at(static_cast<size_t>(category));
     }
 
     bool Cosmos::set_focal_entity(Entity entity)
@@ -174,7 +356,13 @@ namespace pleep
 
     std::pair<TimestreamState, uint16_t> Cosmos::get_timestream_state(Entity entity)
     {
-        return m_timestreamStates[entity];
+        // don't insert missing entities, synchros may read this concurrently
+        auto stateIt = m_timestreamStates.find(entity);
+        if (stateIt == m_timestreamStates.end())
+        {
+            return { TimestreamState::merged, 0 };
+        }
+        return stateIt->second;
     }
     
     void Cosmos::link_cosmos(std::shared_ptr<Cosmos> sourceCosmos)
@@ -193,7 +381,7 @@ namespace pleep
         return m_componentRegistry->stringify();
     }
 
-    void Cosmos::_condemn_all_handler(EventMessage condemnEvent)
+    void Cosmos::_condemn_all_handler(EventMessage& condemnEvent)
     {
         UNREFERENCED_PARAMETER(condemnEvent);
         // keep cosmos config the same but remove all entities
@@ -3,11 +3,17 @@
 
 //#include "intercession_pch.h"
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <array>
 
 #include "ecs/ecs_types.h"
 #include "ecs/entity_registry.h"
 #include "ecs/component_registry.h"
 #include "ecs/synchro_registry.h"
+#include "ecs/entity_command_buffer.h"
+#include "core/stage_scheduler.h"
 #include "events/event_types.h"
 #include "events/event_broker.h"
 #include "spacetime/timestream_state.h"
@@ -59,6 +65,7 @@ namespace pleep
         // source: can specify an entity deletion was triggered by.
         //   Used to avoid duplicate deletions by clients or child servers
         //   NULL_ENTITY always allows deletion
+        // (recorded in the calling thread's command buffer, safe to call while iterating)
         void condemn_entity(Entity entity, Entity source = NULL_ENTITY);
 
         // forwards to EntityRegistry
@@ -94,6 +101,9 @@ namespace pleep
         size_t get_hosted_entity_count(Entity entity);
         // Returns total number of TampoeralEntities this cosmos is currently hosting
         size_t get_num_hosted_entities();
+        // copy out/overwrite all hosted entity id bookkeeping (for checkpoints)
+        EntityRegistry::HostedState get_hosted_state();
+        void set_hosted_state(const EntityRegistry::HostedState& state);
 
         // setup component T to be usable in this cosmos
         // Assign category to the registered type
@@ -125,9 +135,30 @@ namespace pleep
         bool has_component(Entity entity, ComponentType componentId);
 
         // find component T of entity
+        // flags the component as changed (to be replicated), use read_component if not modifying it
         template<typename T>
         T& get_component(Entity entity);
 
+        // find component T of entity without flagging it as changed
+        template<typename T>
+        const T& read_component(Entity entity);
+
+        // find component T of entity to hand to a dynamo which may modify it later, without flagging it as changed
+        // whoever modifies replicated data through it must mark_component_changed
+        template<typename T>
+        T& get_component_unmarked(Entity entity);
+
+        // flag component as changed when it is modified through a reference fetched earlier
+        template<typename T>
+        void mark_component_changed(Entity entity);
+        void mark_component_changed(Entity entity, ComponentType componentId);
+
+        // components (in entity's signature) changed since last clear_changed_components
+        Signature get_changed_signature(Entity entity);
+
+        // unflag all components, after replication has sent them
+        void clear_changed_components();
+
         // get registered component T's typeid
         template<typename T>
         ComponentType get_component_type();
@@ -145,6 +176,28 @@ namespace pleep
         // TODO: Do we need a method to change a synchro signature after registry and then recalculate its entities accordingly?
 
 
+        ///// Deferred structural changes /////
+        // Record changes into the calling thread's command buffer instead of applying them immediately
+        // They are applied together (with condemned entities) at the start of the next update(),
+        // so they are safe to call while synchros/dynamos/handlers are iterating entities
+        // or holding component references, and from multiple threads at once
+
+        // create entity (see create_entity) then call onCreated with it (if creation was allowed)
+        // onCreated is called during the flush, its deferred changes are applied in the same flush
+        void defer_create_entity(bool isTemporal = true, Entity source = NULL_ENTITY, std::function<void(Entity)> onCreated = nullptr);
+
+        // add component with value, or overwrite its value if entity already has it by then
+        template<typename T>
+        void defer_add_component(Entity entity, T component);
+        // add default constructed component, ignored if entity already has it by then
+        void defer_add_component(Entity entity, ComponentType componentId);
+
+        // ignored if entity doesn't have it by then
+        template<typename T>
+        void defer_remove_component(Entity entity);
+        void defer_remove_component(Entity entity, ComponentType componentId);
+
+
         ///// Helper methods for sending entity information in Messages (for events or network) /////
 
         // Pack each component of entity in sign into msg in reverse (stacked) order
@@ -152,7 +205,9 @@ namespace pleep
         // Components in sign but missing from entity signature will THROW range_error
         // !!! Does NOT include entity id and signature (header)
         // (We have to specify Message<EventId> because IComponentArray must use virtual methods)
-        void serialize_entity_components(Entity entity, Signature sign, EventMessage& msg);
+        // category (the one the receiver will deserialize with) selects the wire encoding
+        // the encoding is stored in msg, so the receiver may use a different category
+        void serialize_entity_components(Entity entity, Signature sign, EventMessage& msg, ComponentCategory category = ComponentCategory::all);
 
         // Unpack each component from msg according to entity signature
         // Only components in category are written (and added if necessary)
@@ -168,7 +223,12 @@ namespace pleep
         // leverage same component dispatching to remove data from a message
         // Unpack the component from message and just forget it
         // Use to ignore certain ComponentCategories
-        void discard_single_component(ComponentType type, EventMessage& msg);
+        void discard_single_component(ComponentType type, EventMessage& msg, WireEncoding encoding = WireEncoding::exact);
+
+        // choose how components serialized for category are encoded
+        // default: upstream/downstream (sent to/from clients often) are quantized, others exact
+        void set_wire_encoding(ComponentCategory category, WireEncoding encoding);
+        WireEncoding get_wire_encoding(ComponentCategory category) const;
 
         // Set shared "special" entity for this cosmos instance
         // returns false if entity does not exist
@@ -201,6 +261,11 @@ namespace pleep
         // Ordered vector of all synchro typeid names
         std::vector<std::string> stringify_synchro_registry();
 
+        // false -> update synchros one at a time in registration order (for debugging)
+        void set_parallel_synchros(bool parallel);
+        // dependency graph shape and timing of the last synchro update
+        const StageScheduleReport& get_synchro_schedule_report() const;
+
         // Ordered vector of all synchro typeid names
         std::vector<std::string> stringify_component_registry();
 
@@ -209,14 +274,27 @@ namespace pleep
         // angerous if references have been submitted to dynamos
         void destroy_entity(Entity entity, Entity source = NULL_ENTITY);
 
+        // get (or create) the command buffer for the calling thread
+        EntityCommandBuffer& _get_command_buffer();
+        // apply changes recorded by every thread since last update:
+        // creations (in recorded order), then adds/removes sorted by entity (one signature update per entity)
+        // and condemnations moved into m_condemned (their entity's other changes are dropped)
+        void _flush_command_buffers();
+
         // event handlers
-        void _condemn_all_handler(EventMessage condemnEvent);
+        void _condemn_all_handler(EventMessage& condemnEvent);
 
         // use ECS (Entity, Component, Synchro) pattern to optimize update calls
         std::unique_ptr<ComponentRegistry> m_componentRegistry;
         std::unique_ptr<EntityRegistry>    m_entityRegistry;
         std::unique_ptr<SynchroRegistry>   m_synchroRegistry;
 
+        // runs synchro updates each frame according to their declared access
+        StageScheduler m_synchroScheduler;
+
+        // ComponentCategory -> encoding used when serializing for it
+        std::array<WireEncoding, COMPONENT_CATEGORY_COUNT> m_wireEncodings{};
+
         // for emitting events::cosmos
         std::shared_ptr<EventBroker> m_sharedBroker = nullptr;
 
@@ -241,6 +319,17 @@ namespace pleep
         // so all component references should be cleared by then
         std::set<std::pair<Entity, Entity>> m_condemned;
 
+        // each recording thread gets its own buffer, so recording never contends
+        // the mutex only guards the list of buffers (creating one and the flush walking them)
+        std::vector<std::pair<std::thread::id, std::unique_ptr<EntityCommandBuffer>>> m_commandBuffers;
+        std::mutex m_commandBuffersMutex;
+        // commands taken from all buffers for the current flush (kept to reuse allocations)
+        EntityCommandBuffer::Batch m_flushBatch;
+        // reused to unpack recorded components
+        EventMessage m_commandScratch;
+        // process unique id so threads can cache their buffer for this cosmos
+        const size_t m_instanceId;
+
         // store TimestreamState information locally so it is not propogated into the past
         // uint16_t is "time"stamp for last update to this entity's state
         // No entry implies TimestreamState::merged
@@ -277,7 +366,7 @@ namespace pleep
         {
             // threadsafe?
             Entity deferredEntity = m_linkedCosmos->create_entity(isTemporal, NULL_ENTITY);
-            PLEEPLOG_DEBUG("Defferred entity creation to produce: " + std::to_string(deferredEntity));
+            PLEEPLOG_DEBUG("Defferred entity creation to produce: {}", deferredEntity);
             if (this->register_entity(deferredEntity, {}, source))
             {
                 return deferredEntity;
@@ -340,8 +429,8 @@ namespace pleep
     {
         if (entity == NULL_ENTITY) return;
 
-        PLEEPLOG_TRACE("Entity " + std::to_string(entity) + " was condemned to deletion.");
-        m_condemned.insert({ entity, source });
+        PLEEPLOG_TRACE("Entity {} was condemned to deletion.", entity);
+        this->_get_command_buffer().record_condemn(entity, source);
     }
     
     // private:
@@ -357,7 +446,7 @@ namespace pleep
         m_componentRegistry->clear_entity(entity);
         m_synchroRegistry->clear_entity(entity);
 
-        PLEEPLOG_TRACE("Entity " + std::to_string(entity) + " was destroyed");
+        PLEEPLOG_TRACE("Entity {} was destroyed", entity);
 
         // clear focal entity if we just deleted it
         if (entity == m_focalEntity) set_focal_entity(NULL_ENTITY);
@@ -425,6 +514,14 @@ namespace pleep
     {
         return m_entityRegistry->get_num_hosted_entities();
     }
+    inline EntityRegistry::HostedState Cosmos::get_hosted_state()
+    {
+        return m_entityRegistry->get_hosted_state();
+    }
+    inline void Cosmos::set_hosted_state(const EntityRegistry::HostedState& state)
+    {
+        m_entityRegistry->set_hosted_state(state);
+    }
 
     template<typename T>
     void Cosmos::register_component(ComponentCategory category) 
@@ -434,7 +531,7 @@ namespace pleep
 
     inline Signature Cosmos::get_category_signature(ComponentCategory category)
     {
-        if (ComponentCategory::all == category)
+        if (ComponentCategory::all == category || ComponentCategory::partial == category)
         {
             Signature all; all.set();
             return all;
@@ -516,6 +613,75 @@ namespace pleep
     {
         return m_componentRegistry->get_component<T>(entity);
     }
+
+    template<typename T>
+    const T& Cosmos::read_component(Entity entity)
+    {
+        return m_componentRegistry->read_component<T>(entity);
+    }
+
+    template<typename T>
+    T& Cosmos::get_component_unmarked(Entity entity)
+    {
+        // component storage itself is never const, read_component only withholds the changed flag
+        return const_cast<T&>(m_componentRegistry->read_component<T>(entity));
+    }
+
+    template<typename T>
+    void Cosmos::mark_component_changed(Entity entity)
+    {
+        m_componentRegistry->mark_component_changed(entity, m_componentRegistry->get_component_type<T>());
+    }
+
+    inline void Cosmos::mark_component_changed(Entity entity, ComponentType componentId)
+    {
+        m_componentRegistry->mark_component_changed(entity, componentId);
+    }
+
+    inline Signature Cosmos::get_changed_signature(Entity entity)
+    {
+        return m_componentRegistry->get_changed_signature(entity, m_entityRegistry->get_signature(entity));
+    }
+
+    inline void Cosmos::clear_changed_components()
+    {
+        m_componentRegistry->clear_changed_components();
+    }
+    
+    inline void Cosmos::defer_create_entity(bool isTemporal, Entity source, std::function<void(Entity)> onCreated)
+    {
+        this->_get_command_buffer().record_create(isTemporal, source, std::move(onCreated));
+    }
+
+    template<typename T>
+    void Cosmos::defer_add_component(Entity entity, T component)
+    {
+        if (entity == NULL_ENTITY) return;
+
+        this->_get_command_buffer().record_add(entity, m_componentRegistry->get_component_type<T>(), component);
+    }
+
+    inline void Cosmos::defer_add_component(Entity entity, ComponentType componentId)
+    {
+        if (entity == NULL_ENTITY) return;
+
+        this->_get_command_buffer().record_add(entity, componentId);
+    }
+
+    template<typename T>
+    void Cosmos::defer_remove_component(Entity entity)
+    {
+        if (entity == NULL_ENTITY) return;
+
+        this->_get_command_buffer().record_remove(entity, m_componentRegistry->get_component_type<T>());
+    }
+
+    inline void Cosmos::defer_remove_component(Entity entity, ComponentType componentId)
+    {
+        if (entity == NULL_ENTITY) return;
+
+        this->_get_command_buffer().record_remove(entity, componentId);
+    }
     
     template<typename T>
     ComponentType Cosmos::get_component_type()
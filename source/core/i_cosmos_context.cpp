@@ -16,13 +16,61 @@ namespace pleep
     {
     }
     
+    void I_CosmosContext::_run_dynamos(std::initializer_list<A_Dynamo*> dynamos, double deltaTime)
+    {
+        for (A_Dynamo* dynamo : dynamos)
+        {
+            if (dynamo) dynamo->run_relays(deltaTime);
+        }
+    }
+    
+    std::string FrameLoopReport::stringify() const
+    {
+        return std::to_string(simulationSteps) + " simulation steps in "
+            + std::to_string(simulationSeconds) + "s, "
+            + std::to_string(renderFrames) + " frames drawn in "
+            + std::to_string(renderSeconds) + "s ("
+            + std::to_string(droppedFrames) + " dropped) over "
+            + std::to_string(wallSeconds) + "s, overlap "
+            + std::to_string(get_overlap())
+            + (pipelined ? "" : " (single thread)")
+            + ", synchros: " + synchroSchedule.stringify();
+    }
+
     void I_CosmosContext::run()
     {
-        // incase another thread is already running (make this atomic?)
-        if (m_isRunning) return;
+        // incase another thread is already running
+        if (m_isRunning.exchange(true)) return;
 
-        m_isRunning = true;
+        {
+            std::lock_guard<std::mutex> reportLock(m_frameLoopReportMutex);
+            m_frameLoopReport = FrameLoopReport{};
+            m_frameLoopReport.pipelined = m_isPipelined;
+            m_frameLoopReportStart = std::chrono::steady_clock::now();
+        }
 
+        if (!m_isPipelined)
+        {
+            this->_run_frame_loop();
+        }
+        else
+        {
+            m_isSimulating = true;
+            std::thread simulationThread([this]()
+            {
+                this->_run_frame_loop();
+                m_isSimulating = false;
+            });
+            this->_run_render_loop();
+            simulationThread.join();
+        }
+
+        m_isRunning = false;
+        // any non-destructor cleanup?
+    }
+
+    void I_CosmosContext::_run_frame_loop()
+    {
         // main game loop
         PLEEPLOG_TRACE("Starting \"frame loop\"");
         std::chrono::system_clock::time_point lastTimeVal = std::chrono::system_clock::now();
@@ -50,8 +98,11 @@ namespace pleep
                 m_fixedTimeRemaining += deltaTime;
                 m_frameTimeRemaining += deltaTime;
                 lastTimeVal = thisTimeVal;
+                const std::chrono::steady_clock::time_point stepStart = std::chrono::steady_clock::now();
+                std::chrono::duration<double> frameTime(0.0);
 
                 // ***** Setup Frame *****
+                if (m_currentCosmos) m_currentCosmos->set_parallel_synchros(m_parallelStages);
                 this->_prime_frame();
 
                 // ***** Run fixed timestep(s) *****
@@ -71,19 +122,32 @@ namespace pleep
                 // ***** Run "frame time" timestep *****
                 if (m_frameTimeRemaining >= m_minFrameTimestep)
                 {
+                    const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
                     this->_on_frame(deltaTime.count());
                     using namespace std::chrono_literals;
                     m_frameTimeRemaining = 0s;
+                    // when pipelined this only hands the frame off, which is part of simulating
+                    if (!m_isPipelined)
+                    {
+                        frameTime = std::chrono::steady_clock::now() - frameStart;
+                        this->_record_render(frameTime.count());
+                    }
                 }
 
                 // ***** Finish Frame *****
                 // Context gets last word on any final superceding actions
                 this->_clean_frame();
+                // events deferred during this frame are dispatched together once relays are cleared
+                m_eventBroker->flush_deferred_events();
 
                 // TODO: let Cosmos make any volitile changes now that entity references are cleared
                 // e.g. cleanup all entities signalled to be deleted during frame
                 // who should listen for delete requests? me or Cosmos?
                 //m_currentCosmos->flush_entity_changes?();
+
+                const std::chrono::duration<double> stepTime = std::chrono::steady_clock::now() - stepStart;
+                this->_record_simulation((stepTime - frameTime).count());
+                this->_roll_frame_loop_report();
             }
         }
         catch (const std::exception& expt)
@@ -96,7 +160,85 @@ namespace pleep
 
         m_isRunning = false;
         PLEEPLOG_TRACE("Exiting \"frame loop\"");
-        // any non-destructor cleanup?
+    }
+
+    void I_CosmosContext::_run_render_loop()
+    {
+        PLEEPLOG_TRACE("Starting \"render loop\"");
+        std::chrono::steady_clock::time_point lastTimeVal = std::chrono::steady_clock::now();
+
+        // keep going until simulation has actually returned, it may be waiting on this thread
+        // (see ModelManager::set_gl_thread)
+        while (m_isSimulating)
+        {
+            const std::chrono::steady_clock::time_point thisTimeVal = std::chrono::steady_clock::now();
+            const std::chrono::duration<double> deltaTime = thisTimeVal - lastTimeVal;
+            lastTimeVal = thisTimeVal;
+
+            try
+            {
+                if (this->_on_render(deltaTime.count()))
+                {
+                    this->_record_render(std::chrono::duration<double>(std::chrono::steady_clock::now() - thisTimeVal).count());
+                }
+            }
+            catch (const std::exception& expt)
+            {
+                PLEEPLOG_ERROR("The following uncaught exception occurred during CosmosContext::_on_render(): " + std::string(expt.what()));
+                // simulation will see this and return
+                this->stop();
+            }
+        }
+
+        PLEEPLOG_TRACE("Exiting \"render loop\"");
+    }
+
+    FrameLoopReport I_CosmosContext::get_frame_loop_report() const
+    {
+        std::lock_guard<std::mutex> reportLock(m_frameLoopReportMutex);
+        return m_lastFrameLoopReport;
+    }
+
+    void I_CosmosContext::set_parallel_stages(bool parallel)
+    {
+        m_parallelStages = parallel;
+    }
+
+    void I_CosmosContext::_report_dropped_frame()
+    {
+        std::lock_guard<std::mutex> reportLock(m_frameLoopReportMutex);
+        m_frameLoopReport.droppedFrames++;
+    }
+
+    void I_CosmosContext::_record_simulation(double seconds)
+    {
+        std::lock_guard<std::mutex> reportLock(m_frameLoopReportMutex);
+        m_frameLoopReport.simulationSteps++;
+        m_frameLoopReport.simulationSeconds += seconds;
+    }
+
+    void I_CosmosContext::_record_render(double seconds)
+    {
+        std::lock_guard<std::mutex> reportLock(m_frameLoopReportMutex);
+        m_frameLoopReport.renderFrames++;
+        m_frameLoopReport.renderSeconds += seconds;
+    }
+
+    void I_CosmosContext::_roll_frame_loop_report()
+    {
+        std::lock_guard<std::mutex> reportLock(m_frameLoopReportMutex);
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const double wallSeconds = std::chrono::duration<double>(now - m_frameLoopReportStart).count();
+        if (wallSeconds < FRAME_LOOP_REPORT_SECONDS) return;
+
+        m_frameLoopReport.wallSeconds = wallSeconds;
+        if (m_currentCosmos) m_frameLoopReport.synchroSchedule = m_currentCosmos->get_synchro_schedule_report();
+        PLEEPLOG_DEBUG("Frame loop: " + m_frameLoopReport.stringify());
+
+        m_lastFrameLoopReport = m_frameLoopReport;
+        m_frameLoopReport = FrameLoopReport{};
+        m_frameLoopReport.pipelined = m_isPipelined;
+        m_frameLoopReportStart = now;
     }
     
     void I_CosmosContext::stop()
@@ -142,7 +284,7 @@ namespace pleep
         return m_cosmosThread.joinable();
     }
     
-    void I_CosmosContext::_quit_handler(EventMessage quitEvent)
+    void I_CosmosContext::_quit_handler(EventMessage& quitEvent)
     {
         // should only be subscribed to events given with type:
         // events::window::QUIT
@@ -6,6 +6,10 @@
 // external
 #include <memory>
 #include <chrono>
+#include <initializer_list>
+#include <atomic>
+#include <mutex>
+#include <string>
 
 // our "window api"
 #include "imgui.h"
@@ -22,6 +26,35 @@
 namespace pleep
 {
     const uint16_t FRAMERATE = 45;
+    // period of the frame loop report (logged at debug level)
+    const double FRAME_LOOP_REPORT_SECONDS = 5.0;
+
+    // Time spent simulating and rendering over one report period
+    struct FrameLoopReport
+    {
+        // iterations of the frame loop which primed the cosmos
+        size_t simulationSteps = 0;
+        double simulationSeconds = 0.0;
+        // frames actually drawn
+        size_t renderFrames = 0;
+        double renderSeconds = 0.0;
+        // frames simulation published which were replaced before they were drawn
+        size_t droppedFrames = 0;
+        // length of the period
+        double wallSeconds = 0.0;
+        // whether simulation and rendering were on separate threads
+        bool pipelined = false;
+        // most recent cosmos update's synchro schedule
+        StageScheduleReport synchroSchedule;
+
+        // average number of threads busy (1.0 is fully busy on one thread, above 1.0 means they overlapped)
+        double get_overlap() const
+        {
+            return wallSeconds > 0.0 ? (simulationSeconds + renderSeconds) / wallSeconds : 0.0;
+        }
+
+        std::string stringify() const;
+    };
 
     // Abstract base class that:
     // maintains a current interactive "world" aka cosmos and attaches dynamos to it
@@ -56,6 +89,12 @@ namespace pleep
         // returns if internal thread is joinable
         bool joinable();
 
+        // timing over the last complete report period
+        FrameLoopReport get_frame_loop_report() const;
+
+        // update our cosmos' synchros concurrently (where their access allows) or one at a time in order
+        void set_parallel_stages(bool parallel);
+
     protected:
         // Runtime pipeline:
         // 1. m_currentCosmos updates
@@ -63,6 +102,8 @@ namespace pleep
         // 3. _on_frame is called once with time since last frame
         // 4. _clean_frame is called once (context is responsible for notifying dynamos when they should clear their packets for next frame)
         // Pipeline methods not pure virtual because you MAY not want to implement a particular step
+        // If m_isPipelined, the pipeline above runs on its own simulation thread (_on_frame should then only
+        // hand its frame off to be drawn) while the thread which called run() calls _on_render until simulation stops
 
         // called to setup dynamo relays with packets from synchros
         virtual void _prime_frame() {};
@@ -72,15 +113,28 @@ namespace pleep
         virtual void _on_frame(double deltaTime) { UNREFERENCED_PARAMETER(deltaTime); }
         // cleanup before next cosmos update
         virtual void _clean_frame() {}
+        // called by run() (if pipelined) on its calling thread as often as possible with time since last call
+        // returns true if a frame was drawn
+        virtual bool _on_render(double deltaTime) { UNREFERENCED_PARAMETER(deltaTime); return false; }
+        // count a frame published by simulation which was never drawn
+        void _report_dropped_frame();
 
         // Listening to events:window::QUIT sent by InputDynamo
-        void _quit_handler(EventMessage quitEvent);
+        void _quit_handler(EventMessage& quitEvent);
+
+        // run_relays for each (non-null) dynamo in the given order
+        // (relays dispatch events and reach through packets into the cosmos, so they can't overlap)
+        void _run_dynamos(std::initializer_list<A_Dynamo*> dynamos, double deltaTime);
 
         // subclasses should create this as they see fit
         std::shared_ptr<Cosmos> m_currentCosmos = nullptr;
         // context owns its own thread to call run() on
         std::thread m_cosmosThread;
-        bool m_isRunning = false;
+        std::atomic<bool> m_isRunning{ false };
+        // subclasses set this before run() to simulate and render on separate threads
+        bool m_isPipelined = false;
+        // given to whichever cosmos is current (it can be replaced while running)
+        std::atomic<bool> m_parallelStages{ true };
 
         // shared event distributor (pub/sub) to be used by context (me), my dynamos, and synchros that attach to those dynamos
         std::shared_ptr<EventBroker> m_eventBroker;
@@ -101,6 +155,26 @@ namespace pleep
         // time elapsed since last frame render
         std::chrono::duration<double> m_frameTimeRemaining = 
             std::chrono::duration<double>(0.0);
+
+    private:
+        // steps 1-4 of the runtime pipeline until stopped
+        void _run_frame_loop();
+        // _on_render until the simulation thread has finished
+        void _run_render_loop();
+
+        void _record_simulation(double seconds);
+        void _record_render(double seconds);
+        // log and restart the report once its period is over
+        void _roll_frame_loop_report();
+
+        // false once the simulation thread's frame loop has returned
+        std::atomic<bool> m_isSimulating{ false };
+
+        // period being recorded, and the last one completed
+        FrameLoopReport m_frameLoopReport;
+        FrameLoopReport m_lastFrameLoopReport;
+        std::chrono::steady_clock::time_point m_frameLoopReportStart;
+        mutable std::mutex m_frameLoopReportMutex;
     };
 }
 
@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    // bytes handed to the os per write call, so large files don't need one huge request
+    constexpr size_t MAPPED_FILE_WRITE_CHUNK = 1U << 20;
+
+    MappedFile::MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return;
+        m_file = file;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) return;
+        m_mapping = mapping;
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL) return;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            ::close(fd);
+            return;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (view == MAP_FAILED) return;
+        // formats are read front to back
+        madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) CloseHandle(m_file);
+#else
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    }
+
+    bool stamp_file(const std::string& path, FileStamp& dest)
+    {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) return false;
+        dest.size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+        dest.modified = static_cast<int64_t>((static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime);
+#else
+        struct stat fileStat;
+        if (stat(path.c_str(), &fileStat) != 0) return false;
+        dest.size = static_cast<uint64_t>(fileStat.st_size);
+#if defined(__APPLE__)
+        dest.modified = static_cast<int64_t>(fileStat.st_mtimespec.tv_sec) * 1000000000 + fileStat.st_mtimespec.tv_nsec;
+#else
+        dest.modified = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+#endif
+#endif
+        return true;
+    }
+
+    bool write_file_replacing(const std::string& path, const std::vector<uint8_t>& data)
+    {
+        const std::string partialPath = path + ".tmp";
+
+        FILE* file = std::fopen(partialPath.c_str(), "wb");
+        if (!file)
+        {
+            PLEEPLOG_ERROR("Could not open " + partialPath + " to write (does its directory exist?)");
+            return false;
+        }
+
+        bool written = true;
+        for (size_t offset = 0; written && offset < data.size(); offset += MAPPED_FILE_WRITE_CHUNK)
+        {
+            const size_t chunk = std::min(MAPPED_FILE_WRITE_CHUNK, data.size() - offset);
+            written = std::fwrite(data.data() + offset, 1, chunk, file) == chunk;
+        }
+        written &= std::fclose(file) == 0;
+
+        if (!written)
+        {
+            PLEEPLOG_ERROR("Could not write " + partialPath);
+            std::remove(partialPath.c_str());
+            return false;
+        }
+
+        // rename can't replace an existing file everywhere
+        std::remove(path.c_str());
+        if (std::rename(partialPath.c_str(), path.c_str()) != 0)
+        {
+            PLEEPLOG_ERROR("Could not move " + partialPath + " to " + path);
+            return false;
+        }
+        return true;
+    }
+}
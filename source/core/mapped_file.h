@@ -0,0 +1,142 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+//#include "intercession_pch.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace pleep
+{
+    // Read-only memory mapping of a whole file, unmapped on destruction
+    // For binary formats that are read in place (checkpoints, snapshots, baked assets)
+    class MappedFile
+    {
+    public:
+        // data() is null if the file doesn't exist, is empty, or can't be mapped
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+
+    // Bounds checked sequential reads of POD out of a byte range (like a MappedFile)
+    // throws runtime_error if the range ends early
+    class MappedReader
+    {
+    public:
+        MappedReader(const uint8_t* data, size_t size)
+            : m_data(data)
+            , m_size(size)
+        {}
+
+        template<typename T>
+        void read(T& dest)
+        {
+            static_assert(std::is_standard_layout<T>::value, "MappedReader can only read POD types");
+            std::memcpy(&dest, take(sizeof(T)), sizeof(T));
+        }
+        // count contiguous elements in one copy
+        template<typename T>
+        void read_array(std::vector<T>& dest, size_t count)
+        {
+            static_assert(std::is_standard_layout<T>::value, "MappedReader can only read POD types");
+            if (count > (m_size - m_offset) / sizeof(T))
+            {
+                throw std::runtime_error("Mapped data ended before " + std::to_string(count) + " elements");
+            }
+            dest.resize(count);
+            if (count > 0) std::memcpy(dest.data(), take(count * sizeof(T)), count * sizeof(T));
+        }
+        void read_bytes(std::vector<uint8_t>& dest, size_t size)
+        {
+            const uint8_t* src = take(size);
+            dest.assign(src, src + size);
+        }
+        // uint32_t length then characters
+        void read_string(std::string& dest)
+        {
+            uint32_t length = 0;
+            read(length);
+            const uint8_t* src = take(length);
+            dest.assign(reinterpret_cast<const char*>(src), length);
+        }
+        // pointer to the next size bytes (valid as long as the range is), and move past them
+        const uint8_t* take(size_t size)
+        {
+            if (size > m_size - m_offset)
+            {
+                throw std::runtime_error("Mapped data ended " + std::to_string(size - (m_size - m_offset)) + " bytes early");
+            }
+            const uint8_t* src = m_data + m_offset;
+            m_offset += size;
+            return src;
+        }
+
+        size_t get_offset() const { return m_offset; }
+        bool is_done() const { return m_offset == m_size; }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+    };
+
+    // Appends to build the byte ranges MappedReader reads
+    template<typename T>
+    void append_mapped(std::vector<uint8_t>& dest, const T& data)
+    {
+        static_assert(std::is_standard_layout<T>::value, "append_mapped can only write POD types");
+        const size_t i = dest.size();
+        dest.resize(i + sizeof(T));
+        std::memcpy(dest.data() + i, &data, sizeof(T));
+    }
+    // elements only, readers must know the count
+    template<typename T>
+    void append_mapped_array(std::vector<uint8_t>& dest, const std::vector<T>& data)
+    {
+        static_assert(std::is_standard_layout<T>::value, "append_mapped_array can only write POD types");
+        const size_t i = dest.size();
+        dest.resize(i + data.size() * sizeof(T));
+        if (!data.empty()) std::memcpy(dest.data() + i, data.data(), data.size() * sizeof(T));
+    }
+    inline void append_mapped_bytes(std::vector<uint8_t>& dest, const std::vector<uint8_t>& bytes)
+    {
+        dest.insert(dest.end(), bytes.begin(), bytes.end());
+    }
+    inline void append_mapped_string(std::vector<uint8_t>& dest, const std::string& str)
+    {
+        append_mapped(dest, static_cast<uint32_t>(str.size()));
+        dest.insert(dest.end(), str.begin(), str.end());
+    }
+
+    // Size and last modification time of a file, to tell if it changed without reading it
+    struct FileStamp
+    {
+        uint64_t size = 0;
+        // os specific units, only compare for equality
+        int64_t modified = 0;
+    };
+    // returns false if there is no file at path
+    bool stamp_file(const std::string& path, FileStamp& dest);
+
+    // write data to path.tmp and then move it over path, so readers never see a partial file
+    // returns false (leaving any previous file at path) if it could not be written
+    bool write_file_replacing(const std::string& path, const std::vector<uint8_t>& data);
+}
+
+#endif // MAPPED_FILE_H
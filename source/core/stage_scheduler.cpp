@@ -0,0 +1,322 @@
+#include "stage_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    // stages are coarse (whole synchros/dynamos) so more workers than this rarely helps
+    constexpr size_t STAGE_SCHEDULER_MAX_WORKERS = 4;
+
+    // Process wide threads which run submitted jobs in submission order
+    class StageWorkerPool
+    {
+    public:
+        static StageWorkerPool& get()
+        {
+            static StageWorkerPool pool;
+            return pool;
+        }
+
+        ~StageWorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> jobsLock(m_jobsMutex);
+                m_shutdown = true;
+            }
+            m_jobsCondition.notify_all();
+            for (std::thread& worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        size_t size() const
+        {
+            return m_workers.size();
+        }
+
+        void submit(std::function<void()> job)
+        {
+            {
+                std::lock_guard<std::mutex> jobsLock(m_jobsMutex);
+                m_jobs.push_back(std::move(job));
+            }
+            m_jobsCondition.notify_one();
+        }
+
+    private:
+        StageWorkerPool()
+        {
+            // leave one hardware thread for the caller (it runs stages too)
+            const size_t hardwareThreads = std::thread::hardware_concurrency();
+            const size_t workerCount = hardwareThreads > 1 ? std::min(hardwareThreads - 1, STAGE_SCHEDULER_MAX_WORKERS) : 0;
+
+            m_workers.reserve(workerCount);
+            for (size_t i = 0; i < workerCount; i++)
+            {
+                m_workers.emplace_back(&StageWorkerPool::_work, this);
+            }
+        }
+
+        void _work()
+        {
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> jobsLock(m_jobsMutex);
+                    m_jobsCondition.wait(jobsLock, [this]() { return m_shutdown || !m_jobs.empty(); });
+                    if (m_jobs.empty()) return;
+                    job = std::move(m_jobs.front());
+                    m_jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_jobs;
+        std::mutex m_jobsMutex;
+        std::condition_variable m_jobsCondition;
+        bool m_shutdown = false;
+    };
+
+    inline static bool stages_conflict(const StageAccess& lhs, const StageAccess& rhs)
+    {
+        if (lhs.exclusive || rhs.exclusive) return true;
+        if ((lhs.writes & (rhs.reads | rhs.writes)).any()) return true;
+        if ((rhs.writes & lhs.reads).any()) return true;
+
+        for (const void* resource : lhs.resources)
+        {
+            if (resource != nullptr && std::find(rhs.resources.begin(), rhs.resources.end(), resource) != rhs.resources.end())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string StageScheduleReport::stringify() const
+    {
+        return std::to_string(stageCount) + " stages, "
+            + std::to_string(dependencyCount) + " dependencies, critical path "
+            + std::to_string(criticalPathLength) + ", max width "
+            + std::to_string(maxWidth) + ", achieved parallelism "
+            + std::to_string(get_achieved_parallelism())
+            + (ranParallel ? "" : " (serial)");
+    }
+
+    void StageScheduler::add_stage(const char* name, StageAccess access, std::function<void()> run)
+    {
+        m_stages.push_back(Stage{ name, std::move(access), std::move(run) });
+    }
+
+    void StageScheduler::clear_stages()
+    {
+        m_stages.clear();
+    }
+
+    void StageScheduler::run()
+    {
+        _build_graph();
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        // nothing to gain if no two stages can overlap
+        m_lastReport.ranParallel = m_parallel && m_lastReport.maxWidth > 1 && get_worker_count() > 0;
+        if (m_lastReport.ranParallel)
+        {
+            _run_parallel();
+        }
+        else
+        {
+            _run_serial();
+        }
+
+        m_lastReport.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void StageScheduler::set_parallel(bool parallel)
+    {
+        m_parallel = parallel;
+    }
+
+    bool StageScheduler::is_parallel() const
+    {
+        return m_parallel;
+    }
+
+    const StageScheduleReport& StageScheduler::get_last_report() const
+    {
+        return m_lastReport;
+    }
+
+    size_t StageScheduler::get_worker_count()
+    {
+        return StageWorkerPool::get().size();
+    }
+
+    void StageScheduler::_build_graph()
+    {
+        const size_t stageCount = m_stages.size();
+        m_dependents.resize(stageCount);
+        for (std::vector<size_t>& dependents : m_dependents)
+        {
+            dependents.clear();
+        }
+        m_dependencyCounts.assign(stageCount, 0);
+
+        // depth of each stage (longest chain of conflicts ending at it)
+        std::vector<size_t> depths(stageCount, 1);
+        m_lastReport = StageScheduleReport{};
+        m_lastReport.stageCount = stageCount;
+
+        for (size_t later = 0; later < stageCount; later++)
+        {
+            for (size_t earlier = 0; earlier < later; earlier++)
+            {
+                if (!stages_conflict(m_stages[earlier].access, m_stages[later].access)) continue;
+
+                m_dependents[earlier].push_back(later);
+                m_dependencyCounts[later]++;
+                depths[later] = std::max(depths[later], depths[earlier] + 1);
+                m_lastReport.dependencyCount++;
+            }
+            m_lastReport.criticalPathLength = std::max(m_lastReport.criticalPathLength, depths[later]);
+        }
+
+        // stages at the same depth never conflict with each other
+        std::vector<size_t> widths(m_lastReport.criticalPathLength + 1, 0);
+        for (size_t depth : depths)
+        {
+            m_lastReport.maxWidth = std::max(m_lastReport.maxWidth, ++widths[depth]);
+        }
+    }
+
+    void StageScheduler::_run_serial()
+    {
+        std::exception_ptr firstError = nullptr;
+        for (Stage& stage : m_stages)
+        {
+            const std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+            try
+            {
+                stage.run();
+            }
+            catch (...)
+            {
+                PLEEPLOG_ERROR("Scheduled stage {} threw an exception", stage.name);
+                if (!firstError) firstError = std::current_exception();
+            }
+            m_lastReport.stageSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stageStart).count();
+        }
+
+        if (firstError) std::rethrow_exception(firstError);
+    }
+
+    struct StageScheduler::RunState
+    {
+        // only touched after taking a stage, which must finish before run() returns
+        StageScheduler* scheduler;
+
+        std::mutex mutex;
+        std::condition_variable stageFinished;
+        std::deque<size_t> ready;
+        std::vector<size_t> remainingDependencies;
+        size_t finishedCount = 0;
+        double stageSeconds = 0.0;
+        std::exception_ptr firstError = nullptr;
+    };
+
+    void StageScheduler::_run_parallel()
+    {
+        std::shared_ptr<RunState> state = std::make_shared<RunState>();
+        state->scheduler = this;
+        state->remainingDependencies = m_dependencyCounts;
+        for (size_t i = 0; i < m_stages.size(); i++)
+        {
+            if (m_dependencyCounts[i] == 0) state->ready.push_back(i);
+        }
+
+        std::unique_lock<std::mutex> stateLock(state->mutex);
+        // this thread takes the first ready stage, workers are offered the rest
+        for (size_t extra = 1; extra < state->ready.size(); extra++)
+        {
+            StageWorkerPool::get().submit([state]()
+            {
+                std::unique_lock<std::mutex> helperLock(state->mutex);
+                _drain_ready(state, helperLock);
+            });
+        }
+
+        while (state->finishedCount < m_stages.size())
+        {
+            _drain_ready(state, stateLock);
+            // remaining stages are running elsewhere or waiting on them
+            state->stageFinished.wait(stateLock, [this, &state]()
+            {
+                return !state->ready.empty() || state->finishedCount == m_stages.size();
+            });
+        }
+
+        m_lastReport.stageSeconds = state->stageSeconds;
+        if (state->firstError) std::rethrow_exception(state->firstError);
+    }
+
+    void StageScheduler::_drain_ready(const std::shared_ptr<RunState>& state, std::unique_lock<std::mutex>& stateLock)
+    {
+        StageScheduler* scheduler = state->scheduler;
+
+        while (!state->ready.empty())
+        {
+            const size_t stageIndex = state->ready.front();
+            state->ready.pop_front();
+            stateLock.unlock();
+
+            std::exception_ptr error = nullptr;
+            const std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+            try
+            {
+                scheduler->m_stages[stageIndex].run();
+            }
+            catch (...)
+            {
+                PLEEPLOG_ERROR("Scheduled stage {} threw an exception", scheduler->m_stages[stageIndex].name);
+                error = std::current_exception();
+            }
+            const double stageSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stageStart).count();
+
+            stateLock.lock();
+            state->stageSeconds += stageSeconds;
+            if (error && !state->firstError) state->firstError = error;
+
+            const size_t readyBefore = state->ready.size();
+            for (size_t dependent : scheduler->m_dependents[stageIndex])
+            {
+                if (--state->remainingDependencies[dependent] == 0) state->ready.push_back(dependent);
+            }
+            state->finishedCount++;
+            state->stageFinished.notify_all();
+
+            // keep one newly ready stage for ourselves, offer the others to workers
+            for (size_t extra = std::max<size_t>(readyBefore, 1); extra < state->ready.size(); extra++)
+            {
+                StageWorkerPool::get().submit([state]()
+                {
+                    std::unique_lock<std::mutex> helperLock(state->mutex);
+                    _drain_ready(state, helperLock);
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef STAGE_SCHEDULER_H
+#define STAGE_SCHEDULER_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <functional>
+#include <string>
+#include <memory>
+#include <mutex>
+
+#include "ecs/ecs_types.h"
+
+namespace pleep
+{
+    // What a stage (synchro update, dynamo relays, ...) touches while it runs
+    // Two stages conflict (and keep their added order) if either writes a component the other uses,
+    // they share a resource, or either is exclusive
+    struct StageAccess
+    {
+        // components only read
+        Signature reads;
+        // components modified
+        Signature writes;
+        // any other shared state the stage mutates (usually the dynamo it submits to)
+        std::vector<const void*> resources;
+        // conflicts with every other stage (for stages which can't describe what they touch)
+        bool exclusive = true;
+    };
+
+    // Timing of the most recent StageScheduler::run
+    struct StageScheduleReport
+    {
+        size_t stageCount = 0;
+        // number of conflicts between stages
+        size_t dependencyCount = 0;
+        // most stages which have to run one after another
+        size_t criticalPathLength = 0;
+        // most stages which could run at once
+        size_t maxWidth = 0;
+        // sum of all stage run times
+        double stageSeconds = 0.0;
+        // time from start of run until all stages finished
+        double wallSeconds = 0.0;
+        // whether stages were given to workers
+        bool ranParallel = false;
+
+        // average number of stages actually running at once
+        double get_achieved_parallelism() const
+        {
+            return wallSeconds > 0.0 ? stageSeconds / wallSeconds : 1.0;
+        }
+
+        std::string stringify() const;
+    };
+
+    // Runs a list of stages, concurrently where their StageAccess doesn't conflict
+    // Dependencies are rebuilt every run from the stages' current access, a stage only
+    // waits for conflicting stages that were added before it, so running them serially
+    // in added order is always a valid (deterministic) fallback
+    // Workers are shared by all schedulers in the process, the calling thread also runs
+    // stages so a run always completes even if every worker is busy elsewhere
+    class StageScheduler
+    {
+    public:
+        StageScheduler() = default;
+        ~StageScheduler() = default;
+
+        // name is kept by pointer (use string literals or typeid names)
+        void add_stage(const char* name, StageAccess access, std::function<void()> run);
+        // forget all stages (keeps allocations)
+        void clear_stages();
+
+        // run all stages and block until they are all finished
+        // rethrows the first exception thrown by a stage (after the rest have finished)
+        void run();
+
+        // false -> always run serially on the calling thread in added order
+        void set_parallel(bool parallel);
+        bool is_parallel() const;
+
+        const StageScheduleReport& get_last_report() const;
+
+        // number of shared worker threads (0 if only the calling thread is used)
+        static size_t get_worker_count();
+
+    private:
+        struct Stage
+        {
+            const char* name;
+            StageAccess access;
+            std::function<void()> run;
+        };
+
+        // progress of one parallel run, shared with worker jobs
+        struct RunState;
+
+        // populate m_dependents/m_dependencyCounts, and report shape
+        void _build_graph();
+        void _run_serial();
+        void _run_parallel();
+        // run ready stages until there are none left (stateLock held on entry and return)
+        static void _drain_ready(const std::shared_ptr<RunState>& state, std::unique_lock<std::mutex>& stateLock);
+
+        std::vector<Stage> m_stages;
+        // stage index -> later stages which must wait for it
+        std::vector<std::vector<size_t>> m_dependents;
+        // stage index -> number of earlier stages it must wait for
+        std::vector<size_t> m_dependencyCounts;
+
+        bool m_parallel = true;
+        StageScheduleReport m_lastReport;
+    };
+}
+
+#endif // STAGE_SCHEDULER_H
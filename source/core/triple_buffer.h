@@ -0,0 +1,89 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+//#include "intercession_pch.h"
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <utility>
+
+namespace pleep
+{
+    // Hands whole values from one producer thread to one consumer thread without either waiting on the other:
+    // the producer fills the back slot and publishes it as the ready slot, the consumer acquires
+    // the ready slot as its front slot. Slots are swapped (never copied) so their storage is reused.
+    // If the producer publishes again before the consumer acquired, the unconsumed value is dropped
+    // (consumer always gets the newest one).
+    template<typename T_Value>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+        ~TripleBuffer() = default;
+
+        // producer's slot, only valid on the producer thread until the next publish
+        T_Value& get_back()
+        {
+            return m_slots[m_back];
+        }
+
+        // make back slot the newest ready value, producer gets the previous ready (or consumed) slot as its back
+        // returns true if the ready value being replaced was never acquired
+        bool publish()
+        {
+            bool dropped;
+            {
+                std::lock_guard<std::mutex> slotsLock(m_slotsMutex);
+                std::swap(m_back, m_ready);
+                dropped = m_isReadyFresh;
+                m_isReadyFresh = true;
+            }
+            m_readyCondition.notify_one();
+            return dropped;
+        }
+
+        // swap the newest ready value into the front slot
+        // returns false (and keeps the current front) if nothing was published since the last acquire
+        bool acquire()
+        {
+            std::lock_guard<std::mutex> slotsLock(m_slotsMutex);
+            return _acquire();
+        }
+
+        // acquire, waiting up to maxWaitSeconds for the producer to publish
+        bool wait_acquire(double maxWaitSeconds)
+        {
+            std::unique_lock<std::mutex> slotsLock(m_slotsMutex);
+            m_readyCondition.wait_for(slotsLock, std::chrono::duration<double>(maxWaitSeconds), [this]() { return m_isReadyFresh; });
+            return _acquire();
+        }
+
+        // consumer's slot, only valid on the consumer thread until the next acquire
+        T_Value& get_front()
+        {
+            return m_slots[m_front];
+        }
+
+    private:
+        bool _acquire()
+        {
+            if (!m_isReadyFresh) return false;
+            std::swap(m_front, m_ready);
+            m_isReadyFresh = false;
+            return true;
+        }
+
+        T_Value m_slots[3];
+        // indices into m_slots, m_ready is only touched with m_slotsMutex held
+        size_t m_back  = 0;
+        size_t m_ready = 1;
+        size_t m_front = 2;
+        // ready slot has been published but not yet acquired
+        bool m_isReadyFresh = false;
+
+        std::mutex m_slotsMutex;
+        std::condition_variable m_readyCondition;
+    };
+}
+
+#endif // TRIPLE_BUFFER_H
@@ -3,7 +3,9 @@
 
 //#include "intercession_pch.h"
 #include <exception>
-#include <array>
+#include <deque>
+#include <vector>
+#include <atomic>
 #include <unordered_map>
 
 #include "ecs/ecs_types.h"
@@ -38,36 +40,54 @@ namespace pleep
         
         // Push component data into msg
         // does nothing if component does not exist
-        void serialize_data_for(Entity entity, EventMessage& msg) override;
+        void serialize_data_for(Entity entity, EventMessage& msg, WireEncoding encoding) override;
         
         // Pop component data from msg and overwrite;
         // non-strict usage, does nothing if component does not exist
-        void deserialize_data_for(Entity entity, EventMessage& msg) override;
+        void deserialize_data_for(Entity entity, EventMessage& msg, WireEncoding encoding) override;
 
         // Pop component data from msg and destroy it
         // non-strict usage, does nothing if component does not exist
-        void discard_data_for(EventMessage& msg) override;
+        void discard_data_for(EventMessage& msg, WireEncoding encoding) override;
 
-        // return reference to component for this entity
+        // flag component as modified
+        void mark_changed_for(Entity entity) override;
+
+        bool is_changed_for(Entity entity) override;
+
+        void clear_changed() override;
+
+        // return reference to component for this entity, assumed to be modified (marks changed)
         // does NOT return "not found", THROWS if no component exists
         T& get_data_for(Entity entity);
 
+        // return reference to component for this entity without marking it changed
+        // does NOT return "not found", THROWS if no component exists
+        const T& read_data_for(Entity entity);
+
         // linearly find first entity with T equal to component
         // operator == must be defined for T
         Entity find_entity_for(T component);
 
     private:
         // Goal is to have a PACKED array of components
-        // each possible entity has a unique spot available
-        std::array<T, ENTITY_SIZE> m_array;
+        // sized by the number of components, not the range of Entity values
+        // (deque grows in blocks without moving existing elements, so references stay valid)
+        std::deque<T> m_array;
 
         // Maintained map of entity -> component index
         std::unordered_map<Entity, size_t> m_mapEntityToIndex;
 
-        // Maintained map of component index -> entity
-        std::unordered_map<size_t, Entity> m_mapIndexToEntity;
+        // Maintained map of component index -> entity (parallel to m_array)
+        std::vector<Entity> m_mapIndexToEntity;
 
-        size_t m_size;
+        // Modified since last clear_changed (parallel to m_array)
+        // atomic because synchros fetching the same component may be updated concurrently
+        std::deque<std::atomic<uint8_t>> m_changed;
+
+        // index of entity's component
+        // THROWS if no component exists
+        size_t _get_index_for(Entity entity);
     };
     
     template<typename T>
@@ -75,16 +95,17 @@ namespace pleep
     {
         if (m_mapEntityToIndex.find(entity) != m_mapEntityToIndex.end())
         {
-            PLEEPLOG_ERROR("Cannot add component to entity " + std::to_string(entity) + " which already has component of this type");
+            PLEEPLOG_ERROR("Cannot add component to entity {} which already has component of this type", entity);
             throw std::range_error("ComponentArray cannot add component to entity " + std::to_string(entity) + " which already has component of this type");
         }
 
         // append new entry
-        size_t newIndex = m_size;
-        m_mapEntityToIndex[entity]   = newIndex;
-        m_mapIndexToEntity[newIndex] = entity;
-        m_array[newIndex]            = component;
-        m_size++;
+        size_t newIndex = m_array.size();
+        m_mapEntityToIndex[entity] = newIndex;
+        m_mapIndexToEntity.push_back(entity);
+        m_array.push_back(std::move(component));
+        // new components haven't been replicated yet
+        m_changed.emplace_back(static_cast<uint8_t>(1));
     }
 
     template<typename T>
@@ -98,14 +119,15 @@ namespace pleep
     {
         if (m_mapEntityToIndex.find(entity) == m_mapEntityToIndex.end())
         {
-            PLEEPLOG_ERROR("Cannot remove component from entity " + std::to_string(entity) + " which has no component of this type");
+            PLEEPLOG_ERROR("Cannot remove component from entity {} which has no component of this type", entity);
             throw std::range_error("ComponentArray cannot remove component from entity " + std::to_string(entity) + " which has no component of this type");
         }
 
         // copy end element into removed index
         size_t removedIndex   = m_mapEntityToIndex[entity];
-        size_t lastIndex      = m_size - 1;
+        size_t lastIndex      = m_array.size() - 1;
         m_array[removedIndex] = m_array[lastIndex];
+        m_changed[removedIndex].store(m_changed[lastIndex].load(std::memory_order_relaxed), std::memory_order_relaxed);
 
         // Update maps to point to moved index
         Entity lastEntity = m_mapIndexToEntity[lastIndex];
@@ -113,24 +135,65 @@ namespace pleep
         m_mapIndexToEntity[removedIndex] = lastEntity;
 
         m_mapEntityToIndex.erase(entity);
-        m_mapIndexToEntity.erase(lastIndex);
-
-        m_size--;
+        m_mapIndexToEntity.pop_back();
+        m_array.pop_back();
+        m_changed.pop_back();
     }
 
     template<typename T>
-    T& ComponentArray<T>::get_data_for(Entity entity)
+    size_t ComponentArray<T>::_get_index_for(Entity entity)
     {
         auto indexIt = m_mapEntityToIndex.find(entity);
         if (indexIt == m_mapEntityToIndex.end())
         {
-            PLEEPLOG_ERROR("Cannot retrieve component '" + std::string(typeid(T).name()) + "' from entity " + std::to_string(entity) + " which has no component of this type");
+            PLEEPLOG_ERROR("Cannot retrieve component '{}' from entity {} which has no component of this type", typeid(T).name(), entity);
             throw std::range_error("ComponentArray cannot retrieve component '" + std::string(typeid(T).name()) + "' from entity " + std::to_string(entity) + " which has no component of this type");
         }
         // If we found data for NULL_ENTITY, something has gone wrong
         assert(entity != NULL_ENTITY);
 
-        return m_array[indexIt->second];
+        return indexIt->second;
+    }
+
+    template<typename T>
+    T& ComponentArray<T>::get_data_for(Entity entity)
+    {
+        const size_t index = this->_get_index_for(entity);
+        m_changed[index].store(1, std::memory_order_relaxed);
+        return m_array[index];
+    }
+
+    template<typename T>
+    const T& ComponentArray<T>::read_data_for(Entity entity)
+    {
+        return m_array[this->_get_index_for(entity)];
+    }
+
+    template<typename T>
+    void ComponentArray<T>::mark_changed_for(Entity entity)
+    {
+        auto indexIt = m_mapEntityToIndex.find(entity);
+        if (indexIt == m_mapEntityToIndex.end()) return;
+
+        m_changed[indexIt->second].store(1, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    bool ComponentArray<T>::is_changed_for(Entity entity)
+    {
+        auto indexIt = m_mapEntityToIndex.find(entity);
+        if (indexIt == m_mapEntityToIndex.end()) return false;
+
+        return m_changed[indexIt->second].load(std::memory_order_relaxed) != 0;
+    }
+
+    template<typename T>
+    void ComponentArray<T>::clear_changed()
+    {
+        for (std::atomic<uint8_t>& changed : m_changed)
+        {
+            changed.store(0, std::memory_order_relaxed);
+        }
     }
 
     template<typename T>
@@ -156,7 +219,7 @@ namespace pleep
     }
     
     template<typename T>
-    void ComponentArray<T>::serialize_data_for(Entity entity, EventMessage& msg)
+    void ComponentArray<T>::serialize_data_for(Entity entity, EventMessage& msg, WireEncoding encoding)
     {
         // exit safely if not found
         if (m_mapEntityToIndex.find(entity) == m_mapEntityToIndex.end())
@@ -165,11 +228,12 @@ namespace pleep
             return;
         }
 
-        msg << this->get_data_for(entity);
+        // uses T's codec overload if it has one, otherwise operator<<
+        encode_component(msg, this->read_data_for(entity), encoding);
     }
 
     template<typename T>
-    void ComponentArray<T>::deserialize_data_for(Entity entity, EventMessage& msg)
+    void ComponentArray<T>::deserialize_data_for(Entity entity, EventMessage& msg, WireEncoding encoding)
     {
         // exit safely if not found
         if (m_mapEntityToIndex.find(entity) == m_mapEntityToIndex.end())
@@ -179,15 +243,15 @@ namespace pleep
         }
 
         // Assume new msg data is for type T
-        // write directly into component array via operator>> override
-        msg >> m_array[m_mapEntityToIndex[entity]];
+        // write directly into component array via codec/operator>> override
+        decode_component(msg, this->get_data_for(entity), encoding);
     }
     
     template<typename T>
-    void ComponentArray<T>::discard_data_for(EventMessage& msg)
+    void ComponentArray<T>::discard_data_for(EventMessage& msg, WireEncoding encoding)
     {
         T dumper;
-        msg >> dumper;
+        decode_component(msg, dumper, encoding);
         // cast it into the fire! ...get it?
         static_cast<void>(dumper);
     }
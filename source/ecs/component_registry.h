@@ -2,7 +2,8 @@
 #define COMPONENT_REGISTRY_H
 
 //#include "intercession_pch.h"
-#include <unordered_map>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <typeinfo>
 #include <exception>
@@ -14,6 +15,31 @@
 
 namespace pleep
 {
+    // Process-wide dense index for each component type, assigned the first time a type is used
+    // This is NOT the ComponentType (signature bit), which depends on registration order per registry,
+    // it only lets registries find a type's array without hashing its name
+    class ComponentTypeIndex
+    {
+    public:
+        template<typename T>
+        static size_t get()
+        {
+            static const size_t index = _next()++;
+            return index;
+        }
+
+    private:
+        // (inline function statics are shared between translation units)
+        static std::atomic<size_t>& _next()
+        {
+            static std::atomic<size_t> counter{ 0 };
+            return counter;
+        }
+    };
+
+    // max distinct component types used across all registries in this process
+    const size_t MAX_COMPONENT_TYPE_INDEX = 4 * MAX_COMPONENT_TYPES;
+
     class ComponentRegistry
     {
     public:
@@ -61,6 +87,21 @@ namespace pleep
         // THROWS if component does not exist or component type has not yet been registered
         template<typename T>
         T& get_component(Entity entity);
+
+        // get reference to component without flagging it as changed (for replication)
+        // THROWS if component does not exist or component type has not yet been registered
+        template<typename T>
+        const T& read_component(Entity entity);
+
+        // flag component as changed, for modifications made through references held elsewhere
+        // THROWS runtime_error if componentId does not exist
+        void mark_component_changed(Entity entity, ComponentType componentId);
+
+        // subset of sign which has been changed for entity since last clear_changed_components
+        Signature get_changed_signature(Entity entity, Signature sign);
+
+        // unflag all components of all entities
+        void clear_changed_components();
         
         // safely clear all registered components for given entity
         void clear_entity(Entity entity);
@@ -75,7 +116,8 @@ namespace pleep
 
         // loop through each ComponentType in entitySign, map to name, index that component array,
         // get the component data for entity, then push it into message
-        void serialize_entity_components(Entity entity, Signature sign, EventMessage& msg);
+        // encoding is pushed last, so the receiver doesn't need to know it
+        void serialize_entity_components(Entity entity, Signature sign, EventMessage& msg, WireEncoding encoding);
 
         // loop through each ComponentType in entitySign, map to name, index that component array,
         // call deserialize_single_component with that component
@@ -83,11 +125,11 @@ namespace pleep
 
         // index component array using name,
         // get that array to unpack next data in msg, and copy it into entity's data
-        void deserialize_single_component(Entity entity, ComponentType type, EventMessage& msg);
+        void deserialize_single_component(Entity entity, ComponentType type, EventMessage& msg, WireEncoding encoding = WireEncoding::exact);
 
         // index component array using name,
         // get that array to unpack next data in msg, and destroy it!
-        void discard_single_component(ComponentType type, EventMessage& msg);
+        void discard_single_component(ComponentType type, EventMessage& msg, WireEncoding encoding = WireEncoding::exact);
 
         // Return list of component typeid names
         // MUST be ordered by ComponentType
@@ -96,17 +138,23 @@ namespace pleep
     private:
         // cast ComponentArray into mapped type
         template<typename T>
-        std::shared_ptr<ComponentArray<T>> _get_component_array();
+        ComponentArray<T>* _get_component_array();
+
+        // get array for registered id
+        // THROWS runtime_error if component type is not yet registered
+        I_ComponentArray* _get_component_array(ComponentType componentId);
 
-        // "type string" pointer to a component type's id
-        std::unordered_map<const char*, ComponentType> m_componentTypes{};
-        // reverse map
-        std::unordered_map<ComponentType, const char*> m_componentNames{};
-        // map components to categories
-        std::unordered_map<ComponentType, ComponentCategory> m_componentCategories{};
+        // ComponentTypeIndex -> (non-owning) component array, null if not registered here
+        std::array<I_ComponentArray*, MAX_COMPONENT_TYPE_INDEX> m_arraysByTypeIndex{};
+        // ComponentTypeIndex -> registered id (only valid where m_arraysByTypeIndex is non-null)
+        std::array<ComponentType, MAX_COMPONENT_TYPE_INDEX> m_componentTypes{};
 
-        // "type string" pointer to a component Array objeect pointer
-        std::unordered_map<const char*, std::shared_ptr<I_ComponentArray>> m_componentArrays{};
+        // registered id -> component array (owning)
+        std::array<std::unique_ptr<I_ComponentArray>, MAX_COMPONENT_TYPES> m_componentArrays{};
+        // registered id -> typeid name
+        std::array<const char*, MAX_COMPONENT_TYPES> m_componentNames{};
+        // registered id -> category
+        std::array<ComponentCategory, MAX_COMPONENT_TYPES> m_componentCategories{};
 
         // track total components registered
         // this isn't a queue (unlike entities) so component types can't be recycled
@@ -118,28 +166,36 @@ namespace pleep
     void ComponentRegistry::register_component_type(ComponentCategory category)
     {
         const char* typeName = typeid(T).name();
+        const size_t typeIndex = ComponentTypeIndex::get<T>();
 
-        if (m_componentTypes.find(typeName) != m_componentTypes.end())
+        if (typeIndex >= MAX_COMPONENT_TYPE_INDEX)
         {
-            PLEEPLOG_ERROR("Cannot register component type " + std::string(typeName) + " which already exists");
+            PLEEPLOG_ERROR("Cannot register component type {}. Max component type index {} exceeded.", typeName, MAX_COMPONENT_TYPE_INDEX);
+            throw std::runtime_error("ComponentRegistry cannot register component type " + std::string(typeName) + ". Max component type index " + std::to_string(MAX_COMPONENT_TYPE_INDEX) + " exceeded.");
+        }
+
+        if (m_arraysByTypeIndex[typeIndex] != nullptr)
+        {
+            PLEEPLOG_ERROR("Cannot register component type {} which already exists", typeName);
             throw std::runtime_error("ComponentRegistry cannot register component type " + std::string(typeName) + " which already exists");
         }
         
         if (m_componentTypeCount >= MAX_COMPONENT_TYPES)
         {
-            PLEEPLOG_ERROR("Cannot register component type " + std::string(typeName) + ". Max component count " + std::to_string(MAX_COMPONENT_TYPES) + " exceeded.");
+            PLEEPLOG_ERROR("Cannot register component type {}. Max component count {} exceeded.", typeName, MAX_COMPONENT_TYPES);
             throw std::runtime_error("ComponentRegistry cannot register component type " + std::string(typeName) + ". Max component count " + std::to_string(MAX_COMPONENT_TYPES) + " exceeded.");
         }
 
         // add type id/name to next register index
-        m_componentTypes.insert({ typeName, m_componentTypeCount });
-        m_componentNames.insert({ m_componentTypeCount, typeName });
+        m_componentTypes[typeIndex] = m_componentTypeCount;
+        m_componentNames[m_componentTypeCount] = typeName;
 
         // assign category
-        m_componentCategories.insert({ m_componentTypeCount, category });
+        m_componentCategories[m_componentTypeCount] = category;
 
         // create an array object for this type id/name
-        m_componentArrays.insert({typeName, std::make_shared<ComponentArray<T>>()});
+        m_componentArrays[m_componentTypeCount] = std::make_unique<ComponentArray<T>>();
+        m_arraysByTypeIndex[typeIndex] = m_componentArrays[m_componentTypeCount].get();
 
         // Increment count to next available index
         m_componentTypeCount++;
@@ -148,7 +204,7 @@ namespace pleep
     inline Signature ComponentRegistry::get_category_signature(ComponentCategory category)
     {
         Signature sign;
-        for (ComponentType i = 0; i < MAX_COMPONENT_TYPES; i++)
+        for (ComponentType i = 0; i < m_componentTypeCount; i++)
         {
             if (m_componentCategories[i] == category) sign.set(i);
         }
@@ -158,23 +214,23 @@ namespace pleep
     template<typename T>
     ComponentType ComponentRegistry::get_component_type()
     {
-        const char* typeName = typeid(T).name();
+        const size_t typeIndex = ComponentTypeIndex::get<T>();
 
-        if (m_componentTypes.find(typeName) == m_componentTypes.end())
+        if (typeIndex >= MAX_COMPONENT_TYPE_INDEX || m_arraysByTypeIndex[typeIndex] == nullptr)
         {
-            PLEEPLOG_ERROR("Cannot retrieve component type " + std::string(typeName) + " which has not been registered");
-            throw std::range_error("ComponentRegistry cannot retrieve component type " + std::string(typeName) + " which has not been registered");
+            PLEEPLOG_ERROR("Cannot retrieve component type {} which has not been registered", typeid(T).name());
+            throw std::range_error("ComponentRegistry cannot retrieve component type " + std::string(typeid(T).name()) + " which has not been registered");
         }
 
         // this type is used for creating signatures
-        return m_componentTypes[typeName];
+        return m_componentTypes[typeIndex];
     }
 
     inline const char* ComponentRegistry::get_component_name(ComponentType componentId)
     {
-        if (m_componentNames.find(componentId) == m_componentNames.end())
+        if (componentId >= m_componentTypeCount)
         {
-            PLEEPLOG_ERROR("Cannot retrieve component id " + std::to_string(componentId) + " which has not been registered");
+            PLEEPLOG_ERROR("Cannot retrieve component id {} which has not been registered", componentId);
             throw std::range_error("ComponentRegistry cannot retrieve component id " + std::to_string(componentId) + " which has not been registered");
         }
 
@@ -189,7 +245,7 @@ namespace pleep
 
     inline void ComponentRegistry::add_component(Entity entity, ComponentType componentId)
     {
-        m_componentArrays[get_component_name(componentId)]->emplace_data_for(entity);
+        this->_get_component_array(componentId)->emplace_data_for(entity);
     }
 
     template<typename T>
@@ -200,15 +256,15 @@ namespace pleep
 
     inline void ComponentRegistry::remove_component(Entity entity, ComponentType componentId)
     {
-        m_componentArrays[get_component_name(componentId)]->clear_data_for(entity);
+        this->_get_component_array(componentId)->clear_data_for(entity);
     }
 
     
     inline bool ComponentRegistry::has_component(Entity entity, ComponentType componentId)
     {
-        if (m_componentNames.find(componentId) != m_componentNames.end())
+        if (componentId < m_componentTypeCount)
         {
-            return m_componentArrays[get_component_name(componentId)]->has_data_for(entity);
+            return m_componentArrays[componentId]->has_data_for(entity);
         }
         return false;
     }
@@ -219,13 +275,40 @@ namespace pleep
         return this->_get_component_array<T>()->get_data_for(entity);
     }
     
+    template<typename T>
+    const T& ComponentRegistry::read_component(Entity entity)
+    {
+        return this->_get_component_array<T>()->read_data_for(entity);
+    }
+
+    inline void ComponentRegistry::mark_component_changed(Entity entity, ComponentType componentId)
+    {
+        this->_get_component_array(componentId)->mark_changed_for(entity);
+    }
+
+    inline Signature ComponentRegistry::get_changed_signature(Entity entity, Signature sign)
+    {
+        Signature changed;
+        for (ComponentType i = 0; i < m_componentTypeCount; i++)
+        {
+            if (sign.test(i) && m_componentArrays[i]->is_changed_for(entity)) changed.set(i);
+        }
+        return changed;
+    }
+
+    inline void ComponentRegistry::clear_changed_components()
+    {
+        for (ComponentType i = 0; i < m_componentTypeCount; i++)
+        {
+            m_componentArrays[i]->clear_changed();
+        }
+    }
+    
     inline void ComponentRegistry::clear_entity(Entity entity)
     {
-        // typeid & ComponentArray pointer
-        for (auto const& pair : m_componentArrays)
+        for (ComponentType i = 0; i < m_componentTypeCount; i++)
         {
-            //std::shared_ptr<I_ComponentArray> const& components = pair.second;
-            pair.second->clear_data_for(entity);
+            m_componentArrays[i]->clear_data_for(entity);
         }
     }
     
@@ -235,7 +318,7 @@ namespace pleep
         return this->_get_component_array<T>()->find_entity_for(component);
     }
     
-    inline void ComponentRegistry::serialize_entity_components(Entity entity, Signature sign, EventMessage& msg)
+    inline void ComponentRegistry::serialize_entity_components(Entity entity, Signature sign, EventMessage& msg, WireEncoding encoding)
     {
         // Signature size is defined as a ComponentType so no loss is possible
         assert(sign.size() == MAX_COMPONENT_TYPES);
@@ -247,13 +330,17 @@ namespace pleep
             {
                 // this index is valid
                 //PLEEPLOG_DEBUG("Serializing component: " + std::to_string(i) + " into msg(" + std::to_string(msg.size()) + ")");
-                m_componentArrays[get_component_name(i)]->serialize_data_for(entity, msg);
+                this->_get_component_array(i)->serialize_data_for(entity, msg, encoding);
             }
         }
+        msg << encoding;
     }
 
     inline void ComponentRegistry::deserialize_entity_components(Entity entity, Signature sign, EventMessage& msg, Signature filterSign)
     {
+        WireEncoding encoding;
+        msg >> encoding;
+
         for (ComponentType i = 0; i < MAX_COMPONENT_TYPES; i++)
         {
             if (sign.test(i))
@@ -268,59 +355,63 @@ namespace pleep
                 //PLEEPLOG_DEBUG("Deserializing msg(" + std::to_string(msg.size()) + ") into " + std::string(componentTypename));
                 if (filterSign.test(i))
                 {
-                    this->deserialize_single_component(entity, i, msg);
+                    this->deserialize_single_component(entity, i, msg, encoding);
                 }
                 else
                 {
-                    this->discard_single_component(i, msg);
+                    this->discard_single_component(i, msg, encoding);
                 }
             }
         }
     }
 
-    inline void ComponentRegistry::deserialize_single_component(Entity entity, ComponentType type, EventMessage& msg)
+    inline void ComponentRegistry::deserialize_single_component(Entity entity, ComponentType type, EventMessage& msg, WireEncoding encoding)
     {
-        m_componentArrays.at(get_component_name(type))->deserialize_data_for(entity, msg);
+        this->_get_component_array(type)->deserialize_data_for(entity, msg, encoding);
     }
     
-    inline void ComponentRegistry::discard_single_component(ComponentType type, EventMessage& msg)
+    inline void ComponentRegistry::discard_single_component(ComponentType type, EventMessage& msg, WireEncoding encoding)
     {
-        m_componentArrays.at(get_component_name(type))->discard_data_for(msg);
+        this->_get_component_array(type)->discard_data_for(msg, encoding);
     }
     
     template<typename T>
-    std::shared_ptr<ComponentArray<T>> ComponentRegistry::_get_component_array()
+    ComponentArray<T>* ComponentRegistry::_get_component_array()
     {
-        // c++ magic?
-        const char* typeName = typeid(T).name();
+        const size_t typeIndex = ComponentTypeIndex::get<T>();
 
         // component type may not have been registered
-        if (m_componentTypes.find(typeName) == m_componentTypes.end())
+        if (typeIndex >= MAX_COMPONENT_TYPE_INDEX || m_arraysByTypeIndex[typeIndex] == nullptr)
         {
-            PLEEPLOG_ERROR("Cannot get array for component " + std::string(typeName) + " which has not been registered");
-            throw std::runtime_error("ComponentRegistry cannot get array for component " + std::string(typeName) + " which has not been registered");
+            PLEEPLOG_ERROR("Cannot get array for component {} which has not been registered", typeid(T).name());
+            throw std::runtime_error("ComponentRegistry cannot get array for component " + std::string(typeid(T).name()) + " which has not been registered");
         }
 
-        return std::static_pointer_cast<ComponentArray<T>>(m_componentArrays[typeName]);
+        // only ComponentArray<T> is ever stored at T's index
+        return static_cast<ComponentArray<T>*>(m_arraysByTypeIndex[typeIndex]);
+    }
+
+    inline I_ComponentArray* ComponentRegistry::_get_component_array(ComponentType componentId)
+    {
+        if (componentId >= m_componentTypeCount)
+        {
+            PLEEPLOG_ERROR("Cannot get array for component id {} which has not been registered", componentId);
+            throw std::runtime_error("ComponentRegistry cannot get array for component id " + std::to_string(componentId) + " which has not been registered");
+        }
+
+        return m_componentArrays[componentId].get();
     }
 
     
     inline std::vector<std::string> ComponentRegistry::stringify()
     {
         std::vector<std::string> componentNames;
-        componentNames.reserve(m_componentNames.size());
-        for (auto componentIt : m_componentNames)
+        componentNames.reserve(m_componentTypeCount);
+        // names are already indexed by ComponentType
+        for (ComponentType i = 0; i < m_componentTypeCount; i++)
         {
-            componentNames.push_back(componentIt.second);
+            componentNames.push_back(m_componentNames[i]);
         }
-
-        // Just sort AFTER extracting from the map?
-        std::sort(componentNames.begin(), componentNames.end(), 
-            [this](std::string a, std::string b)
-            {
-                return this->m_componentTypes[a.c_str()] < this->m_componentTypes[b.c_str()];
-            }
-        );
         
         return componentNames;
     }
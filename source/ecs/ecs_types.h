@@ -5,19 +5,91 @@
 #include <bitset>
 #include <cstdint>
 #include <cassert>
+#include <limits>
+#include <type_traits>
 #include "logging/pleep_log.h"
 
 namespace pleep
 {
     // Top-level constant definitions for the ECS
 
+    // Entity values have 3 constituents: TimesliceId, GenesisId and CausalChainLink
+    // packed into a single unsigned integer as:
+    //     [high bits] (Their host's) TimesliceId
+    //     [mid  bits] GenesisId
+    //     [low  bits] CausalChainLink
+    // A layout picks the storage type and the bitwidth of each constituent,
+    // ranges only affect how many ids are available, storage scales with entities actually in use
+
+    // 15 timeslices, 255 entities hosted per timeslice, 15 chainlinks
+    struct EntityLayout16
+    {
+        using type = std::uint16_t;
+        static constexpr unsigned TIMESLICEID_BITS     = 4;
+        static constexpr unsigned GENESISID_BITS       = 8;
+        static constexpr unsigned CAUSALCHAINLINK_BITS = 4;
+    };
+    // 63 timeslices, ~1M entities hosted per timeslice, 63 chainlinks
+    struct EntityLayout32
+    {
+        using type = std::uint32_t;
+        static constexpr unsigned TIMESLICEID_BITS     = 6;
+        static constexpr unsigned GENESISID_BITS       = 20;
+        static constexpr unsigned CAUSALCHAINLINK_BITS = 6;
+    };
+    // 65535 timeslices, ~4B entities hosted per timeslice, 65535 chainlinks
+    struct EntityLayout64
+    {
+        using type = std::uint64_t;
+        static constexpr unsigned TIMESLICEID_BITS     = 16;
+        static constexpr unsigned GENESISID_BITS       = 32;
+        static constexpr unsigned CAUSALCHAINLINK_BITS = 16;
+    };
+
+    // Derive masks, offsets and reserved values from a layout
+    template<typename T_Layout>
+    struct EntityTraits
+    {
+        using type = typename T_Layout::type;
+        static_assert(std::is_unsigned<type>::value, "Entity storage type must be unsigned");
+        static_assert(T_Layout::TIMESLICEID_BITS + T_Layout::GENESISID_BITS + T_Layout::CAUSALCHAINLINK_BITS == sizeof(type) * 8,
+            "Entity layout must use every bit of its storage type");
+        static_assert(T_Layout::TIMESLICEID_BITS >= 2 && T_Layout::GENESISID_BITS >= 1 && T_Layout::CAUSALCHAINLINK_BITS >= 1,
+            "Entity layout constituents are too small");
+
+        static constexpr unsigned CAUSALCHAINLINK_OFFSET = 0;
+        static constexpr unsigned GENESISID_OFFSET       = T_Layout::CAUSALCHAINLINK_BITS;
+        static constexpr unsigned TIMESLICEID_OFFSET     = T_Layout::CAUSALCHAINLINK_BITS + T_Layout::GENESISID_BITS;
+
+        // max value of each constituent (in its own low bits)
+        static constexpr type TIMESLICEID_MAX     = static_cast<type>((type(1) << (T_Layout::TIMESLICEID_BITS - 1) << 1) - 1);
+        static constexpr type GENESISID_MAX       = static_cast<type>((type(1) << (T_Layout::GENESISID_BITS - 1) << 1) - 1);
+        static constexpr type CAUSALCHAINLINK_MAX = static_cast<type>((type(1) << (T_Layout::CAUSALCHAINLINK_BITS - 1) << 1) - 1);
+
+        static constexpr type TIMESLICEID_MASK     = static_cast<type>(TIMESLICEID_MAX << TIMESLICEID_OFFSET);
+        static constexpr type GENESISID_MASK       = static_cast<type>(GENESISID_MAX << GENESISID_OFFSET);
+        static constexpr type CAUSALCHAINLINK_MASK = static_cast<type>(CAUSALCHAINLINK_MAX << CAUSALCHAINLINK_OFFSET);
+
+        static constexpr type NULL_ENTITY = std::numeric_limits<type>::max();
+        // Forbid max TimesliceId value to prevent Entity collision with NULL_ENTITY
+        static constexpr type NULL_TIMESLICEID     = TIMESLICEID_MAX - 1;
+        static constexpr type NULL_GENESISID       = GENESISID_MAX;
+        static constexpr type NULL_CAUSALCHAINLINK = CAUSALCHAINLINK_MAX;
+    };
+
+    // ***** Select Entity layout *****
+    // (every host in a timeline must use the same layout, Entities are sent as raw values)
+#ifndef PLEEP_ENTITY_LAYOUT
+#define PLEEP_ENTITY_LAYOUT EntityLayout16
+#endif
+    using ActiveEntityTraits = EntityTraits<PLEEP_ENTITY_LAYOUT>;
+
     // An Entity is a (possibly empty) set of components
     // The Entity value is treated AS an entity
-    using Entity = std::uint16_t;
-    #define NULL_ENTITY UINT16_MAX  // 65535
-    #define ENTITY_SIZE NULL_ENTITY
+    using Entity = ActiveEntityTraits::type;
+    constexpr Entity NULL_ENTITY = ActiveEntityTraits::NULL_ENTITY;
+    constexpr Entity ENTITY_SIZE = NULL_ENTITY;
     
-    // Entity values have 3 constituents: TimesliceId, GenesisId and CausalChainLink
     // (Entity constituents are defined with the same bitwidth as Entity for bitmasking)
     
     // A TemporalEntity is the abstract collection of all entities with the same TemporalEntityId
@@ -38,24 +110,18 @@ namespace pleep
     // Yugioh uses "chain" and "link" as separate words therefore PascalCase -> ChainLink
     using CausalChainlink = Entity;
 
-    // Entity values are represented as a bit-wise composition of:
-    //     [1 , 4] (Their host's) TimesliceId (4 bits)
-    //     [5 ,12] GenesisId                  (8 bits)
-    //     [13,16] CausalChainLink            (4 bits)
-    #define TIMESLICEID_MASK       0xF000
-    #define GENESISID_MASK         0x0FF0
-    #define CAUSALCHAINLINK_MASK   0x000F
-    #define TIMESLICEID_OFFSET     12
-    #define GENESISID_OFFSET       4
-    #define CAUSALCHAINLINK_OFFSET 0
-    // Forbid max TimesliceId value to prevent Entity collision with NULL_ENTITY (4 bits -> 15-1 -> 14)
-    #define NULL_TIMESLICEID       14
-    #define NULL_GENESISID         255
-    #define NULL_CAUSALCHAINLINK   15
-    #define TIMESLICEID_SIZE       NULL_TIMESLICEID
-    #define GENESISID_SIZE         NULL_GENESISID
-    #define CAUSALCHAINLINK_SIZE   NULL_CAUSALCHAINLINK
-    // There can be 15 timeslices, each timeslice can host 256 entities, each entity can have 16 instances in the timeline
+    constexpr Entity TIMESLICEID_MASK       = ActiveEntityTraits::TIMESLICEID_MASK;
+    constexpr Entity GENESISID_MASK         = ActiveEntityTraits::GENESISID_MASK;
+    constexpr Entity CAUSALCHAINLINK_MASK   = ActiveEntityTraits::CAUSALCHAINLINK_MASK;
+    constexpr unsigned TIMESLICEID_OFFSET     = ActiveEntityTraits::TIMESLICEID_OFFSET;
+    constexpr unsigned GENESISID_OFFSET       = ActiveEntityTraits::GENESISID_OFFSET;
+    constexpr unsigned CAUSALCHAINLINK_OFFSET = ActiveEntityTraits::CAUSALCHAINLINK_OFFSET;
+    constexpr TimesliceId     NULL_TIMESLICEID     = ActiveEntityTraits::NULL_TIMESLICEID;
+    constexpr GenesisId       NULL_GENESISID       = ActiveEntityTraits::NULL_GENESISID;
+    constexpr CausalChainlink NULL_CAUSALCHAINLINK = ActiveEntityTraits::NULL_CAUSALCHAINLINK;
+    constexpr TimesliceId     TIMESLICEID_SIZE     = NULL_TIMESLICEID;
+    constexpr GenesisId       GENESISID_SIZE       = NULL_GENESISID;
+    constexpr CausalChainlink CAUSALCHAINLINK_SIZE = NULL_CAUSALCHAINLINK;
 
 
     // Back to regular ECS definitions
@@ -72,30 +138,34 @@ namespace pleep
         all,            // Any Components
         downstream,     // Components which flow out to clients
         upstream,       // Components which flow into servers
-        unknown
+        unknown,
+        // values are sent over the network, only append
+        partial         // Any Components, but ones missing from a message are kept (only changed ones were sent)
     };
+    // number of ComponentCategory values (unknown is not the last)
+    const size_t COMPONENT_CATEGORY_COUNT = static_cast<size_t>(ComponentCategory::partial) + 1;
 
     // Helper functions for comprehending Entity bit-wise composition
 
     inline TimesliceId derive_timeslice_id(Entity e)
     {
-        return (e & TIMESLICEID_MASK) >> TIMESLICEID_OFFSET;
+        return static_cast<TimesliceId>((e & TIMESLICEID_MASK) >> TIMESLICEID_OFFSET);
     }
     
     inline GenesisId derive_genesis_id(Entity e)
     {
-        return (e & GENESISID_MASK) >> GENESISID_OFFSET;
+        return static_cast<GenesisId>((e & GENESISID_MASK) >> GENESISID_OFFSET);
     }
 
     inline pleep::CausalChainlink derive_causal_chain_link(Entity e)
     {
-        return (e & CAUSALCHAINLINK_MASK) >> CAUSALCHAINLINK_OFFSET;
+        return static_cast<CausalChainlink>((e & CAUSALCHAINLINK_MASK) >> CAUSALCHAINLINK_OFFSET);
     }
 
     // Returns the entity from the same TemporalEntity with chainlink 0
     inline Entity strip_causal_chain_link(Entity e)
     {
-        return e & (~CAUSALCHAINLINK_MASK);
+        return static_cast<Entity>(e & static_cast<Entity>(~CAUSALCHAINLINK_MASK));
     }
 
     // checks if entities are equal except for chainlink
@@ -112,7 +182,7 @@ namespace pleep
         assert(g < NULL_GENESISID);
         // clients can compose entities using NULL_CAUSALCHAINLINK (non-temporal entities)
         assert(c <= NULL_CAUSALCHAINLINK);
-        return (t << TIMESLICEID_OFFSET) | (g << GENESISID_OFFSET) | (c << CAUSALCHAINLINK_OFFSET);
+        return static_cast<Entity>((t << TIMESLICEID_OFFSET) | (g << GENESISID_OFFSET) | (c << CAUSALCHAINLINK_OFFSET));
     }
 
     inline bool increment_causal_chain_link(Entity& e)
@@ -0,0 +1,167 @@
+#ifndef ENTITY_COMMAND_BUFFER_H
+#define ENTITY_COMMAND_BUFFER_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+#include "ecs_types.h"
+#include "events/event_types.h"
+
+namespace pleep
+{
+    // Recorded structural changes (entity creation/destruction, component add/remove)
+    // to be applied all at once by the owner at a point where no one is iterating.
+    // A buffer is only written by a single thread, Cosmos keeps one per recording thread.
+    class EntityCommandBuffer
+    {
+    public:
+        enum class CommandType : uint8_t
+        {
+            create,
+            condemn,
+            add,
+            remove
+        };
+
+        struct Command
+        {
+            CommandType type;
+            // target entity (NULL_ENTITY for create)
+            Entity entity = NULL_ENTITY;
+            // source for create/condemn
+            Entity source = NULL_ENTITY;
+            // component for add/remove
+            ComponentType component = 0;
+            // create only
+            bool isTemporal = true;
+            // add: range of Batch::payload holding serialized component (size 0 -> default constructed)
+            // create: index into Batch::onCreated (or SIZE_MAX)
+            size_t payloadOffset = 0;
+            size_t payloadSize = 0;
+        };
+
+        // commands taken out of a buffer to be applied, offsets in commands index into this batch
+        struct Batch
+        {
+            std::vector<Command> commands;
+            std::vector<uint8_t> payload;
+            std::vector<std::function<void(Entity)>> onCreated;
+
+            // copy a recorded component into msg so it can be popped
+            void load_payload(const Command& cmd, EventMessage& msg) const
+            {
+                msg.body.assign(payload.begin() + cmd.payloadOffset, payload.begin() + cmd.payloadOffset + cmd.payloadSize);
+                msg.header.size = static_cast<uint32_t>(msg.size());
+            }
+
+            // forget all commands but keep allocations for the next flush
+            void clear()
+            {
+                commands.clear();
+                payload.clear();
+                onCreated.clear();
+            }
+        };
+
+        void record_create(bool isTemporal, Entity source, std::function<void(Entity)> onCreated)
+        {
+            Command cmd{ CommandType::create };
+            cmd.source = source;
+            cmd.isTemporal = isTemporal;
+            cmd.payloadOffset = SIZE_MAX;
+
+            std::lock_guard<std::mutex> recordedLock(m_recordedMutex);
+            if (onCreated)
+            {
+                cmd.payloadOffset = m_recorded.onCreated.size();
+                m_recorded.onCreated.push_back(std::move(onCreated));
+            }
+            m_recorded.commands.push_back(cmd);
+        }
+
+        void record_condemn(Entity entity, Entity source)
+        {
+            Command cmd{ CommandType::condemn };
+            cmd.entity = entity;
+            cmd.source = source;
+
+            std::lock_guard<std::mutex> recordedLock(m_recordedMutex);
+            m_recorded.commands.push_back(cmd);
+        }
+
+        // serialize component with its Message operator<< so it can be deserialized by ComponentRegistry
+        template<typename T>
+        void record_add(Entity entity, ComponentType component, const T& data)
+        {
+            // scratch is only touched by the recording thread
+            m_scratch.body.clear();
+            m_scratch << data;
+
+            Command cmd{ CommandType::add };
+            cmd.entity = entity;
+            cmd.component = component;
+            cmd.payloadSize = m_scratch.body.size();
+
+            std::lock_guard<std::mutex> recordedLock(m_recordedMutex);
+            cmd.payloadOffset = m_recorded.payload.size();
+            m_recorded.payload.insert(m_recorded.payload.end(), m_scratch.body.begin(), m_scratch.body.end());
+            m_recorded.commands.push_back(cmd);
+        }
+
+        void record_add(Entity entity, ComponentType component)
+        {
+            Command cmd{ CommandType::add };
+            cmd.entity = entity;
+            cmd.component = component;
+
+            std::lock_guard<std::mutex> recordedLock(m_recordedMutex);
+            m_recorded.commands.push_back(cmd);
+        }
+
+        void record_remove(Entity entity, ComponentType component)
+        {
+            Command cmd{ CommandType::remove };
+            cmd.entity = entity;
+            cmd.component = component;
+
+            std::lock_guard<std::mutex> recordedLock(m_recordedMutex);
+            m_recorded.commands.push_back(cmd);
+        }
+
+        // move everything recorded so far onto the end of dest (offsets are rebased into dest)
+        void take(Batch& dest)
+        {
+            std::lock_guard<std::mutex> recordedLock(m_recordedMutex);
+
+            const size_t payloadBase = dest.payload.size();
+            const size_t onCreatedBase = dest.onCreated.size();
+            for (Command cmd : m_recorded.commands)
+            {
+                if (cmd.type == CommandType::add) cmd.payloadOffset += payloadBase;
+                else if (cmd.type == CommandType::create && cmd.payloadOffset != SIZE_MAX) cmd.payloadOffset += onCreatedBase;
+                dest.commands.push_back(cmd);
+            }
+            dest.payload.insert(dest.payload.end(), m_recorded.payload.begin(), m_recorded.payload.end());
+            for (std::function<void(Entity)>& onCreated : m_recorded.onCreated)
+            {
+                dest.onCreated.push_back(std::move(onCreated));
+            }
+            m_recorded.clear();
+        }
+
+    private:
+        // Both recording and take lock: the owner flushes at the start of its update, but threads it doesn't
+        // join (network handlers, asset imports) may still be recording then. Each buffer has one recording thread,
+        // so the lock is uncontended except against a flush.
+        std::mutex m_recordedMutex;
+        Batch m_recorded;
+
+        // reused to serialize added components
+        EventMessage m_scratch;
+    };
+}
+
+#endif // ENTITY_COMMAND_BUFFER_H
@@ -4,6 +4,8 @@
 //#include "intercession_pch.h"
 #include <array>
 #include <queue>
+#include <vector>
+#include <utility>
 
 #include "ecs/ecs_types.h"
 #include "logging/pleep_log.h"
@@ -14,6 +16,14 @@ namespace pleep
     class EntityRegistry
     {
     public:
+        // All HostedEntity id bookkeeping (for checkpoints)
+        struct HostedState
+        {
+            GenesisId nextGenesisId = 0;
+            std::vector<Entity> availableIds;
+            std::vector<std::pair<Entity, size_t>> counts;
+        };
+
         // Known timesliceId to compose Entity values with
         // Clients will have NULL_TIMESLICEID
         EntityRegistry(const TimesliceId localTimesliceIndex = NULL_TIMESLICEID);
@@ -36,6 +46,10 @@ namespace pleep
         size_t get_hosted_entity_count(Entity entity);
         // Returns total number of TampoeralEntities this cosmos is currently hosting
         size_t get_num_hosted_entities();
+
+        // copy out/overwrite hosted id bookkeeping
+        HostedState get_hosted_state();
+        void set_hosted_state(const HostedState& state);
         
         void set_signature(Entity entity, Signature sign);
 
@@ -44,7 +58,12 @@ namespace pleep
         std::unordered_map<Entity, Signature>& get_signatures_ref();
 
     private:
-        // queue of ALL unused Entity ids
+        // TimesliceId to compose new Entity values with
+        TimesliceId m_localTimesliceIndex;
+        // GenesisIds below this have been issued at least once
+        // (ids are issued on demand so the registry doesn't scale with the Entity layout's range)
+        GenesisId m_nextGenesisId = 0;
+        // queue of released Entity ids to be reused after all fresh ids are issued
         // Only contains HostedEntityIds with TimesliceId = m_timesliceId
         std::queue<Entity> m_availableHostedEntityIds{};
 
@@ -69,28 +88,33 @@ namespace pleep
 
     
     inline EntityRegistry::EntityRegistry(const TimesliceId localTimesliceIndex)
+        : m_localTimesliceIndex(localTimesliceIndex)
     {
-        // initialize the queue statically with ALL entities (as non are used yet)
-        for (GenesisId g = 0; g < GENESISID_SIZE; g++)
-        {
-            m_availableHostedEntityIds.push(compose_entity(localTimesliceIndex, g, 0));
-        }
     }
 
     inline Entity EntityRegistry::create_entity(const CausalChainlink link)
     {
         // assert() entity count doesn't go beyond max
         size_t localEntityCount = m_hostedEntityCounts.size();
-        if (localEntityCount > GENESISID_SIZE || m_availableHostedEntityIds.empty())
+        if (localEntityCount > GENESISID_SIZE || (m_nextGenesisId >= GENESISID_SIZE && m_availableHostedEntityIds.empty()))
         {
-            PLEEPLOG_ERROR("Cannot exceed max entity capacity of: " + std::to_string(GENESISID_SIZE));
+            PLEEPLOG_ERROR("Cannot exceed max entity capacity of: {}", GENESISID_SIZE);
             throw std::range_error("EntityRegistry is at entity count " + std::to_string(localEntityCount) + " and cannot create more Entities.");
         }
 
-        // use queue to get Entity id
-        Entity ent = m_availableHostedEntityIds.front();
+        // use fresh ids first, then the queue of released ids
+        Entity ent = NULL_ENTITY;
+        if (m_nextGenesisId < GENESISID_SIZE)
+        {
+            ent = compose_entity(m_localTimesliceIndex, m_nextGenesisId, 0);
+            m_nextGenesisId++;
+        }
+        else
+        {
+            ent = m_availableHostedEntityIds.front();
+            m_availableHostedEntityIds.pop();
+        }
         assert(m_hostedEntityCounts.find(strip_causal_chain_link(ent)) == m_hostedEntityCounts.end());
-        m_availableHostedEntityIds.pop();
 
         // use link parameter
         TimesliceId entHostId = derive_timeslice_id(ent);
@@ -117,7 +141,7 @@ namespace pleep
         // If non empty signature already exists for this entity then something has gone wrong
         if (m_signatures.count(entity) != 0)
         {
-            PLEEPLOG_DEBUG("Trying to register entity " + std::to_string(entity) + " which already exists?!");
+            PLEEPLOG_DEBUG("Trying to register entity {} which already exists?!", entity);
         }
         assert(m_signatures.count(entity) == 0);
 
@@ -131,7 +155,7 @@ namespace pleep
     {
         if (entity >= ENTITY_SIZE)
         {
-            PLEEPLOG_ERROR("Cannot destroy entity " + std::to_string(entity) + " above max capacity of: " + std::to_string(ENTITY_SIZE));
+            PLEEPLOG_ERROR("Cannot destroy entity {} above max capacity of: {}", entity, ENTITY_SIZE);
             throw std::range_error("EntityRegistry cannot destroy entity " + std::to_string(entity) + " greater than capacity " + std::to_string(ENTITY_SIZE));
         }
 
@@ -161,7 +185,7 @@ namespace pleep
         assert(entityCountsIt->second != 0);
 
         entityCountsIt->second += 1;
-        PLEEPLOG_TRACE("HostedEntity " + std::to_string(hostedEntity) + " host count has incremented to " + std::to_string(entityCountsIt->second) + " from creation of Entity " + std::to_string(entity) + " (link " + std::to_string(ccl) + ")");
+        PLEEPLOG_TRACE("HostedEntity {} host count has incremented to {} from creation of Entity {} (link {})", hostedEntity, entityCountsIt->second, entity, ccl);
     }
     inline void EntityRegistry::decrement_hosted_entity_count(Entity entity)
     {
@@ -171,13 +195,13 @@ namespace pleep
         auto entityCountsIt = m_hostedEntityCounts.find(hostedEntity);
         if (entityCountsIt == m_hostedEntityCounts.end())
         {
-            PLEEPLOG_ERROR("Tried to decrement the count of a hosted entity " + std::to_string(hostedEntity) + " which doesn't exist");
+            PLEEPLOG_ERROR("Tried to decrement the count of a hosted entity {} which doesn't exist", hostedEntity);
             throw std::range_error("EntityRegistry tried to decrement the count of a hosted entity which doesn't exist");
         }
         // count of 0 means decrementer failed to clear entry when it reached 0
         assert(entityCountsIt->second != 0);
         entityCountsIt->second -= 1;
-        PLEEPLOG_TRACE("HostedEntity " + std::to_string(hostedEntity) + " host count has decremented to " + std::to_string(entityCountsIt->second) + " from removal of Entity " + std::to_string(entity) + " (link " + std::to_string(ccl) + ")");
+        PLEEPLOG_TRACE("HostedEntity {} host count has decremented to {} from removal of Entity {} (link {})", hostedEntity, entityCountsIt->second, entity, ccl);
 
         // ensure all counts of 0 become unlisted and re-added to pool
         if (entityCountsIt->second == 0) 
@@ -205,12 +229,44 @@ namespace pleep
     {
         return m_hostedEntityCounts.size();
     }
+
+    inline EntityRegistry::HostedState EntityRegistry::get_hosted_state()
+    {
+        HostedState state;
+        state.nextGenesisId = m_nextGenesisId;
+
+        std::queue<Entity> available = m_availableHostedEntityIds;
+        while (!available.empty())
+        {
+            state.availableIds.push_back(available.front());
+            available.pop();
+        }
+
+        state.counts.assign(m_hostedEntityCounts.begin(), m_hostedEntityCounts.end());
+        return state;
+    }
+    inline void EntityRegistry::set_hosted_state(const HostedState& state)
+    {
+        m_nextGenesisId = state.nextGenesisId;
+
+        m_availableHostedEntityIds = std::queue<Entity>();
+        for (Entity entity : state.availableIds)
+        {
+            m_availableHostedEntityIds.push(entity);
+        }
+
+        m_hostedEntityCounts.clear();
+        for (const std::pair<Entity, size_t>& count : state.counts)
+        {
+            m_hostedEntityCounts[strip_causal_chain_link(count.first)] = count.second;
+        }
+    }
     
     inline void EntityRegistry::set_signature(Entity entity, Signature sign)
     {
         if (entity > ENTITY_SIZE)
         {
-            PLEEPLOG_ERROR("Cannot set signature of entity " + std::to_string(entity) + " above max capacity of: " + std::to_string(ENTITY_SIZE));
+            PLEEPLOG_ERROR("Cannot set signature of entity {} above max capacity of: {}", entity, ENTITY_SIZE);
             throw std::range_error("EntityRegistry set signature of entity " + std::to_string(entity) + " greater than capacity " + std::to_string(ENTITY_SIZE));
         }
 
@@ -221,7 +277,7 @@ namespace pleep
     {
         if (entity > ENTITY_SIZE)
         {
-            PLEEPLOG_ERROR("Cannot get signature of entity " + std::to_string(entity) + " above max capacity of: " + std::to_string(ENTITY_SIZE));
+            PLEEPLOG_ERROR("Cannot get signature of entity {} above max capacity of: {}", entity, ENTITY_SIZE);
             throw std::range_error("EntityRegistry cannot get signature of entity " + std::to_string(entity) + " greater than capacity " + std::to_string(ENTITY_SIZE));
         }
 
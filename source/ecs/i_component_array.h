@@ -4,6 +4,7 @@
 //#include "intercession_pch.h"
 #include "ecs_types.h"
 #include "events/event_types.h"
+#include "events/wire_codec.h"
 
 namespace pleep
 {
@@ -30,15 +31,27 @@ namespace pleep
 
         // Push component data into msg
         // non-strict usage, does nothing if component does not exist
-        virtual void serialize_data_for(Entity entity, EventMessage& msg) = 0;
+        virtual void serialize_data_for(Entity entity, EventMessage& msg, WireEncoding encoding) = 0;
 
         // Pop component data from msg and overwrite;
+        // (encoding must match the one it was serialized with)
         // non-strict usage, does nothing if component does not exist
-        virtual void deserialize_data_for(Entity entity, EventMessage& msg) = 0;
+        virtual void deserialize_data_for(Entity entity, EventMessage& msg, WireEncoding encoding) = 0;
 
         // Pop component data from msg and destroy it
         // non-strict usage, does nothing if component does not exist
-        virtual void discard_data_for(EventMessage& msg) = 0;
+        virtual void discard_data_for(EventMessage& msg, WireEncoding encoding) = 0;
+
+        // flag entity's component as modified since the last clear_changed
+        // non-strict usage, does nothing if component does not exist
+        virtual void mark_changed_for(Entity entity) = 0;
+
+        // has entity's component been modified since the last clear_changed
+        // false if component does not exist
+        virtual bool is_changed_for(Entity entity) = 0;
+
+        // unflag all components (after they have been replicated)
+        virtual void clear_changed() = 0;
     };
 }
 
@@ -4,8 +4,11 @@
 //#include "intercession_pch.h"
 #include <set>
 #include <memory>
+#include <exception>
+#include <functional>
 
 #include "ecs_types.h"
+#include "core/stage_scheduler.h"
 
 
 namespace pleep
@@ -43,11 +46,44 @@ namespace pleep
         // returns empty bitset if desired components could not be found
         virtual Signature derive_signature() = 0;
 
+        // Components and dynamos touched during update() so Cosmos can update
+        // synchros which don't conflict at the same time
+        // Default is exclusive (updated alone, in registration order)
+        virtual StageAccess derive_access()
+        {
+            return StageAccess{};
+        }
+
         // entities to fetch from owner cosmos and feed to dynamo
         // set by SynchroRegistry
         std::set<Entity> m_entities;
 
     protected:
+        // derive_access for synchros which only touch components and the one dynamo they submit to
+        // declare sets reads/writes from the owner's component types,
+        // stays exclusive if there is no owner or a component isn't registered
+        StageAccess _derive_dynamo_access(const void* dynamo, const std::function<void(Cosmos&, StageAccess&)>& declare)
+        {
+            std::shared_ptr<Cosmos> cosmos = m_ownerCosmos.lock();
+            StageAccess access;
+            if (cosmos == nullptr) return access;
+
+            try
+            {
+                declare(*cosmos, access);
+            }
+            catch(const std::exception& e)
+            {
+                // Component Registry already logs error
+                UNREFERENCED_PARAMETER(e);
+                return StageAccess{};
+            }
+            access.resources.push_back(dynamo);
+            access.exclusive = false;
+
+            return access;
+        }
+
         // Access to ecs where m_entities are contained
         // weak to avoid circular smart pointer with cosmos, 
         // deleting context's pointer should delete us (after all dynamos safely are cleared)
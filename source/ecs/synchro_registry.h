@@ -5,6 +5,7 @@
 #include <memory>
 #include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 #include "ecs_types.h"
 #include "i_synchro.h"
@@ -39,6 +40,10 @@ namespace pleep
         // this is potentially dangerous, but cosmos needs access to iterate
         std::unordered_map<const char*, std::shared_ptr<I_Synchro>>& get_synchros_ref();
 
+        // synchros (and their typeid) in the order they were registered
+        // cosmos updates conflicting synchros in this order
+        std::vector<std::pair<const char*, std::shared_ptr<I_Synchro>>>& get_registration_order_ref();
+
         // Return list of synchro typeid names
         // Not ordered, though it should not matter
         std::vector<std::string> stringify();
@@ -50,6 +55,9 @@ namespace pleep
         // synchro typeid -> synchro pointer
         // shares pointer between caller and registry so that it can be called externally
         std::unordered_map<const char*, std::shared_ptr<I_Synchro>> m_synchros{};
+
+        // same synchros as m_synchros, but deterministically ordered
+        std::vector<std::pair<const char*, std::shared_ptr<I_Synchro>>> m_registrationOrder{};
     };
     
 
@@ -60,12 +68,13 @@ namespace pleep
 
         if (m_synchros.find(typeName) != m_synchros.end())
         {
-            PLEEPLOG_ERROR("Cannot register synchro " + std::string(typeName) + " which is already registered");
+            PLEEPLOG_ERROR("Cannot register synchro {} which is already registered", typeName);
             throw std::runtime_error("SynchroRegistry cannot register synchro " + std::string(typeName) + " which is already registered");
         }
 
         std::shared_ptr<T> synchro = std::make_shared<T>(ownerCosmos);
         m_synchros.insert({typeName, synchro});
+        m_registrationOrder.push_back({typeName, synchro});
         return synchro;
     }
 
@@ -76,7 +85,7 @@ namespace pleep
 
         if (m_synchros.find(typeName) == m_synchros.end())
         {
-            PLEEPLOG_ERROR("Cannot set signature of synchro " + std::string(typeName) + " which has not been registered");
+            PLEEPLOG_ERROR("Cannot set signature of synchro {} which has not been registered", typeName);
             throw std::runtime_error("SynchroRegistry cannot set signature of synchro " + std::string(typeName) + " which has not been registered");
         }
 
@@ -122,6 +131,11 @@ namespace pleep
         return m_synchros;
     }
     
+    inline std::vector<std::pair<const char*, std::shared_ptr<I_Synchro>>>& SynchroRegistry::get_registration_order_ref()
+    {
+        return m_registrationOrder;
+    }
+    
     inline std::vector<std::string> SynchroRegistry::stringify()
     {
         std::vector<std::string> synchroNames;
@@ -1,42 +1,195 @@
 #include "event_broker.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "logging/pleep_log.h"
 
 namespace pleep
 {
-    void EventBroker::add_listener(EventId eventId, std::function<void(EventMessage&)> const& listener) 
+    // bound on listeners deferring events in response to deferred events
+    constexpr size_t EVENT_BROKER_MAX_FLUSH_PASSES = 16;
+
+    void EventBroker::add_listener(EventId eventId, EventListener listener) 
     {
         // may be convenient to have a better eventId name conversion
-        PLEEPLOG_TRACE("Add listener for event " + std::to_string(eventId));
-        m_listeners[eventId].push_back(listener);
+        PLEEPLOG_TRACE("Add listener for event {}", eventId);
+        if (eventId >= m_listeners.size())
+        {
+            m_listeners.resize(static_cast<size_t>(eventId) + 1);
+        }
+        m_listeners[eventId].listeners.push_back(listener);
     }
     
-    void EventBroker::remove_listener(EventId eventId, std::function<void(EventMessage&)> const& listener) 
+    void EventBroker::remove_listener(EventId eventId, EventListener listener) 
     {
-        PLEEPLOG_TRACE("Remove listener for event " + std::to_string(eventId));
-        m_listeners[eventId].remove_if([listener](std::function<void(EventMessage&)> f){ return f.target_type() == listener.target_type(); });
+        PLEEPLOG_TRACE("Remove listener for event {}", eventId);
+        if (eventId >= m_listeners.size()) return;
+
+        std::vector<EventListener>& listeners = m_listeners[eventId].listeners;
+        for (EventListener& slot : listeners)
+        {
+            // don't invalidate indices of a dispatch in progress, just clear the slot
+            if (slot == listener) slot = EventListener{};
+        }
+        if (m_dispatchDepth > 0)
+        {
+            m_pendingCompaction = true;
+        }
+        else
+        {
+            _compact_listeners();
+        }
     }
     
-    void EventBroker::send_event(EventMessage& event) 
+    void EventBroker::send_event(const EventMessage& event) 
     {
         EventId type = event.header.id;
-        PLEEPLOG_TRACE("Triggering callbacks for event " + std::to_string(type));
 
-        for (std::function<void(EventMessage&)> const& listener : m_listeners[type])
+        if (is_deferred(type))
         {
-            listener(event);
+            PLEEPLOG_TRACE("Deferring callbacks for event {}", type);
+            m_deferredEvents.push_back(event);
+            return;
         }
+
+        PLEEPLOG_TRACE("Triggering callbacks for event {}", type);
+        // event belongs to the sender, so listeners only ever see copies
+        _dispatch(event, nullptr);
     }
     
     void EventBroker::send_event(EventId eventId) 
     {
-        PLEEPLOG_TRACE("Triggering callbacks for event " + std::to_string(eventId));
         // construct parameter-less event of given id
         EventMessage event(eventId);
 
-        for (std::function<void(EventMessage&)> const& listener : m_listeners[eventId])
+        if (is_deferred(eventId))
+        {
+            PLEEPLOG_TRACE("Deferring callbacks for event {}", eventId);
+            m_deferredEvents.push_back(std::move(event));
+            return;
+        }
+
+        PLEEPLOG_TRACE("Triggering callbacks for event {}", eventId);
+        _dispatch(event, &event);
+    }
+
+    void EventBroker::set_deferred(EventId eventId, bool deferred) 
+    {
+        if (eventId >= m_listeners.size())
+        {
+            m_listeners.resize(static_cast<size_t>(eventId) + 1);
+        }
+        m_listeners[eventId].deferred = deferred;
+    }
+
+    bool EventBroker::is_deferred(EventId eventId) const 
+    {
+        return eventId < m_listeners.size() && m_listeners[eventId].deferred;
+    }
+
+    void EventBroker::flush_deferred_events() 
+    {
+        {
+            std::lock_guard<std::mutex> postedEventsLock(m_postedEventsMutex);
+            if (!m_postedEvents.empty())
+            {
+                std::move(m_postedEvents.begin(), m_postedEvents.end(), std::back_inserter(m_deferredEvents));
+                m_postedEvents.clear();
+            }
+        }
+        if (m_deferredEvents.empty()) return;
+
+        // each pass dispatches from a local queue, so listeners deferring more events (or flushing themselves)
+        // only ever touch m_deferredEvents, which the next pass picks up
+        std::vector<EventMessage> flushing;
+        // reuse capacity kept from last flush
+        flushing.swap(m_flushingEvents);
+        for (size_t pass = 0; !m_deferredEvents.empty(); pass++)
+        {
+            if (pass >= EVENT_BROKER_MAX_FLUSH_PASSES)
+            {
+                PLEEPLOG_WARN("Deferred events still being deferred after " + std::to_string(pass) + " passes, leaving " + std::to_string(m_deferredEvents.size()) + " for next flush");
+                break;
+            }
+
+            flushing.swap(m_deferredEvents);
+            PLEEPLOG_TRACE("Flushing {} deferred events", flushing.size());
+
+            for (EventMessage& event : flushing)
+            {
+                // queued events are owned by the broker, so the last listener can have it
+                _dispatch(event, &event);
+            }
+            flushing.clear();
+        }
+        // keep capacity for next frame
+        if (flushing.capacity() > m_flushingEvents.capacity()) m_flushingEvents.swap(flushing);
+    }
+
+    void EventBroker::post_event(const EventMessage& event) 
+    {
+        std::lock_guard<std::mutex> postedEventsLock(m_postedEventsMutex);
+        m_postedEvents.push_back(event);
+    }
+
+    void EventBroker::post_event(EventId eventId) 
+    {
+        std::lock_guard<std::mutex> postedEventsLock(m_postedEventsMutex);
+        m_postedEvents.emplace_back(eventId);
+    }
+
+    void EventBroker::_dispatch(const EventMessage& event, EventMessage* consumableEvent) 
+    {
+        const EventId type = event.header.id;
+        if (type >= m_listeners.size()) return;
+
+        if (m_dispatchDepth >= m_scratchEvents.size())
+        {
+            m_scratchEvents.push_back(std::make_unique<EventMessage>());
+        }
+        EventMessage& scratch = *m_scratchEvents[m_dispatchDepth];
+        m_dispatchDepth++;
+
+        // listeners may add/remove listeners while we're iterating,
+        // so index (don't hold a reference) and copy each listener before calling it
+        for (size_t i = 0; i < m_listeners[type].listeners.size(); i++)
+        {
+            const EventListener listener = m_listeners[type].listeners[i];
+            // removed during this dispatch
+            if (!listener) continue;
+
+            if (consumableEvent && i + 1 == m_listeners[type].listeners.size())
+            {
+                listener(*consumableEvent);
+                // event has been popped, any listener added by that call can't have it
+                break;
+            }
+            else
+            {
+                // assigning into scratch reuses its body capacity
+                scratch.header = event.header;
+                scratch.body.assign(event.body.begin(), event.body.end());
+                listener(scratch);
+            }
+        }
+
+        m_dispatchDepth--;
+        if (m_dispatchDepth == 0 && m_pendingCompaction)
+        {
+            _compact_listeners();
+        }
+    }
+
+    void EventBroker::_compact_listeners() 
+    {
+        for (ListenerSlot& slot : m_listeners)
         {
-            listener(event);
+            slot.listeners.erase(
+                std::remove_if(slot.listeners.begin(), slot.listeners.end(), [](const EventListener& l){ return !l; }),
+                slot.listeners.end()
+            );
         }
+        m_pendingCompaction = false;
     }
-}
\ No newline at end of file
+}
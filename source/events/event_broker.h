@@ -2,8 +2,9 @@
 #define EVENT_BROKER_H
 
 //#include "intercession_pch.h"
-#include <unordered_map>
-#include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
 
 #include "event_types.h"
 
@@ -12,17 +13,58 @@ namespace pleep
     class EventBroker
     {
     public:
-        void add_listener(EventId eventId, std::function<void(EventMessage&)> const& listener);
-        void remove_listener(EventId eventId, std::function<void(EventMessage&)> const& listener);
+        void add_listener(EventId eventId, EventListener listener);
+        void remove_listener(EventId eventId, EventListener listener);
 
-        // synchronous send to all registered listeners
-        void send_event(EventMessage& event);
+        // synchronous send to all registered listeners (or queue if eventId is deferred)
+        // each listener recieves its own copy of event to pop from, event itself is unchanged
+        void send_event(const EventMessage& event);
         void send_event(EventId eventId);
 
+        // Deferred events are queued by send_event and dispatched together by flush_deferred_events
+        // (contexts flush at the end of _clean_frame)
+        void set_deferred(EventId eventId, bool deferred = true);
+        bool is_deferred(EventId eventId) const;
+        // dispatch all events queued since last flush
+        // events deferred during the flush are dispatched by it too, until the queue is empty
+        void flush_deferred_events();
+
+        // The broker is otherwise single threaded, other threads (like a window thread) can only post:
+        // queue event to be dispatched (on the broker's thread) by the next flush_deferred_events
+        void post_event(const EventMessage& event);
+        void post_event(EventId eventId);
+
     private:
-        // store subscriber's callbacks
-        std::unordered_map<EventId, std::list<std::function<void(EventMessage&)>>> m_listeners;
+        // call each listener with a copy of event
+        // if consumableEvent is given (the same message, owned by us) the last listener recieves it directly
+        void _dispatch(const EventMessage& event, EventMessage* consumableEvent);
+        // remove listener slots which were cleared during dispatch
+        void _compact_listeners();
+
+        struct ListenerSlot
+        {
+            std::vector<EventListener> listeners;
+            bool deferred = false;
+        };
+        // store subscriber's callbacks, indexed directly by EventId (ids are small, see event_types.h)
+        std::vector<ListenerSlot> m_listeners;
+
+        // each dispatch depth (listeners may send events) gets a reused message to copy into
+        // so copying for each listener reuses the same body capacity
+        std::vector<std::unique_ptr<EventMessage>> m_scratchEvents;
+        size_t m_dispatchDepth = 0;
+        // listeners removed during dispatch are only cleared until the outermost dispatch finishes
+        bool m_pendingCompaction = false;
+
+        // events waiting for flush_deferred_events
+        std::vector<EventMessage> m_deferredEvents;
+        // capacity of the last flush's local queue, reused by the next one
+        std::vector<EventMessage> m_flushingEvents;
+
+        // events posted from other threads, moved into m_deferredEvents by flush
+        std::vector<EventMessage> m_postedEvents;
+        std::mutex m_postedEventsMutex;
     };
 }
 
-#endif // EVENT_BROKER_H
\ No newline at end of file
+#endif // EVENT_BROKER_H
@@ -13,14 +13,6 @@
 
 namespace pleep
 {
-    // we cant use this because it doesn't implicitly convert
-    //using EventHandler = std::function<void(Event&)>;
-
-    // austin morlan's macro for generating function pointer wrappers
-    #define METHOD_LISTENER(EventType, Listener) EventType, std::bind(&Listener, this, std::placeholders::_1)
-    #define FUNCTION_LISTENER(EventType, Listener) EventType, std::bind(&Listener, std::placeholders::_1)
-
-
     // Event Type Definitions
     // enums conveniently assign values to each event
     // but all events would have to be under the same enum
@@ -30,6 +22,57 @@ namespace pleep
     using EventId = std::uint32_t;
     using EventMessage = Message<EventId>;
 
+    // Non-owning callback to a member (or free) function taking EventMessage&
+    // Unlike std::bind into std::function this never allocates, calls through a single
+    // function pointer, and compares equal only to the same function on the same instance
+    struct EventListener
+    {
+        void* instance = nullptr;
+        void (*thunk)(void*, EventMessage&) = nullptr;
+
+        void operator()(EventMessage& event) const
+        {
+            thunk(instance, event);
+        }
+        explicit operator bool() const
+        {
+            return thunk != nullptr;
+        }
+        bool operator==(const EventListener& other) const
+        {
+            return instance == other.instance && thunk == other.thunk;
+        }
+
+        // T_Method is deduced from the member pointer so methods inherited from a base class still resolve
+        template<typename T_Method, T_Method Method>
+        struct MethodThunk;
+        template<typename T, void (T::*Method)(EventMessage&)>
+        struct MethodThunk<void (T::*)(EventMessage&), Method>
+        {
+            using Class = T;
+            static void call(void* instance, EventMessage& event)
+            {
+                (static_cast<T*>(instance)->*Method)(event);
+            }
+        };
+
+        template<typename T_Method, T_Method Method>
+        static EventListener from_method(typename MethodThunk<T_Method, Method>::Class* instance)
+        {
+            return EventListener{ instance, &MethodThunk<T_Method, Method>::call };
+        }
+
+        template<void (*Function)(EventMessage&)>
+        static EventListener from_function()
+        {
+            return EventListener{ nullptr, [](void*, EventMessage& event){ Function(event); } };
+        }
+    };
+
+    // austin morlan's macro for generating function pointer wrappers
+    #define METHOD_LISTENER(EventType, Listener) EventType, ::pleep::EventListener::from_method<decltype(&Listener), &Listener>(this)
+    #define FUNCTION_LISTENER(EventType, Listener) EventType, ::pleep::EventListener::from_function<&Listener>()
+
     // namespaces can nest event classifications in a tree
     // but their values must be generated uniquely otherwise
     namespace events {
@@ -145,6 +188,23 @@ namespace pleep
                 struct TIMESTREAM_INTERCESSION_params {
                     ///...
                 };
+
+            // Hash of an entity's motion state at the message coherency, pushed into the past
+            // with input-only timestreams so the past can tell when its re-simulation drifted
+            const EventId TIMESTREAM_CHECKSUM = __LINE__;
+                struct TIMESTREAM_CHECKSUM_params {
+                    Entity entity;
+                    // see checksum_entity_state
+                    uint32_t checksum;
+                };
+
+            // Sent directly to the timeslice ahead when an entity's re-simulation
+            // does not match its TIMESTREAM_CHECKSUM, requesting its full state
+            const EventId TIMESTREAM_DESYNC = __LINE__;
+                struct TIMESTREAM_DESYNC_params {
+                    // as it exists in the requesting (past) timeslice
+                    Entity entity;
+                };
         } // namespace cosmos
 
         // events used as network messages sent over net::Connection
@@ -219,6 +279,14 @@ namespace pleep
                     //uint16_t coherency;
                 };
 
+            // (local only) our timeline transport dropped messages it couldn't deliver to a timeslice
+            // anything it needs (eg. the past's timestream) has to be resent in full
+            const EventId TIMELINE_RESYNC = __LINE__;
+                struct TIMELINE_RESYNC_params
+                {
+                    TimesliceId peerId;
+                };
+
             // Indicates an entity is intending to timetravel
             // contains serialized entity
             const EventId JUMP_REQUEST = __LINE__;
@@ -0,0 +1,313 @@
+#ifndef WIRE_CODEC_H
+#define WIRE_CODEC_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "events/message.h"
+
+namespace pleep
+{
+    // How component data is written into a Message
+    // exact: raw POD copy (operator<<), for anything which must round trip perfectly (timestreams, jumps)
+    // quantized: compact lossy encoding for replicated components which are resent often (client updates)
+    // (components without a quantized codec use exact either way)
+    enum class WireEncoding : uint8_t
+    {
+        exact,
+        quantized
+    };
+
+    // Ranges and precision of quantized values, must match on every host
+    // Values outside of a range are clamped
+    struct WireQuantization
+    {
+        // positions are fixed point in [-worldHalfExtent, worldHalfExtent] on each axis
+        float worldHalfExtent = 4096.0f;
+        // 24 bits over 8192m -> ~0.25mm max error
+        unsigned positionBits = 24;
+        // bits for each of the smallest three quaternion components -> ~2e-5 max error each
+        unsigned rotationBits = 15;
+        // velocities in [-maxSpeed, maxSpeed] -> ~3.9mm/s max error
+        float maxSpeed = 256.0f;
+        float maxAngularSpeed = 64.0f;
+        float maxAcceleration = 1024.0f;
+        float maxAngularAcceleration = 1024.0f;
+        unsigned velocityBits = 16;
+    };
+
+    // process wide quantization settings (set before any connections are made)
+    inline WireQuantization& get_wire_quantization()
+    {
+        static WireQuantization quantization;
+        return quantization;
+    }
+
+    // Appends values of arbitrary bitwidth to a byte buffer (little endian bit order)
+    class BitWriter
+    {
+    public:
+        // bitCount <= 32
+        void write(uint32_t value, unsigned bitCount)
+        {
+            const uint64_t mask = (uint64_t(1) << bitCount) - 1;
+            m_scratch |= (uint64_t(value) & mask) << m_scratchBits;
+            m_scratchBits += bitCount;
+            while (m_scratchBits >= 8)
+            {
+                m_bytes.push_back(static_cast<uint8_t>(m_scratch));
+                m_scratch >>= 8;
+                m_scratchBits -= 8;
+            }
+        }
+
+        void write_bool(bool value)
+        {
+            this->write(value ? 1 : 0, 1);
+        }
+
+        void write_float(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(float));
+            this->write(bits, 32);
+        }
+
+        // quantize value in [minValue, maxValue] into bitCount bits
+        void write_ranged(float value, float minValue, float maxValue, unsigned bitCount)
+        {
+            const double steps = static_cast<double>((uint64_t(1) << bitCount) - 1);
+            const double t = (std::min(std::max(value, minValue), maxValue) - static_cast<double>(minValue)) / (static_cast<double>(maxValue) - minValue);
+            this->write(static_cast<uint32_t>(t * steps + 0.5), bitCount);
+        }
+
+        // pad to a whole byte and return all bytes written
+        const std::vector<uint8_t>& finish()
+        {
+            if (m_scratchBits > 0)
+            {
+                m_bytes.push_back(static_cast<uint8_t>(m_scratch));
+                m_scratch = 0;
+                m_scratchBits = 0;
+            }
+            return m_bytes;
+        }
+
+    private:
+        std::vector<uint8_t> m_bytes;
+        uint64_t m_scratch = 0;
+        unsigned m_scratchBits = 0;
+    };
+
+    // Reads values in the order they were given to a BitWriter
+    // THROWS range_error if reading past the end
+    class BitReader
+    {
+    public:
+        BitReader(std::vector<uint8_t> bytes)
+            : m_bytes(std::move(bytes))
+        {}
+
+        uint32_t read(unsigned bitCount)
+        {
+            while (m_scratchBits < bitCount)
+            {
+                if (m_nextByte >= m_bytes.size())
+                {
+                    PLEEPLOG_ERROR("Read past end of packed bits");
+                    throw std::range_error("BitReader read past end of packed bits");
+                }
+                m_scratch |= uint64_t(m_bytes[m_nextByte++]) << m_scratchBits;
+                m_scratchBits += 8;
+            }
+            const uint64_t mask = (uint64_t(1) << bitCount) - 1;
+            const uint32_t value = static_cast<uint32_t>(m_scratch & mask);
+            m_scratch >>= bitCount;
+            m_scratchBits -= bitCount;
+            return value;
+        }
+
+        bool read_bool()
+        {
+            return this->read(1) != 0;
+        }
+
+        float read_float()
+        {
+            const uint32_t bits = this->read(32);
+            float value;
+            std::memcpy(&value, &bits, sizeof(float));
+            return value;
+        }
+
+        float read_ranged(float minValue, float maxValue, unsigned bitCount)
+        {
+            const double steps = static_cast<double>((uint64_t(1) << bitCount) - 1);
+            return static_cast<float>(minValue + (static_cast<double>(maxValue) - minValue) * (this->read(bitCount) / steps));
+        }
+
+    private:
+        std::vector<uint8_t> m_bytes;
+        size_t m_nextByte = 0;
+        uint64_t m_scratch = 0;
+        unsigned m_scratchBits = 0;
+    };
+
+    // ***** Packed value helpers *****
+
+    inline void write_position(BitWriter& writer, const glm::vec3& position)
+    {
+        const WireQuantization& q = get_wire_quantization();
+        for (int i = 0; i < 3; i++)
+        {
+            writer.write_ranged(position[i], -q.worldHalfExtent, q.worldHalfExtent, q.positionBits);
+        }
+    }
+    inline glm::vec3 read_position(BitReader& reader)
+    {
+        const WireQuantization& q = get_wire_quantization();
+        glm::vec3 position;
+        for (int i = 0; i < 3; i++)
+        {
+            position[i] = reader.read_ranged(-q.worldHalfExtent, q.worldHalfExtent, q.positionBits);
+        }
+        return position;
+    }
+
+    // zero vectors (very common for resting entities) only cost 1 bit
+    inline void write_bounded_vector(BitWriter& writer, const glm::vec3& vector, float bound)
+    {
+        const bool isZero = vector == glm::vec3(0.0f);
+        writer.write_bool(isZero);
+        if (isZero) return;
+
+        const unsigned bits = get_wire_quantization().velocityBits;
+        for (int i = 0; i < 3; i++)
+        {
+            writer.write_ranged(vector[i], -bound, bound, bits);
+        }
+    }
+    inline glm::vec3 read_bounded_vector(BitReader& reader, float bound)
+    {
+        glm::vec3 vector(0.0f);
+        if (reader.read_bool()) return vector;
+
+        const unsigned bits = get_wire_quantization().velocityBits;
+        for (int i = 0; i < 3; i++)
+        {
+            vector[i] = reader.read_ranged(-bound, bound, bits);
+        }
+        return vector;
+    }
+
+    // "smallest three": the largest component is implied by the unit length,
+    // so only its index and the other three (each within +-1/sqrt(2)) are sent
+    inline void write_rotation(BitWriter& writer, const glm::quat& rotation)
+    {
+        const glm::quat unit = glm::normalize(rotation);
+        float components[4] = { unit.x, unit.y, unit.z, unit.w };
+
+        unsigned largest = 0;
+        for (unsigned i = 1; i < 4; i++)
+        {
+            if (std::abs(components[i]) > std::abs(components[largest])) largest = i;
+        }
+        // q and -q are the same rotation, keep the implied component positive
+        const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        const float bound = 0.70710678f;
+        const unsigned bits = get_wire_quantization().rotationBits;
+        writer.write(largest, 2);
+        for (unsigned i = 0; i < 4; i++)
+        {
+            if (i == largest) continue;
+            writer.write_ranged(components[i] * sign, -bound, bound, bits);
+        }
+    }
+    inline glm::quat read_rotation(BitReader& reader)
+    {
+        const float bound = 0.70710678f;
+        const unsigned bits = get_wire_quantization().rotationBits;
+        const unsigned largest = reader.read(2);
+
+        float components[4];
+        float sumSquares = 0.0f;
+        for (unsigned i = 0; i < 4; i++)
+        {
+            if (i == largest) continue;
+            components[i] = reader.read_ranged(-bound, bound, bits);
+            sumSquares += components[i] * components[i];
+        }
+        components[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquares));
+
+        // glm::quat constructor is (w, x, y, z)
+        return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+    }
+
+    // floats which are usually left at their default only cost 1 bit
+    inline void write_usually(BitWriter& writer, float value, float usualValue)
+    {
+        const bool isUsual = value == usualValue;
+        writer.write_bool(isUsual);
+        if (!isUsual) writer.write_float(value);
+    }
+    inline float read_usually(BitReader& reader, float usualValue)
+    {
+        return reader.read_bool() ? usualValue : reader.read_float();
+    }
+
+    // push packed bytes onto msg (followed by their count to be popped first)
+    template<typename T_Msg>
+    void push_packed(Message<T_Msg>& msg, BitWriter& writer)
+    {
+        const std::vector<uint8_t>& bytes = writer.finish();
+        assert(bytes.size() <= UINT16_MAX);
+        msg.body.insert(msg.body.end(), bytes.begin(), bytes.end());
+        msg.header.size = static_cast<uint32_t>(msg.size());
+        msg << static_cast<uint16_t>(bytes.size());
+    }
+
+    // pop bytes pushed by push_packed
+    template<typename T_Msg>
+    BitReader pop_packed(Message<T_Msg>& msg)
+    {
+        uint16_t byteCount;
+        msg >> byteCount;
+        assert(msg.size() >= byteCount);
+
+        const size_t begin = msg.size() - byteCount;
+        std::vector<uint8_t> bytes(msg.body.begin() + begin, msg.body.end());
+        msg.body.resize(begin);
+        msg.header.size = static_cast<uint32_t>(msg.size());
+        return BitReader(std::move(bytes));
+    }
+
+    // ***** Component codecs *****
+    // ComponentArray serializes through these, overload them (in the component's header)
+    // for components with a quantized encoding
+
+    template<typename T_Msg, typename T_Data>
+    void encode_component(Message<T_Msg>& msg, const T_Data& data, WireEncoding encoding)
+    {
+        UNREFERENCED_PARAMETER(encoding);
+        msg << data;
+    }
+
+    template<typename T_Msg, typename T_Data>
+    void decode_component(Message<T_Msg>& msg, T_Data& data, WireEncoding encoding)
+    {
+        UNREFERENCED_PARAMETER(encoding);
+        msg >> data;
+    }
+}
+
+#endif // WIRE_CODEC_H
@@ -39,10 +39,10 @@ namespace pleep
     
     void InputDynamo::run_relays(double deltaTime)
     {
-        // this will call all registered callbacks
-        glfwPollEvents();
+        if (!m_isPolledExternally) this->poll_window();
         // Raw input buffer will be set now
 
+        std::lock_guard<std::mutex> inputBufferLock(m_inputBufferMutex);
         // engage relays with polled input
         m_spacialInputRelay.engage(deltaTime);
 
@@ -50,6 +50,17 @@ namespace pleep
         // after all relays have used the buffer, prep it for next frame
         // (or any virtual devices that will happen this frame)
         m_inputBuffer.flush();
+    }
+
+    void InputDynamo::set_external_polling(bool external)
+    {
+        m_isPolledExternally = external;
+    }
+
+    void InputDynamo::poll_window()
+    {
+        // this will call all registered callbacks
+        glfwPollEvents();
 
         // check for any interactions with window frame (not captured specifically by callbacks)
         // glfwWindowShouldClose will be set after glfwPollEvents
@@ -123,6 +134,8 @@ namespace pleep
         static double lastX = -1;
         static double lastY = -1;
 
+        std::lock_guard<std::mutex> inputBufferLock(m_inputBufferMutex);
+
         // provide mouse DELTA as analog input (analog 0)
         m_inputBuffer.setTwoDimAnalog(
             0,
@@ -150,6 +163,7 @@ namespace pleep
         UNREFERENCED_PARAMETER(w);
 
         // we'll assign the scroll wheel to be analog 2
+        std::lock_guard<std::mutex> inputBufferLock(m_inputBufferMutex);
         m_inputBuffer.setTwoDimAnalog(2, dx, dy);
 
         //PLEEPLOG_TRACE("Mouse scroll callback. Scrolled (" + std::to_string(dx) + ", " + std::to_string(dy) + ")");
@@ -165,6 +179,7 @@ namespace pleep
 
         // action is one of GLFW_PRESS || GLFW_RELEASE
         // buttons should be in range [0,8]
+        std::lock_guard<std::mutex> inputBufferLock(m_inputBufferMutex);
         m_inputBuffer.setDigital(button, action);
 
         // mods will be set on key callback for relays to use
@@ -185,10 +200,13 @@ namespace pleep
         
         //PLEEPLOG_TRACE("Key event: " + std::to_string(key) + ", code: " + std::to_string(scancode) + ", " + std::to_string(action));
 
-        m_inputBuffer.setDigital(key, action);
+        {
+            std::lock_guard<std::mutex> inputBufferLock(m_inputBufferMutex);
+            m_inputBuffer.setDigital(key, action);
 
-        // disambiguate left and right shift/alt/etc...
-        m_inputBuffer.convertMods(mods);
+            // disambiguate left and right shift/alt/etc...
+            m_inputBuffer.convertMods(mods);
+        }
 
         // ****** HARDCODED SHORTCUTS ******
         /* 
@@ -212,7 +230,8 @@ namespace pleep
         // foreward as a cosmos::QUIT for context
         // temporary: context will handle this and stop main loop
         PLEEPLOG_TRACE("Sending event " + std::to_string(events::window::QUIT) + " (events::window::QUIT)");
-        m_sharedBroker->send_event(events::window::QUIT);
+        if (m_isPolledExternally) m_sharedBroker->post_event(events::window::QUIT);
+        else m_sharedBroker->send_event(events::window::QUIT);
     }
     
     void InputDynamo::_window_size_callback(GLFWwindow* w, int width, int height) 
@@ -226,13 +245,15 @@ namespace pleep
         events::window::RESIZE_params resizeParams { width, height };
         resizeEvent << resizeParams;
 
-        m_sharedBroker->send_event(resizeEvent);
+        if (m_isPolledExternally) m_sharedBroker->post_event(resizeEvent);
+        else m_sharedBroker->send_event(resizeEvent);
     }
     
     void InputDynamo::_odm_gear_move_callback(GLFWwindow* w, double x, double y, double z)
     {
         UNREFERENCED_PARAMETER(w);
 
+        std::lock_guard<std::mutex> inputBufferLock(m_inputBufferMutex);
         m_inputBuffer.threeDimAnalog[0][0] = x;
         m_inputBuffer.threeDimAnalog[0][1] = y;
         m_inputBuffer.threeDimAnalog[0][2] = z;
@@ -242,7 +263,7 @@ namespace pleep
     }
 
     
-    void InputDynamo::_virtual_odm_gear_handler(EventMessage odmEvent)
+    void InputDynamo::_virtual_odm_gear_handler(EventMessage& odmEvent)
     {
         events::window::VIRTUAL_ODM_GEAR_INPUT_params odmInfo;
         odmEvent >> odmInfo;
@@ -4,6 +4,7 @@
 //#include "intercession_pch.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <mutex>
 
 #include "core/a_dynamo.h"
 #include "inputting/spacial_input_packet.h"
@@ -30,6 +31,13 @@ namespace pleep
         // THROWS runtime_error if m_windowApi is null
         void run_relays(double deltaTime) override;
 
+        // When the window is polled externally run_relays only processes relays
+        // and poll_window must be called on the window's thread instead
+        // (window events are then posted to the broker, for its thread to dispatch)
+        void set_external_polling(bool external);
+        // call window callbacks for any new window events, filling the raw input buffer
+        void poll_window();
+
         // prepare relays for next frame
         void reset_relays() override;
 
@@ -45,7 +53,7 @@ namespace pleep
         void _odm_gear_move_callback(GLFWwindow* w, double x, double y, double z);
         
         // translates message into input callback
-        void _virtual_odm_gear_handler(EventMessage odmEvent);
+        void _virtual_odm_gear_handler(EventMessage& odmEvent);
         
         // receive events from windowing api
         // NpcDynamo will mirror the InputDynamo, but use internal logic instead of a window
@@ -53,8 +61,12 @@ namespace pleep
         // configurations for window api (since it is not abstracted to a class yet)
         int m_glfwMouseMode = GLFW_CURSOR_NORMAL;
 
+        bool m_isPolledExternally = false;
+
         // store raw window api input for relays to reference
+        // (written by window callbacks, which may be on another thread than relays)
         RawInputBuffer m_inputBuffer;
+        std::mutex m_inputBufferMutex;
 
         // Input Convertion Relays
         SpacialInputRelay m_spacialInputRelay;
@@ -32,7 +32,8 @@ namespace pleep
                 continue;
             }
 
-            SpacialInputComponent& input = cosmos->get_component<SpacialInputComponent>(entity);
+            // input is sent upstream every update regardless of changed flags
+            SpacialInputComponent& input = cosmos->get_component_unmarked<SpacialInputComponent>(entity);
             
             m_attachedInputDynamo->submit(SpacialInputPacket{ input });
         }
@@ -71,4 +72,13 @@ namespace pleep
     {
         m_attachedInputDynamo = contextDynamo;
     }
+    
+    StageAccess SpacialInputSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedInputDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // only reads, InputDynamo writes input through packets after all synchros
+            access.reads.set(cosmos.get_component_type<SpacialInputComponent>());
+        });
+    }
 }
\ No newline at end of file
@@ -21,6 +21,8 @@ namespace pleep
 
         Signature derive_signature() override;
 
+        StageAccess derive_access() override;
+
         // synchro needs a InputDynamo to operate on
         void attach_dynamo(std::shared_ptr<InputDynamo> contextDynamo);
 
@@ -8,23 +8,62 @@
 // predefined macro to supply meta data
 //SPDLOG_LOGGER_DEBUG(GET_PLEEP_LOGGER(), __VA_ARGS__))
 
+// Macros accept either a single message or fmt-style format string and arguments:
+//   PLEEPLOG_DEBUG("Entity " + std::to_string(entity) + " created");
+//   PLEEPLOG_DEBUG("Entity {} created", entity);
+// Arguments are only evaluated (and formatted) if the level is enabled,
+// prefer the fmt-style form on hot paths so no temporary strings are built
+
 #ifdef PLEEPLOG_ON
     #define INIT_PLEEPLOG() pleep::PleepLogger::init()
+    #define DEINIT_PLEEPLOG() pleep::PleepLogger::shutdown()
     #define GET_PLEEP_LOGGER() pleep::PleepLogger::GetPleepLogger()
 
-    #define PLEEPLOG_TRACE(...) GET_PLEEP_LOGGER()->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, spdlog::level::trace, __VA_ARGS__)
-
-    #define PLEEPLOG_DEBUG(...) GET_PLEEP_LOGGER()->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, spdlog::level::debug, __VA_ARGS__)
-
-    #define PLEEPLOG_INFO(...) GET_PLEEP_LOGGER()->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, spdlog::level::info, __VA_ARGS__)
-
-    #define PLEEPLOG_WARN(...) GET_PLEEP_LOGGER()->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, spdlog::level::warn, __VA_ARGS__)
-
-    #define PLEEPLOG_ERROR(...) GET_PLEEP_LOGGER()->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, spdlog::level::err, __VA_ARGS__)
-
-    #define PLEEPLOG_CRITICAL(...) GET_PLEEP_LOGGER()->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, spdlog::level::critical, __VA_ARGS__)
+    // check runtime level before evaluating any arguments
+    // (logger is null before init and after deinit, drop those messages)
+    #define PLEEPLOG_AT_LEVEL(level, ...) \
+        do { \
+            if (pleep::PleepLogger::should_log(level)) { \
+                std::shared_ptr<spdlog::logger> pleepLogger_ = GET_PLEEP_LOGGER(); \
+                if (pleepLogger_) \
+                    pleepLogger_->log(spdlog::source_loc{__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__)}, level, __VA_ARGS__); \
+            } \
+        } while (0)
+
+    #if PLEEPLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+        #define PLEEPLOG_TRACE(...) PLEEPLOG_AT_LEVEL(spdlog::level::trace, __VA_ARGS__)
+    #else
+        #define PLEEPLOG_TRACE(...) (void)0
+    #endif
+
+    #if PLEEPLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+        #define PLEEPLOG_DEBUG(...) PLEEPLOG_AT_LEVEL(spdlog::level::debug, __VA_ARGS__)
+    #else
+        #define PLEEPLOG_DEBUG(...) (void)0
+    #endif
+
+    #if PLEEPLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+        #define PLEEPLOG_INFO(...) PLEEPLOG_AT_LEVEL(spdlog::level::info, __VA_ARGS__)
+    #else
+        #define PLEEPLOG_INFO(...) (void)0
+    #endif
+
+    #if PLEEPLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+        #define PLEEPLOG_WARN(...) PLEEPLOG_AT_LEVEL(spdlog::level::warn, __VA_ARGS__)
+    #else
+        #define PLEEPLOG_WARN(...) (void)0
+    #endif
+
+    #if PLEEPLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+        #define PLEEPLOG_ERROR(...) PLEEPLOG_AT_LEVEL(spdlog::level::err, __VA_ARGS__)
+    #else
+        #define PLEEPLOG_ERROR(...) (void)0
+    #endif
+
+    #define PLEEPLOG_CRITICAL(...) PLEEPLOG_AT_LEVEL(spdlog::level::critical, __VA_ARGS__)
 #else
     #define INIT_PLEEPLOG()
+    #define DEINIT_PLEEPLOG()
     #define GET_PLEEP_LOGGER()
 
     #define PLEEPLOG_TRACE(...)
@@ -40,4 +79,4 @@
     #define PLEEPLOG_CRITICAL(...)
 #endif
 
-#endif // PLEEP_LOG_H
\ No newline at end of file
+#endif // PLEEP_LOG_H
@@ -1,13 +1,16 @@
 #include "pleep_logger.h"
 
+#include <chrono>
+#include <thread>
+
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "logging/pleep_log.h"
 
 namespace pleep
 {
 #ifdef PLEEPLOG_ON
-    // define static logger
-    std::shared_ptr<spdlog::logger> PleepLogger::s_coreLogger;
+    std::atomic<int> PleepLogger::s_level{ spdlog::level::off };
 
     PleepLogger::PleepLogger() 
     {
@@ -28,16 +31,58 @@ namespace pleep
         // %t for thread id
         // %P for process id
 
-        s_coreLogger = spdlog::stdout_color_mt("INTERCESSION");
-        s_coreLogger->set_pattern("[%T.%e] #%-5t %28!s:%-4#|%^%6!l%$: %v");
-        s_coreLogger->set_level(PLEEPLOG_LEVEL);
+        // single writer thread pulls from a fixed size ring buffer
+        // %t still reports the thread which made the log call
+        spdlog::init_thread_pool(PLEEPLOG_QUEUE_SIZE, 1);
+        // non-blocking: overrun oldest message instead of waiting when the queue is full
+        std::shared_ptr<spdlog::logger> coreLogger = spdlog::create_async_nb<spdlog::sinks::stdout_color_sink_mt>("INTERCESSION");
+        coreLogger->set_pattern("[%T.%e] #%-5t %28!s:%-4#|%^%6!l%$: %v");
+        coreLogger->set_level(PLEEPLOG_LEVEL);
+        // errors may be followed by a crash, so don't leave them in the queue
+        coreLogger->flush_on(spdlog::level::err);
+
+        std::atomic_store(&_get_core_logger(), coreLogger);
+        s_level = PLEEPLOG_LEVEL;
 
         PLEEPLOG_TRACE("Initialized pleep logger!");
     }
     
-    std::shared_ptr<spdlog::logger>& PleepLogger::GetPleepLogger() 
+    void PleepLogger::shutdown() 
+    {
+        // new log calls stop here, ones already past should_log find a null logger
+        s_level = spdlog::level::off;
+        std::shared_ptr<spdlog::logger> coreLogger = std::atomic_exchange(&_get_core_logger(), std::shared_ptr<spdlog::logger>());
+        if (!coreLogger) return;
+        // (registry's reference would look like a caller's)
+        spdlog::drop(coreLogger->name());
+
+        // calls which fetched the logger just before hold it only until their message is queued
+        const std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+        while (coreLogger.use_count() > 1 && std::chrono::steady_clock::now() - waitStart < std::chrono::milliseconds(100))
+        {
+            std::this_thread::yield();
+        }
+
+        coreLogger->flush();
+        coreLogger = nullptr;
+        // drops registry's reference and joins the writer thread
+        spdlog::shutdown();
+    }
+
+    bool PleepLogger::should_log(spdlog::level::level_enum level)
+    {
+        return level >= s_level.load(std::memory_order_relaxed);
+    }
+    
+    std::shared_ptr<spdlog::logger> PleepLogger::GetPleepLogger() 
+    {
+        return std::atomic_load(&_get_core_logger());
+    }
+
+    std::shared_ptr<spdlog::logger>& PleepLogger::_get_core_logger()
     {
-        return s_coreLogger;
+        static std::shared_ptr<spdlog::logger>* coreLogger = new std::shared_ptr<spdlog::logger>();
+        return *coreLogger;
     }
 #endif
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 
 //#include "intercession_pch.h"
 #include <memory>
+#include <atomic>
 
 // also defined in glfw, glfw has redefine guard, spdlog does not
 #undef APIENTRY
@@ -19,6 +20,16 @@
 // 2. change minimum displayed log level
 #define PLEEPLOG_LEVEL spdlog::level::debug
 
+// 3. change minimum compiled log level, call sites below this are removed entirely
+//    (their arguments are never evaluated) so it should be <= PLEEPLOG_LEVEL
+#ifndef PLEEPLOG_ACTIVE_LEVEL
+#define PLEEPLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#endif
+
+// 4. async sink queue size (in messages), when full the oldest message is dropped
+//    so that logging never blocks the calling thread
+#define PLEEPLOG_QUEUE_SIZE 8192
+
 // TODO: sink logging to file?
 //#define PLEEPLOG_FILE
 //#define PLEEPLOG_CONSOLE
@@ -38,14 +49,25 @@ namespace pleep
         PleepLogger();
         ~PleepLogger();
 
+        // starts the writer thread which formats and prints queued messages
         static void init();
+        // flush queued messages and join writer thread (call before exiting main)
+        // other threads (worker pools, static destructors) may still log, their messages are dropped
+        static void shutdown();
 
-        static std::shared_ptr<spdlog::logger>& GetPleepLogger();
+        // cheap check to make before GetPleepLogger, false before init and after shutdown
+        static bool should_log(spdlog::level::level_enum level);
+        // null before init and after shutdown, hold the returned pointer while logging
+        // so shutdown waits for the message to be queued before joining the writer thread
+        static std::shared_ptr<spdlog::logger> GetPleepLogger();
 
     private:
-        static std::shared_ptr<spdlog::logger> s_coreLogger;
+        // never destroyed, so logging from static destructors is still safe
+        static std::shared_ptr<spdlog::logger>& _get_core_logger();
+        // mirror of core logger's level (off when there is no logger)
+        static std::atomic<int> s_level;
     };
 #endif
 }
 
-#endif // PLEEP_LOGGER_H
\ No newline at end of file
+#endif // PLEEP_LOGGER_H
@@ -0,0 +1,349 @@
+#include "a_peer_timeline_transport.h"
+
+#include <stdexcept>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <iterator>
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    A_PeerTimelineTransport::A_PeerTimelineTransport(TimesliceId id, size_t numTimeslices)
+        : m_timesliceId(id)
+        , m_numTimeslices(numTimeslices)
+        , m_outgoing(numTimeslices)
+        , m_incoming(numTimeslices)
+        , m_session(static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count()) | 1U)
+    {
+        if (id >= numTimeslices)
+        {
+            std::string errMsg = ("Timeline transport was constructed with an id (" + std::to_string(id) + ") outside of the timeline (" + std::to_string(numTimeslices) + " timeslices)");
+            PLEEPLOG_ERROR(errMsg);
+            throw std::range_error(errMsg);
+        }
+    }
+
+    size_t A_PeerTimelineTransport::get_num_timeslices()
+    {
+        return m_numTimeslices;
+    }
+
+    bool A_PeerTimelineTransport::send_message(TimesliceId id, const EventMessage& data)
+    {
+        if (id >= m_numTimeslices)
+        {
+            PLEEPLOG_WARN("Trying to send data to non-existent id (" + std::to_string(id) + "). Only " + std::to_string(m_numTimeslices) + " total ids exist.");
+            return false;
+        }
+        // sending to my own id is ok, because we can re-use the same logic on receiving
+        if (id == m_timesliceId)
+        {
+            m_inbox.push_back(data);
+            return true;
+        }
+        return _send_frame(id, data, FrameKind::message, NULL_ENTITY);
+    }
+
+    bool A_PeerTimelineTransport::broadcast_message(const EventMessage& data)
+    {
+        bool sent = true;
+        for (TimesliceId i = 0; i < m_numTimeslices; i++)
+        {
+            if (i == m_timesliceId) continue;
+            sent &= _send_frame(i, data, FrameKind::message, NULL_ENTITY);
+        }
+        return sent;
+    }
+
+    bool A_PeerTimelineTransport::is_message_available()
+    {
+        _receive();
+        return !m_inbox.empty();
+    }
+
+    bool A_PeerTimelineTransport::pop_message(EventMessage& dest)
+    {
+        _receive();
+        if (m_inbox.empty()) return false;
+
+        dest = std::move(m_inbox.front());
+        m_inbox.pop_front();
+        return true;
+    }
+
+    bool A_PeerTimelineTransport::has_future()
+    {
+        // future is the next lower id
+        return m_timesliceId > 0;
+    }
+
+    bool A_PeerTimelineTransport::has_past()
+    {
+        return m_timesliceId + 1U < m_numTimeslices;
+    }
+
+    void A_PeerTimelineTransport::push_past_timestream(Entity entity, const EventMessage& data)
+    {
+        if (!this->has_past())
+        {
+            PLEEPLOG_WARN("This timeslice has no past timestream to push to");
+            return;
+        }
+        _send_frame(m_timesliceId + 1U, data, FrameKind::timestream, entity);
+    }
+
+    std::vector<Entity> A_PeerTimelineTransport::get_entities_with_future_streams()
+    {
+        if (!this->has_future())
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream at all!");
+            return std::vector<Entity>{};
+        }
+        _receive();
+        return m_futureTimestreams.get_entities_with_streams();
+    }
+
+    bool A_PeerTimelineTransport::pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest)
+    {
+        if (!this->has_future())
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream to pop from");
+            return false;
+        }
+        _receive();
+        return m_futureTimestreams.pop_from_timestream(entity, coherency, dest);
+    }
+
+    void A_PeerTimelineTransport::copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest)
+    {
+        // anything received but not yet sorted belongs in it too
+        _receive();
+        m_futureTimestreams.copy_timestreams(dest);
+    }
+
+    void A_PeerTimelineTransport::restore_future_timestream(Entity entity, const EventMessage& stored)
+    {
+        if (!this->has_future())
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream to restore to");
+            return;
+        }
+        m_futureTimestreams.restore_to_timestream(entity, stored);
+    }
+
+    void A_PeerTimelineTransport::link_timestreams(std::shared_ptr<EntityTimestreamMap> sourceTimestreams)
+    {
+        UNREFERENCED_PARAMETER(sourceTimestreams);
+        PLEEPLOG_WARN("Timestreams of a multi-process timeline cannot be linked (parallel is unavailable)");
+    }
+
+    void A_PeerTimelineTransport::push_timestream_at_breakpoint(Entity entity, const EventMessage& data)
+    {
+        UNREFERENCED_PARAMETER(entity);
+        UNREFERENCED_PARAMETER(data);
+        PLEEPLOG_WARN("Timestreams of a multi-process timeline have no breakpoints (parallel is unavailable)");
+    }
+
+    bool A_PeerTimelineTransport::pop_timestream_at_breakpoint(Entity entity, uint16_t coherency, EventMessage& dest)
+    {
+        UNREFERENCED_PARAMETER(entity);
+        UNREFERENCED_PARAMETER(coherency);
+        UNREFERENCED_PARAMETER(dest);
+        PLEEPLOG_WARN("Timestreams of a multi-process timeline have no breakpoints (parallel is unavailable)");
+        return false;
+    }
+
+    // same results as InProcessTimelineTransport without a parallel context
+    void A_PeerTimelineTransport::parallel_notify_divergence()
+    {
+    }
+
+    bool A_PeerTimelineTransport::parallel_load_and_link(const std::shared_ptr<Cosmos> sourceCosmos)
+    {
+        UNREFERENCED_PARAMETER(sourceCosmos);
+        return true;
+    }
+
+    void A_PeerTimelineTransport::parallel_retarget(uint16_t newTarget)
+    {
+        UNREFERENCED_PARAMETER(newTarget);
+    }
+
+    bool A_PeerTimelineTransport::parallel_start()
+    {
+        return false;
+    }
+
+    TimesliceId A_PeerTimelineTransport::parallel_get_timeslice()
+    {
+        return NULL_TIMESLICEID;
+    }
+
+    bool A_PeerTimelineTransport::parallel_extract(std::shared_ptr<Cosmos> dstCosmos)
+    {
+        UNREFERENCED_PARAMETER(dstCosmos);
+        return false;
+    }
+
+    bool A_PeerTimelineTransport::_send_frame(TimesliceId id, const EventMessage& data, FrameKind kind, Entity entity)
+    {
+        if (_get_held_count(id) >= TIMELINE_PEER_BACKLOG)
+        {
+            _wait_for_backlog(id);
+        }
+
+        OutgoingLink& link = m_outgoing[id];
+        HeldFrame held{ link.nextSequence++, data };
+        FrameEnvelope envelope{ kind, entity, m_timesliceId, m_session, held.sequence };
+        held.frame << envelope;
+        link.backlog.push_back(std::move(held));
+
+        _flush(id);
+        return true;
+    }
+
+    void A_PeerTimelineTransport::_wait_for_backlog(TimesliceId id)
+    {
+        PLEEPLOG_WARN("Timeslice " + std::to_string(id) + " is not accepting messages, waiting on " + std::to_string(_get_held_count(id)) + " held messages");
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < TIMELINE_PEER_BACKLOG_WAIT)
+        {
+            // it may be waiting on us to accept its frames too
+            _receive();
+            if (_get_held_count(id) < TIMELINE_PEER_BACKLOG) return;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // stalling our simulation any longer hurts everyone else, it can catch up from full state instead
+        OutgoingLink& link = m_outgoing[id];
+        PLEEPLOG_WARN("Timeslice " + std::to_string(id) + " did not accept messages for " + std::to_string(TIMELINE_PEER_BACKLOG_WAIT) + "s, dropping " + std::to_string(_get_held_count(id)) + " held messages and resyncing it");
+        link.backlog.clear();
+        link.unacknowledged.clear();
+
+        EventMessage resyncMsg(events::network::TIMELINE_RESYNC);
+        events::network::TIMELINE_RESYNC_params resyncInfo = { id };
+        resyncMsg << resyncInfo;
+        m_inbox.push_back(resyncMsg);
+    }
+
+    void A_PeerTimelineTransport::_flush(TimesliceId id)
+    {
+        OutgoingLink& link = m_outgoing[id];
+        while (!link.backlog.empty() && _deliver_frame(id, link.backlog.front().frame))
+        {
+            link.unacknowledged.push_back(std::move(link.backlog.front()));
+            link.backlog.pop_front();
+        }
+    }
+
+    void A_PeerTimelineTransport::_requeue_unacknowledged(TimesliceId id)
+    {
+        OutgoingLink& link = m_outgoing[id];
+        if (link.unacknowledged.empty()) return;
+
+        PLEEPLOG_DEBUG("Redelivering {} unacknowledged messages to timeslice {}", link.unacknowledged.size(), id);
+        // (already numbered, so they keep their order ahead of the backlog)
+        link.backlog.insert(link.backlog.begin(),
+            std::make_move_iterator(link.unacknowledged.begin()),
+            std::make_move_iterator(link.unacknowledged.end()));
+        link.unacknowledged.clear();
+    }
+
+    size_t A_PeerTimelineTransport::_get_held_count(TimesliceId id) const
+    {
+        return m_outgoing[id].backlog.size() + m_outgoing[id].unacknowledged.size();
+    }
+
+    void A_PeerTimelineTransport::_receive()
+    {
+        // also make progress on held messages if nothing new is sent to them
+        for (TimesliceId i = 0; i < m_numTimeslices; i++)
+        {
+            if (i == m_timesliceId || m_outgoing[i].backlog.empty()) continue;
+            _flush(i);
+        }
+
+        EventMessage frame;
+        while (_pop_frame(frame))
+        {
+            FrameEnvelope envelope;
+            frame >> envelope;
+            if (envelope.sender >= m_numTimeslices || envelope.sender == m_timesliceId)
+            {
+                PLEEPLOG_WARN("Received timeline frame from unknown timeslice " + std::to_string(envelope.sender) + ", ignoring: " + frame.info());
+                continue;
+            }
+
+            if (envelope.kind == FrameKind::ack)
+            {
+                // acks for a previous run of us are meaningless
+                if (envelope.session != m_session) continue;
+                std::deque<HeldFrame>& unacknowledged = m_outgoing[envelope.sender].unacknowledged;
+                while (!unacknowledged.empty() && unacknowledged.front().sequence <= envelope.sequence)
+                {
+                    unacknowledged.pop_front();
+                }
+                continue;
+            }
+
+            IncomingLink& incoming = m_incoming[envelope.sender];
+            if (envelope.session != incoming.session)
+            {
+                // sender restarted (or first contact)
+                incoming = IncomingLink{};
+                incoming.session = envelope.session;
+                incoming.lastAck = std::chrono::steady_clock::now();
+            }
+            else if (envelope.sequence <= incoming.sequence)
+            {
+                // redelivered after we had already read it
+                continue;
+            }
+            incoming.sequence = envelope.sequence;
+
+            switch (envelope.kind)
+            {
+            case FrameKind::message:
+                m_inbox.push_back(std::move(frame));
+                break;
+            case FrameKind::timestream:
+                m_futureTimestreams.push_to_timestream(envelope.entity, frame);
+                break;
+            default:
+                PLEEPLOG_WARN("Received timeline frame of unknown kind, ignoring: " + frame.info());
+                break;
+            }
+        }
+
+        _acknowledge();
+    }
+
+    void A_PeerTimelineTransport::_acknowledge()
+    {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (TimesliceId i = 0; i < m_numTimeslices; i++)
+        {
+            IncomingLink& incoming = m_incoming[i];
+            if (i == m_timesliceId || incoming.sequence == incoming.acknowledged) continue;
+            if (incoming.sequence - incoming.acknowledged < TIMELINE_PEER_ACK_FRAMES
+                && std::chrono::duration<double>(now - incoming.lastAck).count() < TIMELINE_PEER_ACK_INTERVAL)
+            {
+                continue;
+            }
+
+            // acks aren't held, a newer one replaces any that can't be delivered now
+            EventMessage ackFrame;
+            FrameEnvelope envelope{ FrameKind::ack, NULL_ENTITY, m_timesliceId, incoming.session, incoming.sequence };
+            ackFrame << envelope;
+            if (_deliver_frame(i, ackFrame))
+            {
+                incoming.acknowledged = incoming.sequence;
+                incoming.lastAck = now;
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef A_PEER_TIMELINE_TRANSPORT_H
+#define A_PEER_TIMELINE_TRANSPORT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <vector>
+#include <deque>
+#include <chrono>
+
+#include "networking/i_timeline_transport.h"
+
+// messages held for a timeslice until it has acknowledged them, past this sending waits for it to catch up
+#define TIMELINE_PEER_BACKLOG 4096
+// seconds to wait on a full backlog before dropping it and resyncing (see events::network::TIMELINE_RESYNC)
+#define TIMELINE_PEER_BACKLOG_WAIT 2.0
+// received frames (or seconds) before acknowledging them to their sender
+#define TIMELINE_PEER_ACK_FRAMES 64
+#define TIMELINE_PEER_ACK_INTERVAL 0.05
+// seconds between attempts to (re)connect to a timeslice which isn't accepting
+#define TIMELINE_PEER_RETRY_INTERVAL 1.0
+
+namespace pleep
+{
+    // Common to transports where each timeslice may be its own process:
+    // every message to another timeslice is framed with an envelope and delivered to it,
+    // and the receiver sorts frames into its inbox or (for timestream pushes from its future)
+    // its own future timestream, so pops never wait on the other process.
+    // Frames are only forgotten once the receiver acknowledges them, if a subclass loses its link
+    // (the receiver may not have read what was handed over) they are delivered again.
+    // Parallel resolution needs the futures' cosmos & timestreams in memory so is unavailable
+    // (divergences resolve as they would without a parallel context)
+    class A_PeerTimelineTransport : public I_TimelineTransport
+    {
+    protected:
+        A_PeerTimelineTransport(TimesliceId id, size_t numTimeslices);
+    public:
+        virtual ~A_PeerTimelineTransport() = default;
+
+        size_t get_num_timeslices() override;
+
+        bool send_message(TimesliceId id, const EventMessage& data) override;
+        bool broadcast_message(const EventMessage& data) override;
+        bool is_message_available() override;
+        bool pop_message(EventMessage& dest) override;
+
+        bool has_future() override;
+        bool has_past() override;
+        void push_past_timestream(Entity entity, const EventMessage& data) override;
+        std::vector<Entity> get_entities_with_future_streams() override;
+        bool pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest) override;
+        void copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest) override;
+        void restore_future_timestream(Entity entity, const EventMessage& stored) override;
+
+        // breakpoints are only used by parallel
+        void link_timestreams(std::shared_ptr<EntityTimestreamMap> sourceTimestreams) override;
+        void push_timestream_at_breakpoint(Entity entity, const EventMessage& data) override;
+        bool pop_timestream_at_breakpoint(Entity entity, uint16_t coherency, EventMessage& dest) override;
+
+        void parallel_notify_divergence() override;
+        bool parallel_load_and_link(const std::shared_ptr<Cosmos> sourceCosmos) override;
+        void parallel_retarget(uint16_t newTarget) override;
+        bool parallel_start() override;
+        TimesliceId parallel_get_timeslice() override;
+        bool parallel_extract(std::shared_ptr<Cosmos> dstCosmos) override;
+
+    protected:
+        // hand frame to timeslice id, returning false if it cannot take it (yet)
+        // undelivered frames are held and offered again in order
+        virtual bool _deliver_frame(TimesliceId id, const EventMessage& frame) = 0;
+        // next frame delivered to us, returns false if there are none
+        virtual bool _pop_frame(EventMessage& frame) = 0;
+        // subclass' link to id was lost, frames handed over but not acknowledged are delivered again (first)
+        void _requeue_unacknowledged(TimesliceId id);
+
+        TimesliceId m_timesliceId;
+        size_t m_numTimeslices;
+
+    private:
+        // which local queue a received frame belongs in
+        enum class FrameKind : uint8_t
+        {
+            message,
+            timestream,
+            // receiver has every frame of ours up to sequence
+            ack
+        };
+        // pushed on top of each message sent between timeslices
+        struct FrameEnvelope
+        {
+            FrameKind kind;
+            Entity entity;
+            TimesliceId sender;
+            // sender's frames are numbered from 1 for each run of it (session)
+            // so its receivers can drop the ones redelivered after they were read
+            uint32_t session;
+            uint32_t sequence;
+        };
+
+        struct HeldFrame
+        {
+            uint32_t sequence;
+            EventMessage frame;
+        };
+        // our frames to one timeslice
+        struct OutgoingLink
+        {
+            // not yet handed to the subclass
+            std::deque<HeldFrame> backlog;
+            // handed over, kept until acknowledged
+            std::deque<HeldFrame> unacknowledged;
+            uint32_t nextSequence = 1;
+        };
+        // one timeslice's frames to us
+        struct IncomingLink
+        {
+            uint32_t session = 0;
+            // newest received and newest acknowledged
+            uint32_t sequence = 0;
+            uint32_t acknowledged = 0;
+            std::chrono::steady_clock::time_point lastAck;
+        };
+
+        // wrap data with envelope and deliver (or hold) it for timeslice id
+        // BLOCKS while id's backlog is full (up to TIMELINE_PEER_BACKLOG_WAIT), receiving meanwhile so two full timeslices can't deadlock
+        bool _send_frame(TimesliceId id, const EventMessage& data, FrameKind kind, Entity entity);
+        // wait until id has acknowledged enough held frames to hold another
+        // if it doesn't in time everything held for it is dropped and our own network dynamo is told to resync it
+        void _wait_for_backlog(TimesliceId id);
+        // deliver held frames in order until one is refused
+        void _flush(TimesliceId id);
+        // sort everything received into the inbox or future timestream, and acknowledge it
+        void _receive();
+        // tell senders what we've received (when enough has been since last time)
+        void _acknowledge();
+
+        size_t _get_held_count(TimesliceId id) const;
+
+        // by timeslice id, our own is unused
+        std::vector<OutgoingLink> m_outgoing;
+        std::vector<IncomingLink> m_incoming;
+        // distinguishes our frames from those of a previous run with the same id
+        uint32_t m_session;
+
+        // messages received for us
+        std::deque<EventMessage> m_inbox;
+        // timestream pushed to us by our future timeslice
+        EntityTimestreamMap m_futureTimestreams;
+    };
+}
+
+#endif // A_PEER_TIMELINE_TRANSPORT_H
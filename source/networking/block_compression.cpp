@@ -0,0 +1,249 @@
+#include "block_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+namespace pleep
+{
+    // LZ4 block format constants
+    // shortest match worth encoding
+    constexpr size_t LZ_MIN_MATCH = 4;
+    // last bytes of a block are always literals
+    constexpr size_t LZ_LAST_LITERALS = 5;
+    // no match may start within this many bytes of the end
+    constexpr size_t LZ_MATCH_FIND_LIMIT = 12;
+    // offsets are 16 bit
+    constexpr size_t LZ_MAX_DISTANCE = 65535;
+    constexpr unsigned LZ_HASH_LOG = 12;
+
+    namespace
+    {
+        inline uint32_t read32(const uint8_t* p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(uint32_t));
+            return value;
+        }
+
+        inline uint32_t lz_hash(uint32_t sequence)
+        {
+            // Knuth's multiplicative hash, keep top bits
+            return (sequence * 2654435761U) >> (32 - LZ_HASH_LOG);
+        }
+
+        // lengths >= 15 continue in following bytes of 255s and a remainder
+        inline void write_length(std::vector<uint8_t>& dest, size_t length)
+        {
+            while (length >= 255)
+            {
+                dest.push_back(255);
+                length -= 255;
+            }
+            dest.push_back(static_cast<uint8_t>(length));
+        }
+
+        // returns false if src runs out
+        inline bool read_length(const uint8_t* src, size_t srcSize, size_t& ip, size_t& length)
+        {
+            uint8_t byte;
+            do
+            {
+                if (ip >= srcSize) return false;
+                byte = src[ip++];
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+        void write_sequence(std::vector<uint8_t>& dest, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+        {
+            const size_t matchCode = matchLength - LZ_MIN_MATCH;
+            dest.push_back(static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15)));
+            if (literalLength >= 15) write_length(dest, literalLength - 15);
+            dest.insert(dest.end(), literals, literals + literalLength);
+
+            dest.push_back(static_cast<uint8_t>(offset & 0xFF));
+            dest.push_back(static_cast<uint8_t>(offset >> 8));
+            if (matchCode >= 15) write_length(dest, matchCode - 15);
+        }
+
+        void write_last_literals(std::vector<uint8_t>& dest, const uint8_t* literals, size_t literalLength)
+        {
+            dest.push_back(static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4));
+            if (literalLength >= 15) write_length(dest, literalLength - 15);
+            dest.insert(dest.end(), literals, literals + literalLength);
+        }
+    }
+
+    bool LzBlockCompressor::compress(const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dest)
+    {
+        dest.clear();
+        dest.reserve(srcSize);
+
+        size_t anchor = 0;
+        if (srcSize > LZ_MATCH_FIND_LIMIT)
+        {
+            // most recent position of each hashed 4 byte sequence
+            std::array<uint32_t, 1 << LZ_HASH_LOG> table;
+            table.fill(0);
+
+            const size_t matchLimit = srcSize - LZ_LAST_LITERALS;
+            const size_t findLimit = srcSize - LZ_MATCH_FIND_LIMIT;
+            size_t ip = 0;
+            while (ip < findLimit)
+            {
+                const uint32_t sequence = read32(src + ip);
+                const uint32_t hash = lz_hash(sequence);
+                size_t candidate = table[hash];
+                table[hash] = static_cast<uint32_t>(ip);
+
+                if (candidate >= ip || ip - candidate > LZ_MAX_DISTANCE || read32(src + candidate) != sequence)
+                {
+                    // skip faster through incompressible data
+                    ip += 1 + ((ip - anchor) >> 6);
+                    continue;
+                }
+
+                // extend backwards into pending literals
+                while (ip > anchor && candidate > 0 && src[ip - 1] == src[candidate - 1])
+                {
+                    ip--;
+                    candidate--;
+                }
+                size_t matchLength = LZ_MIN_MATCH;
+                while (ip + matchLength < matchLimit && src[ip + matchLength] == src[candidate + matchLength])
+                {
+                    matchLength++;
+                }
+
+                write_sequence(dest, src + anchor, ip - anchor, ip - candidate, matchLength);
+                ip += matchLength;
+                anchor = ip;
+
+                // no gain, stop early
+                if (dest.size() >= srcSize) return false;
+
+                // seed the table inside the match so following data can refer back to it
+                if (ip - 2 < findLimit)
+                {
+                    table[lz_hash(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+                }
+            }
+        }
+
+        write_last_literals(dest, src + anchor, srcSize - anchor);
+        return dest.size() < srcSize;
+    }
+
+    bool LzBlockCompressor::decompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t rawSize)
+    {
+        size_t ip = 0;
+        size_t op = 0;
+        while (ip < srcSize)
+        {
+            const uint8_t token = src[ip++];
+
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !read_length(src, srcSize, ip, literalLength)) return false;
+            if (literalLength > srcSize - ip || literalLength > rawSize - op) return false;
+            std::memcpy(dest + op, src + ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+
+            // last sequence has no match
+            if (ip == srcSize) break;
+
+            if (srcSize - ip < 2) return false;
+            const size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > op) return false;
+
+            size_t matchLength = token & 0x0F;
+            if (matchLength == 15 && !read_length(src, srcSize, ip, matchLength)) return false;
+            matchLength += LZ_MIN_MATCH;
+            if (matchLength > rawSize - op) return false;
+
+            // matches may overlap their own output (runs), so copy forwards bytewise
+            const uint8_t* match = dest + op - offset;
+            if (offset >= matchLength)
+            {
+                std::memcpy(dest + op, match, matchLength);
+            }
+            else
+            {
+                for (size_t i = 0; i < matchLength; i++) dest[op + i] = match[i];
+            }
+            op += matchLength;
+        }
+        return op == rawSize;
+    }
+
+    BlockCompression::BlockCompression(size_t threshold)
+        : m_compressor(std::make_shared<LzBlockCompressor>())
+        , m_threshold(threshold)
+    {
+    }
+
+    bool BlockCompression::compress(const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dest)
+    {
+        if (srcSize < m_threshold)
+        {
+            m_blocksSkipped++;
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool compressed = m_compressor->compress(src, srcSize, dest);
+        m_compressNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        m_rawBytes += srcSize;
+        if (compressed)
+        {
+            m_storedBytes += dest.size();
+            m_blocksCompressed++;
+        }
+        else
+        {
+            m_storedBytes += srcSize;
+            m_blocksSkipped++;
+        }
+        return compressed;
+    }
+
+    bool BlockCompression::decompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t rawSize)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const bool decompressed = m_compressor->decompress(src, srcSize, dest, rawSize);
+        m_decompressNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        return decompressed;
+    }
+
+    void BlockCompression::set_compressor(std::shared_ptr<I_BlockCompressor> compressor)
+    {
+        m_compressor = compressor;
+    }
+
+    void BlockCompression::set_threshold(size_t threshold)
+    {
+        m_threshold = threshold;
+    }
+
+    size_t BlockCompression::get_threshold() const
+    {
+        return m_threshold;
+    }
+
+    CompressionTickMetrics BlockCompression::get_totals() const
+    {
+        CompressionTickMetrics metrics;
+        metrics.rawBytes = m_rawBytes.load();
+        metrics.storedBytes = m_storedBytes.load();
+        metrics.blocksCompressed = m_blocksCompressed.load();
+        metrics.blocksSkipped = m_blocksSkipped.load();
+        metrics.compressMs = m_compressNanoseconds.load() / 1.0e6;
+        metrics.decompressMs = m_decompressNanoseconds.load() / 1.0e6;
+        return metrics;
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+// Blocks smaller than these are never compressed (not worth the cpu or the risk of growing)
+#define NETWORK_COMPRESSION_THRESHOLD 256
+#define TIMESTREAM_COMPRESSION_THRESHOLD 128
+
+namespace pleep
+{
+    // Interface for a lossless codec of whole, independent blocks
+    // Both ends of a connection must use the same compressor
+    class I_BlockCompressor
+    {
+    public:
+        virtual ~I_BlockCompressor() = default;
+
+        // overwrite dest with compressed src
+        // returns false (dest undefined) if the result would not be smaller than src
+        virtual bool compress(const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dest) = 0;
+
+        // write exactly rawSize bytes decompressed from src into dest
+        // returns false if src is malformed or doesn't decompress to exactly rawSize
+        virtual bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t rawSize) = 0;
+    };
+
+    // Byte oriented LZ77 in the LZ4 block format: greedy single-probe hash matching,
+    // no entropy coding, so it runs at memory speeds rather than ratios.
+    // Stateless between blocks, safe to share between threads
+    class LzBlockCompressor : public I_BlockCompressor
+    {
+    public:
+        bool compress(const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dest) override;
+        bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t rawSize) override;
+    };
+
+    // Totals over some period (see BlockCompression::get_totals)
+    struct CompressionTickMetrics
+    {
+        // bytes given to compress (at or above threshold)
+        uint64_t rawBytes = 0;
+        // bytes those became (raw size for blocks which didn't shrink)
+        uint64_t storedBytes = 0;
+        uint64_t blocksCompressed = 0;
+        // below threshold or didn't shrink
+        uint64_t blocksSkipped = 0;
+        double compressMs = 0.0;
+        double decompressMs = 0.0;
+
+        // raw / stored, > 1 is good
+        double ratio() const
+        {
+            return storedBytes > 0 ? static_cast<double>(rawBytes) / storedBytes : 1.0;
+        }
+
+        // totals between an earlier snapshot and this one
+        CompressionTickMetrics since(const CompressionTickMetrics& earlier) const
+        {
+            CompressionTickMetrics delta;
+            delta.rawBytes = rawBytes - earlier.rawBytes;
+            delta.storedBytes = storedBytes - earlier.storedBytes;
+            delta.blocksCompressed = blocksCompressed - earlier.blocksCompressed;
+            delta.blocksSkipped = blocksSkipped - earlier.blocksSkipped;
+            delta.compressMs = compressMs - earlier.compressMs;
+            delta.decompressMs = decompressMs - earlier.decompressMs;
+            return delta;
+        }
+    };
+
+    // Threshold, codec, and metrics for one use of compression (network frames, timestreams)
+    // compress/decompress can be called from any thread
+    class BlockCompression
+    {
+    public:
+        BlockCompression(size_t threshold);
+
+        // returns true if dest holds compressed src, false if src should be used as is
+        bool compress(const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dest);
+
+        // returns false if src is malformed
+        bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t rawSize);
+
+        // replace codec, only before any blocks are compressed
+        void set_compressor(std::shared_ptr<I_BlockCompressor> compressor);
+
+        void set_threshold(size_t threshold);
+        size_t get_threshold() const;
+
+        // metrics accumulated since construction, never reset so any number of readers
+        // (eg. every timeslice's network dynamo) can each report their own period with since()
+        CompressionTickMetrics get_totals() const;
+
+    private:
+        std::shared_ptr<I_BlockCompressor> m_compressor;
+        std::atomic<size_t> m_threshold;
+
+        std::atomic<uint64_t> m_rawBytes{ 0 };
+        std::atomic<uint64_t> m_storedBytes{ 0 };
+        std::atomic<uint64_t> m_blocksCompressed{ 0 };
+        std::atomic<uint64_t> m_blocksSkipped{ 0 };
+        std::atomic<uint64_t> m_compressNanoseconds{ 0 };
+        std::atomic<uint64_t> m_decompressNanoseconds{ 0 };
+    };
+
+    // process wide compression of batched Connection frames
+    inline BlockCompression& get_network_compression()
+    {
+        static BlockCompression compression(NETWORK_COMPRESSION_THRESHOLD);
+        return compression;
+    }
+
+    // process wide compression of messages waiting deep in EntityTimestreamMap timestreams
+    inline BlockCompression& get_timestream_compression()
+    {
+        static BlockCompression compression(TIMESTREAM_COMPRESSION_THRESHOLD);
+        return compression;
+    }
+}
+
+#endif // BLOCK_COMPRESSION_H
@@ -6,12 +6,23 @@
 #include <unordered_map>
 #include <mutex>
 #include <memory>
+#include <vector>
+#include <utility>
+#include <stdexcept>
 
 #include "networking/ts_breakpoint_queue.h"
 #include "networking/net_message.h"
+#include "networking/block_compression.h"
 #include "ecs/ecs_types.h"
 #include "events/event_types.h"
 
+// Messages this far (or further) from the front of a timestream are "cold"
+// and have their bodies block compressed until they are popped
+#define TIMESTREAM_HOT_MESSAGES 2
+// Only entity updates with bodies at least this large are worth compressing
+// (small or infrequent messages don't save enough to pay for the compression)
+#define TIMESTREAM_COLD_MIN_BYTES 256
+
 namespace pleep
 {
     // Track entities and components through time
@@ -58,19 +69,33 @@ namespace pleep
         // coherency is circular so there is no catch-all default value
         void push_to_timestream(Entity entity, const EventMessage& msg)
         {
-            const std::lock_guard<std::mutex> lk(m_mapMux);
-            
-            if (m_areBreakpointsActive && m_timestreams.count(entity) == 0)
-            {
-                // create and set breakpoint for new timestream
-                m_timestreams[entity].set_breakpoint_at_begin();
-            }
-
             // TODO: detect when timstreams has gone way beyond expected capacity and stop pushing
             //PLEEPLOG_DEBUG("Pushing event: " + std::to_string(msg.header.id) + " for entity: " + std::to_string(entity) + " at coherency: " + std::to_string(msg.header.coherency));
 
-            // operator[] emplaces with default constructor for TsBreakpointQueue
-            m_timestreams[entity].push_back(msg);
+            if (msg.header.id == events::cosmos::ENTITY_UPDATE && msg.body.size() >= TIMESTREAM_COLD_MIN_BYTES)
+            {
+                // compress without holding the lock (pops may shorten the stream meanwhile,
+                // a cold message which ends up hot is still decompressed when popped)
+                bool isCold = false;
+                {
+                    const std::lock_guard<std::mutex> lk(m_mapMux);
+                    auto timestreamIt = m_timestreams.find(entity);
+                    isCold = timestreamIt != m_timestreams.end() && timestreamIt->second.count() >= TIMESTREAM_HOT_MESSAGES;
+                    if (!isCold)
+                    {
+                        push_locked(entity, msg);
+                        return;
+                    }
+                }
+
+                const EventMessage cold = compress_cold(msg);
+                const std::lock_guard<std::mutex> lk(m_mapMux);
+                push_locked(entity, cold);
+                return;
+            }
+
+            const std::lock_guard<std::mutex> lk(m_mapMux);
+            push_locked(entity, msg);
         }
         void push_to_timestream_at_breakpoint(Entity entity, const EventMessage& msg)
         {
@@ -105,6 +130,30 @@ namespace pleep
             return is_data_available_at_breakpoint(entity, currentCoherency);
         }
 
+        // append every stored message of every timestream (in order) to dest, for checkpoints
+        // messages are as stored, so cold ones are still compressed
+        void copy_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest)
+        {
+            const std::lock_guard<std::mutex> lk(m_mapMux);
+
+            std::vector<EventMessage> stored;
+            for (auto& timestreamIt : m_timestreams)
+            {
+                stored.clear();
+                timestreamIt.second.copy_to(stored);
+                for (EventMessage& msg : stored)
+                {
+                    dest.emplace_back(timestreamIt.first, std::move(msg));
+                }
+            }
+        }
+        // push a message exactly as it was copied by copy_timestreams
+        void restore_to_timestream(Entity entity, const EventMessage& stored)
+        {
+            const std::lock_guard<std::mutex> lk(m_mapMux);
+            push_locked(entity, stored);
+        }
+
         // check if entity has an active timestream (empty or not)
         bool entity_has_timestream(Entity entity)
         {
@@ -129,23 +178,32 @@ namespace pleep
         // we should only be able to pop once the correct coherency has been reached
         bool pop_from_timestream(Entity entity, uint16_t currentCoherency, EventMessage& dest)
         {
-            const std::lock_guard<std::mutex> lk(m_mapMux);
+            {
+                const std::lock_guard<std::mutex> lk(m_mapMux);
 
-            // check if data is available internally to avoid lock juggling
-            if (!is_data_available(entity, currentCoherency)) return false;
-            //PLEEPLOG_DEBUG("Popping for entity: " + std::to_string(entity) + " on coherency: " + std::to_string(currentCoherency) + ". There are " + std::to_string(m_timestreams.at(entity).count()) + " messages.");
+                // check if data is available internally to avoid lock juggling
+                if (!is_data_available(entity, currentCoherency)) return false;
+                //PLEEPLOG_DEBUG("Popping for entity: " + std::to_string(entity) + " on coherency: " + std::to_string(currentCoherency) + ". There are " + std::to_string(m_timestreams.at(entity).count()) + " messages.");
 
-            // breakpoint may still prevent the "avaiable" data from being popped
-            return m_timestreams.at(entity).pop_front(dest);
+                // breakpoint may still prevent the "avaiable" data from being popped
+                if (!m_timestreams.at(entity).pop_front(dest)) return false;
+            }
+            // dest is ours now, don't hold the lock while decompressing
+            decompress_cold(dest);
+            return true;
         }
         bool pop_from_timestream_at_breakpoint(Entity entity, uint16_t currentCoherency, EventMessage& dest)
         {
-            const std::lock_guard<std::mutex> lk(m_mapMux);
-            
-            // check if data is available internally to avoid lock juggling
-            if (!is_data_available_at_breakpoint(entity, currentCoherency)) return false;
+            {
+                const std::lock_guard<std::mutex> lk(m_mapMux);
+
+                // check if data is available internally to avoid lock juggling
+                if (!is_data_available_at_breakpoint(entity, currentCoherency)) return false;
 
-            return m_timestreams.at(entity).pop_at_breakpoint(dest);
+                if (!m_timestreams.at(entity).pop_at_breakpoint(dest)) return false;
+            }
+            decompress_cold(dest);
+            return true;
         }
 
         // Clear timestream for specified Entity
@@ -199,6 +257,42 @@ namespace pleep
         }
 
     private:
+        // push msg as is, m_mapMux must be held
+        void push_locked(Entity entity, const EventMessage& msg)
+        {
+            if (m_areBreakpointsActive && m_timestreams.count(entity) == 0)
+            {
+                // create and set breakpoint for new timestream
+                m_timestreams[entity].set_breakpoint_at_begin();
+            }
+            // operator[] emplaces with default constructor for TsBreakpointQueue
+            m_timestreams[entity].push_back(msg);
+        }
+
+        // cold messages keep their header (with header.size of the raw body) but store a compressed body,
+        // so a body smaller than header.size means it is compressed
+        static EventMessage compress_cold(const EventMessage& msg)
+        {
+            EventMessage cold;
+            cold.header = msg.header;
+            cold.header.size = static_cast<uint32_t>(msg.body.size());
+            if (!get_timestream_compression().compress(msg.body.data(), msg.body.size(), cold.body)) return msg;
+            return cold;
+        }
+        // THROWS runtime_error if a compressed body is corrupt
+        static void decompress_cold(EventMessage& msg)
+        {
+            if (msg.body.size() >= msg.header.size) return;
+
+            std::vector<uint8_t> raw(msg.header.size);
+            if (!get_timestream_compression().decompress(msg.body.data(), msg.body.size(), raw.data(), raw.size()))
+            {
+                PLEEPLOG_ERROR("Timestream message for event " + std::to_string(msg.header.id) + " failed to decompress");
+                throw std::runtime_error("EntityTimestreamMap popped a corrupt compressed message");
+            }
+            msg.body = std::move(raw);
+        }
+
         // check if timestream exists for an entity, if it is non-empty,
         // and if the front value has a coherency <= currentCoherency
         // without holding the lock
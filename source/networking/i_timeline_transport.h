@@ -0,0 +1,62 @@
+#ifndef I_TIMELINE_TRANSPORT_H
+#define I_TIMELINE_TRANSPORT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "networking/entity_timestream_map.h"
+#include "events/event_types.h"
+#include "core/cosmos.h"
+
+namespace pleep
+{
+    // How a single timeslice's TimelineApi reaches the rest of the timeline
+    // (other timeslices' message queues, past/future timestreams, and parallel)
+    // TimelineApi owns one per instance and passes these calls straight through
+    class I_TimelineTransport
+    {
+    public:
+        virtual ~I_TimelineTransport() = default;
+
+        // total number of timeslices in the timeline (ids SHOULD start from 0)
+        virtual size_t get_num_timeslices() = 0;
+
+        // ***** Multiplex *****
+
+        virtual bool send_message(TimesliceId id, const EventMessage& data) = 0;
+        // Send identical message to all OTHER timeslices
+        virtual bool broadcast_message(const EventMessage& data) = 0;
+        virtual bool is_message_available() = 0;
+        // returns false if nothing was available at time of call
+        virtual bool pop_message(EventMessage& dest) = 0;
+
+        // ***** Timestreams *****
+
+        virtual bool has_future() = 0;
+        virtual bool has_past() = 0;
+        virtual void push_past_timestream(Entity entity, const EventMessage& data) = 0;
+        virtual std::vector<Entity> get_entities_with_future_streams() = 0;
+        virtual bool pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest) = 0;
+        // (for checkpoints) everything in our future timestream as stored, and putting it back
+        virtual void copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest) = 0;
+        virtual void restore_future_timestream(Entity entity, const EventMessage& stored) = 0;
+
+        // (for parallel to use breakpoint functions)
+        virtual void link_timestreams(std::shared_ptr<EntityTimestreamMap> sourceTimestreams) = 0;
+        virtual void push_timestream_at_breakpoint(Entity entity, const EventMessage& data) = 0;
+        virtual bool pop_timestream_at_breakpoint(Entity entity, uint16_t coherency, EventMessage& dest) = 0;
+
+        // ***** Parallel Context *****
+
+        virtual void parallel_notify_divergence() = 0;
+        virtual bool parallel_load_and_link(const std::shared_ptr<Cosmos> sourceCosmos) = 0;
+        virtual void parallel_retarget(uint16_t newTarget) = 0;
+        virtual bool parallel_start() = 0;
+        virtual TimesliceId parallel_get_timeslice() = 0;
+        virtual bool parallel_extract(std::shared_ptr<Cosmos> dstCosmos) = 0;
+    };
+}
+
+#endif // I_TIMELINE_TRANSPORT_H
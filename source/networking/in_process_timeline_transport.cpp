@@ -0,0 +1,214 @@
+#include "in_process_timeline_transport.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "logging/pleep_log.h"
+#include "spacetime/parallel_cosmos_context.h"
+
+namespace pleep
+{
+    InProcessTimelineTransport::InProcessTimelineTransport(TimesliceId id,
+            std::shared_ptr<Multiplex> sharedMultiplex,
+            std::shared_ptr<EntityTimestreamMap> pastTimestreams,
+            std::shared_ptr<EntityTimestreamMap> futureTimestreams,
+            std::shared_ptr<ParallelCosmosContext> parallelContext)
+        : m_timesliceId(id)
+        , m_multiplex(sharedMultiplex)
+        , m_futureTimestreams(futureTimestreams)
+        , m_pastTimestreams(pastTimestreams)
+        , m_sharedParallel(parallelContext)
+    {
+        if (id != NULL_TIMESLICEID && m_multiplex->find(id) == m_multiplex->end())
+        {
+            std::string errMsg = ("InProcessTimelineTransport was constructed with an id (" + std::to_string(id) + ") which does not exist in the provided Multiplex");
+            PLEEPLOG_ERROR(errMsg);
+            throw std::range_error(errMsg);
+        }
+    }
+
+    size_t InProcessTimelineTransport::get_num_timeslices()
+    {
+        return m_multiplex->size();
+    }
+
+    bool InProcessTimelineTransport::send_message(TimesliceId id, const EventMessage& data)
+    {
+        // sending to my own id is ok, because we can re-use the same logic on receiving
+        auto outgoingQueueIt = m_multiplex->find(id);
+        if (outgoingQueueIt == m_multiplex->end())
+        {
+            PLEEPLOG_WARN("Trying to send data to non-existent id (" + std::to_string(id) + "). Only " + std::to_string(get_num_timeslices()) + " total ids exist.");
+            return false;
+        }
+
+        outgoingQueueIt->second.push_back(data);
+        return true;
+    }
+
+    bool InProcessTimelineTransport::broadcast_message(const EventMessage& data)
+    {
+        for (auto& msgQ : *m_multiplex)
+        {
+            if (msgQ.first == m_timesliceId) continue;
+
+            msgQ.second.push_back(data);
+        }
+        // is there any "false" condition?
+        return true;
+    }
+
+    bool InProcessTimelineTransport::is_message_available()
+    {
+        return !(m_multiplex->at(m_timesliceId).empty());
+    }
+
+    bool InProcessTimelineTransport::pop_message(EventMessage& dest)
+    {
+        // MUST ONLY POP FROM m_timesliceId
+        return m_multiplex->at(m_timesliceId).pop_front(dest);
+    }
+
+    bool InProcessTimelineTransport::has_future()
+    {
+        return m_futureTimestreams != nullptr;
+    }
+
+    bool InProcessTimelineTransport::has_past()
+    {
+        return m_pastTimestreams != nullptr;
+    }
+
+    void InProcessTimelineTransport::push_past_timestream(Entity entity, const EventMessage& data)
+    {
+        if (!m_pastTimestreams)
+        {
+            PLEEPLOG_WARN("This timeslice has no past timestream to push to");
+            return;
+        }
+        m_pastTimestreams->push_to_timestream(entity, data);
+    }
+
+    std::vector<Entity> InProcessTimelineTransport::get_entities_with_future_streams()
+    {
+        if (!m_futureTimestreams)
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream at all!");
+            return std::vector<Entity>{};
+        }
+
+        return m_futureTimestreams->get_entities_with_streams();
+    }
+
+    bool InProcessTimelineTransport::pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest)
+    {
+        if (!m_futureTimestreams)
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream to pop from");
+            return false;
+        }
+        return m_futureTimestreams->pop_from_timestream(entity, coherency, dest);
+    }
+
+    void InProcessTimelineTransport::copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest)
+    {
+        if (!m_futureTimestreams) return;
+        m_futureTimestreams->copy_timestreams(dest);
+    }
+
+    void InProcessTimelineTransport::restore_future_timestream(Entity entity, const EventMessage& stored)
+    {
+        if (!m_futureTimestreams)
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream to restore to");
+            return;
+        }
+        m_futureTimestreams->restore_to_timestream(entity, stored);
+    }
+
+    void InProcessTimelineTransport::link_timestreams(std::shared_ptr<EntityTimestreamMap> sourceTimestreams)
+    {
+        // clear breakpoints of old streams which we linked to
+        if (m_futureTimestreams) m_futureTimestreams->remove_breakpoints();
+        if (m_pastTimestreams) m_pastTimestreams->remove_breakpoints();
+
+        // set breakpoint to start
+        if (sourceTimestreams) sourceTimestreams->set_breakpoints();
+
+        // do both so that has_past and has_future work as expected
+        m_futureTimestreams = sourceTimestreams;
+        m_pastTimestreams = sourceTimestreams;
+    }
+
+    void InProcessTimelineTransport::push_timestream_at_breakpoint(Entity entity, const EventMessage& data)
+    {
+        if (!m_pastTimestreams)
+        {
+            PLEEPLOG_WARN("This timeslice has no past timestream to push to");
+            return;
+        }
+        m_pastTimestreams->push_to_timestream_at_breakpoint(entity, data);
+    }
+
+    bool InProcessTimelineTransport::pop_timestream_at_breakpoint(Entity entity, uint16_t coherency, EventMessage& dest)
+    {
+        // use the "future" timestream
+        if (!m_futureTimestreams)
+        {
+            PLEEPLOG_WARN("This timeslice has no future timestream to pop from");
+            return false;
+        }
+        return m_futureTimestreams->pop_from_timestream_at_breakpoint(entity, coherency, dest);
+    }
+
+    void InProcessTimelineTransport::parallel_notify_divergence()
+    {
+        if (m_sharedParallel == nullptr) return;
+        m_sharedParallel->request_resolution(m_timesliceId);
+    }
+
+    bool InProcessTimelineTransport::parallel_load_and_link(const std::shared_ptr<Cosmos> sourceCosmos)
+    {
+        if (m_sharedParallel == nullptr) return true;
+        // parallel should stop us if it is already running for some reason
+
+        PLEEPLOG_TRACE("Initing parallel cosmos");
+
+        // deep copy cosmos and timestream into parallel
+        return m_sharedParallel->load_and_link(sourceCosmos, m_futureTimestreams);
+    }
+
+    void InProcessTimelineTransport::parallel_retarget(uint16_t newTarget)
+    {
+        if (m_sharedParallel == nullptr) return;
+        m_sharedParallel->set_coherency_target(newTarget);
+    }
+
+    bool InProcessTimelineTransport::parallel_start()
+    {
+        if (m_sharedParallel == nullptr) return false;
+
+        // try restart thread only if it had stopped
+        if (m_sharedParallel->is_running())
+        {
+            PLEEPLOG_WARN("Called to start parallel while it is already running... ignoring.");
+            return false;
+        }
+        PLEEPLOG_DEBUG("Restarting parallel...");
+        // start() is idempotent if already running
+        m_sharedParallel->start();
+        return true;
+    }
+
+    TimesliceId InProcessTimelineTransport::parallel_get_timeslice()
+    {
+        if (m_sharedParallel == nullptr) return NULL_TIMESLICEID;
+        return m_sharedParallel->get_current_timeslice();
+    }
+
+    bool InProcessTimelineTransport::parallel_extract(std::shared_ptr<Cosmos> dstCosmos)
+    {
+        if (m_sharedParallel == nullptr) return false;
+        return m_sharedParallel->extract_entity_updates(dstCosmos);
+    }
+}
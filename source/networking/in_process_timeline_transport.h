@@ -0,0 +1,93 @@
+#ifndef IN_PROCESS_TIMELINE_TRANSPORT_H
+#define IN_PROCESS_TIMELINE_TRANSPORT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <unordered_map>
+#include <cassert>
+
+#include "networking/i_timeline_transport.h"
+#include "networking/ts_deque.h"
+
+namespace pleep
+{
+    // We need a pointer to the parallel context
+    // but the parallel context needs to have its own TimelineApi
+    // so a foreward declaration is unfortunate, but needed
+    class ParallelCosmosContext;
+
+    // All timeslices are threads of the same process,
+    // so queues and timestreams are simply shared in memory
+    class InProcessTimelineTransport : public I_TimelineTransport
+    {
+    public:
+        // Should queue type contain the source id? Otherwise it has to be built into message manually
+        // Hard-code message type to use EventId (to avoid template cascading)
+        using Multiplex = std::unordered_map<TimesliceId, TsDeque<Message<EventId>>>;
+
+        // id indexes into sharedMultiplex (NULL_TIMESLICEID is allowed for parallel)
+        InProcessTimelineTransport(TimesliceId id,
+                                   std::shared_ptr<Multiplex> sharedMultiplex,
+                                   std::shared_ptr<EntityTimestreamMap> pastTimestreams = nullptr,
+                                   std::shared_ptr<EntityTimestreamMap> futureTimestreams = nullptr,
+                                   std::shared_ptr<ParallelCosmosContext> parallelContext = nullptr);
+
+        size_t get_num_timeslices() override;
+
+        bool send_message(TimesliceId id, const EventMessage& data) override;
+        bool broadcast_message(const EventMessage& data) override;
+        bool is_message_available() override;
+        bool pop_message(EventMessage& dest) override;
+
+        bool has_future() override;
+        bool has_past() override;
+        void push_past_timestream(Entity entity, const EventMessage& data) override;
+        std::vector<Entity> get_entities_with_future_streams() override;
+        bool pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest) override;
+        void copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest) override;
+        void restore_future_timestream(Entity entity, const EventMessage& stored) override;
+
+        void link_timestreams(std::shared_ptr<EntityTimestreamMap> sourceTimestreams) override;
+        void push_timestream_at_breakpoint(Entity entity, const EventMessage& data) override;
+        bool pop_timestream_at_breakpoint(Entity entity, uint16_t coherency, EventMessage& dest) override;
+
+        void parallel_notify_divergence() override;
+        bool parallel_load_and_link(const std::shared_ptr<Cosmos> sourceCosmos) override;
+        void parallel_retarget(uint16_t newTarget) override;
+        bool parallel_start() override;
+        TimesliceId parallel_get_timeslice() override;
+        bool parallel_extract(std::shared_ptr<Cosmos> dstCosmos) override;
+
+    private:
+        TimesliceId m_timesliceId;
+
+        // Direct message multiplex shared with all other timeslices
+        std::shared_ptr<Multiplex> m_multiplex;
+
+        // timestream queues shared with timeslices ahead and behind in the timeline
+        // future-most timeslice will have no future, past-most timelice will have no past
+        std::shared_ptr<EntityTimestreamMap> m_futureTimestreams;
+        std::shared_ptr<EntityTimestreamMap> m_pastTimestreams;
+
+        // Access to shared ParallelContext
+        std::shared_ptr<ParallelCosmosContext> m_sharedParallel;
+    };
+
+    // return a multiplex map with empty queues for ids 0 to (numUsers - 1)
+    // this should be passed to each InProcessTimelineTransport, along with each unique id
+    inline std::shared_ptr<InProcessTimelineTransport::Multiplex> generate_timeline_multiplex(TimesliceId numUsers)
+    {
+        assert(numUsers < TIMESLICEID_SIZE);
+
+        std::shared_ptr<InProcessTimelineTransport::Multiplex> multiplex = std::make_shared<InProcessTimelineTransport::Multiplex>();
+        for (TimesliceId i = 0; i < numUsers; i++)
+        {
+            // emplace with default constructor for TsDeque
+            multiplex->operator[](i);
+        }
+
+        return multiplex;
+    }
+}
+
+#endif // IN_PROCESS_TIMELINE_TRANSPORT_H
@@ -6,6 +6,9 @@
 #define _WIN32_WINNT 0x0A00
 #endif
 #define ASIO_STANDALONE
+#include <atomic>
+#include <array>
+#include <cstring>
 #include <asio.hpp>
 #include <asio/ts/buffer.hpp>
 #include <asio/ts/internet.hpp>
@@ -14,9 +17,14 @@
 #include "networking/net_message.h"
 #include "networking/net_i_server.h"
 #include "networking/pleep_crypto.h"
+#include "networking/block_compression.h"
 
 // Max number of bytes in a message header size before we consider it corrupt
 #define CORRUPT_MESSAGE_BYTES_THRESHOLD 65536
+// Queued messages are batched into one frame until it reaches this many (uncompressed) bytes
+#define NET_FRAME_TARGET_BYTES 16384
+// Max uncompressed bytes in a frame before we consider it corrupt (target plus one maximum message)
+#define CORRUPT_FRAME_BYTES_THRESHOLD (NET_FRAME_TARGET_BYTES + CORRUPT_MESSAGE_BYTES_THRESHOLD + 4096)
 
 namespace pleep
 {
@@ -26,15 +34,29 @@ namespace net
     // How do we access methods with only a foreward declaration? templates?
     template<typename T_Msg>
     class I_Server;
+    template<typename T_Msg>
+    class DatagramChannel;
+
+    // Prepended to each batch of messages written to the stream
+    // Frame body is back to back MessageHeaders and bodies, block compressed if wireSize < rawSize
+    struct FrameHeader
+    {
+        uint32_t rawSize = 0;
+        uint32_t wireSize = 0;
+    };
 
     // For outgoing (client) connections: Fresh socket is given to Connection and connect_to_remote establishes communication with remote endpoint.
-    //     Internally: connect_to_remote() -> start_communication() -> _riposte_validation() -> _read_header() (and loop indefinately on _read_header() -> (optionally _read_body()) -> _add_scratch_to_incoming() -> repeat)
+    //     Internally: connect_to_remote() -> start_communication() -> _riposte_validation() -> _read_frame_header() (and loop indefinately on _read_frame_header() -> (optionally _read_frame_body()) -> _add_frame_to_incoming() -> repeat)
     //
     // For incoming (server) connections, a pre-established (asio acceptor) socket is given and start_communication(server) validates communication with the accepted remote endpoint.
-    //     Internally: start_communication() -> _initiate_validation() -> _reprise_validation -> _read_header() (and loop indefinately on _read_header() -> (optionally _read_body()) -> _add_scratch_to_incoming() -> repeat)
+    //     Internally: start_communication() -> _initiate_validation() -> _reprise_validation -> _read_frame_header() (and loop indefinately on _read_frame_header() -> (optionally _read_frame_body()) -> _add_frame_to_incoming() -> repeat)
     //
     // Both connections can send() message data to write data across the connection
-    //     Internally: send() -> _write_header() -> (optionally _write_body())
+    //     Internally: send() -> _queue_outgoing() -> _write_frame() (and loop until no messages are queued)
+    //     Messages queued while a frame is being written are batched into the next frame
+    //
+    // If the owner attached a DatagramChannel, after validation the Connection is associated with a udp endpoint
+    //     and send_unreliable() sends through the channel instead (falling back to send() until then)
     template<typename T_Msg>
     class Connection : public std::enable_shared_from_this<Connection<T_Msg>>
     {
@@ -65,12 +87,12 @@ namespace net
                 if (callback_server != nullptr)
                 {
                     // validation chain will use callback's on_remote_validated,
-                    // and start _read_header() on success
+                    // and start _read_frame_header() on success
                     this->_initiate_validation(callback_server);
                 }
                 else // (no callback_server)
                 {
-                    // validation chain will start _read_header() on success
+                    // validation chain will start _read_frame_header() on success
                     this->_riposte_validation();
                 }
             }
@@ -134,7 +156,7 @@ namespace net
             return m_socket.remote_endpoint();
         }
 
-        // Append msg into to-write message queue and proceed to _write_header
+        // Append msg into to-write message queue and proceed to _write_frame
         // does not return if message was not sent (or failed during async methods)
         void send(const Message<T_Msg>& msg)
         {
@@ -148,13 +170,29 @@ namespace net
                 m_asioContext,
                 [this, msg]()
                 {
-                    // if new size > 1, messages were already being written
-                    size_t newSize = m_outgoingMessages.push_back(msg);
+                    this->_queue_outgoing(msg);
+                }
+            );
+        }
 
-                    // prime for writing if not already
-                    if (newSize == 1)
+        // Send msg where loss is acceptable because a newer message will replace it
+        // Messages with the same supersedeKey are only received in order (older ones arriving late are dropped)
+        // Uses the reliable stream if no datagram channel is associated (yet) or msg is too large
+        void send_unreliable(const Message<T_Msg>& msg, uint64_t supersedeKey)
+        {
+            if (!this->is_ready())
+            {
+                PLEEPLOG_WARN("Cannot send message, Connection is not ready (yet?).");
+                return;
+            }
+            asio::post(
+                m_asioContext,
+                [this, msg, supersedeKey]()
+                {
+                    if (!m_datagramAssociated
+                        || !m_datagramChannel->send(m_datagramEndpoint, this->get_handshake_token(), msg, supersedeKey))
                     {
-                        this->_write_header();
+                        this->_queue_outgoing(msg);
                     }
                 }
             );
@@ -169,40 +207,67 @@ namespace net
             m_isSendable = true;
         }
 
+        // owner's channel to associate with after validation
+        void set_datagram_channel(std::shared_ptr<DatagramChannel<T_Msg>> channel)
+        {
+            m_datagramChannel = channel;
+        }
+
+        // called by DatagramChannel (on asio thread) once remote's udp endpoint is known
+        void associate_datagrams(std::shared_ptr<DatagramChannel<T_Msg>> channel, const asio::ip::udp::endpoint& endpoint)
+        {
+            m_datagramChannel = channel;
+            m_datagramEndpoint = endpoint;
+            m_datagramAssociated = true;
+        }
+
+        // report if send_unreliable will actually use datagrams
+        bool is_datagram_associated() const
+        {
+            return m_datagramAssociated;
+        }
+
+        // shared secret identifying this connection on the datagram channel
+        uint32_t get_handshake_token() const
+        {
+            return m_handshakePlaintext;
+        }
+        uint32_t get_handshake_checksum() const
+        {
+            return pleep::Squirrel3(m_handshakePlaintext);
+        }
+
     private:
         ////////////////////////////// READ MESSAGES //////////////////////////////
 
-        // ASYNC - start task to read fixed header.
-        // fill m_scratchMessage with type and body size
-        // proceed to _read_body if header indicates non-zero body size
-        // or proceed to _add_scratch_to_incoming with body-less message
-        void _read_header()
+        // ASYNC - start task to read fixed frame header.
+        // proceed to _read_frame_body if header indicates non-zero body size
+        void _read_frame_header()
         {
             asio::async_read(
                 m_socket, 
-                asio::buffer(&m_scratchMessage.header, sizeof(MessageHeader<T_Msg>)),
+                asio::buffer(&m_scratchFrameHeader, sizeof(FrameHeader)),
                 [this](std::error_code ec, std::size_t length)
                 {
                     UNREFERENCED_PARAMETER(length);
                     if (!ec)
                     {
-                        if (m_scratchMessage.header.size > CORRUPT_MESSAGE_BYTES_THRESHOLD)
+                        if (m_scratchFrameHeader.rawSize > CORRUPT_FRAME_BYTES_THRESHOLD
+                            || m_scratchFrameHeader.wireSize > m_scratchFrameHeader.rawSize)
                         {
-                            // TODO: Should we ignore the message, assuming its body size is not real? Worst case it is real and we then read in a bunch of garbage.
-                            // or should we try to read the data and just dump it? Worst case it isn't real and we are essentially ddosed while reading 113849273 bytes
-                            PLEEPLOG_WARN("Message header size " + std::to_string(m_scratchMessage.header.size) + ", greater than corrupt threshold " + std::to_string(CORRUPT_MESSAGE_BYTES_THRESHOLD) + ". Ignoring...");
-                            this->_read_header();
+                            // unlike a single message we can't skip a frame without trusting its size, so the stream is lost
+                            PLEEPLOG_ERROR("Frame header sizes " + std::to_string(m_scratchFrameHeader.wireSize) + "/" + std::to_string(m_scratchFrameHeader.rawSize) + " are corrupt. Closing connection.");
+                            m_socket.close();
                         }
-                        else if (m_scratchMessage.header.size > 0)
+                        else if (m_scratchFrameHeader.wireSize > 0)
                         {
-                            // get message size from header and prime asio to read body content
-                            m_scratchMessage.body.resize(m_scratchMessage.header.size);
-                            this->_read_body();
+                            m_scratchFrame.resize(m_scratchFrameHeader.wireSize);
+                            this->_read_frame_body();
                         }
-                        // no body to read so add scratch message
+                        // empty frame
                         else
                         {
-                            this->_add_scratch_to_incoming();
+                            this->_read_frame_header();
                         }
                     }
                     else
@@ -215,21 +280,21 @@ namespace net
             );
         }
 
-        // ASYNC - start task to read message body
-        // dynamic size passed through m_scratchMessage
-        // proceed to _add_scratch_to_incoming
-        void _read_body()
+        // ASYNC - start task to read frame body
+        // dynamic size passed through m_scratchFrame
+        // proceed to _add_frame_to_incoming
+        void _read_frame_body()
         {
             asio::async_read(
                 m_socket, 
-                asio::buffer(m_scratchMessage.body.data(), m_scratchMessage.body.size()),
+                asio::buffer(m_scratchFrame.data(), m_scratchFrame.size()),
                 [this](std::error_code ec, std::size_t length)
                 {
                     UNREFERENCED_PARAMETER(length);
                     if (!ec)
                     {
-                        // body is read, now add to queue
-                        this->_add_scratch_to_incoming();
+                        // body is read, now add its messages to queue
+                        this->_add_frame_to_incoming();
                     }
                     else
                     {
@@ -241,89 +306,123 @@ namespace net
             );
         }
 
-        // push finished "read" message to queue available for app
-        // "recurse" to _read_header
-        void _add_scratch_to_incoming()
+        // decompress m_scratchFrame (if needed), push each message in it to queue available for app
+        // "recurse" to _read_frame_header
+        void _add_frame_to_incoming()
         {
-            // clients only have 1 Connection, so they dont need to know shared_from_this,
-            // but to keep behaviour ambiguous to client or server we have to store it for server
-            // does maintaining all the shared counts unnecessarily cost too much?
-            m_incomingMessages.push_back({ this->shared_from_this(), m_scratchMessage });
+            const std::vector<uint8_t>* frame = &m_scratchFrame;
+            if (m_scratchFrameHeader.wireSize < m_scratchFrameHeader.rawSize)
+            {
+                m_scratchRawFrame.resize(m_scratchFrameHeader.rawSize);
+                if (!get_network_compression().decompress(m_scratchFrame.data(), m_scratchFrame.size(), m_scratchRawFrame.data(), m_scratchRawFrame.size()))
+                {
+                    PLEEPLOG_ERROR("Frame failed to decompress. Closing connection.");
+                    m_socket.close();
+                    return;
+                }
+                frame = &m_scratchRawFrame;
+            }
 
-            // clear scratch?
-            // body will be resized (potentially to 0) on next header read
+            // frame is back to back MessageHeaders and bodies
+            size_t offset = 0;
+            while (offset < frame->size())
+            {
+                if (frame->size() - offset < sizeof(MessageHeader<T_Msg>))
+                {
+                    PLEEPLOG_ERROR("Frame ended partway through a message header. Closing connection.");
+                    m_socket.close();
+                    return;
+                }
+                std::memcpy(&m_scratchMessage.header, frame->data() + offset, sizeof(MessageHeader<T_Msg>));
+                offset += sizeof(MessageHeader<T_Msg>);
 
-            // prime to read next message
-            this->_read_header();
+                if (frame->size() - offset < m_scratchMessage.header.size)
+                {
+                    PLEEPLOG_ERROR("Message header size " + std::to_string(m_scratchMessage.header.size) + " overruns its frame. Closing connection.");
+                    m_socket.close();
+                    return;
+                }
+                m_scratchMessage.body.assign(frame->begin() + offset, frame->begin() + offset + m_scratchMessage.header.size);
+                offset += m_scratchMessage.header.size;
+
+                // clients only have 1 Connection, so they dont need to know shared_from_this,
+                // but to keep behaviour ambiguous to client or server we have to store it for server
+                // does maintaining all the shared counts unnecessarily cost too much?
+                m_incomingMessages.push_back({ this->shared_from_this(), m_scratchMessage });
+            }
+
+            // prime to read next frame
+            this->_read_frame_header();
         }
-        
-        ////////////////////////////// WRITE MESSAGES //////////////////////////////
 
-        // ASYNC - start task to write message header from front of to-write message queue
-        // proceed to _write_body if non-zero message body
-        // or pop message and "recurse" to _write_header if no message body AND to-write message queue is non-empty
-        void _write_header()
+        // push msg to to-write message queue (on asio thread)
+        // proceed to _write_frame if not already writing
+        void _queue_outgoing(const Message<T_Msg>& msg)
         {
-            asio::async_write(
-                m_socket, 
-                asio::buffer(&m_outgoingMessages.front().header, sizeof(MessageHeader<T_Msg>)),
-                [this](std::error_code ec, std::size_t length)
-                {
-                    UNREFERENCED_PARAMETER(length);
-                    if (!ec)
-                    {
-                        if (m_outgoingMessages.front().body.size() > 0)
-                        {
-                            this->_write_body();
-                        }
-                        // no body to write, so clear message
-                        else
-                        {
-                            Message<T_Msg> popped;
-                            m_outgoingMessages.pop_front(popped);
+            if (msg.body.size() > CORRUPT_MESSAGE_BYTES_THRESHOLD)
+            {
+                PLEEPLOG_WARN("Message size " + std::to_string(msg.body.size()) + ", greater than corrupt threshold " + std::to_string(CORRUPT_MESSAGE_BYTES_THRESHOLD) + ". Not sending.");
+                return;
+            }
 
-                            // prime next write
-                            if (m_outgoingMessages.count() > 0)
-                            {
-                                this->_write_header();
-                            }
-                        }
-                    }
-                    else
-                    {
-                        PLEEPLOG_ERROR("Asio error: " + ec.message());
-                        // on error close socket to that server/client will cleanup
-                        m_socket.close();
-                    }
-                }
-            );
+            m_outgoingMessages.push_back(msg);
+
+            // prime for writing if not already
+            if (!m_isWriting)
+            {
+                this->_write_frame();
+            }
         }
+        
+        ////////////////////////////// WRITE MESSAGES //////////////////////////////
 
-        // ASYNC - start task to write message body from  front of to-write message queue
-        // pop message and "recurse" to _write_header if to-write message queue is non-empty
-        void _write_body()
+        // ASYNC - batch messages from front of to-write message queue into one frame,
+        // compress it if large enough, and start task to write it
+        // "recurse" to _write_frame until to-write message queue is empty
+        void _write_frame()
         {
+            m_isWriting = m_outgoingMessages.count() > 0;
+            if (!m_isWriting) return;
+
+            m_outgoingFrame.clear();
+            Message<T_Msg> msg;
+            while (m_outgoingFrame.size() < NET_FRAME_TARGET_BYTES && m_outgoingMessages.pop_front(msg))
+            {
+                // body size is what the remote uses to split the frame
+                msg.header.size = static_cast<uint32_t>(msg.body.size());
+                const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&msg.header);
+                m_outgoingFrame.insert(m_outgoingFrame.end(), headerBytes, headerBytes + sizeof(MessageHeader<T_Msg>));
+                m_outgoingFrame.insert(m_outgoingFrame.end(), msg.body.begin(), msg.body.end());
+            }
+
+            m_outgoingFrameHeader.rawSize = static_cast<uint32_t>(m_outgoingFrame.size());
+            const std::vector<uint8_t>* wireFrame = &m_outgoingFrame;
+            if (get_network_compression().compress(m_outgoingFrame.data(), m_outgoingFrame.size(), m_outgoingCompressedFrame))
+            {
+                wireFrame = &m_outgoingCompressedFrame;
+            }
+            m_outgoingFrameHeader.wireSize = static_cast<uint32_t>(wireFrame->size());
+
+            const std::array<asio::const_buffer, 2> buffers = {
+                asio::buffer(&m_outgoingFrameHeader, sizeof(FrameHeader)),
+                asio::buffer(wireFrame->data(), wireFrame->size())
+            };
             asio::async_write(
                 m_socket, 
-                asio::buffer(m_outgoingMessages.front().body.data(), m_outgoingMessages.front().body.size()),
+                buffers,
                 [this](std::error_code ec, std::size_t length)
                 {
                     UNREFERENCED_PARAMETER(length);
                     if (!ec)
                     {
-                        // body is written, prime for next write
-                        Message<T_Msg> popped;
-                        m_outgoingMessages.pop_front(popped);
-
-                        if (m_outgoingMessages.count() > 0)
-                        {
-                            this->_write_header();
-                        }
+                        // prime next write
+                        this->_write_frame();
                     }
                     else
                     {
                         PLEEPLOG_ERROR("Asio error: " + ec.message());
                         // on error close socket to that server/client will cleanup
+                        m_isWriting = false;
                         m_socket.close();
                     }
                 }
@@ -365,7 +464,7 @@ namespace net
             );
         }
         // ASYNC - start task to wait for remote's data from _initiate_validation()
-        // respond and proceed to _read_header() loop
+        // respond and proceed to _read_frame_header() loop
         void _riposte_validation()
         {
             asio::async_read(
@@ -390,8 +489,16 @@ namespace net
                                 {
                                     // after sending validation, wait for app level messages
                                     // (read header loop)
-                                    this->_read_header();
+                                    this->_read_frame_header();
                                     m_handshakeSuccess = true;
+
+                                    // server's datagram port matches its tcp port
+                                    std::error_code endpointError;
+                                    const asio::ip::tcp::endpoint remote = m_socket.remote_endpoint(endpointError);
+                                    if (m_datagramChannel && !endpointError)
+                                    {
+                                        m_datagramChannel->begin_association(this->shared_from_this(), asio::ip::udp::endpoint(remote.address(), remote.port()));
+                                    }
                                 }
                                 else
                                 {
@@ -412,7 +519,7 @@ namespace net
             );
         }
         // ASYNC - start task to wait for remote's checksum from _riposte_validation()
-        // send acknowledge and proceed to _read_header loop
+        // send acknowledge and proceed to _read_frame_header loop
         void _reprise_validation(I_Server<T_Msg>* callback_server)
         {
             assert(callback_server != nullptr);
@@ -430,12 +537,15 @@ namespace net
                         {
                             m_handshakeSuccess = true;
 
+                            // client may now say hello on the datagram channel
+                            if (m_datagramChannel) m_datagramChannel->expect_peer(this->shared_from_this());
+
                             callback_server->on_remote_validated(this->shared_from_this());
                             // app level can now send version/config data and client can
                             // voulentarily disconnect from mismatch
 
                             // go to read header loop
-                            this->_read_header();
+                            this->_read_frame_header();
                         }
                         else
                         {
@@ -467,9 +577,18 @@ namespace net
         // Reference to Connection OWNER's queue of Messages recieved
         // thus servers can have multiple Connections all push to 1 queue
         TsDeque<OwnedMessage<T_Msg>>& m_incomingMessages;
-        // Storage for building incoming message
+        // Storage for building incoming frames and the messages in them
+        FrameHeader                   m_scratchFrameHeader;
+        std::vector<uint8_t>          m_scratchFrame;
+        std::vector<uint8_t>          m_scratchRawFrame;
         Message<T_Msg>                m_scratchMessage;
 
+        // Storage for the frame being written (only touched on asio thread)
+        FrameHeader                   m_outgoingFrameHeader;
+        std::vector<uint8_t>          m_outgoingFrame;
+        std::vector<uint8_t>          m_outgoingCompressedFrame;
+        bool m_isWriting = false;
+
         // unique id to distinguish multiple connections used by a server
         uint32_t m_id = 0;
 
@@ -480,6 +599,12 @@ namespace net
         uint32_t m_handshakePlaintext = 0;
         uint32_t m_handshakeChecksum = 0;
         bool m_handshakeSuccess = false;
+
+        // Optional connectionless channel (shared with other Connections of owner)
+        std::shared_ptr<DatagramChannel<T_Msg>> m_datagramChannel = nullptr;
+        asio::ip::udp::endpoint m_datagramEndpoint;
+        // set on asio thread, read by app thread
+        std::atomic<bool> m_datagramAssociated{ false };
     };
 }
 }
@@ -0,0 +1,586 @@
+#ifndef NET_DATAGRAM_CHANNEL_H
+#define NET_DATAGRAM_CHANNEL_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <cstring>
+
+#include "logging/pleep_log.h"
+#include "networking/ts_deque.h"
+#include "networking/net_message.h"
+#include "networking/net_connection.h"
+
+// Max bytes of one datagram (including DatagramHeader)
+// conservative for 1500 byte ethernet MTU after IP/UDP headers and any tunneling
+#define DATAGRAM_MAX_BYTES 1200
+// Messages needing more fragments than this are sent over tcp instead
+#define DATAGRAM_MAX_FRAGMENTS 64
+// Partially received messages kept per peer before the oldest is abandoned
+#define DATAGRAM_MAX_ASSEMBLIES 32
+// Client resends its hello this often until the server acknowledges
+#define DATAGRAM_HELLO_INTERVAL_MS 200
+#define DATAGRAM_HELLO_ATTEMPTS 25
+// Requested os buffer size, bursts of updates overflowing the default buffer are silently lost
+#define DATAGRAM_SOCKET_BUFFER_BYTES (1 << 20)
+// Peers of closed connections (and old supersede keys) are forgotten this often
+#define DATAGRAM_PRUNE_INTERVAL_MS 1000
+// Supersede keys with no message delivered within this many sequences of a peer's newest are forgotten
+// (far more than could still be in flight, and far less than the sequence wrap around)
+#define DATAGRAM_SEQUENCE_HORIZON (1U << 20)
+
+namespace pleep
+{
+namespace net
+{
+    // Prepended to every datagram
+    // Data datagrams carry one fragment of a serialized Message (MessageHeader then body)
+    struct DatagramHeader
+    {
+        // handshake plaintext of the tcp Connection this datagram belongs to
+        uint32_t token = 0;
+        // increases per message sent (per peer), for control datagrams: handshake checksum
+        uint32_t sequence = 0;
+        // only the newest message with the same key is delivered (eg. entity id)
+        uint64_t supersedeKey = 0;
+        uint16_t fragmentIndex = 0;
+        // 0 -> control datagram (hello from client, acknowledge from server)
+        uint16_t fragmentCount = 0;
+    };
+
+    // Connectionless channel shared by all Connections of a server (or the single Connection of a client)
+    // for traffic where only the newest state matters: a lost datagram is never resent,
+    // and a message older than the last one delivered with the same supersede key is dropped
+    // so one loss cannot block any other message (unlike the tcp stream)
+    // Connections associate by having the client send its tcp handshake token to the server's
+    // udp port (same number as the tcp port), until then Connection::send_unreliable uses tcp
+    // All methods besides set_simulated_conditions/get_stats must be called on the asio context thread
+    // (or while it is not running, eg. close)
+    // Pending handlers keep the channel alive, so owners may drop it with operations in flight
+    template<typename T_Msg>
+    class DatagramChannel : public std::enable_shared_from_this<DatagramChannel<T_Msg>>
+    {
+    public:
+        struct Stats
+        {
+            std::atomic<uint64_t> datagramsSent{ 0 };
+            std::atomic<uint64_t> datagramsReceived{ 0 };
+            // dropped by simulated conditions
+            std::atomic<uint64_t> datagramsDropped{ 0 };
+            std::atomic<uint64_t> messagesDelivered{ 0 };
+            // arrived (or completed) after a newer message with the same key
+            std::atomic<uint64_t> messagesSuperseded{ 0 };
+            // abandoned with fragments still missing
+            std::atomic<uint64_t> messagesIncomplete{ 0 };
+        };
+
+        // server: bind to port to receive hellos, client: port 0 for any
+        // THROWS asio system_error if socket cannot be bound
+        DatagramChannel(asio::io_context& asioContext, uint16_t port, TsDeque<OwnedMessage<T_Msg>>& inQ)
+            : m_asioContext(asioContext)
+            , m_socket(asioContext, asio::ip::udp::endpoint(asio::ip::udp::v4(), port))
+            , m_pruneTimer(asioContext)
+            , m_incomingMessages(inQ)
+        {
+            // os may clamp (or refuse) the size, which is not an error worth failing for
+            std::error_code ec;
+            m_socket.set_option(asio::socket_base::receive_buffer_size(DATAGRAM_SOCKET_BUFFER_BYTES), ec);
+            m_socket.set_option(asio::socket_base::send_buffer_size(DATAGRAM_SOCKET_BUFFER_BYTES), ec);
+        }
+        ~DatagramChannel()
+        {}
+
+        // ASYNC - start loop receiving datagrams (and pruning peers)
+        void start_receiving()
+        {
+            this->_read_datagram();
+            this->_wait_to_prune();
+        }
+
+        // cancel pending operations so their handlers release the channel when the context next runs
+        void close()
+        {
+            std::error_code ec;
+            m_socket.close(ec);
+            m_pruneTimer.cancel();
+        }
+
+        // stop tracking messages with supersedeKey (eg. its entity was removed)
+        // a late message with the key can then still be delivered, so only forget keys which won't be reused soon
+        void forget_key(uint64_t supersedeKey)
+        {
+            std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+            asio::post(m_asioContext, [self, supersedeKey]()
+            {
+                for (auto& peerIt : self->m_peers)
+                {
+                    Peer& peer = peerIt.second;
+                    peer.newestSequences.erase(supersedeKey);
+                    for (auto it = peer.assemblies.begin(); it != peer.assemblies.end();)
+                    {
+                        if (it->second.supersedeKey == supersedeKey) it = peer.assemblies.erase(it);
+                        else it++;
+                    }
+                }
+            });
+        }
+
+        // server: Connection passed validation, accept hellos using its token
+        void expect_peer(std::shared_ptr<Connection<T_Msg>> connection)
+        {
+            m_expectedPeers[connection->get_handshake_token()] = connection;
+        }
+
+        // client: Connection passed validation, say hello to server until it acknowledges
+        void begin_association(std::shared_ptr<Connection<T_Msg>> connection, const asio::ip::udp::endpoint& serverEndpoint)
+        {
+            Peer& peer = m_peers[serverEndpoint];
+            peer.connection = connection;
+            this->_send_hello(serverEndpoint, DATAGRAM_HELLO_ATTEMPTS);
+        }
+
+        // fragment and send msg to endpoint
+        // returns false if msg is too large (caller should use tcp)
+        bool send(const asio::ip::udp::endpoint& endpoint, uint32_t token, const Message<T_Msg>& msg, uint64_t supersedeKey)
+        {
+            const size_t chunkBytes = DATAGRAM_MAX_BYTES - sizeof(DatagramHeader);
+            const size_t messageBytes = sizeof(MessageHeader<T_Msg>) + msg.body.size();
+            const size_t fragmentCount = (messageBytes + chunkBytes - 1) / chunkBytes;
+            if (fragmentCount > DATAGRAM_MAX_FRAGMENTS) return false;
+
+            auto peerIt = m_peers.find(endpoint);
+            if (peerIt == m_peers.end()) return false;
+
+            DatagramHeader header;
+            header.token = token;
+            header.sequence = peerIt->second.nextSequence++;
+            header.supersedeKey = supersedeKey;
+            header.fragmentCount = static_cast<uint16_t>(fragmentCount);
+
+            for (size_t i = 0; i < fragmentCount; i++)
+            {
+                header.fragmentIndex = static_cast<uint16_t>(i);
+                const size_t begin = i * chunkBytes;
+                const size_t end = std::min(begin + chunkBytes, messageBytes);
+
+                std::shared_ptr<std::vector<uint8_t>> datagram = std::make_shared<std::vector<uint8_t>>(sizeof(DatagramHeader) + end - begin);
+                std::memcpy(datagram->data(), &header, sizeof(DatagramHeader));
+                uint8_t* dest = datagram->data() + sizeof(DatagramHeader);
+
+                // message is not contiguous, copy the parts of header/body this fragment spans
+                for (size_t byte = begin; byte < end; byte++)
+                {
+                    *(dest++) = byte < sizeof(MessageHeader<T_Msg>)
+                        ? reinterpret_cast<const uint8_t*>(&msg.header)[byte]
+                        : msg.body[byte - sizeof(MessageHeader<T_Msg>)];
+                }
+
+                this->_send_datagram(endpoint, datagram);
+            }
+            return true;
+        }
+
+        // Degrade outgoing datagrams to test behaviour over a poor network (on loopback)
+        // lossChance in [0,1], delay is added to every datagram sent
+        void set_simulated_conditions(float lossChance, std::chrono::milliseconds delay)
+        {
+            std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+            asio::post(m_asioContext, [self, lossChance, delay]()
+            {
+                self->m_simulatedLossChance = lossChance;
+                self->m_simulatedDelay = delay;
+            });
+        }
+
+        const Stats& get_stats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        // message waiting for the rest of its fragments
+        struct Assembly
+        {
+            uint64_t supersedeKey = 0;
+            uint16_t fragmentCount = 0;
+            uint16_t receivedCount = 0;
+            uint64_t receivedMask = 0;
+            std::vector<uint8_t> bytes;
+        };
+
+        // per remote endpoint sequencing state
+        struct Peer
+        {
+            std::weak_ptr<Connection<T_Msg>> connection;
+            uint32_t nextSequence = 1;
+            // supersede key -> sequence of last delivered message
+            std::unordered_map<uint64_t, uint32_t> newestSequences;
+            // newest sequence delivered under any key
+            uint32_t newestDelivered = 0;
+            // sequence -> partially received message
+            std::map<uint32_t, Assembly> assemblies;
+        };
+
+        // sequence a was sent after sequence b (accounting for wrap around)
+        static bool _sequence_newer(uint32_t a, uint32_t b)
+        {
+            return static_cast<int32_t>(a - b) > 0;
+        }
+
+        // ASYNC - start task to receive one datagram, then "recurse"
+        void _read_datagram()
+        {
+            // scratch buffer is written until the handler runs, even if owner has dropped the channel
+            std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+            m_socket.async_receive_from(
+                asio::buffer(m_scratchDatagram, DATAGRAM_MAX_BYTES),
+                m_scratchEndpoint,
+                [self](std::error_code ec, std::size_t length)
+                {
+                    if (!ec)
+                    {
+                        self->m_stats.datagramsReceived++;
+                        self->_handle_datagram(length);
+                    }
+                    else if (ec == asio::error::operation_aborted)
+                    {
+                        // socket closing
+                        return;
+                    }
+                    else
+                    {
+                        // udp errors (eg. icmp port unreachable) are not fatal to the socket
+                        PLEEPLOG_DEBUG("Asio datagram error: " + ec.message());
+                    }
+                    self->_read_datagram();
+                }
+            );
+        }
+
+        void _handle_datagram(size_t length)
+        {
+            if (length < sizeof(DatagramHeader)) return;
+
+            DatagramHeader header;
+            std::memcpy(&header, m_scratchDatagram, sizeof(DatagramHeader));
+
+            if (header.fragmentCount == 0)
+            {
+                this->_handle_control(header);
+                return;
+            }
+
+            auto peerIt = m_peers.find(m_scratchEndpoint);
+            if (peerIt == m_peers.end()) return;
+            Peer& peer = peerIt->second;
+
+            std::shared_ptr<Connection<T_Msg>> connection = peer.connection.lock();
+            if (!connection || header.token != connection->get_handshake_token())
+            {
+                return;
+            }
+
+            const size_t chunkBytes = DATAGRAM_MAX_BYTES - sizeof(DatagramHeader);
+            const size_t payloadBytes = length - sizeof(DatagramHeader);
+            if (header.fragmentCount > DATAGRAM_MAX_FRAGMENTS
+                || header.fragmentIndex >= header.fragmentCount
+                || (header.fragmentIndex + 1 < header.fragmentCount && payloadBytes != chunkBytes))
+            {
+                PLEEPLOG_WARN("Received malformed datagram, ignoring...");
+                return;
+            }
+
+            if (this->_is_superseded(peer, header.supersedeKey, header.sequence))
+            {
+                m_stats.messagesSuperseded++;
+                return;
+            }
+
+            const uint8_t* payload = m_scratchDatagram + sizeof(DatagramHeader);
+
+            // most messages fit in one datagram
+            if (header.fragmentCount == 1)
+            {
+                this->_deliver(peer, connection, header.supersedeKey, header.sequence, payload, payloadBytes);
+                return;
+            }
+
+            Assembly& assembly = peer.assemblies[header.sequence];
+            if (assembly.fragmentCount == 0)
+            {
+                assembly.supersedeKey = header.supersedeKey;
+                assembly.fragmentCount = header.fragmentCount;
+            }
+            else if (assembly.fragmentCount != header.fragmentCount || assembly.supersedeKey != header.supersedeKey)
+            {
+                PLEEPLOG_WARN("Received datagram fragment inconsistent with its message, ignoring...");
+                return;
+            }
+
+            const uint64_t fragmentBit = 1ULL << header.fragmentIndex;
+            if (assembly.receivedMask & fragmentBit) return;
+            assembly.receivedMask |= fragmentBit;
+            assembly.receivedCount++;
+
+            const size_t offset = header.fragmentIndex * chunkBytes;
+            if (assembly.bytes.size() < offset + payloadBytes) assembly.bytes.resize(offset + payloadBytes);
+            std::memcpy(assembly.bytes.data() + offset, payload, payloadBytes);
+
+            if (assembly.receivedCount == assembly.fragmentCount)
+            {
+                std::vector<uint8_t> bytes = std::move(assembly.bytes);
+                peer.assemblies.erase(header.sequence);
+                this->_deliver(peer, connection, header.supersedeKey, header.sequence, bytes.data(), bytes.size());
+            }
+            else if (peer.assemblies.size() > DATAGRAM_MAX_ASSEMBLIES)
+            {
+                // oldest sequence is least likely to ever complete
+                auto oldestIt = peer.assemblies.begin();
+                for (auto it = peer.assemblies.begin(); it != peer.assemblies.end(); it++)
+                {
+                    if (_sequence_newer(oldestIt->first, it->first)) oldestIt = it;
+                }
+                peer.assemblies.erase(oldestIt);
+                m_stats.messagesIncomplete++;
+            }
+        }
+
+        bool _is_superseded(const Peer& peer, uint64_t supersedeKey, uint32_t sequence) const
+        {
+            auto newestIt = peer.newestSequences.find(supersedeKey);
+            return newestIt != peer.newestSequences.end() && !_sequence_newer(sequence, newestIt->second);
+        }
+
+        void _deliver(Peer& peer, std::shared_ptr<Connection<T_Msg>>& connection, uint64_t supersedeKey, uint32_t sequence, const uint8_t* bytes, size_t length)
+        {
+            // could have been superseded while waiting for fragments
+            if (this->_is_superseded(peer, supersedeKey, sequence))
+            {
+                m_stats.messagesSuperseded++;
+                return;
+            }
+            if (length < sizeof(MessageHeader<T_Msg>)) return;
+
+            OwnedMessage<T_Msg> owned;
+            owned.remote = connection;
+            std::memcpy(&owned.msg.header, bytes, sizeof(MessageHeader<T_Msg>));
+            if (owned.msg.header.size != length - sizeof(MessageHeader<T_Msg>))
+            {
+                PLEEPLOG_WARN("Received datagram message with wrong body size, ignoring...");
+                return;
+            }
+            owned.msg.body.assign(bytes + sizeof(MessageHeader<T_Msg>), bytes + length);
+
+            peer.newestSequences[supersedeKey] = sequence;
+            if (peer.newestSequences.size() == 1 || _sequence_newer(sequence, peer.newestDelivered)) peer.newestDelivered = sequence;
+
+            // abandon older partial messages this one supersedes
+            for (auto it = peer.assemblies.begin(); it != peer.assemblies.end();)
+            {
+                if (it->second.supersedeKey == supersedeKey && _sequence_newer(sequence, it->first))
+                {
+                    it = peer.assemblies.erase(it);
+                    m_stats.messagesIncomplete++;
+                }
+                else
+                {
+                    it++;
+                }
+            }
+
+            m_incomingMessages.push_back(owned);
+            m_stats.messagesDelivered++;
+        }
+
+        void _handle_control(const DatagramHeader& header)
+        {
+            // server: hello from a validated client
+            auto expectedIt = m_expectedPeers.find(header.token);
+            if (expectedIt != m_expectedPeers.end())
+            {
+                std::shared_ptr<Connection<T_Msg>> connection = expectedIt->second.lock();
+                if (!connection || !connection->is_connected())
+                {
+                    m_expectedPeers.erase(expectedIt);
+                    return;
+                }
+                if (header.sequence != connection->get_handshake_checksum()) return;
+
+                // resent hellos (lost acknowledge) keep sequencing state
+                Peer& peer = m_peers[m_scratchEndpoint];
+                peer.connection = connection;
+                connection->associate_datagrams(this->shared_from_this(), m_scratchEndpoint);
+                PLEEPLOG_DEBUG("[" + std::to_string(connection->get_id()) + "] Associated datagram endpoint " + m_scratchEndpoint.address().to_string() + ":" + std::to_string(m_scratchEndpoint.port()));
+
+                this->_prune_peers();
+                this->_send_control(m_scratchEndpoint, header);
+                return;
+            }
+
+            // client: acknowledge from server
+            auto peerIt = m_peers.find(m_scratchEndpoint);
+            if (peerIt == m_peers.end()) return;
+            std::shared_ptr<Connection<T_Msg>> connection = peerIt->second.connection.lock();
+            if (connection
+                && header.token == connection->get_handshake_token()
+                && header.sequence == connection->get_handshake_checksum()
+                && !connection->is_datagram_associated())
+            {
+                connection->associate_datagrams(this->shared_from_this(), m_scratchEndpoint);
+                PLEEPLOG_DEBUG("Associated datagram endpoint with server");
+            }
+        }
+
+        // ASYNC - send hello and repeat until acknowledged or out of attempts
+        void _send_hello(const asio::ip::udp::endpoint& serverEndpoint, int attemptsRemaining)
+        {
+            auto peerIt = m_peers.find(serverEndpoint);
+            if (peerIt == m_peers.end()) return;
+            std::shared_ptr<Connection<T_Msg>> connection = peerIt->second.connection.lock();
+            if (!connection || !connection->is_connected() || connection->is_datagram_associated()) return;
+
+            if (attemptsRemaining <= 0)
+            {
+                PLEEPLOG_WARN("Server did not acknowledge datagram hello, all messages will use tcp");
+                return;
+            }
+
+            DatagramHeader hello;
+            hello.token = connection->get_handshake_token();
+            hello.sequence = connection->get_handshake_checksum();
+            this->_send_control(serverEndpoint, hello);
+
+            std::shared_ptr<asio::steady_timer> timer = std::make_shared<asio::steady_timer>(m_asioContext, std::chrono::milliseconds(DATAGRAM_HELLO_INTERVAL_MS));
+            std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+            timer->async_wait([self, timer, serverEndpoint, attemptsRemaining](std::error_code ec)
+            {
+                if (!ec) self->_send_hello(serverEndpoint, attemptsRemaining - 1);
+            });
+        }
+
+        void _send_control(const asio::ip::udp::endpoint& endpoint, DatagramHeader header)
+        {
+            header.fragmentIndex = 0;
+            header.fragmentCount = 0;
+            std::shared_ptr<std::vector<uint8_t>> datagram = std::make_shared<std::vector<uint8_t>>(sizeof(DatagramHeader));
+            std::memcpy(datagram->data(), &header, sizeof(DatagramHeader));
+            this->_send_datagram(endpoint, datagram);
+        }
+
+        // ASYNC - send (or simulate losing/delaying) one datagram
+        void _send_datagram(const asio::ip::udp::endpoint& endpoint, std::shared_ptr<std::vector<uint8_t>> datagram)
+        {
+            if (m_simulatedLossChance > 0.0f && m_lossDistribution(m_lossGenerator) < m_simulatedLossChance)
+            {
+                m_stats.datagramsDropped++;
+                return;
+            }
+
+            if (m_simulatedDelay.count() > 0)
+            {
+                std::shared_ptr<asio::steady_timer> timer = std::make_shared<asio::steady_timer>(m_asioContext, m_simulatedDelay);
+                std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+                timer->async_wait([self, timer, endpoint, datagram](std::error_code ec)
+                {
+                    if (!ec) self->_write_datagram(endpoint, datagram);
+                });
+            }
+            else
+            {
+                this->_write_datagram(endpoint, datagram);
+            }
+        }
+
+        void _write_datagram(const asio::ip::udp::endpoint& endpoint, std::shared_ptr<std::vector<uint8_t>> datagram)
+        {
+            std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+            m_socket.async_send_to(
+                asio::buffer(*datagram),
+                endpoint,
+                [self, datagram](std::error_code ec, std::size_t length)
+                {
+                    UNREFERENCED_PARAMETER(length);
+                    if (!ec)
+                    {
+                        self->m_stats.datagramsSent++;
+                    }
+                    else
+                    {
+                        PLEEPLOG_DEBUG("Asio datagram error: " + ec.message());
+                    }
+                }
+            );
+        }
+
+        // ASYNC - prune peers, then wait to again
+        void _wait_to_prune()
+        {
+            std::shared_ptr<DatagramChannel<T_Msg>> self = this->shared_from_this();
+            m_pruneTimer.expires_after(std::chrono::milliseconds(DATAGRAM_PRUNE_INTERVAL_MS));
+            m_pruneTimer.async_wait([self](std::error_code ec)
+            {
+                // cancelled by close
+                if (ec) return;
+                self->_prune_peers();
+                self->_wait_to_prune();
+            });
+        }
+
+        // forget peers and expected tokens of closed connections, and keys peers haven't sent in a long time
+        void _prune_peers()
+        {
+            for (auto it = m_peers.begin(); it != m_peers.end();)
+            {
+                std::shared_ptr<Connection<T_Msg>> connection = it->second.connection.lock();
+                if (!connection || !connection->is_connected())
+                {
+                    it = m_peers.erase(it);
+                    continue;
+                }
+
+                Peer& peer = it->second;
+                for (auto keyIt = peer.newestSequences.begin(); keyIt != peer.newestSequences.end();)
+                {
+                    if (peer.newestDelivered - keyIt->second > DATAGRAM_SEQUENCE_HORIZON) keyIt = peer.newestSequences.erase(keyIt);
+                    else keyIt++;
+                }
+                it++;
+            }
+            for (auto it = m_expectedPeers.begin(); it != m_expectedPeers.end();)
+            {
+                std::shared_ptr<Connection<T_Msg>> connection = it->second.lock();
+                if (!connection || !connection->is_connected()) it = m_expectedPeers.erase(it);
+                else it++;
+            }
+        }
+
+        asio::io_context& m_asioContext;
+        asio::ip::udp::socket m_socket;
+        asio::steady_timer m_pruneTimer;
+        // Reference to OWNER's queue, delivered messages are mixed in with tcp messages
+        TsDeque<OwnedMessage<T_Msg>>& m_incomingMessages;
+
+        uint8_t m_scratchDatagram[DATAGRAM_MAX_BYTES];
+        asio::ip::udp::endpoint m_scratchEndpoint;
+
+        std::map<asio::ip::udp::endpoint, Peer> m_peers;
+        // handshake token -> validated connection which hasn't said hello yet
+        std::unordered_map<uint32_t, std::weak_ptr<Connection<T_Msg>>> m_expectedPeers;
+
+        float m_simulatedLossChance = 0.0f;
+        std::chrono::milliseconds m_simulatedDelay{ 0 };
+        std::minstd_rand m_lossGenerator;
+        std::uniform_real_distribution<float> m_lossDistribution{ 0.0f, 1.0f };
+
+        Stats m_stats;
+    };
+}
+}
+
+#endif // NET_DATAGRAM_CHANNEL_H
@@ -11,6 +11,7 @@
 #include "networking/ts_deque.h"
 #include "networking/net_message.h"
 #include "networking/net_connection.h"
+#include "networking/net_datagram_channel.h"
 
 namespace pleep
 {
@@ -20,7 +21,9 @@ namespace net
     class I_Client
     {
     protected:
-        I_Client()
+        // useDatagrams: also open a DatagramChannel for send_unreliable_message (otherwise it uses tcp)
+        I_Client(bool useDatagrams = false)
+            : m_useDatagrams(useDatagrams)
         {
             // construct asio socket with context
         }
@@ -46,6 +49,24 @@ namespace net
                     m_incomingMessages
                 );
 
+                // datagrams aren't required, stay on tcp if we can't open a socket
+                if (m_useDatagrams)
+                {
+                    try
+                    {
+                        m_datagramChannel = std::make_shared<DatagramChannel<T_Msg>>(m_asioContext, 0, m_incomingMessages);
+                        m_datagramChannel->start_receiving();
+                        m_connection->set_datagram_channel(m_datagramChannel);
+                    }
+                    catch (const std::exception& err)
+                    {
+                        UNREFERENCED_PARAMETER(err);
+                        PLEEPLOG_WARN("Could not open datagram channel, all messages will use tcp:");
+                        PLEEPLOG_WARN(err.what());
+                        m_datagramChannel = nullptr;
+                    }
+                }
+
                 m_connection->connect_to_remote(endpoints);
 
                 // start async asio thread
@@ -78,6 +99,9 @@ namespace net
                 m_contextThread.join();
             }
 
+            // pending datagram handlers hold the channel, abort them so they drain below
+            if (m_datagramChannel) m_datagramChannel->close();
+
             // re-prime context
             m_asioContext.restart();
             // block and run a few(?) times to try to clear any jobs (at least 1 for async_read and async_write?)
@@ -90,6 +114,7 @@ namespace net
             
             // destroy member reference to connection
             m_connection = nullptr;
+            m_datagramChannel = nullptr;
             // remove all shared queue references to connection to invoke destructor
             m_incomingMessages.clear();
         }
@@ -118,6 +143,25 @@ namespace net
             }
         }
 
+        // newer messages with the same supersedeKey replace this one (see Connection::send_unreliable)
+        void send_unreliable_message(const Message<T_Msg>& msg, uint64_t supersedeKey)
+        {
+            if (!this->is_connected())
+            {
+                PLEEPLOG_ERROR("Cannot send message, Conection is closed");
+            }
+            else
+            {
+                m_connection->send_unreliable(msg, supersedeKey);
+            }
+        }
+
+        // nullptr if not connected, or datagrams are not used or could not be opened
+        std::shared_ptr<DatagramChannel<T_Msg>> get_datagram_channel()
+        {
+            return m_datagramChannel;
+        }
+
         // provide user access to m_incomingMessages synchronously
         bool is_message_available()
         {
@@ -144,6 +188,9 @@ namespace net
         std::thread m_contextThread;
         // client interface has single connection
         std::shared_ptr<Connection<T_Msg>> m_connection = nullptr;
+        // optional channel for send_unreliable_message
+        const bool m_useDatagrams;
+        std::shared_ptr<DatagramChannel<T_Msg>> m_datagramChannel = nullptr;
     };
 }
 }
@@ -11,6 +11,7 @@
 #include "networking/ts_deque.h"
 #include "networking/net_message.h"
 #include "networking/net_connection.h"
+#include "networking/net_datagram_channel.h"
 
 namespace pleep
 {
@@ -21,9 +22,24 @@ namespace net
     class I_Server
     {
     protected:
-        I_Server(uint16_t port)
+        // useDatagrams: also bind a DatagramChannel for Connection::send_unreliable (otherwise it uses tcp)
+        I_Server(uint16_t port, bool useDatagrams = false)
             : m_asioAcceptor(m_asioContext, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port))
         {
+            if (!useDatagrams) return;
+
+            // datagrams share the tcp port number, but aren't required
+            try
+            {
+                m_datagramChannel = std::make_shared<DatagramChannel<T_Msg>>(m_asioContext, port, m_incomingMessages);
+            }
+            catch (const std::exception& err)
+            {
+                UNREFERENCED_PARAMETER(err);
+                PLEEPLOG_WARN("Could not bind datagram channel, all messages will use tcp:");
+                PLEEPLOG_WARN(err.what());
+                m_datagramChannel = nullptr;
+            }
         }
     public:
         virtual ~I_Server()
@@ -38,6 +54,7 @@ namespace net
             {
                 // issue "work" to asio context
                 this->_wait_for_connection();
+                if (m_datagramChannel) m_datagramChannel->start_receiving();
                 // then start context on separate thread
                 m_contextThread = std::thread([this]() { m_asioContext.run(); });
                 std::ostringstream contextThreadId; contextThreadId << m_contextThread.get_id();
@@ -60,6 +77,9 @@ namespace net
             m_asioContext.stop();
 
             if (m_contextThread.joinable()) m_contextThread.join();
+
+            // pending datagram handlers hold the channel until the context is destroyed
+            if (m_datagramChannel) m_datagramChannel->close();
             
             PLEEPLOG_TRACE("Stopped looking for connections.");
         }
@@ -85,6 +105,20 @@ namespace net
             }
         }
 
+        // linear time to search for connectionId, keep the result if sending many messages
+        // returns nullptr if there is no such connection
+        std::shared_ptr<Connection<T_Msg>> get_connection(uint32_t connectionId)
+        {
+            for (auto& remote : m_connectionDeque)
+            {
+                if (remote && remote->get_id() == connectionId)
+                {
+                    return remote;
+                }
+            }
+            return nullptr;
+        }
+
         // Don't do this often it is linear time to search for connectionId
         void send_message(uint32_t connectionId, const Message<T_Msg>& msg)
         {
@@ -150,6 +184,12 @@ namespace net
             return m_connectionDeque.size();
         }
 
+        // nullptr if datagrams are not used or could not be bound
+        std::shared_ptr<DatagramChannel<T_Msg>> get_datagram_channel()
+        {
+            return m_datagramChannel;
+        }
+
     private:
         // ASYNC - Task asio to wait for connection
         // asio will provide us with the connected socket to use to append m_connectionDeque
@@ -163,6 +203,7 @@ namespace net
                         PLEEPLOG_DEBUG("New connection: " + socket.remote_endpoint().address().to_string() + ":" + std::to_string(socket.remote_endpoint().port()));
 
                         std::shared_ptr<Connection<T_Msg>> newConn = std::make_shared<Connection<T_Msg>>(m_asioContext, std::move(socket), m_incomingMessages);
+                        newConn->set_datagram_channel(m_datagramChannel);
 
                         // go to on connect callback
                         if (this->on_remote_connect(newConn))
@@ -226,6 +267,9 @@ namespace net
         // set task to build Connection upon incoming connection
         asio::ip::tcp::acceptor m_asioAcceptor;
 
+        // optional channel for Connection::send_unreliable shared by all connections
+        std::shared_ptr<DatagramChannel<T_Msg>> m_datagramChannel = nullptr;
+
         // interally maintained numberical id for each connection
         uint32_t m_idCounter = 1000;
     };
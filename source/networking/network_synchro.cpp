@@ -35,6 +35,15 @@ namespace pleep
         return Signature();
     }
     
+    StageAccess NetworkSynchro::derive_access()
+    {
+        // only submits an access packet, touches no components until the dynamo runs
+        StageAccess access;
+        access.resources.push_back(m_attachedNetworkDynamo.get());
+        access.exclusive = false;
+        return access;
+    }
+    
     void NetworkSynchro::attach_dynamo(std::shared_ptr<I_NetworkDynamo> contextDynamo) 
     {
         // clear events registered through old dynamo
@@ -0,0 +1,317 @@
+#include "shared_memory_ring.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    // marks a region as initialized by its owner
+    constexpr uint32_t SHARED_MEMORY_RING_MAGIC = 0x504C5250; // "PLRP"
+    // seconds a writer spins on a held lock before checking its holder (a push holds it for microseconds)
+    constexpr double SHARED_MEMORY_RING_LOCK_TIMEOUT = 0.1;
+    // seconds between checks that a ring's owner process still exists
+    constexpr double SHARED_MEMORY_RING_OWNER_CHECK_INTERVAL = 0.5;
+
+    static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+        "SharedMemoryRing needs lock free atomics to share them between processes");
+
+    std::unique_ptr<SharedMemoryRing> SharedMemoryRing::create(const std::string& name, uint32_t capacity)
+    {
+        std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+        ring->m_name = name;
+        ring->m_isOwner = true;
+
+        if (!ring->_map(true, sizeof(RingHeader) + capacity))
+        {
+            std::string errMsg = ("Could not create shared memory ring " + name);
+            PLEEPLOG_ERROR(errMsg);
+            throw std::runtime_error(errMsg);
+        }
+
+        // fresh mapping is zeroed, but a stale one may not be
+        ring->m_header->capacity = capacity;
+        ring->m_header->ownerPid.store(_get_process_id(), std::memory_order_relaxed);
+        ring->m_header->writeLock.store(0, std::memory_order_relaxed);
+        ring->m_header->head.store(0, std::memory_order_relaxed);
+        ring->m_header->tail.store(0, std::memory_order_relaxed);
+        // writers can open it from now on
+        ring->m_header->magic.store(SHARED_MEMORY_RING_MAGIC, std::memory_order_release);
+
+        return ring;
+    }
+
+    std::unique_ptr<SharedMemoryRing> SharedMemoryRing::open(const std::string& name)
+    {
+        std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+        ring->m_name = name;
+        ring->m_isOwner = false;
+
+        if (!ring->_map(false, 0)) return nullptr;
+
+        if (ring->m_header->magic.load(std::memory_order_acquire) != SHARED_MEMORY_RING_MAGIC
+            || ring->m_regionSize < sizeof(RingHeader) + ring->m_header->capacity)
+        {
+            // owner is still initializing it
+            return nullptr;
+        }
+        if (!_is_process_alive(ring->m_header->ownerPid.load(std::memory_order_relaxed)))
+        {
+            // left behind by a crashed owner
+            return nullptr;
+        }
+        ring->m_lastOwnerCheck = std::chrono::steady_clock::now();
+        return ring;
+    }
+
+    SharedMemoryRing::~SharedMemoryRing()
+    {
+        // writers still mapping it should reopen a new one
+        if (m_isOwner && m_header) m_header->magic.store(0, std::memory_order_release);
+        _unmap();
+    }
+
+    bool SharedMemoryRing::push(const EventMessage& msg)
+    {
+        const RecordSize recordSize = static_cast<RecordSize>(sizeof(RecordSize) + sizeof(msg.header) + msg.body.size());
+        if (msg.body.size() > this->get_max_message_size()) return false;
+
+        // writers are other timeslices' single network threads, so contention is rare and short
+        const uint32_t pid = _get_process_id();
+        const std::chrono::steady_clock::time_point spinStart = std::chrono::steady_clock::now();
+        uint32_t holder = 0;
+        while (!m_header->writeLock.compare_exchange_weak(holder, pid, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            if (holder != 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - spinStart).count() > SHARED_MEMORY_RING_LOCK_TIMEOUT)
+            {
+                // a live holder is just slow, try again later like a full ring
+                if (_is_process_alive(holder)) return false;
+
+                // holder crashed mid push, its record was never published so the ring is still consistent
+                PLEEPLOG_WARN("Process " + std::to_string(holder) + " died holding the lock of shared memory ring " + m_name + ", taking it over");
+                if (m_header->writeLock.compare_exchange_strong(holder, pid, std::memory_order_acquire, std::memory_order_relaxed)) break;
+            }
+            holder = 0;
+            std::this_thread::yield();
+        }
+
+        const uint64_t head = m_header->head.load(std::memory_order_relaxed);
+        const uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+        if (m_header->capacity - (head - tail) < recordSize)
+        {
+            m_header->writeLock.store(0, std::memory_order_release);
+            return false;
+        }
+
+        _write(head, &recordSize, sizeof(RecordSize));
+        _write(head + sizeof(RecordSize), &msg.header, sizeof(msg.header));
+        if (!msg.body.empty())
+        {
+            _write(head + sizeof(RecordSize) + sizeof(msg.header), msg.body.data(), msg.body.size());
+        }
+        // publish record to reader
+        m_header->head.store(head + recordSize, std::memory_order_release);
+
+        m_header->writeLock.store(0, std::memory_order_release);
+        return true;
+    }
+
+    bool SharedMemoryRing::pop(EventMessage& dest)
+    {
+        const uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+        const uint64_t head = m_header->head.load(std::memory_order_acquire);
+        if (head == tail) return false;
+
+        RecordSize recordSize;
+        _read(tail, &recordSize, sizeof(RecordSize));
+        _read(tail + sizeof(RecordSize), &dest.header, sizeof(dest.header));
+        dest.body.resize(recordSize - sizeof(RecordSize) - sizeof(dest.header));
+        if (!dest.body.empty())
+        {
+            _read(tail + sizeof(RecordSize) + sizeof(dest.header), dest.body.data(), dest.body.size());
+        }
+
+        // release space to writers
+        m_header->tail.store(tail + recordSize, std::memory_order_release);
+        return true;
+    }
+
+    bool SharedMemoryRing::is_alive() const
+    {
+        if (m_header->magic.load(std::memory_order_acquire) != SHARED_MEMORY_RING_MAGIC) return false;
+        if (m_isOwner) return true;
+
+        // a crashed owner never clears magic
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - m_lastOwnerCheck).count() < SHARED_MEMORY_RING_OWNER_CHECK_INTERVAL) return true;
+        m_lastOwnerCheck = now;
+        return _is_process_alive(m_header->ownerPid.load(std::memory_order_relaxed));
+    }
+
+    size_t SharedMemoryRing::get_max_message_size() const
+    {
+        return m_header->capacity - sizeof(RecordSize) - sizeof(EventMessage::header);
+    }
+
+    void SharedMemoryRing::_write(uint64_t position, const void* src, size_t size)
+    {
+        const size_t offset = static_cast<size_t>(position % m_header->capacity);
+        const size_t firstSize = std::min(size, m_header->capacity - offset);
+        std::memcpy(m_data + offset, src, firstSize);
+        std::memcpy(m_data, static_cast<const uint8_t*>(src) + firstSize, size - firstSize);
+    }
+
+    void SharedMemoryRing::_read(uint64_t position, void* dst, size_t size) const
+    {
+        const size_t offset = static_cast<size_t>(position % m_header->capacity);
+        const size_t firstSize = std::min(size, m_header->capacity - offset);
+        std::memcpy(dst, m_data + offset, firstSize);
+        std::memcpy(static_cast<uint8_t*>(dst) + firstSize, m_data, size - firstSize);
+    }
+
+#ifdef _WIN32
+    bool SharedMemoryRing::_map(bool create, size_t size)
+    {
+        const std::string objectName = "Local\\" + m_name;
+        HANDLE mapping = NULL;
+        if (create)
+        {
+            const uint64_t size64 = size;
+            mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFF), objectName.c_str());
+        }
+        else
+        {
+            mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, objectName.c_str());
+        }
+        if (mapping == NULL) return false;
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (view == NULL)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        MEMORY_BASIC_INFORMATION viewInfo;
+        VirtualQuery(view, &viewInfo, sizeof(viewInfo));
+
+        m_handle = reinterpret_cast<intptr_t>(mapping);
+        m_region = view;
+        m_regionSize = viewInfo.RegionSize;
+        m_header = static_cast<RingHeader*>(m_region);
+        m_data = static_cast<uint8_t*>(m_region) + sizeof(RingHeader);
+        return true;
+    }
+
+    void SharedMemoryRing::_unmap()
+    {
+        // mapping is destroyed with its last handle
+        if (m_region) UnmapViewOfFile(m_region);
+        if (m_handle != -1) CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+        m_region = nullptr;
+        m_handle = -1;
+    }
+
+    uint32_t SharedMemoryRing::_get_process_id()
+    {
+        return static_cast<uint32_t>(GetCurrentProcessId());
+    }
+
+    bool SharedMemoryRing::_is_process_alive(uint32_t pid)
+    {
+        HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+        // no such process (access denied means it exists)
+        if (process == NULL) return GetLastError() == ERROR_ACCESS_DENIED;
+        const bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return alive;
+    }
+#else
+    bool SharedMemoryRing::_map(bool create, size_t size)
+    {
+        const std::string objectName = "/" + m_name;
+        int fd = -1;
+        if (create)
+        {
+            // one left by a crashed run would have stale contents (and maybe a held lock)
+            shm_unlink(objectName.c_str());
+            fd = shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd != -1 && ftruncate(fd, static_cast<off_t>(size)) != 0)
+            {
+                close(fd);
+                shm_unlink(objectName.c_str());
+                return false;
+            }
+        }
+        else
+        {
+            fd = shm_open(objectName.c_str(), O_RDWR, 0600);
+            struct stat regionStat;
+            if (fd != -1 && (fstat(fd, &regionStat) != 0 || static_cast<size_t>(regionStat.st_size) < sizeof(RingHeader)))
+            {
+                close(fd);
+                return false;
+            }
+            if (fd != -1) size = static_cast<size_t>(regionStat.st_size);
+        }
+        if (fd == -1) return false;
+
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED)
+        {
+            close(fd);
+            if (create) shm_unlink(objectName.c_str());
+            return false;
+        }
+
+        m_handle = fd;
+        m_region = view;
+        m_regionSize = size;
+        m_header = static_cast<RingHeader*>(m_region);
+        m_data = static_cast<uint8_t*>(m_region) + sizeof(RingHeader);
+        return true;
+    }
+
+    void SharedMemoryRing::_unmap()
+    {
+        if (m_region) munmap(m_region, m_regionSize);
+        if (m_handle != -1) close(static_cast<int>(m_handle));
+        // writers which still have it mapped keep it alive, new ones won't find it
+        if (m_isOwner) shm_unlink(("/" + m_name).c_str());
+        m_region = nullptr;
+        m_handle = -1;
+    }
+
+    uint32_t SharedMemoryRing::_get_process_id()
+    {
+        return static_cast<uint32_t>(getpid());
+    }
+
+    bool SharedMemoryRing::_is_process_alive(uint32_t pid)
+    {
+        // signal 0 only checks it exists (permission denied means it exists)
+        return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+    }
+#endif
+}
@@ -0,0 +1,94 @@
+#ifndef SHARED_MEMORY_RING_H
+#define SHARED_MEMORY_RING_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+#include "events/event_types.h"
+
+namespace pleep
+{
+    // Byte ring buffer of EventMessages in a named shared memory region, for processes on the same host
+    // One process creates (owns) it and is its only reader, any number of processes can open it to write
+    // Writers take turns with a spinlock in the region (each write is a couple memcpys),
+    // the reader needs no lock as it only ever moves the tail
+    // Owner and lock holder are recorded by process id, so a crashed process can't leave the ring looking
+    // alive or locked forever
+    class SharedMemoryRing
+    {
+    public:
+        // create the named ring with capacity bytes for messages, replacing any left by a previous run
+        // throws if the region cannot be created
+        static std::unique_ptr<SharedMemoryRing> create(const std::string& name, uint32_t capacity);
+        // open a ring created by another process
+        // returns nullptr if it does not exist or isn't initialized (yet)
+        static std::unique_ptr<SharedMemoryRing> open(const std::string& name);
+
+        ~SharedMemoryRing();
+        SharedMemoryRing(const SharedMemoryRing&) = delete;
+        SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+        // copy msg into ring, returns false if there isn't room for it (yet)
+        // or another (live) writer held the lock for too long
+        bool push(const EventMessage& msg);
+        // (owner only) returns false if nothing was available
+        bool pop(EventMessage& dest);
+
+        // false once its owner has closed it or its process is gone (a restarted owner creates a new one)
+        bool is_alive() const;
+        // messages with larger bodies could never fit
+        size_t get_max_message_size() const;
+
+    private:
+        // at the start of the region, followed by capacity bytes
+        // atomics are lock free so address free (work across processes)
+        struct RingHeader
+        {
+            std::atomic<uint32_t> magic;
+            uint32_t capacity;
+            // process id of the creator
+            std::atomic<uint32_t> ownerPid;
+            // process id of the one writer holding it, 0 when free
+            std::atomic<uint32_t> writeLock;
+            // total bytes ever published by writers / consumed by reader (wrap by capacity)
+            std::atomic<uint64_t> head;
+            std::atomic<uint64_t> tail;
+        };
+        // each message is written as: uint32_t recordSize, MessageHeader, body
+        using RecordSize = uint32_t;
+
+        SharedMemoryRing() = default;
+
+        // platform specific mapping, sets m_region & m_regionSize
+        bool _map(bool create, size_t size);
+        void _unmap();
+
+        // platform specific process queries
+        static uint32_t _get_process_id();
+        static bool _is_process_alive(uint32_t pid);
+
+        // copy in/out of the data section handling wrap around
+        void _write(uint64_t position, const void* src, size_t size);
+        void _read(uint64_t position, void* dst, size_t size) const;
+
+        std::string m_name;
+        bool m_isOwner = false;
+
+        // owner process is only queried every SHARED_MEMORY_RING_OWNER_CHECK_INTERVAL
+        mutable std::chrono::steady_clock::time_point m_lastOwnerCheck;
+
+        void* m_region = nullptr;
+        size_t m_regionSize = 0;
+        RingHeader* m_header = nullptr;
+        uint8_t* m_data = nullptr;
+
+        // platform handle (file descriptor or HANDLE)
+        intptr_t m_handle = -1;
+    };
+}
+
+#endif // SHARED_MEMORY_RING_H
@@ -0,0 +1,62 @@
+#include "shared_memory_timeline_transport.h"
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    SharedMemoryTimelineTransport::SharedMemoryTimelineTransport(const TimelineConfig& cfg, TimesliceId id)
+        : A_PeerTimelineTransport(id, cfg.numTimeslices)
+    {
+        m_inboxRing = SharedMemoryRing::create(get_timeline_ring_name(cfg, id), cfg.sharedMemoryRingSize);
+        PLEEPLOG_INFO("Timeslice " + std::to_string(id) + " receiving timeline in shared memory " + get_timeline_ring_name(cfg, id));
+
+        m_peers.resize(m_numTimeslices);
+        for (TimesliceId i = 0; i < m_numTimeslices; i++)
+        {
+            if (i == m_timesliceId) continue;
+            m_peers[i].name = get_timeline_ring_name(cfg, i);
+            // opened on first send, other timeslices may not have started yet
+        }
+    }
+
+    bool SharedMemoryTimelineTransport::_deliver_frame(TimesliceId id, const EventMessage& frame)
+    {
+        PeerRing& peer = m_peers[id];
+
+        // its owner may have restarted since we opened it
+        if (peer.ring && !peer.ring->is_alive())
+        {
+            PLEEPLOG_DEBUG("Timeslice " + std::to_string(id) + " closed its ring, reopening");
+            peer.ring = nullptr;
+            peer.attempted = false;
+            // its new ring starts empty, whatever it hadn't acknowledged was never read
+            this->_requeue_unacknowledged(id);
+        }
+        if (!peer.ring)
+        {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (peer.attempted && std::chrono::duration<double>(now - peer.lastAttempt).count() < TIMELINE_PEER_RETRY_INTERVAL)
+            {
+                return false;
+            }
+            peer.attempted = true;
+            peer.lastAttempt = now;
+
+            peer.ring = SharedMemoryRing::open(peer.name);
+            if (!peer.ring) return false;
+        }
+
+        if (frame.body.size() > peer.ring->get_max_message_size())
+        {
+            PLEEPLOG_ERROR("Message is too large for timeslice " + std::to_string(id) + "'s ring, dropping: " + frame.info());
+            return true;
+        }
+        // full until it reads next update, hold it until then
+        return peer.ring->push(frame);
+    }
+
+    bool SharedMemoryTimelineTransport::_pop_frame(EventMessage& frame)
+    {
+        return m_inboxRing->pop(frame);
+    }
+}
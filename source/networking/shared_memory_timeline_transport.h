@@ -0,0 +1,52 @@
+#ifndef SHARED_MEMORY_TIMELINE_TRANSPORT_H
+#define SHARED_MEMORY_TIMELINE_TRANSPORT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "networking/a_peer_timeline_transport.h"
+#include "networking/timeline_config.h"
+#include "networking/shared_memory_ring.h"
+
+namespace pleep
+{
+    // Each timeslice may be its own process on the same host, reached through shared memory
+    // Every timeslice creates a ring (named by timelinePort & its id) which all other timeslices write into,
+    // so sending is a copy into the reader's memory with no sockets or threads involved
+    // Receivers poll their ring each update (like the other transports' queues)
+    class SharedMemoryTimelineTransport : public A_PeerTimelineTransport
+    {
+    public:
+        // throws if our ring cannot be created
+        SharedMemoryTimelineTransport(const TimelineConfig& cfg, TimesliceId id);
+
+    protected:
+        bool _deliver_frame(TimesliceId id, const EventMessage& frame) override;
+        bool _pop_frame(EventMessage& frame) override;
+
+    private:
+        struct PeerRing
+        {
+            std::unique_ptr<SharedMemoryRing> ring;
+            std::string name;
+            bool attempted = false;
+            std::chrono::steady_clock::time_point lastAttempt;
+        };
+
+        // our ring, written to by all other timeslices
+        std::unique_ptr<SharedMemoryRing> m_inboxRing;
+        // indexed by timeslice id, our own is unused
+        std::vector<PeerRing> m_peers;
+    };
+
+    // unique per timeline on a host (timelinePort) and per timeslice
+    inline std::string get_timeline_ring_name(const TimelineConfig& cfg, TimesliceId id)
+    {
+        return "pleep_timeline_" + std::to_string(cfg.timelinePort) + "_" + std::to_string(id);
+    }
+}
+
+#endif // SHARED_MEMORY_TIMELINE_TRANSPORT_H
@@ -0,0 +1,76 @@
+#include "socket_timeline_transport.h"
+
+#include <stdexcept>
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    SocketTimelineTransport::SocketTimelineTransport(const TimelineConfig& cfg, TimesliceId id)
+        : A_PeerTimelineTransport(id, cfg.numTimeslices)
+    {
+        // offset port in series by unique timeslice id (same as presentPort)
+        m_listener = std::make_unique<Listener>(static_cast<uint16_t>(cfg.timelinePort + id));
+        if (!m_listener->start())
+        {
+            std::string errMsg = ("SocketTimelineTransport could not listen on port " + std::to_string(cfg.timelinePort + id));
+            PLEEPLOG_ERROR(errMsg);
+            throw std::runtime_error(errMsg);
+        }
+        PLEEPLOG_INFO("Timeslice " + std::to_string(id) + " listening for timeline on port " + std::to_string(cfg.timelinePort + id));
+
+        m_peers.resize(m_numTimeslices);
+        for (TimesliceId i = 0; i < m_numTimeslices; i++)
+        {
+            if (i == m_timesliceId) continue;
+            m_peers[i].host = i < cfg.timesliceHosts.size() ? cfg.timesliceHosts[i] : cfg.timelineAddress;
+            m_peers[i].port = static_cast<uint16_t>(cfg.timelinePort + i);
+            // connected on first send, other timeslices may not have started yet
+        }
+    }
+
+    SocketTimelineTransport::~SocketTimelineTransport()
+    {
+        // clients join their threads on destruction, stop accepting first
+        m_listener->stop();
+    }
+
+    bool SocketTimelineTransport::_deliver_frame(TimesliceId id, const EventMessage& frame)
+    {
+        PeerLink& peer = m_peers[id];
+
+        if (!peer.client || !peer.client->is_connected())
+        {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (peer.attempted && std::chrono::duration<double>(now - peer.lastAttempt).count() < TIMELINE_PEER_RETRY_INTERVAL)
+            {
+                return false;
+            }
+            peer.attempted = true;
+            peer.lastAttempt = now;
+
+            // whatever the lost connection hadn't had acknowledged may never have arrived
+            this->_requeue_unacknowledged(id);
+
+            // a failed connection still holds its thread, start over
+            if (peer.client) peer.client->disconnect();
+            else peer.client = std::make_unique<Peer>();
+            peer.client->connect(peer.host, peer.port);
+            return false;
+        }
+        // connected but still handshaking
+        if (!peer.client->is_ready()) return false;
+
+        peer.client->send_message(frame);
+        return true;
+    }
+
+    bool SocketTimelineTransport::_pop_frame(EventMessage& frame)
+    {
+        net::OwnedMessage<EventId> received;
+        if (!m_listener->pop_message(received)) return false;
+
+        frame = std::move(received.msg);
+        return true;
+    }
+}
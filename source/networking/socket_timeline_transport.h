@@ -0,0 +1,67 @@
+#ifndef SOCKET_TIMELINE_TRANSPORT_H
+#define SOCKET_TIMELINE_TRANSPORT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "networking/a_peer_timeline_transport.h"
+#include "networking/timeline_config.h"
+#include "networking/net_i_server.h"
+#include "networking/net_i_client.h"
+
+namespace pleep
+{
+    // Each timeslice may be its own process (or host), reached over tcp
+    // Every timeslice listens on timelinePort + its id, and connects out to every other timeslice to send,
+    // so each connection only carries one direction (no need to know who is on the other end)
+    class SocketTimelineTransport : public A_PeerTimelineTransport
+    {
+    public:
+        // throws if our timeline port cannot be bound
+        SocketTimelineTransport(const TimelineConfig& cfg, TimesliceId id);
+        ~SocketTimelineTransport();
+
+    protected:
+        bool _deliver_frame(TimesliceId id, const EventMessage& frame) override;
+        bool _pop_frame(EventMessage& frame) override;
+
+    private:
+        // accepts every timeslice connecting to send to us
+        class Listener : public net::I_Server<EventId>
+        {
+        public:
+            Listener(uint16_t port)
+                : net::I_Server<EventId>(port)
+            {}
+        protected:
+            bool on_remote_connect(std::shared_ptr<net::Connection<EventId>> remote) override
+            {
+                UNREFERENCED_PARAMETER(remote);
+                PLEEPLOG_INFO("[----] Timeslice connecting from: " + remote->get_endpoint().address().to_string() + ":" + std::to_string(remote->get_endpoint().port()));
+                return true;
+            }
+        };
+
+        // our connection to send to one other timeslice
+        class Peer : public net::I_Client<EventId>
+        {};
+
+        struct PeerLink
+        {
+            std::unique_ptr<Peer> client;
+            std::string host;
+            uint16_t port = 0;
+            bool attempted = false;
+            std::chrono::steady_clock::time_point lastAttempt;
+        };
+
+        std::unique_ptr<Listener> m_listener;
+        // indexed by timeslice id, our own is unused
+        std::vector<PeerLink> m_peers;
+    };
+}
+
+#endif // SOCKET_TIMELINE_TRANSPORT_H
@@ -1,31 +1,45 @@
 #include "timeline_api.h"
 
-#include "spacetime/parallel_cosmos_context.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "core/i_cosmos_context.h"
 
 namespace pleep
 {
-    TimelineApi::TimelineApi(TimelineConfig cfg, TimesliceId id, 
-            std::shared_ptr<Multiplex> sharedMultiplex, 
-            std::shared_ptr<EntityTimestreamMap> pastTimestreams,
-            std::shared_ptr<EntityTimestreamMap> futureTimestreams,
-            std::shared_ptr<ParallelCosmosContext> parallelContext)
-        : m_multiplex(sharedMultiplex)
-        , m_pastTimestreams(pastTimestreams)
-        , m_futureTimestreams(futureTimestreams)
-        , m_sharedParallel(parallelContext)
-    {
-        if (id != NULL_TIMESLICEID && m_multiplex->find(id) == m_multiplex->end())
+    TimelineApi::TimelineApi(TimelineConfig cfg, TimesliceId id, std::shared_ptr<I_TimelineTransport> transport)
+        : m_transport(transport)
+    {
+        if (!m_transport)
         {
-            std::string errMsg = ("TimelineApi was constructed with an id (" + std::to_string(id) + ") which does not exist in the provided Multiplex");
+            std::string errMsg = ("TimelineApi was constructed for id (" + std::to_string(id) + ") without a transport");
             PLEEPLOG_ERROR(errMsg);
-            throw std::range_error(errMsg);
+            throw std::invalid_argument(errMsg);
         }
 
-        // indexes into sharedMultiplex
         m_timesliceId = id;
 
         // store whole cfg, or just copy individual members?
         m_delayToNextTimeslice = cfg.timesliceDelay;
+        m_simulationHz = FRAMERATE;
+
+        // convert rates to whole numbers of simulation updates (at least every update)
+        auto to_interval = [this](double hz)
+        {
+            if (hz <= 0.0 || hz >= m_simulationHz) return uint16_t(1);
+            return static_cast<uint16_t>(std::min(std::round(m_simulationHz / hz), double(UINT16_MAX)));
+        };
+        m_snapshotInterval      = to_interval(cfg.snapshotHz);
+        m_timestreamInterval    = to_interval(cfg.timestreamHz);
+        m_coherencySyncInterval = to_interval(cfg.coherencySyncHz);
+        m_inputOnlyTimestream   = cfg.inputOnlyTimestreams;
+        m_timestreamChecksumInterval = to_interval(cfg.timestreamChecksumHz);
+        m_timestreamKeyframeInterval = to_interval(cfg.timestreamKeyframeHz);
+        m_worldSnapshot = cfg.worldSnapshot;
+        m_checkpointDirectory = cfg.checkpointDirectory;
+        m_checkpointInterval = static_cast<uint16_t>(std::max(1.0, std::min(std::round(cfg.checkpointInterval * m_simulationHz), double(UINT16_MAX))));
+        m_parallelStages = cfg.parallelStages;
 
         // offset port in series by unique timeslice id
         m_port = cfg.presentPort + m_timesliceId;
@@ -40,7 +54,7 @@ namespace pleep
     // get total number of timeslices in the local network (ids SHOULD start from 0)
     size_t TimelineApi::get_num_timeslices()
     {
-        return m_multiplex->size();
+        return m_transport->get_num_timeslices();
     }
 
     uint16_t TimelineApi::get_port()
@@ -53,171 +67,151 @@ namespace pleep
         return m_delayToNextTimeslice;
     }
 
-    bool TimelineApi::send_message(TimesliceId id, const EventMessage& data)
+    uint16_t TimelineApi::get_snapshot_interval()
     {
-        // sending to my own id is ok, because we can re-use the same logic on receiving
-        /*
-        if (id == m_timesliceId)
-        {
-            PLEEPLOG_WARN("Trying to send data to my own id (" + std::to_string(id) + "). Is this intended?");
-        }
-        */
+        return m_snapshotInterval;
+    }
 
-        auto outgoingQueueIt = m_multiplex->find(id);
-        if (outgoingQueueIt == m_multiplex->end())
-        {
-            PLEEPLOG_WARN("Trying to send data to non-existent id (" + std::to_string(id) + "). Only " + std::to_string(get_num_timeslices()) + " total ids exist.");
-            return false;
-        }
-        
-        outgoingQueueIt->second.push_back(data);
-        return true;
+    uint16_t TimelineApi::get_timestream_interval()
+    {
+        return m_timestreamInterval;
     }
 
-    bool TimelineApi::broadcast_message(const EventMessage& data)
+    uint16_t TimelineApi::get_coherency_sync_interval()
     {
-        for (auto& msgQ : *m_multiplex)
-        {
-            if (msgQ.first == m_timesliceId) continue;
+        return m_coherencySyncInterval;
+    }
 
-            msgQ.second.push_back(data);
-        }
-        // is there any "false" condition?
-        return true;
+    bool TimelineApi::is_input_only_timestream()
+    {
+        return m_inputOnlyTimestream;
+    }
+
+    uint16_t TimelineApi::get_timestream_checksum_interval()
+    {
+        return m_timestreamChecksumInterval;
+    }
+
+    uint16_t TimelineApi::get_timestream_keyframe_interval()
+    {
+        return m_timestreamKeyframeInterval;
+    }
+
+    const std::string& TimelineApi::get_world_snapshot()
+    {
+        return m_worldSnapshot;
+    }
+
+    const std::string& TimelineApi::get_checkpoint_directory()
+    {
+        return m_checkpointDirectory;
+    }
+
+    uint16_t TimelineApi::get_checkpoint_interval()
+    {
+        return m_checkpointInterval;
+    }
+
+    bool TimelineApi::is_parallel_stages()
+    {
+        return m_parallelStages;
+    }
+
+    bool TimelineApi::send_message(TimesliceId id, const EventMessage& data)
+    {
+        return m_transport->send_message(id, data);
+    }
+
+    bool TimelineApi::broadcast_message(const EventMessage& data)
+    {
+        return m_transport->broadcast_message(data);
     }
 
     bool TimelineApi::is_message_available()
     {
-        return !(m_multiplex->at(m_timesliceId).empty());
+        return m_transport->is_message_available();
     }
     bool TimelineApi::pop_message(EventMessage& dest)
     {
-        // MUST ONLY POP FROM m_timesliceId
-        return m_multiplex->at(m_timesliceId).pop_front(dest);
+        return m_transport->pop_message(dest);
     }
 
     bool TimelineApi::has_future()
     {
-        return m_futureTimestreams != nullptr;
+        return m_transport->has_future();
     }
     bool TimelineApi::has_past()
     {
-        return m_pastTimestreams != nullptr;
+        return m_transport->has_past();
     }
 
     void TimelineApi::push_past_timestream(Entity entity, const EventMessage& data)
     {
-        if (!m_pastTimestreams)
-        {
-            PLEEPLOG_WARN("This timeslice has no past timestream to push to");
-            return;
-        }
-        m_pastTimestreams->push_to_timestream(entity, data);
+        m_transport->push_past_timestream(entity, data);
     }
 
     std::vector<Entity> TimelineApi::get_entities_with_future_streams()
     {
-        if (!m_futureTimestreams)
-        {
-            PLEEPLOG_WARN("This timeslice has no future timestream at all!");
-            return std::vector<Entity>{};
-        }
-
-        return m_futureTimestreams->get_entities_with_streams();
+        return m_transport->get_entities_with_future_streams();
     }
 
     bool TimelineApi::pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest)
     {
-        if (!m_futureTimestreams)
-        {
-            PLEEPLOG_WARN("This timeslice has no future timestream to pop from");
-        }
-        return m_futureTimestreams->pop_from_timestream(entity, coherency, dest);
+        return m_transport->pop_future_timestream(entity, coherency, dest);
+    }
+
+    void TimelineApi::copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest)
+    {
+        m_transport->copy_future_timestreams(dest);
+    }
+
+    void TimelineApi::restore_future_timestream(Entity entity, const EventMessage& stored)
+    {
+        m_transport->restore_future_timestream(entity, stored);
     }
     
     void TimelineApi::link_timestreams(std::shared_ptr<EntityTimestreamMap> sourceTimestreams)
     {
-        // clear breakpoints of old streams which we linked to
-        if (m_futureTimestreams) m_futureTimestreams->remove_breakpoints();
-        if (m_pastTimestreams) m_pastTimestreams->remove_breakpoints();
-
-        // set breakpoint to start
-        if (sourceTimestreams) sourceTimestreams->set_breakpoints();
-
-        // do both so that has_past and has_future work as expected
-        m_futureTimestreams = sourceTimestreams;
-        m_pastTimestreams = sourceTimestreams;
+        m_transport->link_timestreams(sourceTimestreams);
     }
     
     void TimelineApi::push_timestream_at_breakpoint(Entity entity, const EventMessage& data)
     {
-        if (!m_pastTimestreams)
-        {
-            PLEEPLOG_WARN("This timeslice has no past timestream to push to");
-            return;
-        }
-        m_pastTimestreams->push_to_timestream_at_breakpoint(entity, data);
+        m_transport->push_timestream_at_breakpoint(entity, data);
     }
     bool TimelineApi::pop_timestream_at_breakpoint(Entity entity, uint16_t coherency, EventMessage& dest)
     {
-        // use the "future" timestream
-        if (!m_futureTimestreams)
-        {
-            PLEEPLOG_WARN("This timeslice has no future timestream to pop from");
-            return false;
-        }
-        return m_futureTimestreams->pop_from_timestream_at_breakpoint(entity, coherency, dest);
+        return m_transport->pop_timestream_at_breakpoint(entity, coherency, dest);
     }
 
 
     void TimelineApi::parallel_notify_divergence()
     {
-        if (m_sharedParallel == nullptr) return;
-        m_sharedParallel->request_resolution(m_timesliceId);
+        m_transport->parallel_notify_divergence();
     }
 
     bool TimelineApi::parallel_load_and_link(const std::shared_ptr<Cosmos> sourceCosmos)
     {
-        if (m_sharedParallel == nullptr) return true;
-        // parallel should stop us if it is already running for some reason
-
-        PLEEPLOG_TRACE("Initing parallel cosmos");
-
-        // deep copy cosmos and timestream into parallel
-        return m_sharedParallel->load_and_link(sourceCosmos, m_futureTimestreams);
+        return m_transport->parallel_load_and_link(sourceCosmos);
     }
 
     void TimelineApi::parallel_retarget(uint16_t newTarget)
     {
-        if (m_sharedParallel == nullptr) return;
-        //PLEEPLOG_DEBUG("Updating parallel coherency target to " + std::to_string(newTarget));
-        m_sharedParallel->set_coherency_target(newTarget);
+        m_transport->parallel_retarget(newTarget);
     }
 
     bool TimelineApi::parallel_start()
     {
-        if (m_sharedParallel == nullptr) return false;
-
-        // try restart thread only if it had stopped
-        if (m_sharedParallel->is_running())
-        {
-            PLEEPLOG_WARN("Called to start parallel while it is already running... ignoring.");
-            return false;
-        }
-        PLEEPLOG_DEBUG("Restarting parallel...");
-        // start() is idempotent if already running
-        m_sharedParallel->start();
-        return true;
+        return m_transport->parallel_start();
     }
     
     TimesliceId TimelineApi::parallel_get_timeslice()
     {
-        return m_sharedParallel->get_current_timeslice();
+        return m_transport->parallel_get_timeslice();
     }
 
     bool TimelineApi::parallel_extract(std::shared_ptr<Cosmos> dstCosmos)
     {
-        if (m_sharedParallel == nullptr) return false;
-        return m_sharedParallel->extract_entity_updates(dstCosmos);
+        return m_transport->parallel_extract(dstCosmos);
     }
 }
\ No newline at end of file
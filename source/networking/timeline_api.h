@@ -4,44 +4,29 @@
 //#include "intercession_pch.h"
 #include <utility>
 #include <memory>
-#include <unordered_map>
-#include <cassert>
 #include <string>
 
 #include "logging/pleep_log.h"
-#include "networking/ts_deque.h"
 #include "networking/timeline_config.h"
 #include "networking/entity_timestream_map.h"
+#include "networking/i_timeline_transport.h"
 #include "events/event_types.h"
 #include "core/cosmos.h"
 
 namespace pleep
 {
 
-    // We need a pointer to the parallel context
-    // but the parallel context needs to have its own TimelineApi
-    // so a foreward declaration is unfortunate, but needed
-    class ParallelCosmosContext;
-
-
     // Provide all "calibratable" parameters for a single thread (and defaults)
     // Should also have a validator function to check values
     // Provide communication channels/addresses to access other timeslices
+    // (through a transport: shared memory for threads of one process, or sockets between processes/hosts)
     // only uses EventMessage as transferable datatype
     class TimelineApi
     {
     public:
-        // Should queue type contain the source id? Otherwise it has to be built into message manually
-        // Hard-code message type to use EventId (to avoid template cascading)
-        using Multiplex = std::unordered_map<TimesliceId, TsDeque<Message<EventId>>>;
-
         // Accept top level timeline config, and my individual timesliceId
-        // accept Message Conduits shared for each individual api?
-        TimelineApi(TimelineConfig cfg, TimesliceId id, 
-                    std::shared_ptr<Multiplex> sharedMultiplex, 
-                    std::shared_ptr<EntityTimestreamMap> pastTimestreams = nullptr,
-                    std::shared_ptr<EntityTimestreamMap> futureTimestreams = nullptr,
-                    std::shared_ptr<ParallelCosmosContext> parallelContext = nullptr);
+        // transport reaches the other timeslices for this id (one per api instance)
+        TimelineApi(TimelineConfig cfg, TimesliceId id, std::shared_ptr<I_TimelineTransport> transport);
 
         // get the unique timesliceId registered for this TimelineApi instance
         TimesliceId get_timeslice_id();
@@ -49,6 +34,21 @@ namespace pleep
         size_t get_num_timeslices();
         uint16_t get_port();
         uint16_t get_timeslice_delay();
+        // number of simulation updates (coherency) between each send of a replication type
+        uint16_t get_snapshot_interval();
+        uint16_t get_timestream_interval();
+        uint16_t get_coherency_sync_interval();
+        // see TimelineConfig::inputOnlyTimestreams
+        bool is_input_only_timestream();
+        uint16_t get_timestream_checksum_interval();
+        uint16_t get_timestream_keyframe_interval();
+        // see TimelineConfig::worldSnapshot (empty if there is none)
+        const std::string& get_world_snapshot();
+        // see TimelineConfig::checkpointDirectory (empty if checkpoints are disabled)
+        const std::string& get_checkpoint_directory();
+        uint16_t get_checkpoint_interval();
+        // see TimelineConfig::parallelStages
+        bool is_parallel_stages();
 
         // ***** Accessors for multiplex *****
 
@@ -76,6 +76,10 @@ namespace pleep
         std::vector<Entity> get_entities_with_future_streams();
         // Restrict access for future timestreams to only be poppable
         bool pop_future_timestream(Entity entity, uint16_t coherency, EventMessage& dest);
+        // (for checkpoints) copy everything in our future timestream as stored (cold messages stay compressed)
+        void copy_future_timestreams(std::vector<std::pair<Entity, EventMessage>>& dest);
+        // (for checkpoints) push a message exactly as copied by copy_future_timestreams
+        void restore_future_timestream(Entity entity, const EventMessage& stored);
 
         // copy pointer to sourceTimestreams, overwrites both m_future and m_past
         // (for parallel to use breakpoint functions)
@@ -111,36 +115,22 @@ namespace pleep
         TimesliceId m_timesliceId;   // Store for Entity composition
         uint16_t m_delayToNextTimeslice;  // Coherency "units"/frames
         uint16_t m_simulationHz;
-        
-        // Direct message multiplex shared with all other timeslices
-        std::shared_ptr<Multiplex> m_multiplex;
-
-        // timestream queues shared with timeslices ahead and behind in the timeline
-        // future-most timeslice will have no future, past-most timelice will have no past
-        std::shared_ptr<EntityTimestreamMap> m_futureTimestreams;
-        std::shared_ptr<EntityTimestreamMap> m_pastTimestreams;
-
-        // Access to shared ParallelContext
-        std::shared_ptr<ParallelCosmosContext> m_sharedParallel;
+        uint16_t m_snapshotInterval;
+        uint16_t m_timestreamInterval;
+        uint16_t m_coherencySyncInterval;
+        bool m_inputOnlyTimestream;
+        uint16_t m_timestreamChecksumInterval;
+        uint16_t m_timestreamKeyframeInterval;
+        std::string m_worldSnapshot;
+        std::string m_checkpointDirectory;
+        uint16_t m_checkpointInterval;
+        bool m_parallelStages;
+
+        // multiplex, timestreams, and parallel for this timeslice
+        std::shared_ptr<I_TimelineTransport> m_transport;
 
         uint16_t m_port;
     };
-
-    // return a multiplex map with empty queues for ids 0 to (numUsers - 1)
-    // this should be passed to each TimelineApi, along with each unique id
-    inline std::shared_ptr<TimelineApi::Multiplex> generate_timeline_multiplex(TimesliceId numUsers)
-    {
-        assert(numUsers < TIMESLICEID_SIZE);
-        
-        std::shared_ptr<TimelineApi::Multiplex> multiplex = std::make_shared<TimelineApi::Multiplex>();
-        for (TimesliceId i = 0; i < numUsers; i++)
-        {
-            // emplace with default constructor for TsDeque
-            multiplex->operator[](i);
-        }
-        
-        return multiplex;
-    }
 }
 
 #endif // TIMELINE_API_H
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 //#include "intercession_pch.h"
 #include <string>
+#include <vector>
 #include "ecs/ecs_types.h"
 
 namespace pleep
@@ -19,15 +20,58 @@ namespace pleep
         // (they may also need a clause to increment & try again if there is a collision)
         uint16_t presentPort = 61336; // "PLEEP"
 
-        // Cosmos updates per second
+        // Timeslice ids this process runs. Empty runs the whole timeline in this process (sharing memory)
+        // otherwise timeslices reach eachother over sockets, even those in the same process
+        // (and parallel resolution is unavailable)
+        std::vector<TimesliceId> localTimeslices;
+        // Port number each timeslice listens on for other timeslices, offset by id (like presentPort)
+        uint16_t timelinePort = 61436;
+        // Address of each timeslice (by id) for other timeslices to connect to
+        // ids without an entry use timelineAddress
+        std::vector<std::string> timesliceHosts;
+        // All timeslices are on this host: reach eachother through shared memory instead of sockets
+        bool sharedMemoryTimeline = false;
+        // bytes each timeslice can have waiting to be received from all others
+        uint32_t sharedMemoryRingSize = 8U * 1024U * 1024U;
+
+        // Cosmos updates per second are fixed at FRAMERATE
         // simulation includes input polling, parsing incoming network messages, behavior updates, physics integration.collision
-        //uint16_t simulationHz = 60;
-        // server updates don't need to happen every frame, client can dead reckon for a few
-        // serializing the whole cosmos is costly so do it less frequently
-        // (client upstream changes would still need to happen every simulation update)
-        //double networkHz    = 30.0;
+        // server updates don't need to happen every frame, changes accumulate until the next send
+        // and clients interpolate between snapshots, so replication can run well below FRAMERATE
+        // (client upstream changes still happen every simulation update)
+        // Rates are rounded to a whole number of simulation updates
+        // entity updates sent to clients
+        double snapshotHz     = 30.0;
+        // entity updates pushed into the past timeslice's timestream
+        double timestreamHz   = 30.0;
+        // coherency syncs sent to clients and the past timeslice
+        double coherencySyncHz = 0.2;
+
+        // Push only upstream components (inputs) into the past, every update they change,
+        // and let the past re-simulate everything else from them (instead of full state at timestreamHz)
+        // full state still goes when signatures change and as periodic keyframes
+        bool inputOnlyTimestreams = false;
+        // (input-only) hashes of each entity's motion state for the past to check its re-simulation against
+        // on mismatch the past requests a keyframe of that entity
+        double timestreamChecksumHz = 3.0;
+        // (input-only) full state of every entity, bounds how long any undetected drift can last
+        double timestreamKeyframeHz = 0.2;
         // renderHz is as-fast-as-possible after the above fixed timesteps (rendering/animation/ui)
 
+        // World snapshot (see cosmos_builder::load_snapshot) the present timeslice starts its cosmos from
+        // if there isn't one yet, the built-in world is built and saved there. Empty always builds it
+        std::string worldSnapshot;
+
+        // Directory (which must already exist) each timeslice checkpoints its whole state into,
+        // and restores from on startup if a checkpoint is there. Empty disables checkpoints
+        std::string checkpointDirectory;
+        // seconds of timeline between checkpoints (all timeslices capture at the same moment)
+        double checkpointInterval = 60.0;
+
+        // update synchros concurrently where their declared access allows
+        // false updates them one at a time in registration order (eg. to rule out scheduling when debugging)
+        bool parallelStages = true;
+
         // number of seconds between each timeslice
         // total timeline duration can be inferred as timesliceDelay * numTimeslices
         // (explicitly define delay means total duration is always cleanly divisible)
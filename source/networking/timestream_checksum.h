@@ -0,0 +1,104 @@
+#ifndef TIMESTREAM_CHECKSUM_H
+#define TIMESTREAM_CHECKSUM_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ecs/ecs_types.h"
+#include "core/cosmos.h"
+#include "physics/transform_component.h"
+#include "physics/physics_component.h"
+
+namespace pleep
+{
+    // FNV-1a accumulated one field value at a time
+    // (hashing whole components would include their padding, which is never initialized)
+    class StateChecksum
+    {
+    public:
+        template<typename T>
+        void add(const T& value)
+        {
+            static_assert(std::is_arithmetic<T>::value, "Only hash field values, not structs with padding");
+            uint8_t bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            for (uint8_t byte : bytes)
+            {
+                m_hash ^= byte;
+                m_hash *= 16777619U;
+            }
+        }
+        void add(bool value)
+        {
+            add(static_cast<uint8_t>(value ? 1 : 0));
+        }
+        void add(const glm::vec3& value)
+        {
+            for (int i = 0; i < 3; i++) add(value[i]);
+        }
+        void add(const glm::quat& value)
+        {
+            add(value.x);
+            add(value.y);
+            add(value.z);
+            add(value.w);
+        }
+
+        uint32_t get() const
+        {
+            return m_hash;
+        }
+
+    private:
+        uint32_t m_hash = 2166136261U;
+    };
+
+    inline void add_to_checksum(StateChecksum& checksum, const TransformComponent& transform)
+    {
+        checksum.add(transform.origin);
+        checksum.add(transform.orientation);
+        checksum.add(transform.scale);
+    }
+
+    inline void add_to_checksum(StateChecksum& checksum, const PhysicsComponent& physics)
+    {
+        checksum.add(physics.velocity);
+        checksum.add(physics.acceleration);
+        checksum.add(physics.angularVelocity);
+        checksum.add(physics.angularAcceleration);
+        checksum.add(physics.linearDrag);
+        checksum.add(physics.angularDrag);
+        checksum.add(physics.collisionLinearDrag);
+        checksum.add(physics.collisionAngularDrag);
+        checksum.add(physics.mass);
+        // locked values are unused (and not kept in sync) while unlocked
+        checksum.add(physics.lockOrigin);
+        if (physics.lockOrigin) checksum.add(physics.lockedOrigin);
+        checksum.add(physics.lockOrientation);
+        if (physics.lockOrientation) checksum.add(physics.lockedOrientation);
+        checksum.add(physics.isAsleep);
+    }
+
+    // Hash of the field values of entity's motion components (that it has)
+    // motion is what a re-simulation drifts on, and unlike some other components never stores entity ids
+    // (which differ by causal chainlink between timeslices)
+    // only equal between timeslices if they simulated bit-identically
+    inline uint32_t checksum_entity_state(std::shared_ptr<Cosmos> cosmos, Entity entity)
+    {
+        StateChecksum checksum;
+        // which components are present is part of the state
+        const bool hasTransform = cosmos->has_component<TransformComponent>(entity);
+        const bool hasPhysics = cosmos->has_component<PhysicsComponent>(entity);
+        checksum.add(hasTransform);
+        checksum.add(hasPhysics);
+
+        if (hasTransform) add_to_checksum(checksum, cosmos->read_component<TransformComponent>(entity));
+        if (hasPhysics) add_to_checksum(checksum, cosmos->read_component<PhysicsComponent>(entity));
+        return checksum.get();
+    }
+}
+
+#endif // TIMESTREAM_CHECKSUM_H
@@ -4,6 +4,7 @@
 //#include "intercession_pch.h"
 #include <mutex>
 #include <list>
+#include <vector>
 #include <utility>
 
 namespace pleep
@@ -79,6 +80,12 @@ namespace pleep
             const std::lock_guard<std::mutex> lk(m_listMux);
             return m_list.size();
         }
+        // append a copy of every element (front to back, regardless of breakpoint) to dest
+        void copy_to(std::vector<T_Element>& dest)
+        {
+            const std::lock_guard<std::mutex> lk(m_listMux);
+            dest.insert(dest.end(), m_list.begin(), m_list.end());
+        }
         void clear()
         {
             const std::lock_guard<std::mutex> lk(m_listMux);
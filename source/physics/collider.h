@@ -9,6 +9,7 @@
 
 #include "logging/pleep_log.h"
 #include "physics/transform_component.h"
+#include "physics/collider_mesh.h"
 #include "ecs/ecs_types.h"
 #include "events/message.h"
 
@@ -24,7 +25,7 @@ namespace pleep
         ray, // unit vector (0,0,1), use localTransform to rotate and scale ray
         //capsule,
         //cylinder,
-        //mesh,
+        mesh, // static triangles from colliderMesh (in model space), use localTransform to place them
         count
     };
 
@@ -62,6 +63,10 @@ namespace pleep
         // if true call on_collision for this entity's behaviors drivetrain when collision occurs
         bool useBehaviorsResponse = false;
 
+        // Triangle data for ColliderType::mesh, shared with ModelCache (ignored by other types)
+        // Mesh colliders are expected to be static (INFINITE_MASS) as they have no volume
+        std::shared_ptr<const ColliderMesh> colliderMesh = nullptr;
+
         // nested transform component "offset" (in local space) from entity's origin
         // Transform scale makes geometrically defined collider shapes
         // NOTE: centre of mass may or may not correlate
@@ -3,6 +3,8 @@
 
 //#include "intercession_pch.h"
 #include "physics/collider.h"
+#include "physics/collider_mesh_source.h"
+#include "events/message.h"
 
 namespace pleep
 {
@@ -15,6 +17,92 @@ namespace pleep
         // the synchro will submit each collider (if active)
         Collider colliders[COLLIDERS_PER_ENTITY];
     };
+
+    // Member pointer (ColliderMesh) makes Collider not sharable, so we must override Message serialization
+    template<typename T_Msg>
+    Message<T_Msg>& operator<<(Message<T_Msg>& msg, const Collider& data)
+    {
+        // REMEMBER this is a STACK so reverse the order!!!
+        msg << data.colliderType;
+        msg << data.collisionType;
+        msg << data.isActive;
+        msg << data.useBehaviorsResponse;
+        msg << data.localTransform;
+        msg << data.inheritOrientation;
+        msg << data.influenceOrientation;
+        msg << data.minParametricValue;
+        msg << data.staticFriction;
+        msg << data.dynamicFriction;
+        msg << data.restitution;
+        msg << data.stiffness;
+        msg << data.damping;
+        msg << data.restLength;
+
+        // Pass ColliderMeshes key AND source filepath incase it needs to be imported
+        msg << (data.colliderMesh ? data.colliderMesh->m_sourceFilepath : std::string());
+        msg << (data.colliderMesh ? data.colliderMesh->m_name : std::string());
+
+        return msg;
+    }
+    template<typename T_Msg>
+    Message<T_Msg>& operator>>(Message<T_Msg>& msg, Collider& data)
+    {
+        std::string newMeshName;
+        msg >> newMeshName;
+        std::string newMeshPath;
+        msg >> newMeshPath;
+
+        // if msg has no mesh (empty string) also clear collider mesh
+        if (newMeshName == "")
+        {
+            data.colliderMesh = nullptr;
+        }
+        // if collider either has no mesh OR a different one then fetch from library
+        else if (data.colliderMesh == nullptr || data.colliderMesh->m_name != newMeshName)
+        {
+            // imports the file if the mesh isn't available yet
+            // if import was empty or failed it will be nullptr, assign either way
+            data.colliderMesh = ColliderMeshes::fetch(newMeshName, newMeshPath);
+        }
+        // else names match, continue as-is
+
+        msg >> data.restLength;
+        msg >> data.damping;
+        msg >> data.stiffness;
+        msg >> data.restitution;
+        msg >> data.dynamicFriction;
+        msg >> data.staticFriction;
+        msg >> data.minParametricValue;
+        msg >> data.influenceOrientation;
+        msg >> data.inheritOrientation;
+        msg >> data.localTransform;
+        msg >> data.useBehaviorsResponse;
+        msg >> data.isActive;
+        msg >> data.collisionType;
+        msg >> data.colliderType;
+
+        return msg;
+    }
+
+    template<typename T_Msg>
+    Message<T_Msg>& operator<<(Message<T_Msg>& msg, const ColliderComponent& data)
+    {
+        // (remember this must be in reverse order as well)
+        for (size_t i = COLLIDERS_PER_ENTITY - 1; i < COLLIDERS_PER_ENTITY; i--)
+        {
+            msg << data.colliders[i];
+        }
+        return msg;
+    }
+    template<typename T_Msg>
+    Message<T_Msg>& operator>>(Message<T_Msg>& msg, ColliderComponent& data)
+    {
+        for (size_t i = 0; i < COLLIDERS_PER_ENTITY; i++)
+        {
+            msg >> data.colliders[i];
+        }
+        return msg;
+    }
 }
 
-#endif // COLLIDER_COMPONENT_H
\ No newline at end of file
+#endif // COLLIDER_COMPONENT_H
@@ -0,0 +1,263 @@
+#include "collider_mesh.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    // stop splitting nodes once they reference this many triangles
+    constexpr uint32_t BVH_LEAF_SIZE = 4;
+    // nodes this deep are made leaves however many triangles they have
+    // (median splits halve every level, so only reached by more than 2^BVH_MAX_DEPTH triangles)
+    constexpr uint32_t BVH_MAX_DEPTH = 48;
+    // depth first traversal holds at most one sibling per level above the current node, plus the two children
+    constexpr size_t BVH_STACK_SIZE = BVH_MAX_DEPTH + 2;
+
+    inline static bool bounds_overlap(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB, const glm::vec3& maxB)
+    {
+        return minA.x <= maxB.x && maxA.x >= minB.x
+            && minA.y <= maxB.y && maxA.y >= minB.y
+            && minA.z <= maxB.z && maxA.z >= minB.z;
+    }
+
+    // slab test for segment origin + t*delta, t in [0,maxT]
+    inline static bool segment_overlaps_bounds(const glm::vec3& origin, const glm::vec3& delta, const float maxT, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        float tEnter = 0.0f;
+        float tExit  = maxT;
+        for (int i = 0; i < 3; i++)
+        {
+            if (delta[i] == 0.0f)
+            {
+                // parallel to this slab, must already be inside it
+                if (origin[i] < boundsMin[i] || origin[i] > boundsMax[i]) return false;
+                continue;
+            }
+            const float invDelta = 1.0f / delta[i];
+            float t1 = (boundsMin[i] - origin[i]) * invDelta;
+            float t2 = (boundsMax[i] - origin[i]) * invDelta;
+            if (t1 > t2) std::swap(t1, t2);
+            tEnter = std::max(tEnter, t1);
+            tExit  = std::min(tExit, t2);
+            if (tEnter > tExit) return false;
+        }
+        return true;
+    }
+
+    // Moller-Trumbore (double sided) for segment origin + t*delta
+    inline static bool segment_triangle_intersect(const glm::vec3& origin, const glm::vec3& delta, const ColliderMesh::Triangle& tri, float& t)
+    {
+        const glm::vec3 edge1 = tri.b - tri.a;
+        const glm::vec3 edge2 = tri.c - tri.a;
+        const glm::vec3 p = glm::cross(delta, edge2);
+        const float det = glm::dot(edge1, p);
+        // segment is parallel to triangle plane (or triangle is degenerate)
+        if (det == 0.0f) return false;
+        const float invDet = 1.0f / det;
+
+        const glm::vec3 s = origin - tri.a;
+        const float u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f) return false;
+
+        const glm::vec3 q = glm::cross(s, edge1);
+        const float v = glm::dot(delta, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) return false;
+
+        t = glm::dot(edge2, q) * invDet;
+        return t >= 0.0f && t <= 1.0f;
+    }
+
+    ColliderMesh::ColliderMesh(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices)
+    {
+        m_triangles.reserve(indices.size() / 3);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            if (indices[i] >= positions.size() || indices[i+1] >= positions.size() || indices[i+2] >= positions.size())
+            {
+                PLEEPLOG_WARN("Collider mesh face " + std::to_string(i/3) + " references a vertex which doesn't exist, skipping");
+                continue;
+            }
+            m_triangles.push_back(Triangle{ positions[indices[i]], positions[indices[i+1]], positions[indices[i+2]] });
+        }
+
+        _build();
+    }
+
+    void ColliderMesh::query_bounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<uint32_t>& dest) const
+    {
+        if (m_nodes.empty()) return;
+
+        uint32_t stack[BVH_STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const BvhNode& node = m_nodes[stack[--top]];
+            if (!bounds_overlap(node.boundsMin, node.boundsMax, boundsMin, boundsMax))
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (uint32_t t = node.index; t < node.index + node.count; t++)
+                {
+                    dest.push_back(t);
+                }
+                continue;
+            }
+
+            assert(top + 2 <= BVH_STACK_SIZE);
+            stack[top++] = node.index;
+            stack[top++] = node.index + 1;
+        }
+    }
+
+    bool ColliderMesh::intersect_segment(const glm::vec3& origin, const glm::vec3& end, float& parametricValue, glm::vec3& faceNormal) const
+    {
+        if (m_nodes.empty()) return false;
+
+        const glm::vec3 delta = end - origin;
+        // shrink the segment as closer hits are found so farther nodes are culled
+        float closestT = 1.0f;
+        bool hit = false;
+
+        uint32_t stack[BVH_STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const BvhNode& node = m_nodes[stack[--top]];
+            if (!segment_overlaps_bounds(origin, delta, closestT, node.boundsMin, node.boundsMax))
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (uint32_t t = node.index; t < node.index + node.count; t++)
+                {
+                    float triT;
+                    if (segment_triangle_intersect(origin, delta, m_triangles[t], triT) && triT <= closestT)
+                    {
+                        closestT = triT;
+                        faceNormal = glm::cross(m_triangles[t].b - m_triangles[t].a, m_triangles[t].c - m_triangles[t].a);
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            assert(top + 2 <= BVH_STACK_SIZE);
+            stack[top++] = node.index;
+            stack[top++] = node.index + 1;
+        }
+
+        if (hit) parametricValue = closestT;
+        return hit;
+    }
+
+    const ColliderMesh::Triangle& ColliderMesh::get_triangle(uint32_t triangleIndex) const
+    {
+        return m_triangles.at(triangleIndex);
+    }
+
+    size_t ColliderMesh::get_triangle_count() const
+    {
+        return m_triangles.size();
+    }
+
+    glm::vec3 ColliderMesh::get_bounds_min() const
+    {
+        return m_nodes.empty() ? glm::vec3(0.0f) : m_nodes[0].boundsMin;
+    }
+
+    glm::vec3 ColliderMesh::get_bounds_max() const
+    {
+        return m_nodes.empty() ? glm::vec3(0.0f) : m_nodes[0].boundsMax;
+    }
+
+    void ColliderMesh::_build()
+    {
+        m_nodes.clear();
+        if (m_triangles.empty()) return;
+
+        // median splits down to BVH_LEAF_SIZE make at most ~2n/BVH_LEAF_SIZE nodes
+        m_nodes.reserve(2 * (m_triangles.size() / BVH_LEAF_SIZE + 1));
+
+        // node to fill in, range of m_triangles it covers, and its depth (root is 0)
+        struct BuildTask
+        {
+            uint32_t node;
+            uint32_t first;
+            uint32_t count;
+            uint32_t depth;
+        };
+        std::vector<BuildTask> tasks;
+        m_nodes.push_back(BvhNode{});
+        tasks.push_back(BuildTask{ 0, 0, static_cast<uint32_t>(m_triangles.size()), 0 });
+
+        while (!tasks.empty())
+        {
+            const BuildTask task = tasks.back();
+            tasks.pop_back();
+
+            // bounds of triangles (for the node) and of their centroids (for choosing a split)
+            glm::vec3 boundsMin(INFINITY);
+            glm::vec3 boundsMax(-INFINITY);
+            glm::vec3 centroidMin(INFINITY);
+            glm::vec3 centroidMax(-INFINITY);
+            for (uint32_t t = task.first; t < task.first + task.count; t++)
+            {
+                const Triangle& tri = m_triangles[t];
+                boundsMin = glm::min(boundsMin, glm::min(tri.a, glm::min(tri.b, tri.c)));
+                boundsMax = glm::max(boundsMax, glm::max(tri.a, glm::max(tri.b, tri.c)));
+                const glm::vec3 centroid = (tri.a + tri.b + tri.c) / 3.0f;
+                centroidMin = glm::min(centroidMin, centroid);
+                centroidMax = glm::max(centroidMax, centroid);
+            }
+            m_nodes[task.node].boundsMin = boundsMin;
+            m_nodes[task.node].boundsMax = boundsMax;
+
+            // split along the widest centroid axis
+            const glm::vec3 extent = centroidMax - centroidMin;
+            const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+            // small enough, all centroids coincide and can't be separated, or traversal stacks couldn't hold children
+            if (task.count <= BVH_LEAF_SIZE || extent[axis] <= 0.0f || task.depth >= BVH_MAX_DEPTH)
+            {
+                m_nodes[task.node].index = task.first;
+                m_nodes[task.node].count = task.count;
+                continue;
+            }
+
+            const uint32_t half = task.count / 2;
+            std::nth_element(
+                m_triangles.begin() + task.first,
+                m_triangles.begin() + task.first + half,
+                m_triangles.begin() + task.first + task.count,
+                [axis](const Triangle& lhs, const Triangle& rhs)
+                {
+                    return (lhs.a[axis] + lhs.b[axis] + lhs.c[axis]) < (rhs.a[axis] + rhs.b[axis] + rhs.c[axis]);
+                }
+            );
+
+            // children are allocated together so they stay adjacent
+            const uint32_t left = static_cast<uint32_t>(m_nodes.size());
+            m_nodes[task.node].index = left;
+            m_nodes[task.node].count = 0;
+            m_nodes.push_back(BvhNode{});
+            m_nodes.push_back(BvhNode{});
+
+            tasks.push_back(BuildTask{ left + 1, task.first + half, task.count - half, task.depth + 1 });
+            tasks.push_back(BuildTask{ left,     task.first,        half,              task.depth + 1 });
+        }
+
+        PLEEPLOG_DEBUG("Built collider mesh with " + std::to_string(m_triangles.size()) + " triangles into " + std::to_string(m_nodes.size()) + " nodes");
+    }
+}
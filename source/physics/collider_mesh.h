@@ -0,0 +1,78 @@
+#ifndef COLLIDER_MESH_H
+#define COLLIDER_MESH_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+namespace pleep
+{
+    // Static triangle data for ColliderType::mesh
+    // Built once from imported vertex positions (see ModelManager::fetch_collider_mesh)
+    // and shared as const between every collider that uses it, like Mesh is for rendering.
+    // Triangles are kept in model space and partitioned by a flattened bounding volume hierarchy
+    // so narrow phase only has to test triangles near the other collider.
+    class ColliderMesh
+    {
+    public:
+        struct Triangle
+        {
+            glm::vec3 a;
+            glm::vec3 b;
+            glm::vec3 c;
+        };
+
+        // Nodes are stored in a single vector with the root at 0:
+        // interior nodes have count == 0 and their (adjacent) children are at [index, index+1]
+        // leaf nodes reference m_triangles[index, index+count)
+        // (32 bytes, so two nodes share a cache line)
+        struct BvhNode
+        {
+            glm::vec3 boundsMin;
+            uint32_t  index = 0;
+            glm::vec3 boundsMax;
+            uint32_t  count = 0;
+        };
+
+        // Init ColliderMesh with no triangles (never intersects)
+        ColliderMesh() = default;
+        // Build triangle list and hierarchy from an indexed triangle list (3 indices per face)
+        ColliderMesh(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices);
+        // Hierarchy may be large, don't let it be copied accidentally
+        ColliderMesh(const ColliderMesh&) = delete;
+        ~ColliderMesh() = default;
+
+        // append indices of all triangles whose bounds overlap the given box (model space)
+        void query_bounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<uint32_t>& dest) const;
+
+        // find the closest triangle crossed by the segment from origin to end (model space)
+        // returns false if nothing was hit, otherwise sets the parametric value [0,1] along the segment
+        // and the (unnormalized, model space) face normal of the triangle that was hit
+        bool intersect_segment(const glm::vec3& origin, const glm::vec3& end, float& parametricValue, glm::vec3& faceNormal) const;
+
+        const Triangle& get_triangle(uint32_t triangleIndex) const;
+        size_t get_triangle_count() const;
+
+        // bounds of the whole mesh in model space (zero if empty)
+        glm::vec3 get_bounds_min() const;
+        glm::vec3 get_bounds_max() const;
+
+        // Name of the Mesh this was built from
+        std::string m_name;
+        // Filename the Mesh was imported from
+        std::string m_sourceFilepath;
+
+    private:
+        // reordered during build so that each leaf is a contiguous range
+        std::vector<Triangle> m_triangles;
+        std::vector<BvhNode>  m_nodes;
+
+        // build m_nodes over m_triangles
+        void _build();
+    };
+}
+
+#endif // COLLIDER_MESH_H
@@ -0,0 +1,59 @@
+#ifndef COLLIDER_MESH_SOURCE_H
+#define COLLIDER_MESH_SOURCE_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <string>
+
+#include "physics/collider_mesh.h"
+
+namespace pleep
+{
+    // Whatever imports model files and keeps their ColliderMeshes (eg. ModelManager)
+    // physics only looks meshes up by name through here, so it doesn't depend on the importer
+    class I_ColliderMeshSource
+    {
+    public:
+        virtual ~I_ColliderMeshSource() = default;
+
+        // nullptr if no mesh with name has been imported
+        virtual std::shared_ptr<const ColliderMesh> fetch_collider_mesh(const std::string& name) = 0;
+        // import every mesh in filepath (so they can be fetched)
+        virtual void import_collider_meshes(const std::string& filepath) = 0;
+    };
+
+    // Global access point to the registered I_ColliderMeshSource
+    namespace ColliderMeshes
+    {
+        // function local so sources may register during static initialization
+        inline I_ColliderMeshSource*& get_source_ref()
+        {
+            static I_ColliderMeshSource* source = nullptr;
+            return source;
+        }
+
+        // source must outlive any fetch (or be unregistered with nullptr)
+        inline void set_source(I_ColliderMeshSource* source)
+        {
+            get_source_ref() = source;
+        }
+
+        // fetch name, importing filepath if it isn't available yet
+        // nullptr if there is no source, or filepath doesn't have the mesh
+        inline std::shared_ptr<const ColliderMesh> fetch(const std::string& name, const std::string& filepath)
+        {
+            I_ColliderMeshSource* source = get_source_ref();
+            if (!source) return nullptr;
+
+            std::shared_ptr<const ColliderMesh> mesh = source->fetch_collider_mesh(name);
+            if (!mesh)
+            {
+                source->import_collider_meshes(filepath);
+                mesh = source->fetch_collider_mesh(name);
+            }
+            return mesh;
+        }
+    }
+}
+
+#endif // COLLIDER_MESH_SOURCE_H
@@ -27,14 +27,19 @@ namespace pleep
 
         for (Entity const& entity : m_entities)
         {
-            TransformComponent& transform = cosmos->get_component<TransformComponent>(entity);
-            ColliderComponent& collider = cosmos->get_component<ColliderComponent>(entity);
+            // collision relay flags both entities' transform & colliders when they actually hit
+            TransformComponent& transform = cosmos->get_component_unmarked<TransformComponent>(entity);
+            ColliderComponent& collider = cosmos->get_component_unmarked<ColliderComponent>(entity);
 
             // separate each collider component into individual colliders
             for (int i = 0; i < COLLIDERS_PER_ENTITY; i++)
             {
                 if (collider.colliders[i].isActive)
                 {
+                    if (collider.colliders[i].minParametricValue != 1.0f)
+                    {
+                        cosmos->mark_component_changed<ColliderComponent>(entity);
+                    }
                     collider.colliders[i].reset();
                     m_attachedPhysicsDynamo->submit(ColliderPacket{ transform, collider.colliders[i], entity, m_ownerCosmos });
                 }
@@ -79,4 +84,14 @@ namespace pleep
 
         // restore event handlers
     }
+    
+    StageAccess ColliderSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedPhysicsDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // resets colliders before submitting them
+            access.reads.set(cosmos.get_component_type<TransformComponent>());
+            access.writes.set(cosmos.get_component_type<ColliderComponent>());
+        });
+    }
 }
\ No newline at end of file
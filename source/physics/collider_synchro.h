@@ -22,6 +22,8 @@ namespace pleep
 
         Signature derive_signature() override;
 
+        StageAccess derive_access() override;
+
         // synchro needs a PhysicsDynamo to operate on
         void attach_dynamo(std::shared_ptr<PhysicsDynamo> contextDynamo);
         
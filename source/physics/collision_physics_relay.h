@@ -7,6 +7,7 @@
 #include "logging/pleep_log.h"
 #include "physics/a_physics_relay.h"
 #include "physics/collider_packet.h"
+#include "physics/collider_component.h"
 #include "core/cosmos.h"
 #include "behaviors/behaviors_component.h"
 #include "physics/collision_procedures.h"
@@ -66,6 +67,12 @@ namespace pleep
                     {
                         continue;
                     }
+                    // colliders (and transforms via static resolution) are only written on a hit,
+                    // collider synchro leaves flagging them to us
+                    cosmos->mark_component_changed<TransformComponent>(dataA.collidee);
+                    cosmos->mark_component_changed<ColliderComponent>(dataA.collidee);
+                    cosmos->mark_component_changed<TransformComponent>(dataB.collidee);
+                    cosmos->mark_component_changed<ColliderComponent>(dataB.collidee);
                     //PLEEPLOG_DEBUG("Collision Detected!");
                     //PLEEPLOG_DEBUG("Collision Point: " + std::to_string(collisionPoint.x) + ", " + std::to_string(collisionPoint.y) + ", " + std::to_string(collisionPoint.z));
                     //PLEEPLOG_DEBUG("Collision Normal: " + std::to_string(collisionNormal.x) + ", " + std::to_string(collisionNormal.y) + ", " + std::to_string(collisionNormal.z));
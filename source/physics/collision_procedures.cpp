@@ -262,6 +262,149 @@ namespace pleep
         return false;
     }
 
+    bool box_mesh_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    )
+    {
+        assert(dataA.collider.colliderType == ColliderType::box);
+        assert(dataB.collider.colliderType == ColliderType::mesh);
+        if (dataB.collider.colliderMesh == nullptr) return false;
+        const ColliderMesh& mesh = *dataB.collider.colliderMesh;
+
+        // SAT of box against each nearby triangle, keeping the deepest one
+
+        glm::mat4 localTransformA  = dataA.collider.compose_transform(dataA.transform);
+        glm::mat3 normalTransformA = glm::transpose(glm::inverse(glm::mat3(localTransformA)));
+        glm::mat4 localTransformB  = dataB.collider.compose_transform(dataB.transform);
+
+        // broad phase: box bounds in mesh model space
+        glm::vec3 queryMin, queryMax;
+        transform_bounds(glm::inverse(localTransformB) * localTransformA, glm::vec3(-UNIT_RADIUS), glm::vec3(UNIT_RADIUS), queryMin, queryMax);
+        std::vector<uint32_t> candidates;
+        mesh.query_bounds(queryMin, queryMax, candidates);
+        if (candidates.empty()) return false;
+
+        // box face normals and edge directions are the same for every triangle
+        const glm::vec3 boxNormals[3] = {
+            normalTransformA * glm::vec3(1.0f, 0.0f, 0.0f),
+            normalTransformA * glm::vec3(0.0f, 1.0f, 0.0f),
+            normalTransformA * glm::vec3(0.0f, 0.0f, 1.0f)
+        };
+        const glm::vec3 boxEdges[3] = {
+            glm::vec3(localTransformA[0]),
+            glm::vec3(localTransformA[1]),
+            glm::vec3(localTransformA[2])
+        };
+
+        // Maintain data from deepest triangle
+        glm::vec3 maxPenetrateNormal(0.0f);
+        float maxPenetrateDepth = 0.0f;
+
+        for (const uint32_t t : candidates)
+        {
+            const ColliderMesh::Triangle& tri = mesh.get_triangle(t);
+            const glm::vec3 a = localTransformB * glm::vec4(tri.a, 1.0f);
+            const glm::vec3 b = localTransformB * glm::vec4(tri.b, 1.0f);
+            const glm::vec3 c = localTransformB * glm::vec4(tri.c, 1.0f);
+            const glm::vec3 triEdges[3] = { b - a, c - b, a - c };
+
+            std::array<glm::vec3, 13> axes;
+            // triangle face normal first so it can be preferred below
+            axes[0] = glm::cross(triEdges[0], -triEdges[2]);
+            axes[1] = boxNormals[0];
+            axes[2] = boxNormals[1];
+            axes[3] = boxNormals[2];
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    axes[4 + i*3 + j] = glm::cross(boxEdges[i], triEdges[j]);
+                }
+            }
+
+            glm::vec3 minPenetrateNormal(0.0f);
+            float minPenetrateDepth = INFINITY;
+            float facePenetrateDepth = INFINITY;
+            bool separated = false;
+
+            for (size_t i = 0; i < axes.size(); i++)
+            {
+                // degenerate triangle or parallel edges
+                if (glm::length2(axes[i]) < 1e-12f) continue;
+                const glm::vec3 axis = glm::normalize(axes[i]);
+
+                const glm::vec2 intervalA = project_box(localTransformA, axis);
+                const glm::vec2 intervalB = project_triangle(a, b, c, axis);
+
+                float penetration = 0;
+                bool flipAxis = false;
+                // determine direction of penetration by midpoints until we account for velocities
+                if ((intervalA.x + intervalA.y)/2.0f > (intervalB.x + intervalB.y)/2.0f)
+                {
+                    penetration = intervalB.y - intervalA.x;
+                }
+                else
+                {
+                    penetration = intervalA.y - intervalB.x;
+                    flipAxis = true;
+                }
+
+                if (penetration <= 0)
+                {
+                    separated = true;
+                    break;
+                }
+
+                if (i == 0) facePenetrateDepth = penetration;
+                if (penetration < minPenetrateDepth)
+                {
+                    minPenetrateDepth = penetration;
+                    minPenetrateNormal = flipAxis ? -axis : axis;
+                }
+            }
+            if (separated || minPenetrateDepth == INFINITY) continue;
+
+            // edges shared between neighbouring triangles can produce sideways normals,
+            // so prefer the face normal when it is nearly as shallow
+            if (facePenetrateDepth <= minPenetrateDepth + MANIFOLD_DEPTH)
+            {
+                glm::vec3 faceNormal = glm::normalize(axes[0]);
+                // face normal should point away from the triangle towards the box
+                if (glm::dot(faceNormal, glm::vec3(localTransformA[3]) - a) < 0.0f) faceNormal = -faceNormal;
+                minPenetrateDepth = facePenetrateDepth;
+                minPenetrateNormal = faceNormal;
+            }
+
+            if (minPenetrateDepth > maxPenetrateDepth)
+            {
+                maxPenetrateDepth = minPenetrateDepth;
+                maxPenetrateNormal = minPenetrateNormal;
+            }
+        }
+
+        if (maxPenetrateDepth <= 0.0f) return false;
+
+        collisionNormal = maxPenetrateNormal;
+        collisionDepth = maxPenetrateDepth;
+
+        // contact point is the average of the box's deepest vertices (along -normal)
+        // moved back onto the surface of the mesh
+        std::vector<glm::vec3> manifold;
+        build_contact_manifold(localTransformA, -collisionNormal, collisionDepth, manifold);
+        if (manifold.empty()) return false;
+        glm::vec3 deepestA(0.0f);
+        for (const glm::vec3& vertex : manifold)
+        {
+            deepestA += vertex;
+        }
+        deepestA /= static_cast<float>(manifold.size());
+
+        collisionPoint = deepestA + (collisionNormal * collisionDepth);
+        return true;
+    }
+
 
     bool sphere_box_intersect(
         ColliderPacket& dataA,
@@ -438,6 +581,70 @@ namespace pleep
         return false;
     }
 
+    bool sphere_mesh_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    )
+    {
+        assert(dataA.collider.colliderType == ColliderType::sphere);
+        assert(dataB.collider.colliderType == ColliderType::mesh);
+        if (dataB.collider.colliderMesh == nullptr) return false;
+        const ColliderMesh& mesh = *dataB.collider.colliderMesh;
+
+        glm::mat4 localTransformA = dataA.collider.compose_transform(dataA.transform);
+        glm::mat4 localTransformB = dataB.collider.compose_transform(dataB.transform);
+
+        const glm::vec3 sphereOrigin = localTransformA * glm::vec4(0,0,0, 1.0f);
+        // only considers scale along x
+        const glm::vec3 sphereSurface = localTransformA * glm::vec4(UNIT_RADIUS,0,0, 1.0f);
+        const float sphereRadius = glm::length(sphereSurface - sphereOrigin);
+
+        // broad phase: sphere bounds in mesh model space
+        glm::vec3 queryMin, queryMax;
+        transform_bounds(glm::inverse(localTransformB), sphereOrigin - glm::vec3(sphereRadius), sphereOrigin + glm::vec3(sphereRadius), queryMin, queryMax);
+        std::vector<uint32_t> candidates;
+        mesh.query_bounds(queryMin, queryMax, candidates);
+
+        // keep the deepest triangle
+        float maxDepth = 0.0f;
+        for (const uint32_t t : candidates)
+        {
+            const ColliderMesh::Triangle& tri = mesh.get_triangle(t);
+            const glm::vec3 a = localTransformB * glm::vec4(tri.a, 1.0f);
+            const glm::vec3 b = localTransformB * glm::vec4(tri.b, 1.0f);
+            const glm::vec3 c = localTransformB * glm::vec4(tri.c, 1.0f);
+
+            const glm::vec3 closest = closest_point_on_triangle(sphereOrigin, a, b, c);
+            glm::vec3 dir = sphereOrigin - closest;
+            const float dist = glm::length(dir);
+            const float depth = sphereRadius - dist;
+            if (depth <= maxDepth) continue;
+
+            if (dist == 0.0f)
+            {
+                // origin is exactly on the triangle, fall back to the face normal
+                dir = glm::cross(b - a, c - a);
+                if (glm::length2(dir) == 0.0f) continue;
+                dir = glm::normalize(dir);
+            }
+            else
+            {
+                dir /= dist;
+            }
+
+            maxDepth = depth;
+            collisionNormal = dir;
+            // on surface of B (regardless of depth)
+            collisionPoint = closest;
+        }
+
+        if (maxDepth <= 0.0f) return false;
+
+        collisionDepth = maxDepth;
+        return true;
+    }
+
 
     bool ray_box_intersect(
         ColliderPacket& dataA,
@@ -621,6 +828,106 @@ namespace pleep
         return false;
     }
 
+    bool ray_mesh_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    )
+    {
+        assert(dataA.collider.colliderType == ColliderType::ray);
+        assert(dataB.collider.colliderType == ColliderType::mesh);
+        if (dataB.collider.colliderMesh == nullptr) return false;
+        const ColliderMesh& mesh = *dataB.collider.colliderMesh;
+
+        glm::mat4 localTransformA = dataA.collider.compose_transform(dataA.transform);
+        glm::mat4 localTransformB = dataB.collider.compose_transform(dataB.transform);
+
+        const glm::vec3 rayOrigin = localTransformA * glm::vec4(0,0,0, 1.0f);
+        const glm::vec3 rayEnd    = localTransformA * glm::vec4(0,0,1, 1.0f);
+
+        // parametric values are preserved by affine transforms,
+        // so we can cast directly in mesh model space
+        const glm::mat4 invTransformB = glm::inverse(localTransformB);
+        const glm::vec3 meshRayOrigin = invTransformB * glm::vec4(rayOrigin, 1.0f);
+        const glm::vec3 meshRayEnd    = invTransformB * glm::vec4(rayEnd, 1.0f);
+
+        float rayParametricValue = 0.0f;
+        glm::vec3 faceNormal;
+        if (!mesh.intersect_segment(meshRayOrigin, meshRayEnd, rayParametricValue, faceNormal))
+        {
+            return false;
+        }
+
+        // remember closest parametric value this physics step to avoid double collision
+        // TODO: this is order dependant, so not always correct
+        if (rayParametricValue >= dataA.collider.minParametricValue)
+        {
+            return false;
+        }
+        dataA.collider.minParametricValue = rayParametricValue;
+
+        // face normal back to world space, pointing back towards the ray origin
+        collisionNormal = glm::normalize(glm::transpose(glm::inverse(glm::mat3(localTransformB))) * faceNormal);
+        if (glm::dot(collisionNormal, rayEnd - rayOrigin) > 0.0f)
+        {
+            collisionNormal = -collisionNormal;
+        }
+
+        // inline solve parametric equation
+        collisionPoint = rayOrigin + rayParametricValue * (rayEnd-rayOrigin);
+        // how far the ray end is past the surface
+        collisionDepth = glm::dot(collisionPoint - rayEnd, collisionNormal);
+        return true;
+    }
+
+    bool mesh_box_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    )
+    {
+        if (box_mesh_intersect(dataB, dataA, collisionPoint, collisionNormal, collisionDepth))
+        {
+            // collision metadata returned is relative to passed this, invert to be relative to other
+            collisionNormal *= -1.0f;
+            collisionPoint = collisionPoint + (collisionNormal * collisionDepth);
+            return true;
+        }
+        return false;
+    }
+
+    bool mesh_sphere_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    )
+    {
+        if (sphere_mesh_intersect(dataB, dataA, collisionPoint, collisionNormal, collisionDepth))
+        {
+            // collision metadata returned is relative to passed this, invert to be relative to other
+            collisionNormal *= -1.0f;
+            collisionPoint = collisionPoint + (collisionNormal * collisionDepth);
+            return true;
+        }
+        return false;
+    }
+
+    bool mesh_ray_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    )
+    {
+        if (ray_mesh_intersect(dataB, dataA, collisionPoint, collisionNormal, collisionDepth))
+        {
+            // collision metadata returned is relative to passed this, invert to be relative to other
+            collisionNormal *= -1.0f;
+            collisionPoint = collisionPoint + (collisionNormal * collisionDepth);
+            return true;
+        }
+        return false;
+    }
+
 
     // PHYSICS RESPONSE PROCEDURES
 
@@ -100,6 +100,84 @@ namespace pleep
         return glm::vec2(originProjection - radiusProjection, originProjection + radiusProjection);
     }
 
+    // return the coefficients (lengths) of the interval of a (world space) triangle's projection along an axis
+    // always returns [min,max]
+    inline glm::vec2 project_triangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& axis)
+    {
+        const float coeffA = glm::dot(a, axis);
+        const float coeffB = glm::dot(b, axis);
+        const float coeffC = glm::dot(c, axis);
+        return glm::vec2(std::min(coeffA, std::min(coeffB, coeffC)), std::max(coeffA, std::max(coeffB, coeffC)));
+    }
+
+    // return the point on triangle abc closest to p (all in the same space)
+    // (Ericson, Real-Time Collision Detection 5.1.5)
+    inline glm::vec3 closest_point_on_triangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        const glm::vec3 ab = b - a;
+        const glm::vec3 ac = c - a;
+        const glm::vec3 ap = p - a;
+        const float d1 = glm::dot(ab, ap);
+        const float d2 = glm::dot(ac, ap);
+        // vertex region a
+        if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+        const glm::vec3 bp = p - b;
+        const float d3 = glm::dot(ab, bp);
+        const float d4 = glm::dot(ac, bp);
+        // vertex region b
+        if (d3 >= 0.0f && d4 <= d3) return b;
+
+        // edge region ab
+        const float vc = d1*d4 - d3*d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            return a + ab * (d1 / (d1 - d3));
+        }
+
+        const glm::vec3 cp = p - c;
+        const float d5 = glm::dot(ab, cp);
+        const float d6 = glm::dot(ac, cp);
+        // vertex region c
+        if (d6 >= 0.0f && d5 <= d6) return c;
+
+        // edge region ac
+        const float vb = d5*d2 - d1*d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        {
+            return a + ac * (d2 / (d2 - d6));
+        }
+
+        // edge region bc
+        const float va = d3*d6 - d5*d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        {
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        // inside face region
+        const float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    // transform an axis aligned box and return the axis aligned bounds of the result
+    inline void transform_bounds(const glm::mat4& trans, const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& destMin, glm::vec3& destMax)
+    {
+        destMin = glm::vec3(INFINITY);
+        destMax = glm::vec3(-INFINITY);
+        for (int i = 0; i < 8; i++)
+        {
+            const glm::vec3 corner(
+                (i & 1) ? boundsMax.x : boundsMin.x,
+                (i & 2) ? boundsMax.y : boundsMin.y,
+                (i & 4) ? boundsMax.z : boundsMin.z
+            );
+            const glm::vec3 transformed = trans * glm::vec4(corner, 1.0f);
+            destMin = glm::min(destMin, transformed);
+            destMax = glm::max(destMax, transformed);
+        }
+    }
+
     // fill dest with all points on plane perpendicular and farthest along axis
     // Manifold must be returned in winding order around the perimeter
     // uses static manifold calibrations (shared with static_intersect)
@@ -342,6 +420,11 @@ namespace pleep
         ColliderPacket& dataB,
         glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
     );
+    bool box_mesh_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    );
     
     bool sphere_box_intersect(
         ColliderPacket& dataA,
@@ -358,6 +441,11 @@ namespace pleep
         ColliderPacket& dataB,
         glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
     );
+    bool sphere_mesh_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    );
 
     bool ray_box_intersect(
         ColliderPacket& dataA,
@@ -374,6 +462,28 @@ namespace pleep
         ColliderPacket& dataB,
         glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
     );
+    bool ray_mesh_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    );
+
+    // mesh colliders are static, so there is no mesh-mesh procedure
+    bool mesh_box_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    );
+    bool mesh_sphere_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    );
+    bool mesh_ray_intersect(
+        ColliderPacket& dataA,
+        ColliderPacket& dataB,
+        glm::vec3& collisionPoint, glm::vec3& collisionNormal, float& collisionDepth
+    );
 
 
     // PHYSICS RESPONSE PROCEDURES
@@ -407,13 +517,14 @@ namespace pleep
     using intersectionProcedure = std::function<
         bool(ColliderPacket&, ColliderPacket&, glm::vec3&, glm::vec3&, float&)
     >;
-    static_assert(ColliderType::count == static_cast<ColliderType>(4));
+    static_assert(ColliderType::count == static_cast<ColliderType>(5));
     const intersectionProcedure intersectProcedures[static_cast<size_t>(ColliderType::count)]
                                                    [static_cast<size_t>(ColliderType::count)] = {
-        {null_intersect,    null_intersect,         null_intersect,             null_intersect},
-        {null_intersect,    box_box_intersect,      box_sphere_intersect,       box_ray_intersect},
-        {null_intersect,    sphere_box_intersect,   null_intersect,             null_intersect},
-        {null_intersect,    ray_box_intersect,      null_intersect,             ray_ray_intersect}
+        {null_intersect,    null_intersect,         null_intersect,             null_intersect,         null_intersect},
+        {null_intersect,    box_box_intersect,      box_sphere_intersect,       box_ray_intersect,      box_mesh_intersect},
+        {null_intersect,    sphere_box_intersect,   null_intersect,             null_intersect,         sphere_mesh_intersect},
+        {null_intersect,    ray_box_intersect,      null_intersect,             ray_ray_intersect,      ray_mesh_intersect},
+        {null_intersect,    mesh_box_intersect,     mesh_sphere_intersect,      mesh_ray_intersect,     null_intersect}
     };
 
     // lookup table for collision physics response between different body types
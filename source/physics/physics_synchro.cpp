@@ -28,6 +28,10 @@ namespace pleep
 
         for (Entity const& entity : m_entities)
         {
+            // sleeping entities aren't integrated, so don't flag them as changed
+            if (cosmos->read_component<PhysicsComponent>(entity).isAsleep) continue;
+
+            // everything else is moved (at least by gravity)
             TransformComponent& transform = cosmos->get_component<TransformComponent>(entity);
             PhysicsComponent& physics = cosmos->get_component<PhysicsComponent>(entity);
             
@@ -73,4 +77,14 @@ namespace pleep
 
         // restore event handlers
     }
+    
+    StageAccess PhysicsSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedPhysicsDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // only reads, PhysicsDynamo modifies components through packets after all synchros
+            access.reads.set(cosmos.get_component_type<TransformComponent>());
+            access.reads.set(cosmos.get_component_type<PhysicsComponent>());
+        });
+    }
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "events/wire_codec.h"
+
 namespace pleep
 {
     // Provide baseline 3D orientation for all "spacial" entities
@@ -49,6 +51,50 @@ namespace pleep
             && lhs.orientation == rhs.orientation
             && lhs.scale == rhs.scale;
     }
+
+    // quantized: fixed point origin, smallest three orientation, scale only if non-unit
+    // (17 bytes with its packed length instead of 40)
+    template<typename T_Msg>
+    void encode_component(Message<T_Msg>& msg, const TransformComponent& data, WireEncoding encoding)
+    {
+        if (encoding != WireEncoding::quantized)
+        {
+            msg << data;
+            return;
+        }
+
+        BitWriter writer;
+        write_position(writer, data.origin);
+        write_rotation(writer, data.orientation);
+        const bool unitScale = data.scale == glm::vec3(1.0f);
+        writer.write_bool(unitScale);
+        if (!unitScale)
+        {
+            for (int i = 0; i < 3; i++) writer.write_float(data.scale[i]);
+        }
+        push_packed(msg, writer);
+    }
+    template<typename T_Msg>
+    void decode_component(Message<T_Msg>& msg, TransformComponent& data, WireEncoding encoding)
+    {
+        if (encoding != WireEncoding::quantized)
+        {
+            msg >> data;
+            return;
+        }
+
+        BitReader reader = pop_packed(msg);
+        data.origin = read_position(reader);
+        data.orientation = read_rotation(reader);
+        if (reader.read_bool())
+        {
+            data.scale = glm::vec3(1.0f);
+        }
+        else
+        {
+            for (int i = 0; i < 3; i++) data.scale[i] = reader.read_float();
+        }
+    }
 }
 
 #endif // TRANSFORM_COMPONENT_H
\ No newline at end of file
@@ -89,7 +89,7 @@ namespace pleep
         // Camera info passed from dynamo
         // ECS components are volatile, so copy in needed info
         //   (subclasses can override for more)
-        TransformComponent* m_viewTransform = nullptr;
+        const TransformComponent* m_viewTransform = nullptr;
         unsigned int m_viewWidth  = 1024;
         unsigned int m_viewHeight = 1024;
 
@@ -0,0 +1,212 @@
+#include "animation_clip.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pleep
+{
+    // resample at twice the densest channel's keyframes, so linear blending between frames
+    // stays close to interpolating the original keyframes
+    constexpr size_t ANIMATION_CLIP_FRAMES_PER_KEYFRAME = 2;
+    constexpr size_t ANIMATION_CLIP_MAX_FRAMES = 4096;
+
+    // index of the last keyframe at or before tick, and how far tick is towards the one after it
+    template<typename T_Keyframe>
+    static size_t _find_keyframe(const std::vector<T_Keyframe>& keyframes, const double tick, float& alpha)
+    {
+        alpha = 0.0f;
+        auto nextIt = std::upper_bound(keyframes.begin(), keyframes.end(), tick,
+            [](const double t, const T_Keyframe& keyframe) { return t < keyframe.timeStamp; });
+        if (nextIt == keyframes.begin()) return 0;
+
+        const size_t i = static_cast<size_t>(nextIt - keyframes.begin()) - 1;
+        if (nextIt == keyframes.end()) return i;
+
+        const double span = nextIt->timeStamp - keyframes[i].timeStamp;
+        if (span > 0.0) alpha = static_cast<float>((tick - keyframes[i].timeStamp) / span);
+        return i;
+    }
+
+    // same as translate * rotate * scale, without the matrix products
+    inline static glm::mat4 _compose_transform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        glm::mat4 transform = glm::mat4_cast(rotation);
+        transform[0] *= scale.x;
+        transform[1] *= scale.y;
+        transform[2] *= scale.z;
+        transform[3] = glm::vec4(position, 1.0f);
+        return transform;
+    }
+
+    AnimationClip::AnimationClip(const AnimationSkeletal& animation, const Armature& armature)
+        : m_duration(animation.m_duration)
+        , m_frequency(animation.m_frequency)
+        , m_boneCount(armature.m_bones.size())
+    {
+        const size_t boneCount = m_boneCount;
+        if (boneCount == 0) return;
+
+        // flatten by walking down from the root (bone 0)
+        m_order.reserve(boneCount);
+        m_parents.reserve(boneCount);
+        std::vector<std::pair<unsigned int, int>> stack = { { 0U, -1 } };
+        while (!stack.empty())
+        {
+            const std::pair<unsigned int, int> next = stack.back();
+            stack.pop_back();
+            if (next.first >= boneCount) continue;
+
+            const int position = static_cast<int>(m_order.size());
+            m_order.push_back(next.first);
+            m_parents.push_back(next.second);
+
+            const std::vector<unsigned int>& childIds = armature.m_bones[next.first].m_childIds;
+            // reversed so children are flattened in their original order
+            for (auto childIt = childIds.rbegin(); childIt != childIds.rend(); childIt++)
+            {
+                stack.push_back({ *childIt, position });
+            }
+        }
+
+        size_t maxKeyframes = 0;
+        m_tracks.reserve(m_order.size());
+        m_restTransforms.reserve(m_order.size());
+        m_bindTransforms.reserve(m_order.size());
+        for (const unsigned int boneId : m_order)
+        {
+            m_restTransforms.push_back(armature.m_bones[boneId].m_relativeTransform);
+            m_bindTransforms.push_back(armature.m_bones[boneId].m_bindTransform);
+
+            auto posIt = animation.m_posKeyframes.find(boneId);
+            auto rotIt = animation.m_rotKeyframes.find(boneId);
+            auto sclIt = animation.m_sclKeyframes.find(boneId);
+            const bool hasPos = posIt != animation.m_posKeyframes.end() && !posIt->second.empty();
+            const bool hasRot = rotIt != animation.m_rotKeyframes.end() && !rotIt->second.empty();
+            const bool hasScl = sclIt != animation.m_sclKeyframes.end() && !sclIt->second.empty();
+
+            if (!hasPos && !hasRot && !hasScl)
+            {
+                m_tracks.push_back(-1);
+                continue;
+            }
+            m_tracks.push_back(static_cast<int>(m_trackCount++));
+            if (hasPos) maxKeyframes = std::max(maxKeyframes, posIt->second.size());
+            if (hasRot) maxKeyframes = std::max(maxKeyframes, rotIt->second.size());
+            if (hasScl) maxKeyframes = std::max(maxKeyframes, sclIt->second.size());
+        }
+        if (m_trackCount == 0) return;
+
+        m_frameCount = std::min(std::max<size_t>(maxKeyframes * ANIMATION_CLIP_FRAMES_PER_KEYFRAME, 2), ANIMATION_CLIP_MAX_FRAMES);
+        m_positions.resize(m_frameCount * m_trackCount);
+        m_rotations.resize(m_frameCount * m_trackCount);
+        m_scales.resize(m_frameCount * m_trackCount);
+
+        for (size_t i = 0; i < m_order.size(); i++)
+        {
+            if (m_tracks[i] < 0) continue;
+            const size_t track = static_cast<size_t>(m_tracks[i]);
+            const unsigned int boneId = m_order[i];
+
+            // channels without keyframes contribute nothing (like an identity matrix)
+            auto posIt = animation.m_posKeyframes.find(boneId);
+            auto rotIt = animation.m_rotKeyframes.find(boneId);
+            auto sclIt = animation.m_sclKeyframes.find(boneId);
+            const std::vector<PositionKeyframe>* posKeyframes = posIt != animation.m_posKeyframes.end() && !posIt->second.empty() ? &posIt->second : nullptr;
+            const std::vector<RotationKeyframe>* rotKeyframes = rotIt != animation.m_rotKeyframes.end() && !rotIt->second.empty() ? &rotIt->second : nullptr;
+            const std::vector<ScaleKeyframe>*    sclKeyframes = sclIt != animation.m_sclKeyframes.end() && !sclIt->second.empty() ? &sclIt->second : nullptr;
+
+            for (size_t f = 0; f < m_frameCount; f++)
+            {
+                const double tick = m_duration * static_cast<double>(f) / static_cast<double>(m_frameCount - 1);
+                const size_t sample = f * m_trackCount + track;
+                float alpha;
+
+                m_positions[sample] = glm::vec3(0.0f);
+                if (posKeyframes)
+                {
+                    const size_t k = _find_keyframe(*posKeyframes, tick, alpha);
+                    const size_t kNext = std::min(k + 1, posKeyframes->size() - 1);
+                    m_positions[sample] = glm::mix((*posKeyframes)[k].position, (*posKeyframes)[kNext].position, alpha);
+                }
+
+                m_rotations[sample] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+                if (rotKeyframes)
+                {
+                    const size_t k = _find_keyframe(*rotKeyframes, tick, alpha);
+                    const size_t kNext = std::min(k + 1, rotKeyframes->size() - 1);
+                    m_rotations[sample] = glm::normalize(glm::slerp((*rotKeyframes)[k].orientation, (*rotKeyframes)[kNext].orientation, alpha));
+                }
+                // keep adjacent frames in the same hemisphere
+                if (f > 0 && glm::dot(m_rotations[sample - m_trackCount], m_rotations[sample]) < 0.0f)
+                {
+                    m_rotations[sample] = -m_rotations[sample];
+                }
+
+                m_scales[sample] = glm::vec3(1.0f);
+                if (sclKeyframes)
+                {
+                    const size_t k = _find_keyframe(*sclKeyframes, tick, alpha);
+                    const size_t kNext = std::min(k + 1, sclKeyframes->size() - 1);
+                    m_scales[sample] = glm::mix((*sclKeyframes)[k].scale, (*sclKeyframes)[kNext].scale, alpha);
+                }
+            }
+        }
+    }
+
+    void AnimationClip::evaluate(std::vector<glm::mat4>& pose, const double elapsedTime) const
+    {
+        if (m_duration <= 0 || pose.size() < m_boneCount) return;
+
+        // locate the two frames around elapsedTime
+        size_t frame = 0;
+        float alpha = 0.0f;
+        if (m_frameCount >= 2)
+        {
+            double tick = std::fmod(elapsedTime * m_frequency, m_duration);
+            if (tick < 0.0) tick += m_duration;
+            const double framePosition = tick / m_duration * static_cast<double>(m_frameCount - 1);
+            frame = std::min(static_cast<size_t>(framePosition), m_frameCount - 2);
+            alpha = static_cast<float>(framePosition - static_cast<double>(frame));
+        }
+
+        // blend tracks of both (contiguous) frames into each animated bone's relative transform
+        // (pose is used as scratch space until the passes below)
+        const glm::vec3* positions0 = m_positions.data() + frame * m_trackCount;
+        const glm::quat* rotations0 = m_rotations.data() + frame * m_trackCount;
+        const glm::vec3* scales0    = m_scales.data()    + frame * m_trackCount;
+        const glm::vec3* positions1 = positions0 + m_trackCount;
+        const glm::quat* rotations1 = rotations0 + m_trackCount;
+        const glm::vec3* scales1    = scales0    + m_trackCount;
+        const float beta = 1.0f - alpha;
+        for (size_t i = 0; i < m_order.size(); i++)
+        {
+            const int track = m_tracks[i];
+            if (track < 0) continue;
+
+            // frames are dense and in the same hemisphere, so a normalized lerp is close enough to slerp
+            const glm::quat rotation = glm::normalize(rotations0[track] * beta + rotations1[track] * alpha);
+            pose[m_order[i]] = _compose_transform(
+                positions0[track] * beta + positions1[track] * alpha,
+                rotation,
+                scales0[track] * beta + scales1[track] * alpha
+            );
+        }
+
+        // compose onto parents (already posed, being earlier in the order) to get model space
+        for (size_t i = 0; i < m_order.size(); i++)
+        {
+            glm::mat4& transform = pose[m_order[i]];
+            const glm::mat4 relative = m_tracks[i] < 0 ? m_restTransforms[i] : transform;
+            transform = m_parents[i] < 0
+                ? relative
+                : pose[m_order[m_parents[i]]] * relative;
+        }
+
+        // and finally from model space into each bone's (inverse bind) space
+        for (size_t i = 0; i < m_order.size(); i++)
+        {
+            glm::mat4& transform = pose[m_order[i]];
+            transform = transform * m_bindTransforms[i];
+        }
+    }
+}
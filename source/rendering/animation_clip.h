@@ -0,0 +1,61 @@
+#ifndef ANIMATION_CLIP_H
+#define ANIMATION_CLIP_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "rendering/armature.h"
+#include "rendering/animation_skeletal.h"
+
+namespace pleep
+{
+    // An AnimationSkeletal baked for one armature's hierarchy, so posing is a straight pass over flat arrays:
+    // bones are flattened parent-before-child, and each animated bone's position/rotation/scale keyframes
+    // are resampled at a fixed rate into frames of contiguous tracks (in flattened bone order).
+    // Evaluating blends two adjacent frames (with interpolation) and composes each bone onto its
+    // already posed parent, instead of crawling the bone tree and searching keyframe maps.
+    class AnimationClip
+    {
+    public:
+        // resample animation's keyframes for armature's bones
+        AnimationClip(const AnimationSkeletal& animation, const Armature& armature);
+        ~AnimationClip() = default;
+
+        // bones in the armature this clip was baked for (size of poses it evaluates)
+        size_t get_bone_count() const { return m_boneCount; }
+
+        // set every bone's transform (model space * inverse bind) in pose (indexed by bone id)
+        // at elapsedTime (seconds, looping)
+        void evaluate(std::vector<glm::mat4>& pose, const double elapsedTime) const;
+
+    private:
+        double m_duration = 0.0;  // in units of "ticks"
+        double m_frequency = 0.0; // "ticks" per second
+        // frames evenly spaced over [0, m_duration], at least 2 if there are any tracks
+        size_t m_frameCount = 0;
+
+        // flattened hierarchy: bone ids in parent-before-child order
+        std::vector<unsigned int> m_order;
+        // position (in m_order) of each flattened bone's parent, -1 for root
+        std::vector<int> m_parents;
+        // track of each flattened bone, -1 if it isn't animated (and uses its rest transform)
+        std::vector<int> m_tracks;
+        size_t m_boneCount = 0;
+        // relative transform of each flattened bone (for those without tracks)
+        std::vector<glm::mat4> m_restTransforms;
+        // inverse bind transform of each flattened bone
+        std::vector<glm::mat4> m_bindTransforms;
+
+        // frame f of track t is at [f * m_trackCount + t]
+        size_t m_trackCount = 0;
+        std::vector<glm::vec3> m_positions;
+        // adjacent frames are in the same hemisphere, so blending them needs no sign check
+        std::vector<glm::quat> m_rotations;
+        std::vector<glm::vec3> m_scales;
+    };
+}
+
+#endif // ANIMATION_CLIP_H
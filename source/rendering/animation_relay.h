@@ -2,10 +2,19 @@
 #define ANIMATION_RELAY_H
 
 //#include "intercession_pch.h"
+#include <map>
+#include <memory>
+#include <algorithm>
+
 #include "rendering/animation_packet.h"
+#include "rendering/animation_clip.h"
+#include "core/stage_scheduler.h"
 
 namespace pleep
 {
+    // fewest packets worth handing to another thread
+    constexpr size_t ANIMATION_RELAY_MIN_PACKETS_PER_STAGE = 16;
+
     // Not inheriting from A_RenderRelay because it doesn't really have the same fingerprint
     class AnimationRelay
     {
@@ -19,13 +28,26 @@ namespace pleep
             // for each armature, update all its bones using deltaTime
             // What about dynamic animations? based on walking distance/speed for example?
             // some sort of event based system to connect biped behaviours and animations?
+            m_poses.clear();
             for (std::vector<AnimationPacket>::iterator packet_it = m_animationPackets.begin(); packet_it != m_animationPackets.end(); packet_it++)
             {
                 AnimationPacket& data = *packet_it;
 
+                if (data.renderable.armature == nullptr)
+                {
+                    data.renderable.pose.clear();
+                    continue;
+                }
+                // armature may have been set without deserializing (like by a cosmos builder)
+                if (data.renderable.pose.size() != data.renderable.armature->m_bones.size())
+                {
+                    data.renderable.pose.resize(data.renderable.armature->m_bones.size());
+                    clear_bones_transform(data.renderable.pose);
+                }
+
                 if (data.animatable.m_currentAnimation == "")
                 {
-                    clear_bones_transform(data.renderable.armature.m_bones);
+                    clear_bones_transform(data.renderable.pose);
                     continue;
                 }
 
@@ -36,90 +58,80 @@ namespace pleep
                     data.animatable.m_currentAnimation = "";
                     continue;
                 }
+                if (!animation_it->second) continue;
 
                 // step time forwards
                 // TODO: we want this to be tied to behaviour script (for velocity based animation)
                 //data.animatable.m_currentTime += deltaTime;
 
-                // PLEEPLOG_DEBUG("Animating " + data.animatable.m_currentAnimation + " on armature " + data.renderable.armature.m_name + " with bones: " + std::to_string(data.renderable.armature.m_bones.size()));
+                // PLEEPLOG_DEBUG("Animating " + data.animatable.m_currentAnimation + " on armature " + data.renderable.armature->m_name + " with bones: " + std::to_string(data.renderable.armature->m_bones.size()));
 
-                // Need to compose transform recursively starting from root bone...?
-                calculate_bones_transform(
-                    data.renderable.armature,
-                    data.animatable.animations[data.animatable.m_currentAnimation],
-                    0,  // boneIndex 0 should be root of armature
-                    glm::mat4(1.0f),//data.renderable.armature.m_relativeTransform,//
+                // clips are resolved here (serially) so evaluation below only reads the cache
+                m_poses.push_back({
+                    &data.renderable.pose,
+                    &get_clip(animation_it->second, data.renderable.armature),
                     data.animatable.m_currentTime
-                );
-
-                // PLEEPLOG_DEBUG("Done animation");
+                });
             }
-        }
 
-        // recursive tree crawl to set all bones
-        void calculate_bones_transform(Armature& armature, std::shared_ptr<const AnimationSkeletal> animation, const unsigned int boneIndex, glm::mat4 parentTransform, const double elapsedTime)
-        {
-            if (animation->m_duration <= 0) return;
-            const double currentTick = elapsedTime * animation->m_frequency;
-            const double progress = fmod(currentTick / animation->m_duration, 1.0);
-            
-            // for non-animated bones use relative transform
-            glm::mat4 interpolatedTransform = armature.m_bones[boneIndex].m_relativeTransform;
-            
-            // for animated bones OVERRIDE with keyframe position using elapsed time
-            if (animation->m_posKeyframes.count(boneIndex) || 
-                animation->m_rotKeyframes.count(boneIndex) || 
-                animation->m_sclKeyframes.count(boneIndex))
+            // each pose only writes its own entity's buffer, so split them evenly across threads
+            const size_t stageCount = std::min(
+                StageScheduler::get_worker_count() + 1,
+                m_poses.size() / ANIMATION_RELAY_MIN_PACKETS_PER_STAGE
+            );
+            if (stageCount <= 1)
             {
-                glm::mat4 translate(1.0f);
-                glm::mat4 rotate(1.0f);
-                glm::mat4 scale(1.0f);
-
-                if (animation->m_posKeyframes.count(boneIndex))
-                {
-                    size_t posFrame = static_cast<size_t>(progress * animation->m_posKeyframes.at(boneIndex).size());
-                    translate = glm::translate(glm::mat4(1.0f), animation->m_posKeyframes.at(boneIndex).at(posFrame).position);
-                }
-
-                if (animation->m_rotKeyframes.count(boneIndex))
-                {
-                    size_t rotFrame = static_cast<size_t>(progress * animation->m_rotKeyframes.at(boneIndex).size());
-                    //PLEEPLOG_DEBUG("Animation frame: " + std::to_string(rotFrame));
-                    //const glm::quat key = animation->m_rotKeyframes.at(boneIndex).at(rotFrame).orientation;
-                    //PLEEPLOG_DEBUG(std::to_string(key.x) + ", " + std::to_string(key.y) + ", " + std::to_string(key.z) + ", " + std::to_string(key.w));
-                    rotate = glm::toMat4(glm::normalize(animation->m_rotKeyframes.at(boneIndex).at(rotFrame).orientation));
-                }
+                evaluate_poses(0, m_poses.size());
+                return;
+            }
 
-                if (animation->m_sclKeyframes.count(boneIndex))
+            StageAccess access;
+            access.exclusive = false;
+            m_scheduler.clear_stages();
+            for (size_t s = 0; s < stageCount; s++)
+            {
+                const size_t begin = m_poses.size() * s / stageCount;
+                const size_t end = m_poses.size() * (s + 1) / stageCount;
+                m_scheduler.add_stage("AnimationRelay::evaluate_poses", access, [this, begin, end]()
                 {
-                    size_t sclFrame = static_cast<size_t>(progress * animation->m_sclKeyframes.at(boneIndex).size());
-                    scale = glm::scale(glm::mat4(1.0f), animation->m_sclKeyframes.at(boneIndex).at(sclFrame).scale);
-                }
-            
-                //PLEEPLOG_DEBUG("Bone " + armature.m_bones[boneIndex].m_name + " is animated");
-                interpolatedTransform = translate * rotate * scale;
+                    evaluate_poses(begin, end);
+                });
             }
+            m_scheduler.run();
 
-            // calculate transform for this "node"
-            const glm::mat4 globalTransform = parentTransform * interpolatedTransform;
-
-            // set bone's cached transform using parent & keyframe (and inverse bind)
-            armature.m_bones[boneIndex].m_localTransform = globalTransform * armature.m_bones[boneIndex].m_bindTransform;
+            // PLEEPLOG_DEBUG("Done animation");
+        }
 
-            // pass onto children
-            for (unsigned int childId : armature.m_bones[boneIndex].m_childIds)
+        // baked clip of animation for armature's hierarchy (built the first time it is needed)
+        // armatures are shared and immutable, so there is one clip per animation per skeleton
+        const AnimationClip& get_clip(std::shared_ptr<const AnimationSkeletal> animation, std::shared_ptr<const Armature> armature)
+        {
+            auto clip_it = m_clips.find({ animation.get(), armature.get() });
+            if (clip_it != m_clips.end())
             {
-                calculate_bones_transform(armature, animation, childId, globalTransform, elapsedTime);
+                return *clip_it->second.clip;
             }
+
+            // keep both alive while cached, so their addresses can't be reused by others
+            CachedClip& cached = m_clips[{ animation.get(), armature.get() }];
+            cached.animation = animation;
+            cached.armature = armature;
+            cached.clip = std::make_unique<AnimationClip>(*animation, *armature);
+            return *cached.clip;
         }
 
-        void clear_bones_transform(std::vector<Bone>& bones)
+        void evaluate_poses(const size_t begin, const size_t end) const
         {
-            for (Bone& bone : bones)
+            for (size_t p = begin; p < end; p++)
             {
-                bone.m_localTransform = glm::mat4(1.0f);
+                m_poses[p].clip->evaluate(*m_poses[p].pose, m_poses[p].elapsedTime);
             }
         }
+
+        void clear_bones_transform(std::vector<glm::mat4>& pose)
+        {
+            std::fill(pose.begin(), pose.end(), glm::mat4(1.0f));
+        }
         
         void clear()
         {
@@ -133,7 +145,27 @@ namespace pleep
 
     private:
         std::vector<AnimationPacket> m_animationPackets;
+
+        struct CachedClip
+        {
+            std::shared_ptr<const AnimationSkeletal> animation;
+            std::shared_ptr<const Armature> armature;
+            std::unique_ptr<AnimationClip> clip;
+        };
+        // clips by animation and the armature they were baked for
+        std::map<std::pair<const AnimationSkeletal*, const Armature*>, CachedClip> m_clips;
+
+        // entity poses to be evaluated this engage
+        struct Pose
+        {
+            std::vector<glm::mat4>* pose;
+            const AnimationClip* clip;
+            double elapsedTime;
+        };
+        std::vector<Pose> m_poses;
+
+        StageScheduler m_scheduler;
     };
 }
 
-#endif // ANIMATION_RELAY_H
\ No newline at end of file
+#endif // ANIMATION_RELAY_H
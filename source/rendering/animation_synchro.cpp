@@ -38,8 +38,9 @@ namespace pleep
         // I should implicitly know my signature and therefore what components i can fetch
         for (Entity const& entity : m_entities)
         {
-            RenderableComponent& renderable = cosmos->get_component<RenderableComponent>(entity);
-            AnimationComponent& animatable = cosmos->get_component<AnimationComponent>(entity);
+            // animation relay only writes the pose, which is never replicated
+            RenderableComponent& renderable = cosmos->get_component_unmarked<RenderableComponent>(entity);
+            AnimationComponent& animatable = cosmos->get_component_unmarked<AnimationComponent>(entity);
 
             m_attachedRenderDynamo->submit(AnimationPacket{ renderable, animatable });
         }
@@ -84,4 +85,14 @@ namespace pleep
 
         // ...
     }
+    
+    StageAccess AnimationSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedRenderDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // only reads, RenderDynamo animates through packets after all synchros
+            access.reads.set(cosmos.get_component_type<RenderableComponent>());
+            access.reads.set(cosmos.get_component_type<AnimationComponent>());
+        });
+    }
 }
\ No newline at end of file
@@ -6,14 +6,15 @@
 #include <unordered_map>
 
 #include "rendering/bone.h"
-#include "events/message.h"
 
 namespace pleep
 {
     // Should match vertex shaders array max
     #define MAX_BONES 64
 
-    // A collection of bones
+    // A collection of bones (the skeleton definition)
+    // Armatures are immutable once cached and shared by every entity using them,
+    // each entity's current bone transforms are its own RenderableComponent::pose
     class Armature
     {
     public:
@@ -30,45 +31,6 @@ namespace pleep
         // Filepath this armature was imported from
         std::string m_sourceFilepath;
     };
-
-    
-    template<typename T_Msg>
-    Message<T_Msg>& operator<<(Message<T_Msg>& msg, const Armature& data)
-    {
-        // REMEMBER this is a STACK so reverse the order!!!
-
-        msg << data.m_sourceFilepath;
-        msg << data.m_name;
-
-        return msg;
-    }
-    template<typename T_Msg>
-    Message<T_Msg>& operator>>(Message<T_Msg>& msg, Armature& data)
-    {
-        // only write data if name has changed.
-        // if so fetch from ModelCache instead of deserializing?
-
-        std::string newName;
-        msg >> newName;
-
-        std::string newSource;
-        msg >> newSource;
-
-        if (data.m_name != newName)
-        {
-            // try to import armature...
-            data = ModelCache::fetch_armature(newName);
-            // check if succeeded
-            if (data.m_name != newName)
-            {
-                ModelCache::import(newSource);
-                // try again?
-                data = ModelCache::fetch_armature(newName);
-            }
-        }
-
-        return msg;
-    }
 }
 
 #endif // ARMATURE_H
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "asset_import_pool.h"
+
+#include <exception>
+
+#include "logging/pleep_log.h"
+
+namespace pleep
+{
+    AssetImportPool::AssetImportPool(size_t workerCount)
+    {
+        m_workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            m_workers.emplace_back(&AssetImportPool::_work, this);
+        }
+    }
+
+    AssetImportPool::~AssetImportPool()
+    {
+        {
+            std::lock_guard<std::mutex> jobsLock(m_jobsMutex);
+            m_shutdown = true;
+            m_jobs.clear();
+        }
+        m_jobsCondition.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void AssetImportPool::submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> jobsLock(m_jobsMutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_jobsCondition.notify_one();
+    }
+
+    void AssetImportPool::_work()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> jobsLock(m_jobsMutex);
+                m_jobsCondition.wait(jobsLock, [this]() { return m_shutdown || !m_jobs.empty(); });
+                if (m_shutdown) return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            // a bad file must not take down the worker
+            try
+            {
+                job();
+            }
+            catch (const std::exception& e)
+            {
+                PLEEPLOG_ERROR("Asset import job threw: " + std::string(e.what()));
+            }
+        }
+    }
+}
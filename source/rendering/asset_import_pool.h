@@ -0,0 +1,42 @@
+#ifndef ASSET_IMPORT_POOL_H
+#define ASSET_IMPORT_POOL_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace pleep
+{
+    // Threads which run asset import jobs (file io, parsing, image decoding) in submission order
+    // Separate from the StageScheduler's workers so a long parse never holds up a cosmos update
+    // Jobs must not make gpu calls or touch ModelManager's caches
+    class AssetImportPool
+    {
+    public:
+        explicit AssetImportPool(size_t workerCount);
+        // waits for running jobs to finish, jobs not yet started are dropped
+        // (without running, so whoever submitted them must fail anything waiting on them)
+        ~AssetImportPool();
+        AssetImportPool(const AssetImportPool&) = delete;
+        AssetImportPool& operator=(const AssetImportPool&) = delete;
+
+        void submit(std::function<void()> job);
+
+        size_t size() const { return m_workers.size(); }
+
+    private:
+        void _work();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_jobs;
+        std::mutex m_jobsMutex;
+        std::condition_variable m_jobsCondition;
+        bool m_shutdown = false;
+    };
+}
+
+#endif // ASSET_IMPORT_POOL_H
@@ -24,12 +24,9 @@ namespace pleep
             , m_relativeTransform(relativeTransform)
         {}
         ~Bone() = default;
-        
-        // the current transform position/orientation of this bone (modified by AnimationSkeletal)
-        glm::mat4 m_localTransform = glm::mat4(1.0f);
 
-
-        // "const" members set at import time:
+        // "const" members set at import time
+        // (current transforms are per entity, see RenderableComponent::pose):
 
         // transform relative to this node's parent
         glm::mat4 m_relativeTransform = glm::mat4(1.0f);
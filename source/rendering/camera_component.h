@@ -45,7 +45,7 @@ namespace pleep
 
     // Helper function for camera use
     // use camera entity's transform and camera data to build world_to_view transform
-    inline glm::mat4 get_lookAt(TransformComponent& trans, CameraComponent& cam)
+    inline glm::mat4 get_lookAt(const TransformComponent& trans, const CameraComponent& cam)
     {
         // recalculate direction vector each time since transform component only stores euler angles (in radians)
         glm::vec3 direction = trans.get_heading();
@@ -55,7 +55,7 @@ namespace pleep
 
     // Helper function for camera use
     // use camera entity's camera data to get projection matrix (view_to_screen)
-    inline glm::mat4 get_projection(CameraComponent& cam)
+    inline glm::mat4 get_projection(const CameraComponent& cam)
     {
         switch(cam.projectionType)
         {
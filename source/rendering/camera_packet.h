@@ -14,8 +14,8 @@ namespace pleep
     //   or smart pointers so that they can live beyond entity for the frame duration
     struct CameraPacket
     {
-        TransformComponent& transform;
-        CameraComponent& camera;
+        const TransformComponent& transform;
+        const CameraComponent& camera;
     };
 }
 
@@ -16,6 +16,8 @@ namespace pleep
         Entity entity;
         glm::mat4 transform;
         ModelManager::BasicMeshType meshType;
+        // drawn instead of meshType if set (for mesh colliders)
+        std::shared_ptr<const Mesh> mesh;
     };
 }
 
@@ -0,0 +1,44 @@
+#include "draw_list.h"
+
+#include <algorithm>
+
+namespace pleep
+{
+    // ranks past this share the last one (only costs state changes, not correctness)
+    constexpr uint32_t DRAW_LIST_MAX_RANK = (1U << 24) - 1;
+
+    void DrawList::clear()
+    {
+        m_draws.clear();
+        m_materialRanks.clear();
+        m_meshRanks.clear();
+    }
+
+    void DrawList::add(uint16_t shader, const void* material, const void* mesh, uint32_t sourceIndex, uint32_t subIndex)
+    {
+        const uint64_t key = (static_cast<uint64_t>(shader) << 48)
+            | (_rank(m_materialRanks, material) << 24)
+            | _rank(m_meshRanks, mesh);
+        m_draws.push_back(Draw{ key, material, mesh, sourceIndex, subIndex });
+    }
+
+    void DrawList::sort()
+    {
+        std::sort(m_draws.begin(), m_draws.end(), [](const Draw& a, const Draw& b)
+        {
+            if (a.key != b.key) return a.key < b.key;
+            if (a.sourceIndex != b.sourceIndex) return a.sourceIndex < b.sourceIndex;
+            return a.subIndex < b.subIndex;
+        });
+    }
+
+    uint64_t DrawList::_rank(std::unordered_map<const void*, uint32_t>& ranks, const void* ptr)
+    {
+        auto rankIt = ranks.find(ptr);
+        if (rankIt != ranks.end()) return rankIt->second;
+
+        const uint32_t rank = static_cast<uint32_t>(std::min<size_t>(ranks.size(), DRAW_LIST_MAX_RANK));
+        ranks.emplace(ptr, rank);
+        return rank;
+    }
+}
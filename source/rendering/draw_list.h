@@ -0,0 +1,55 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace pleep
+{
+    // Orders a frame's draws by a sort key (shader, then material, then mesh)
+    // so consecutive draws share as much gl state as possible, and runs of the same mesh
+    // and material are adjacent (ready to be instanced).
+    // Draws only reference their state by pointer and their source by index, so building
+    // and sorting needs no gl context and can be tested and timed headless
+    class DrawList
+    {
+    public:
+        struct Draw
+        {
+            // shader (16 bits) | material rank (24 bits) | mesh rank (24 bits)
+            uint64_t key;
+            const void* material;
+            const void* mesh;
+            // for the caller to find what to draw (like its packet and mesh within the packet)
+            uint32_t sourceIndex;
+            uint32_t subIndex;
+        };
+
+        DrawList() = default;
+        ~DrawList() = default;
+
+        // forget all draws (keeps allocations)
+        void clear();
+
+        // material may be nullptr (drawn with default textures)
+        void add(uint16_t shader, const void* material, const void* mesh, uint32_t sourceIndex, uint32_t subIndex);
+
+        // sort by key, ties keep source order so output is deterministic
+        void sort();
+
+        const std::vector<Draw>& get_draws() const { return m_draws; }
+
+    private:
+        // materials and meshes are ranked in the order they're first added,
+        // so draw order doesn't depend on where assets happen to be allocated
+        static uint64_t _rank(std::unordered_map<const void*, uint32_t>& ranks, const void* ptr);
+
+        std::vector<Draw> m_draws;
+        std::unordered_map<const void*, uint32_t> m_materialRanks;
+        std::unordered_map<const void*, uint32_t> m_meshRanks;
+    };
+}
+
+#endif // DRAW_LIST_H
@@ -9,6 +9,7 @@
 #include "rendering/render_packet.h"
 #include "rendering/light_source_packet.h"
 #include "rendering/model_cache.h"
+#include "rendering/draw_list.h"
 
 #define RENDER_COLLIDERS
 #define RENDER_MESHES
@@ -172,7 +173,7 @@ namespace pleep
             m_numSpotLights = 0;
             for (std::vector<LightSourcePacket>::iterator packet_it = m_lightSourcePackets.begin(); packet_it != m_lightSourcePackets.end(); packet_it++)
             {
-                LightSourcePacket& data = *packet_it;
+                const LightSourcePacket& data = *packet_it;
                 std::string lightUni;
 
                 switch(data.light.type)
@@ -224,42 +225,52 @@ namespace pleep
             m_sm.set_int("numSpotLights", static_cast<int>(m_numSpotLights));
             m_sm.deactivate();
 #ifdef RENDER_MESHES
-            // Render through all meshes
-            for (std::vector<RenderPacket>::iterator packet_it = m_modelPackets.begin(); packet_it != m_modelPackets.end(); packet_it++)
+            // collect every mesh to draw, then sort so draws sharing a material (and mesh) are adjacent
+            m_drawList.clear();
+            for (size_t p = 0; p < m_modelPackets.size(); p++)
             {
-                RenderPacket& data = *packet_it;
-
-                // check nullptr
-                if (data.renderable.meshData.empty()) continue;
-
-                m_sm.activate();
-
-                // pass in all associated bones:
-                for (int i = 0; i < MAX_BONES && i < data.renderable.armature.m_bones.size(); i++)
+                const RenderableComponent& renderable = m_modelPackets[p].renderable;
+                for (size_t i = 0; i < renderable.meshData.size(); i++)
                 {
-                    m_sm.set_mat4("final_bone_matrices[" + std::to_string(i) + "]", data.renderable.armature.m_bones[i].m_localTransform);
+                    if (renderable.meshData[i] == nullptr) continue;
+                    const Material* material = _get_mesh_material(renderable, i).get();
+                    m_drawList.add(0, material, renderable.meshData[i].get(), static_cast<uint32_t>(p), static_cast<uint32_t>(i));
                 }
+            }
+            m_drawList.sort();
+
+            // Render through all meshes, only setting uniforms when the packet or material changes
+            m_sm.activate();
+            size_t lastPacket = m_modelPackets.size();
+            const void* lastMaterial = nullptr;
+            bool isMaterialSet = false;
+            for (const DrawList::Draw& draw : m_drawList.get_draws())
+            {
+                const RenderPacket& data = m_modelPackets[draw.sourceIndex];
 
-                m_sm.set_mat4("model_to_world", data.transform.get_model_transform() * data.renderable.localTransform.get_model_transform());
-                for (unsigned int i = 0; i < data.renderable.meshData.size(); i++)
+                if (draw.sourceIndex != lastPacket)
                 {
-                    // if there are no materials... do nothing? get debug material from ModelCache?
-                    // TEMP: "highlight" will make it blackout (no materials)
-                    if (data.renderable.materials.empty() || data.renderable.highlight)
-                    {
-                        _set_material_textures(m_sm, nullptr);
-                    }
-                    else
+                    lastPacket = draw.sourceIndex;
+
+                    // pass in all associated bones:
+                    for (int i = 0; i < MAX_BONES && i < data.renderable.pose.size(); i++)
                     {
-                        // if there aren't enough materials for all meshes,
-                        // the un-paired meshes will use the last-most material
-                        _set_material_textures(m_sm, data.renderable.materials[i < data.renderable.materials.size() ? i : (data.renderable.materials.size() - 1)]);
+                        m_sm.set_mat4("final_bone_matrices[" + std::to_string(i) + "]", data.renderable.pose[i]);
                     }
-                    
-                    data.renderable.meshData[i]->invoke_draw(m_sm);
+
+                    m_sm.set_mat4("model_to_world", data.transform.get_model_transform() * data.renderable.localTransform.get_model_transform());
                 }
-                m_sm.deactivate();
+
+                if (!isMaterialSet || draw.material != lastMaterial)
+                {
+                    _set_material_textures(m_sm, _get_mesh_material(data.renderable, draw.subIndex));
+                    lastMaterial = draw.material;
+                    isMaterialSet = true;
+                }
+
+                data.renderable.meshData[draw.subIndex]->invoke_draw(m_sm);
             }
+            m_sm.deactivate();
 #endif // RENDER_MESHES
 #ifdef RENDER_COLLIDERS
             // render debug packets
@@ -272,11 +283,11 @@ namespace pleep
                 
                 glPolygonMode( GL_FRONT_AND_BACK, GL_LINE);
 
-                std::shared_ptr<const Mesh> colliderMesh = ModelCache::fetch_mesh(data.meshType);
+                std::shared_ptr<const Mesh> colliderMesh = data.mesh ? data.mesh : ModelCache::fetch_mesh(data.meshType);
                 // material?
                 _set_material_textures(m_sm, nullptr);
 
-                colliderMesh->invoke_draw(m_sm);
+                if (colliderMesh) colliderMesh->invoke_draw(m_sm);
                 
                 glPolygonMode( GL_FRONT_AND_BACK, GL_FILL);
                 m_sm.deactivate();
@@ -342,6 +353,21 @@ namespace pleep
         std::vector<DebugRenderPacket> m_debugPackets;
         std::vector<LightSourcePacket> m_lightSourcePackets;
 
+        // reused each frame for mesh draw order
+        DrawList m_drawList;
+
+        // material to draw mesh meshIndex of renderable with
+        std::shared_ptr<const Material> _get_mesh_material(const RenderableComponent& renderable, size_t meshIndex)
+        {
+            // if there are no materials... do nothing? get debug material from ModelCache?
+            // TEMP: "highlight" will make it blackout (no materials)
+            if (renderable.materials.empty() || renderable.highlight) return nullptr;
+
+            // if there aren't enough materials for all meshes,
+            // the un-paired meshes will use the last-most material
+            return renderable.materials[meshIndex < renderable.materials.size() ? meshIndex : (renderable.materials.size() - 1)];
+        }
+
         void _set_material_textures(ShaderManager& sm, std::shared_ptr<const Material> material)
         {
             // new materials only have 1 of each texture type!
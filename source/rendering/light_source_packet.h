@@ -14,8 +14,9 @@ namespace pleep
     //   or smart pointers so that they can live beyond entity for the frame duration
     struct LightSourcePacket
     {
-        TransformComponent& transform;
-        LightSourceComponent& light;
+        // only read by relays
+        const TransformComponent& transform;
+        const LightSourceComponent& light;
     };
 }
 
@@ -30,8 +30,8 @@ namespace pleep
         // feed components of m_entities to attached RenderDynamo
         for (Entity const& entity : m_entities)
         {
-            TransformComponent& transform = cosmos->get_component<TransformComponent>(entity);
-            LightSourceComponent& light = cosmos->get_component<LightSourceComponent>(entity);
+            const TransformComponent& transform = cosmos->read_component<TransformComponent>(entity);
+            const LightSourceComponent& light = cosmos->read_component<LightSourceComponent>(entity);
 
             m_attachedRenderDynamo->submit(LightSourcePacket{ transform, light });
         }
@@ -74,4 +74,14 @@ namespace pleep
     {
         m_attachedRenderDynamo = contextDynamo;
     }
+    
+    StageAccess LightingSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedRenderDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // shares RenderDynamo with RenderSynchro, so stays ordered before it
+            access.reads.set(cosmos.get_component_type<TransformComponent>());
+            access.reads.set(cosmos.get_component_type<LightSourceComponent>());
+        });
+    }
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 //#include "intercession_pch.h"
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 
 #include "rendering/texture.h"
@@ -31,15 +33,41 @@ namespace pleep
         {}
         ~Material() = default;
 
+        // Copy source filepaths of each texture type
+        // (safe from any thread, while a placeholder may be filled on the gl thread)
+        std::unordered_map<TextureType, std::string> get_texture_sources() const
+        {
+            std::lock_guard<std::mutex> texturesLock(m_texturesMutex);
+            std::unordered_map<TextureType, std::string> sources;
+            for (const auto& texture : m_textures)
+            {
+                sources.insert({ texture.first, texture.second.get_source_filepath() });
+            }
+            return sources;
+        }
+
+        // Take textures for filling a placeholder Material in place once its asset has been imported
+        // (only on the gl thread)
+        void fill_textures(std::unordered_map<TextureType, Texture>&& movedTextures)
+        {
+            std::lock_guard<std::mutex> texturesLock(m_texturesMutex);
+            m_textures = std::move(movedTextures);
+        }
+
         // only 1 texture per type? every type represented?
         // map of textureType to Texture:
         // no entry implies null texture (0)
+        // only read directly on the gl thread (the only thread which fills it), otherwise use get_texture_sources
         std::unordered_map<TextureType, Texture> m_textures;
 
         // Name given for this material
         std::string m_name = "";
         // Filename this material was imported from
         std::string m_sourceFilepath = "";
+
+    private:
+        // guards m_textures while a placeholder is filled
+        mutable std::mutex m_texturesMutex;
     };
 }
 
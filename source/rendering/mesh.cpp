@@ -1,13 +1,24 @@
 #include "mesh.h"
 
+#include <utility>
+
 #include "logging/pleep_log.h"
 
 namespace pleep
 {
-    Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
         : m_vertices(vertices)
         , m_indices(indices)
     {
+        if (!m_vertices.empty())
+        {
+            m_boundsMin = m_boundsMax = m_vertices.front().position;
+            for (const Vertex& vertex : m_vertices)
+            {
+                m_boundsMin = glm::min(m_boundsMin, vertex.position);
+                m_boundsMax = glm::max(m_boundsMax, vertex.position);
+            }
+        }
         _setup();
     }
 
@@ -21,6 +32,30 @@ namespace pleep
         glDeleteBuffers(1, &EBO_ID);
     }
 
+    void Mesh::swap_data(Mesh& other)
+    {
+        std::swap(m_vertices, other.m_vertices);
+        std::swap(m_indices, other.m_indices);
+        {
+            std::lock(m_boundsMutex, other.m_boundsMutex);
+            std::lock_guard<std::mutex> boundsLock(m_boundsMutex, std::adopt_lock);
+            std::lock_guard<std::mutex> otherBoundsLock(other.m_boundsMutex, std::adopt_lock);
+            std::swap(m_boundsMin, other.m_boundsMin);
+            std::swap(m_boundsMax, other.m_boundsMax);
+        }
+        std::swap(VAO_ID, other.VAO_ID);
+        std::swap(VBO_ID, other.VBO_ID);
+        std::swap(EBO_ID, other.EBO_ID);
+        std::swap(m_isGlSetup, other.m_isGlSetup);
+    }
+
+    void Mesh::read_bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const
+    {
+        std::lock_guard<std::mutex> boundsLock(m_boundsMutex);
+        boundsMin = m_boundsMin;
+        boundsMax = m_boundsMax;
+    }
+
     void Mesh::_setup()
     {
         glGenVertexArrays(1, &VAO_ID);
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <mutex>
 
 #include <glad/glad.h>
 #define GLM_FORCE_SILENT_WARNINGS
@@ -69,7 +70,7 @@ namespace pleep
         // Init Mesh with no gpu data
         Mesh() = default;
         // Allocate gpu buffers with these vertices and indices
-        Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+        Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
         // copying a Mesh would mean GPU memory could be freed by the copy
         Mesh(const Mesh&) = delete;
         // Clear my GPU memory from _setup!
@@ -81,10 +82,19 @@ namespace pleep
         void invoke_draw(ShaderManager& sm) const;
         void invoke_instanced_draw(ShaderManager& sm, size_t amount) const;
 
+        // Exchange vertices, indices and gpu buffers with other (names are kept)
+        // for filling a placeholder Mesh in place once its asset has been imported (only on the gl thread)
+        void swap_data(Mesh& other);
+
         // set attrib pointers for transform matrix starting at attrib location "offset"
         // Instance data Array Buffer MUST be bound before calling!!!
         void setup_instance_transform_attrib_array(unsigned int offset = 6);
 
+        // bounds of all vertex positions in model space, set when constructed (zero if empty)
+        // (skinned meshes can be posed outside of them)
+        // safe from any thread, while a placeholder may be filled on the gl thread
+        void read_bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const;
+
         // Name given for this mesh
         std::string m_name;
         // Filename this mesh was imported from
@@ -94,9 +104,14 @@ namespace pleep
         // after _setup, buffer object data is set based on these values, so they should be protected
         std::vector<Vertex>       m_vertices;
         std::vector<unsigned int> m_indices;
+        glm::vec3 m_boundsMin = glm::vec3(0.0f);
+        glm::vec3 m_boundsMax = glm::vec3(0.0f);
+        // guards bounds while swap_data fills a placeholder
+        // (vertices and gpu buffers are only used on the gl thread)
+        mutable std::mutex m_boundsMutex;
 
         // Array Buffer Object, Vertex Buffer Object, Element Buffer Object
-        unsigned int VAO_ID, VBO_ID, EBO_ID = 0;
+        unsigned int VAO_ID = 0, VBO_ID = 0, EBO_ID = 0;
         bool m_isGlSetup = false;
 
 
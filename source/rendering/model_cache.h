@@ -30,6 +30,35 @@ namespace pleep
         inline ImportReceipt import(std::string filepath)
         { return g_modelManager->import(filepath); }
 
+        // Read file on an import worker, its assets are cached by a later process_async_imports
+        inline std::shared_future<ImportReceipt> import_async(const std::string& filepath)
+        { return g_modelManager->import_async(filepath); }
+
+        // Fetch, or return a placeholder (filled in place once filepath's async import is cached)
+        inline std::shared_ptr<const Mesh>     fetch_mesh_async(const std::string& name, const std::string& filepath)
+        { return g_modelManager->fetch_mesh_async(name, filepath); }
+        inline std::shared_ptr<const Material> fetch_material_async(const std::string& name, const std::string& filepath)
+        { return g_modelManager->fetch_material_async(name, filepath); }
+
+        // Cache (and upload) async imports workers have finished reading, for up to maxSeconds
+        // must be called on the thread with the gl context
+        inline size_t process_async_imports(double maxSeconds)
+        { return g_modelManager->process_async_imports(maxSeconds); }
+        inline size_t get_pending_import_count()
+        { return g_modelManager->get_pending_import_count(); }
+
+        // Make calls from other threads wait for this one to make their gpu data (in its process_async_imports)
+        inline void set_gl_thread()
+        { g_modelManager->set_gl_thread(); }
+
+        // Directory to read and write baked model files in, empty disables baking
+        inline void set_bake_directory(const std::string& directory)
+        { g_modelManager->set_bake_directory(directory); }
+
+        // Read model file at filepath and (re)write its baked file without caching it
+        inline bool bake(const std::string& filepath)
+        { return g_modelManager->bake(filepath); }
+
         // Tries to add Material to the cache, constructed with the given textureDict
         // returns true if it was successful (implied ImportReceipt)
         // returns false if name was taken
@@ -39,15 +68,16 @@ namespace pleep
 
         // ***** Fetch Methods *****
         // If asset exists in cache return shallow, const, shared instance from cache
-        // (or a deep copy for armatures)
         inline std::shared_ptr<const Mesh>              fetch_mesh(const std::string& name)
         { return g_modelManager->fetch_mesh(name); }
         inline std::shared_ptr<const Material>          fetch_material(const std::string& name)
         { return g_modelManager->fetch_material(name); }
-        inline Armature                                 fetch_armature(const std::string& name)
+        inline std::shared_ptr<const Armature>          fetch_armature(const std::string& name)
         { return g_modelManager->fetch_armature(name); }
         inline std::shared_ptr<const AnimationSkeletal> fetch_animation(const std::string& name)
         { return g_modelManager->fetch_animation(name); }
+        inline std::shared_ptr<const ColliderMesh>      fetch_collider_mesh(const std::string& name)
+        { return g_modelManager->fetch_collider_mesh(name); }
 
         // convenience method to fetch or generate-and-fetch hardcoded basic meshes
         // Serialized hardcoded basic meshes will use their ENUM_TO_STR name to be fetched
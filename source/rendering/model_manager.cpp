@@ -1,14 +1,80 @@
 #include "rendering/model_manager.h"
 
 #include <cassert>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <set>
+#include <stdexcept>
+#include <assimp/DefaultIOSystem.h>
 
 #include "logging/pleep_log.h"
+#include "core/mapped_file.h"
 #include "rendering/assimp_converters.h"
 
 namespace pleep
 {
+    // imports are mostly waiting on disk or Assimp, a couple of workers keeps a burst of them moving
+    // without competing with the StageScheduler's workers for cores
+    constexpr size_t MODEL_MANAGER_MAX_IMPORT_WORKERS = 2;
+
+    // Assimp file system which remembers every file an import opens
+    // (the model file and whatever it references, like .mtl or .bin)
+    class RecordingIOSystem : public Assimp::DefaultIOSystem
+    {
+    public:
+        Assimp::IOStream* Open(const char* file, const char* mode = "rb") override
+        {
+            Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file, mode);
+            if (stream) m_openedFiles.insert(file);
+            return stream;
+        }
+
+        const std::set<std::string>& get_opened_files() const
+        {
+            return m_openedFiles;
+        }
+
+    private:
+        std::set<std::string> m_openedFiles;
+    };
+
+    // hardcoded mesh "filepaths" use <> characters (see ENUM_TO_STR)
+    inline static bool is_hardcoded_filepath(const std::string& filepath)
+    {
+        return !filepath.empty() && filepath.front() == '<' && filepath.back() == '>';
+    }
+
+    ModelManager::~ModelManager()
+    {
+        if (ColliderMeshes::get_source_ref() == this) ColliderMeshes::set_source(nullptr);
+
+        // drops reads not yet started, after this nothing else will fulfil m_pendingImports
+        m_importPool.reset();
+
+        // don't leave anyone waiting on a broken promise
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+        for (auto& pendingIt : m_pendingImports)
+        {
+            pendingIt.second->promise.set_exception(std::make_exception_ptr(
+                std::runtime_error("ModelManager was destroyed before " + pendingIt.first + " was imported")));
+        }
+        m_pendingImports.clear();
+    }
+
     ModelManager::ImportReceipt ModelManager::import(const std::string filepath)
     {
+        if (this->_is_off_gl_thread())
+        {
+            // generated meshes need the gl thread, files can be read on an import worker while this one waits
+            if (is_hardcoded_filepath(filepath))
+            {
+                return this->_run_on_gl_thread<ImportReceipt>([this, &filepath]() { return this->import(filepath); });
+            }
+            return this->import_async(filepath).get();
+        }
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+
         // hardcoded assets need to be able to use the same import pathway as 
         // other meshes for ambiguous deserialization
         if (filepath == ModelManager::ENUM_TO_STR(BasicMeshType::cube))
@@ -47,54 +113,296 @@ namespace pleep
             return ImportReceipt{filepath, filepath, {{filepath,{{filepath}}}}, {filepath}};
         }
 
-        // TODO: Unit testing lmao
-        const size_t delimiterIndex = filepath.find_last_of("/\\");
-        std::string directory = ".";
-        std::string filename = filepath;
-        if (delimiterIndex != std::string::npos)
+        const std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
+
+        ModelData model;
+        const bool isBaked = this->_read_baked_model(filepath, model);
+        if (!isBaked)
         {
-            directory = filepath.substr(0, delimiterIndex);
-            filename = filepath.substr(delimiterIndex + 1);
+            if (!this->_read_model(filepath, model)) return ImportReceipt{};
+            // so next import (or next run) can skip Assimp
+            if (!m_bakeDirectory.empty()) this->_write_baked_model(model);
         }
-        std::string filestem = filename.substr(0, filename.find_last_of("."));
-        //PLEEPLOG_DEBUG("Loading model " + filename + " (" + filestem + ") from " + directory);
+        PLEEPLOG_DEBUG("Read model " + filepath + (isBaked ? " from its baked file" : " with Assimp") + " in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count()) + "ms");
 
-        // load in model file (it is up to user to prevent redundant import calls)
-        Assimp::Importer importer;
-        // aiProcess_GenSmoothNormals ?
-        const aiScene *scene = importer.ReadFile(filepath, aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_PopulateArmatureData);
-        if (!scene || !scene->mRootNode || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+        // now all assets are cached, user can call fetch methods using receipt names
+        // return ALL assets available in model
+        return this->_cache_model(model);
+    }
+
+    void ModelManager::set_bake_directory(const std::string& directory)
+    {
+        m_bakeDirectory = directory;
+    }
+
+    bool ModelManager::bake(const std::string& filepath)
+    {
+        const std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
+
+        ModelData model;
+        if (!this->_read_model(filepath, model)) return false;
+        const double assimpMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+        if (!this->_write_baked_model(model)) return false;
+
+        // read it back to compare load times
+        const std::chrono::steady_clock::time_point bakedStart = std::chrono::steady_clock::now();
+        ModelData baked;
+        if (!this->_read_baked_model(filepath, baked))
         {
-            PLEEPLOG_ERROR("Assimp failed to load '" + filepath + "': " + std::string(importer.GetErrorString()));
-            return ImportReceipt{};
+            PLEEPLOG_ERROR("Could not read back baked model " + _get_bake_path(filepath));
+            return false;
         }
+        const double bakedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bakedStart).count();
 
-        // ***********************************
-        //debug_scene(scene);
-        //return ImportReceipt{};
-        // ***********************************
+        PLEEPLOG_INFO("Baked model " + filepath + " to " + _get_bake_path(filepath) + ": read with Assimp in "
+            + std::to_string(assimpMs) + "ms, from baked file in " + std::to_string(bakedMs) + "ms");
+        return true;
+    }
 
-        // check for possible assets and load into receipt
-        ImportReceipt scan = this->_scan_scene(scene, filestem, true);
-        scan.importSourceFilepath = filepath;
-        //debug_receipt(scan);
-        
-        // process materials and armatures first for meshes to reference
-        this->_process_materials(scene, scan, directory);
-        this->_process_armatures(scene->mRootNode, scan);//, glm::inverse(assimp_converters::convert_matrix4(scene->mRootNode->mTransformation)));
-        this->_process_meshes(scene, scan);
-        this->_process_animations(scene, scan);
+    std::shared_future<ModelManager::ImportReceipt> ModelManager::import_async(const std::string& filepath)
+    {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+        auto pendingIt = m_pendingImports.find(filepath);
+        if (pendingIt != m_pendingImports.end())
+        {
+            return pendingIt->second->receipt;
+        }
 
-        // now all assets are cached, user can call fetch methods using receipt names
-        // return ALL assets available in scene
-        ImportReceipt receipt = this->_scan_scene(scene, filestem);
-        receipt.importSourceFilepath = filepath;
-        //debug_receipt(receipt);
-        return receipt;
+        std::shared_ptr<AsyncImport> pending = std::make_shared<AsyncImport>();
+        pending->filepath = filepath;
+        pending->receipt = pending->promise.get_future().share();
+
+        // hardcoded meshes are generated, not read
+        if (!this->_is_async_import_enabled() || is_hardcoded_filepath(filepath))
+        {
+            // (by the gl thread, which this can't wait for while holding the cache)
+            if (this->_is_off_gl_thread())
+            {
+                m_pendingImports[filepath] = pending;
+                this->_queue_on_gl_thread([this, pending]()
+                {
+                    std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+                    m_pendingImports.erase(pending->filepath);
+                    pending->promise.set_value(this->import(pending->filepath));
+                });
+                return pending->receipt;
+            }
+            pending->promise.set_value(this->import(filepath));
+            this->_drop_placeholders(filepath);
+            return pending->receipt;
+        }
+
+        if (!m_importPool)
+        {
+            const size_t hardwareThreads = std::thread::hardware_concurrency();
+            m_importPool = std::make_unique<AssetImportPool>(std::max<size_t>(1, std::min<size_t>(hardwareThreads / 2, MODEL_MANAGER_MAX_IMPORT_WORKERS)));
+        }
+
+        m_pendingImports[filepath] = pending;
+        m_importPool->submit([this, pending]()
+        {
+            try
+            {
+                pending->isRead = this->_read_model_async(pending->filepath, pending->model);
+            }
+            catch (const std::exception& e)
+            {
+                PLEEPLOG_ERROR("Could not import " + pending->filepath + ": " + e.what());
+                pending->isRead = false;
+            }
+
+            std::lock_guard<std::mutex> readImportsLock(m_readImportsMutex);
+            m_readImports.push_back(pending);
+        });
+        return pending->receipt;
+    }
+
+    std::shared_ptr<const Mesh> ModelManager::fetch_mesh_async(const std::string& name, const std::string& filepath)
+    {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+        auto meshIt = this->m_meshMap.find(name);
+        if (meshIt != this->m_meshMap.end())
+        {
+            return meshIt->second;
+        }
+        if (name.empty() || filepath.empty()) return nullptr;
+
+        // hardcoded meshes are cheap to generate (and would replace a placeholder instead of filling it)
+        if (!is_hardcoded_filepath(filepath))
+        {
+            std::shared_ptr<Mesh> placeholder = std::make_shared<Mesh>();
+            placeholder->m_name = name;
+            placeholder->m_sourceFilepath = filepath;
+            this->m_meshMap[name] = placeholder;
+            this->m_meshPlaceholders.insert(name);
+        }
+        this->import_async(filepath);
+
+        // import may have been synchronous (and already filled or dropped the placeholder)
+        meshIt = this->m_meshMap.find(name);
+        return meshIt == this->m_meshMap.end() ? nullptr : meshIt->second;
+    }
+
+    std::shared_ptr<const Material> ModelManager::fetch_material_async(const std::string& name, const std::string& filepath)
+    {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+        auto materialIt = this->m_materialMap.find(name);
+        if (materialIt != this->m_materialMap.end())
+        {
+            return materialIt->second;
+        }
+        if (name.empty() || filepath.empty()) return nullptr;
+
+        std::shared_ptr<Material> placeholder = std::make_shared<Material>();
+        placeholder->m_name = name;
+        placeholder->m_sourceFilepath = filepath;
+        this->m_materialMap[name] = placeholder;
+        this->m_materialPlaceholders.insert(name);
+        this->import_async(filepath);
+
+        materialIt = this->m_materialMap.find(name);
+        return materialIt == this->m_materialMap.end() ? nullptr : materialIt->second;
+    }
+
+    size_t ModelManager::process_async_imports(double maxSeconds)
+    {
+        const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+        // other threads are blocked on these, so they all run regardless of maxSeconds
+        std::deque<std::function<void()>> glTasks;
+        {
+            std::lock_guard<std::mutex> glTasksLock(m_glTasksMutex);
+            glTasks.swap(m_glTasks);
+        }
+        for (std::function<void()>& task : glTasks)
+        {
+            task();
+        }
+
+        size_t processedCount = 0;
+        while (true)
+        {
+            std::shared_ptr<AsyncImport> readImport;
+            {
+                std::lock_guard<std::mutex> readImportsLock(m_readImportsMutex);
+                if (m_readImports.empty()) break;
+                readImport = m_readImports.front();
+                m_readImports.pop_front();
+            }
+
+            // gpu upload stage
+            std::unique_lock<std::recursive_mutex> cacheLock(m_cacheMutex);
+            ImportReceipt receipt;
+            if (readImport->isRead)
+            {
+                receipt = this->_cache_model(readImport->model);
+            }
+            this->_drop_placeholders(readImport->filepath);
+
+            m_pendingImports.erase(readImport->filepath);
+            cacheLock.unlock();
+            readImport->promise.set_value(receipt);
+            processedCount++;
+
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - processStart).count() >= maxSeconds) break;
+        }
+
+        if (processedCount > 0)
+        {
+            std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+            PLEEPLOG_DEBUG("Cached " + std::to_string(processedCount) + " async imports in "
+                + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - processStart).count()) + "ms, "
+                + std::to_string(m_pendingImports.size()) + " still pending");
+        }
+        return processedCount;
+    }
+
+    size_t ModelManager::get_pending_import_count() const
+    {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+        return m_pendingImports.size();
+    }
+
+    void ModelManager::set_gl_thread()
+    {
+        m_glThreadId = std::this_thread::get_id();
+    }
+
+    bool ModelManager::_is_off_gl_thread() const
+    {
+        return m_glThreadId != std::thread::id() && m_glThreadId != std::this_thread::get_id();
+    }
+
+    void ModelManager::_queue_on_gl_thread(std::function<void()> task)
+    {
+        std::lock_guard<std::mutex> glTasksLock(m_glTasksMutex);
+        m_glTasks.push_back(std::move(task));
+    }
+
+    bool ModelManager::_read_model_async(const std::string& filepath, ModelData& dest)
+    {
+        const std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
+
+        const bool isBaked = this->_read_baked_model(filepath, dest);
+        if (!isBaked)
+        {
+            if (!this->_read_model(filepath, dest)) return false;
+            if (!m_bakeDirectory.empty()) this->_write_baked_model(dest);
+        }
+
+        // decode separate texture files here too, leaving only the upload for the gl thread
+        for (ModelData::MaterialData& material : dest.materials)
+        {
+            for (ModelData::TextureData& texture : material.textures)
+            {
+                if (texture.embedded.empty()) texture.image.decode(texture.filepath);
+            }
+        }
+
+        PLEEPLOG_DEBUG("Read model " + filepath + (isBaked ? " from its baked file" : " with Assimp") + " (async) in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count()) + "ms");
+        return true;
+    }
+
+    void ModelManager::_drop_placeholders(const std::string& filepath)
+    {
+        for (auto placeholderIt = m_meshPlaceholders.begin(); placeholderIt != m_meshPlaceholders.end();)
+        {
+            auto meshIt = m_meshMap.find(*placeholderIt);
+            if (meshIt != m_meshMap.end() && meshIt->second->m_sourceFilepath != filepath)
+            {
+                placeholderIt++;
+                continue;
+            }
+            PLEEPLOG_WARN("Mesh " + *placeholderIt + " was not imported from " + filepath);
+            // holders keep the empty placeholder, which draws nothing
+            if (meshIt != m_meshMap.end()) m_meshMap.erase(meshIt);
+            placeholderIt = m_meshPlaceholders.erase(placeholderIt);
+        }
+        for (auto placeholderIt = m_materialPlaceholders.begin(); placeholderIt != m_materialPlaceholders.end();)
+        {
+            auto materialIt = m_materialMap.find(*placeholderIt);
+            if (materialIt != m_materialMap.end() && materialIt->second->m_sourceFilepath != filepath)
+            {
+                placeholderIt++;
+                continue;
+            }
+            PLEEPLOG_WARN("Material " + *placeholderIt + " was not imported from " + filepath);
+            if (materialIt != m_materialMap.end()) m_materialMap.erase(materialIt);
+            placeholderIt = m_materialPlaceholders.erase(placeholderIt);
+        }
     }
 
     bool ModelManager::create_material(const std::string& name, const std::unordered_map<TextureType, std::string>& textureDict) 
     {
+        // textures are given to the gpu as they are constructed
+        if (this->_is_off_gl_thread())
+        {
+            return this->_run_on_gl_thread<bool>([this, &name, &textureDict]() { return this->create_material(name, textureDict); });
+        }
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+
         auto materialIt = this->m_materialMap.find(name);
         if (materialIt != this->m_materialMap.end())
         {
@@ -121,6 +429,7 @@ namespace pleep
 
     std::shared_ptr<const Mesh> ModelManager::fetch_mesh(const std::string& name)
     {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
         auto meshIt = this->m_meshMap.find(name);
         if (meshIt == this->m_meshMap.end())
         {
@@ -135,6 +444,7 @@ namespace pleep
 
     std::shared_ptr<const Material> ModelManager::fetch_material(const std::string& name)
     {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
         auto materialIt = this->m_materialMap.find(name);
         if (materialIt == this->m_materialMap.end())
         {
@@ -147,23 +457,24 @@ namespace pleep
         }
     }
 
-    Armature ModelManager::fetch_armature(const std::string& name)
+    std::shared_ptr<const Armature> ModelManager::fetch_armature(const std::string& name)
     {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
         auto armatureIt = this->m_armatureMap.find(name);
         if (armatureIt == this->m_armatureMap.end())
         {
             PLEEPLOG_WARN("Armature " + name + " is not cached.");
-            return Armature{};
+            return nullptr;
         }
         else
         {
-            // return copy (copy constructor must be a deep copy)
             return armatureIt->second;
         }
     }
 
     std::shared_ptr<const AnimationSkeletal> ModelManager::fetch_animation(const std::string& name)
     {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
         auto animationIt = this->m_animationMap.find(name);
         if (animationIt == this->m_animationMap.end())
         {
@@ -176,21 +487,50 @@ namespace pleep
         }
     }
     
+    std::shared_ptr<const ColliderMesh> ModelManager::fetch_collider_mesh(const std::string& name)
+    {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+        auto colliderMeshIt = this->m_colliderMeshMap.find(name);
+        if (colliderMeshIt != this->m_colliderMeshMap.end())
+        {
+            return colliderMeshIt->second;
+        }
+
+        // first use of this mesh as a collider
+        auto sourceIt = this->m_colliderSourceMap.find(name);
+        if (sourceIt == this->m_colliderSourceMap.end())
+        {
+            PLEEPLOG_WARN("Collider mesh " + name + " is not cached.");
+            return nullptr;
+        }
+        std::shared_ptr<ColliderMesh> colliderMesh = _build_collider_mesh(sourceIt->second);
+        colliderMesh->m_name = name;
+        colliderMesh->m_sourceFilepath = sourceIt->second.sourceFilepath;
+        this->m_colliderSourceMap.erase(sourceIt);
+        this->m_colliderMeshMap[name] = colliderMesh;
+        return colliderMesh;
+    }
+    
     std::shared_ptr<const Mesh> ModelManager::fetch_mesh(const ModelManager::BasicMeshType id)
     {
         std::string polyName = ModelManager::ENUM_TO_STR(id);
         if (polyName == "") return nullptr;
         
         // check if basic mesh is in cache from previous call
-        auto meshIt = this->m_meshMap.find(polyName);
-        if (meshIt != this->m_meshMap.end())
         {
-            return meshIt->second;
+            std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
+            auto meshIt = this->m_meshMap.find(polyName);
+            if (meshIt != this->m_meshMap.end())
+            {
+                return meshIt->second;
+            }
         }
 
         // otherwise, since "filepath" and name are identical we can import it
+        // (without holding the cache, import may wait for the gl thread)
         this->import(polyName);
         // and then return it in this single call
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
         return this->m_meshMap[polyName];
     }
 
@@ -227,7 +567,7 @@ namespace pleep
                     std::remove_if(
                         this->m_armatureMap.begin(),
                         this->m_armatureMap.end(),
-                        [](std::pair<std::string, std::shared_ptr<Armature>> armatureIt) {
+                        [](std::pair<std::string, std::shared_ptr<const Armature>> armatureIt) {
                             if (armatureIt.second.use_count() > 1) return false;
                             return true;
                         }
@@ -251,224 +591,183 @@ namespace pleep
 
     void ModelManager::clear_all()
     {
+        std::lock_guard<std::recursive_mutex> cacheLock(m_cacheMutex);
         this->m_meshMap.clear();
         this->m_materialMap.clear();
         this->m_armatureMap.clear();
         this->m_animationMap.clear();
+        this->m_colliderMeshMap.clear();
+        this->m_colliderSourceMap.clear();
+        this->m_meshPlaceholders.clear();
+        this->m_materialPlaceholders.clear();
     }
     
-    ModelManager::ImportReceipt ModelManager::_scan_scene(const aiScene* scene, const std::string& nameDefault, const bool omitExisting) 
+    bool ModelManager::_read_model(const std::string& filepath, ModelData& dest)
     {
-        ImportReceipt receipt;
-        receipt.importName = nameDefault;
-
-        // all materials should be directly in scene, and have unique named (within this import)
-        for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+        // TODO: Unit testing lmao
+        const size_t delimiterIndex = filepath.find_last_of("/\\");
+        std::string directory = ".";
+        std::string filename = filepath;
+        if (delimiterIndex != std::string::npos)
         {
-            std::string matName = scene->mMaterials[i]->GetName().C_Str();
-            if (matName.empty())
-            {
-                matName = receipt.importName + "_material_" + std::to_string(i);
-            }
-            
-            // check uniqueness
-            if (omitExisting && (m_materialMap.count(matName) || receipt.materialNames.count(matName)))
-            {
-                PLEEPLOG_WARN("Could not import material " + matName + ", it already exists");
-                // we could try to generate a default name here if file name is different
-                continue;
-            }
-
-            receipt.materialNames.insert(matName);
+            directory = filepath.substr(0, delimiterIndex);
+            filename = filepath.substr(delimiterIndex + 1);
         }
+        std::string filestem = filename.substr(0, filename.find_last_of("."));
+        //PLEEPLOG_DEBUG("Loading model " + filename + " (" + filestem + ") from " + directory);
 
-        // all animations should be directly in scene
-        for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+        // load in model file (it is up to user to prevent redundant import calls)
+        Assimp::Importer importer;
+        // importer owns (and deletes) its io handler
+        RecordingIOSystem* recorder = new RecordingIOSystem();
+        importer.SetIOHandler(recorder);
+        // aiProcess_GenSmoothNormals ?
+        const aiScene *scene = importer.ReadFile(filepath, aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_PopulateArmatureData);
+        if (!scene || !scene->mRootNode || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
         {
-            std::string animName = scene->mAnimations[i]->mName.C_Str();
-            if (animName.empty())
-            {
-                animName = receipt.importName + "_animation_" + std::to_string(i);
-            }
+            PLEEPLOG_ERROR("Assimp failed to load '" + filepath + "': " + std::string(importer.GetErrorString()));
+            return false;
+        }
 
-            // check uniqueness
-            if (omitExisting && (m_animationMap.count(animName) || receipt.animationNames.count(animName)))
-            {
-                PLEEPLOG_WARN("Could not import animation " + animName + ", it already exists");
-                // we could try to generate a default name here? unless this already is the deafult name
-                continue;
-            }
+        // ***********************************
+        //debug_scene(scene);
+        //return false;
+        // ***********************************
 
-            receipt.animationNames.insert(animName);
-        }
+        dest.importName = filestem;
+        dest.sourceFilepath = filepath;
 
-        // all meshes should be directly in scene
-        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+        this->_read_materials(scene, dest, directory);
+
+        // separate texture files are read when cached, not by Assimp
+        std::set<std::string> dependencies = recorder->get_opened_files();
+        for (const ModelData::MaterialData& material : dest.materials)
         {
-            std::string meshName = scene->mMeshes[i]->mName.C_Str();
-            if (meshName.empty())
-            {
-                meshName = receipt.importName + "_mesh_" + std::to_string(i);
-            }
-            
-            // check uniqueness
-            if (omitExisting && (m_meshMap.count(meshName) || receipt.meshNames.count(meshName)))
+            for (const ModelData::TextureData& texture : material.textures)
             {
-                PLEEPLOG_WARN("Could not import mesh " + meshName + ", it already exists");
-                // we could try to generate a default name here? unless this already is the deafult name
-                continue;
+                FileStamp stamp;
+                if (texture.embedded.empty() && stamp_file(texture.filepath, stamp)) dependencies.insert(texture.filepath);
             }
-
-            receipt.meshNames.insert(meshName);
         }
-
-        // can scene not have root node?
-        // scene.h::255 > "There will always be at least the root node if the import was successful"
-        assert(scene->mRootNode);
+        dependencies.erase(filepath);
+        dest.dependencies.assign(dependencies.begin(), dependencies.end());
 
         // in GLB export if there are multiple objects, then root node will be called ROOT
         // so if root node has name ROOT then treat each of its children as a collection
         // otherwise root node is the only collection
-        // Is there any better way to recognize this?
-
         // for now we'll just forget collections and import everything flat
-        // come back later if there is a need for better organization
+        std::unordered_set<std::string> armatureNames;
+        this->_scan_armature_names(scene, scene->mRootNode, armatureNames);
 
-        _scan_node(scene, scene->mRootNode, receipt, omitExisting);
+        // read armatures first for meshes to reference
+        std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>> boneIdMapMap;
+        this->_read_armatures(scene->mRootNode, armatureNames, dest, boneIdMapMap);//, glm::inverse(assimp_converters::convert_matrix4(scene->mRootNode->mTransformation)));
+        this->_read_meshes(scene, dest, boneIdMapMap);
+        this->_read_animations(scene, dest);
 
-        return receipt;
+        return true;
     }
-    
-    void ModelManager::_scan_node(const aiScene* scene, const aiNode* node, ImportReceipt& receipt, const bool omitExisting)
+
+    void ModelManager::_read_materials(const aiScene *scene, ModelData& dest, const std::string& directory)
     {
-        // check if I have meshes
-        for (unsigned int m = 0; m < node->mNumMeshes; m++)
+        // all materials should be directly in scene, and have unique named (within this import)
+        for (unsigned int m = 0; m < scene->mNumMaterials; m++)
         {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[m]];
+            const aiMaterial *material = scene->mMaterials[m];
+            ModelData::MaterialData materialData;
+            materialData.name = material->GetName().C_Str();
+            if (materialData.name.empty())
+            {
+                materialData.name = dest.importName + "_material_" + std::to_string(m);
+            }
 
-            // do those meshes have any bones and therefore armatures?
-            if (mesh->HasBones())
+            // for each aiTextureType in material get (only first?) texture filename
+            // aiTextureType should cast directly to pleep::TextureType
+            for (unsigned int type = aiTextureType::aiTextureType_NONE; type <= aiTextureType::aiTextureType_TRANSMISSION; type++)
             {
-                // only need to check first bone?
-                const std::string armatureName = mesh->mBones[0]->mArmature->mName.C_Str();
-                if (omitExisting && (m_armatureMap.count(armatureName) || receipt.armatureNames.count(armatureName)))
+                for (unsigned int i = 0; i < material->GetTextureCount(static_cast<aiTextureType>(type)); i++)
                 {
-                    PLEEPLOG_WARN("Could not import armature " + armatureName + ", it already exists");
-                    // we could try to generate a default name here? unless this already is the default name
-                    continue;
+                    aiString str;
+                    material->GetTexture(static_cast<aiTextureType>(type), i, &str);
+                    // should check for texture already loaded earlier in this model?
+                    // if it is a duplicate, do we want to load twice anyway to not overlap gpu memory owners?
+
+                    if (i > 0)
+                    {
+                        PLEEPLOG_WARN("Found more than one texture of type " + std::to_string(type) + " in material " + materialData.name + " with name " + std::string(str.C_Str()) + " Ignoring...");
+                        continue;
+                    }
+
+                    ModelData::TextureData textureData;
+                    textureData.type = static_cast<TextureType>(type);
+
+                    const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(str.C_Str());
+                    // nullptr means it was not embedded
+                    if (embeddedTexture == nullptr)
+                    {
+                        textureData.filepath = str.C_Str();
+                        if (!directory.empty())
+                            textureData.filepath = directory + '/' + textureData.filepath;
+                    }
+                    else
+                    {
+                        textureData.filepath = embeddedTexture->mFilename.C_Str();
+                        textureData.width = embeddedTexture->mWidth;
+                        textureData.height = embeddedTexture->mHeight;
+                        // compressed textures have height 0 and width in bytes
+                        const size_t texelsSize = textureData.height == 0
+                            ? textureData.width
+                            : static_cast<size_t>(textureData.width) * textureData.height * sizeof(aiTexel);
+                        const uint8_t* texels = reinterpret_cast<const uint8_t*>(embeddedTexture->pcData);
+                        textureData.embedded.assign(texels, texels + texelsSize);
+                    }
+                    materialData.textures.push_back(std::move(textureData));
                 }
-                receipt.armatureNames.insert(armatureName);
             }
-        }
 
-        for (unsigned int rootIndex = 0; rootIndex < node->mNumChildren; rootIndex++)
-        {
-            aiNode* child = node->mChildren[rootIndex];
-            _scan_node(scene, child, receipt, omitExisting);
+            dest.materials.push_back(std::move(materialData));
         }
-
     }
 
-    
-    void ModelManager::_process_materials(const aiScene *scene, const ImportReceipt& receipt, const std::string directory)
+    void ModelManager::_scan_armature_names(const aiScene* scene, const aiNode* node, std::unordered_set<std::string>& dest)
     {
-        // load all materials from scene
-        for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+        // check if I have meshes
+        for (unsigned int m = 0; m < node->mNumMeshes; m++)
         {
-            aiMaterial *material = scene->mMaterials[i];
-            std::string materialName = std::string(material->GetName().C_Str());
-            if (materialName.empty())
+            aiMesh* mesh = scene->mMeshes[node->mMeshes[m]];
+
+            // do those meshes have any bones and therefore armatures?
+            if (mesh->HasBones())
             {
-                materialName = receipt.importName + "_material_" + std::to_string(i);
+                // only need to check first bone?
+                dest.insert(mesh->mBones[0]->mArmature->mName.C_Str());
             }
-            // check if key was validated by scan
-            if (receipt.materialNames.count(materialName) == 0) continue;
-
-            m_materialMap[materialName] = _build_material(scene, material, materialName, directory);
-            m_materialMap[materialName]->m_name = materialName;
-            m_materialMap[materialName]->m_sourceFilepath = receipt.importSourceFilepath;
         }
-    }
-
-    std::shared_ptr<Material> ModelManager::_build_material(const aiScene* scene, const aiMaterial *material, const std::string& materialName, const std::string& directory)
-    {
-        PLEEPLOG_DEBUG("Loading material: " + materialName);
-        UNREFERENCED_PARAMETER(materialName);
 
-        std::unordered_map<TextureType, Texture> loadedTextures;
-        // for each aiTextureType in material get (only first?) texture filename
-
-        // aiTextureType should cast directly to pleep::TextureType
-        for (unsigned int type = aiTextureType::aiTextureType_NONE; type <= aiTextureType::aiTextureType_TRANSMISSION; type++)
+        for (unsigned int rootIndex = 0; rootIndex < node->mNumChildren; rootIndex++)
         {
-            for (unsigned int i = 0; i < material->GetTextureCount(static_cast<aiTextureType>(type)); i++)
-            {
-                aiString str;
-                material->GetTexture(static_cast<aiTextureType>(type), i, &str);
-                // should check for texture already loaded earlier in this model?
-                // if it is a duplicate, do we want to load twice anyway to not overlap gpu memory owners?
-
-                if (i > 0)
-                {
-                    PLEEPLOG_WARN("Found more than one texture of type " + std::to_string(type) + " in material " + std::string(materialName) + " with name " + std::string(str.C_Str()) + " Ignoring...");
-                    continue;
-                }
-                
-                const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(str.C_Str());
-
-                // nullptr means it was not embedded
-                if (embeddedTexture == nullptr)
-                {
-                    std::string filepath = str.C_Str();
-                    if (!directory.empty())
-                        filepath = directory + '/' + filepath;
-                    PLEEPLOG_DEBUG("Loading texture: " + filepath);
-
-                    // create Texture without copying
-                    // weirdness to pass Texture constructor parameters
-                    loadedTextures.emplace(
-                        std::piecewise_construct,
-                        std::forward_as_tuple(static_cast<TextureType>(type)),
-                        std::forward_as_tuple(static_cast<TextureType>(type), filepath)
-                    );
-                }
-                else
-                {
-                    std::string filepath = embeddedTexture->mFilename.C_Str();
-                    PLEEPLOG_DEBUG("Loading EMBEDDED Texture: " + filepath);
-
-                    // extract texture data directly
-                    const unsigned int texWidth = embeddedTexture->mWidth;
-                    const unsigned int texHeight = embeddedTexture->mHeight;
-                    const unsigned int texChannels = 4; // TODO: add achFormatHint[5-7] as integers?
-                    // use pcData directly and let assimp handle scene memory?
-                    aiTexel* texData = embeddedTexture->pcData;
-
-                    loadedTextures.emplace(
-                        std::piecewise_construct,
-                        std::forward_as_tuple(static_cast<TextureType>(type)),
-                        std::forward_as_tuple(static_cast<TextureType>(type), texWidth, texHeight, texChannels, reinterpret_cast<char*>(texData))
-                    );
-                }
-            }
+            _scan_armature_names(scene, node->mChildren[rootIndex], dest);
         }
-
-        return std::make_shared<Material>(std::move(loadedTextures));
     }
 
-    void ModelManager::_process_armatures(const aiNode *node, const ImportReceipt& receipt, const glm::mat4 parentTransform)
+    void ModelManager::_read_armatures(const aiNode *node, const std::unordered_set<std::string>& armatureNames, ModelData& dest,
+        std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>>& boneIdMapMap,
+        const glm::mat4 parentTransform)
     {
-        // crawl through nodes, if we find a node name which matches armature required by receipt
-        // then create an armature from it and all descendants.
+        // crawl through nodes, if we find a node name which matches an armature referenced by a mesh
+        // then read an armature from it and all descendants.
         const std::string nodeName = node->mName.C_Str();
-        if (receipt.armatureNames.count(nodeName))
+        if (armatureNames.count(nodeName))
         {
             // name should be guarenteed because it is referenced by bone?
-            m_armatureMap[nodeName] = _build_armature(node);
-            m_armatureMap[nodeName].m_name = nodeName;
-            m_armatureMap[nodeName].m_sourceFilepath = receipt.importSourceFilepath;
+            ModelData::ArmatureData armatureData;
+            armatureData.name = nodeName;
             // apply parent transform at this point
-            m_armatureMap[nodeName].m_relativeTransform = parentTransform;
+            armatureData.relativeTransform = parentTransform;
+            // assume every descendant node is a bone? including ourself
+            _extract_bones_from_node(node, armatureData.bones, boneIdMapMap[nodeName]);
+
+            dest.armatures.push_back(std::move(armatureData));
         }
         else
         {
@@ -476,25 +775,12 @@ namespace pleep
             // keep looking
             for (unsigned int i = 0; i < node->mNumChildren; i++)
             {
-                _process_armatures(node->mChildren[i], receipt, nodeTransform);
+                _read_armatures(node->mChildren[i], armatureNames, dest, boneIdMapMap, nodeTransform);
             }
         }
     }
 
-    Armature ModelManager::_build_armature(const aiNode* node)
-    {
-        const std::string nodeName = node->mName.C_Str();
-        PLEEPLOG_DEBUG("Loading armature: " + nodeName);
-        std::vector<Bone> armatureBones;
-
-        // assume every descendant node is a bone? including ourself
-        _extract_bones_from_node(node, armatureBones, nodeName);
-
-        return Armature{armatureBones};
-    }
-
-    
-    void ModelManager::_extract_bones_from_node(const aiNode* node, std::vector<Bone>& armatureBones, std::string armatureName)
+    void ModelManager::_extract_bones_from_node(const aiNode* node, std::vector<Bone>& armatureBones, std::unordered_map<std::string, unsigned int>& boneIdMap)
     {
         // add this bone to map
         const unsigned int thisBoneId = static_cast<unsigned int>(armatureBones.size());
@@ -508,66 +794,43 @@ namespace pleep
         // Bone will be missing inverse bind matrix, which is set by the mesh nodes
 
         // link bone to armature
-        m_boneIdMapMap[armatureName][thisBoneName] = thisBoneId;
-        m_boneArmatureMap[thisBoneName] = armatureName;
+        boneIdMap[thisBoneName] = thisBoneId;
 
         // recurse
         for (unsigned int i = 0; i < node->mNumChildren; i++)
         {
             // we know what id our child will pick before we recurse so we can save them easily now
             armatureBones[thisBoneId].m_childIds.push_back(static_cast<unsigned int>(armatureBones.size()));
-            _extract_bones_from_node(node->mChildren[i], armatureBones, armatureName);
+            _extract_bones_from_node(node->mChildren[i], armatureBones, boneIdMap);
         }
     }
-    
-    void ModelManager::_process_meshes(const aiScene* scene, const ImportReceipt& receipt) 
+
+    void ModelManager::_read_meshes(const aiScene* scene, ModelData& dest,
+        const std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>>& boneIdMapMap)
     {
+        // all meshes should be directly in scene
         for (unsigned int m = 0; m < scene->mNumMeshes; m++)
         {
-            aiMesh* mesh = scene->mMeshes[m];
-            std::string meshName = mesh->mName.C_Str();
-            // use same rename rules
-            if (meshName.empty())
+            const aiMesh* mesh = scene->mMeshes[m];
+            ModelData::MeshData meshData;
+            meshData.name = mesh->mName.C_Str();
+            if (meshData.name.empty())
             {
-                meshName = receipt.importName + "_mesh_" + std::to_string(m);
+                meshData.name = dest.importName + "_mesh_" + std::to_string(m);
             }
 
-            // check for meshes only in scan
-            if (receipt.meshNames.count(meshName) <= 0 || m_meshMap.count(meshName) > 0)
-            {
-                continue;
-            }
+            _extract_vertices(meshData.vertices, mesh);
+            _extract_indices(meshData.indices, meshData.colliderIndices, mesh);
+            // setup bone data for each vertex iterating by bones, not by vertices like above
+            _extract_bone_weights_for_vertices(meshData.vertices, mesh, dest, boneIdMapMap);
 
-            m_meshMap[meshName] = _build_mesh(mesh, receipt);
-            // apply name outside of _build_mesh for ModelManagerFaux
-            m_meshMap[meshName]->m_name = meshName;
-            m_meshMap[meshName]->m_sourceFilepath = receipt.importSourceFilepath;
+            dest.meshes.push_back(std::move(meshData));
         }
     }
 
-    std::shared_ptr<Mesh> ModelManager::_build_mesh(const aiMesh *mesh, const ImportReceipt& receipt)
-    {
-        PLEEPLOG_DEBUG("Loading mesh " + std::string(mesh->mName.C_Str()));
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-
-        // extract vertices
-        _extract_vertices(vertices, mesh);
-        //PLEEPLOG_DEBUG("Loaded vertices");
-        // extract indices
-        _extract_indices(indices, mesh);
-        //PLEEPLOG_DEBUG("Loaded indices");
-
-        // extract bone weights
-        // setup bone data for each vertex iterating by bones, not by vertices like above
-        _extract_bone_weights_for_vertices(vertices, mesh, receipt);
-        //PLEEPLOG_DEBUG("Loaded bone weights");
-
-        return std::make_shared<Mesh>(vertices, indices);
-    }
-
     void ModelManager::_extract_vertices(std::vector<Vertex> &dest, const aiMesh *src)
     {
+        dest.reserve(src->mNumVertices);
         for (unsigned int i = 0; i < src->mNumVertices; i++)
         {
             Vertex vertex;
@@ -607,17 +870,33 @@ namespace pleep
         }
     }
 
-    void ModelManager::_extract_indices(std::vector<unsigned int> &dest, const aiMesh *src)
+    void ModelManager::_extract_indices(std::vector<unsigned int> &dest, std::vector<unsigned int>& colliderDest, const aiMesh *src)
     {
+        dest.reserve(src->mNumFaces * 3);
+        bool onlyTriangles = true;
         for (unsigned int i = 0; i < src->mNumFaces; i++)
         {
             aiFace tri = src->mFaces[i];
             for (unsigned int j = 0; j < tri.mNumIndices; j++)
                 dest.push_back(tri.mIndices[j]);
+            onlyTriangles &= tri.mNumIndices == 3;
+        }
+        if (onlyTriangles) return;
+
+        // Triangulate leaves point and line primitives as-is, only keep triangles for collision
+        colliderDest.reserve(src->mNumFaces * 3);
+        for (unsigned int i = 0; i < src->mNumFaces; i++)
+        {
+            const aiFace& face = src->mFaces[i];
+            if (face.mNumIndices != 3) continue;
+            colliderDest.push_back(face.mIndices[0]);
+            colliderDest.push_back(face.mIndices[1]);
+            colliderDest.push_back(face.mIndices[2]);
         }
     }
 
-    void ModelManager::_extract_bone_weights_for_vertices(std::vector<Vertex> &dest, const aiMesh *src, const ImportReceipt& receipt)
+    void ModelManager::_extract_bone_weights_for_vertices(std::vector<Vertex> &dest, const aiMesh *src, ModelData& model,
+        const std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>>& boneIdMapMap)
     {
         //PLEEPLOG_DEBUG("Mesh has bones: " + std::to_string(src->mNumBones));
         // parse through assimp bone list
@@ -626,47 +905,38 @@ namespace pleep
             aiBone* boneData = src->mBones[boneIndex];
             // use bone name or bone->mNode name? We use node name elsewhere
             std::string boneName = boneData->mNode->mName.C_Str();
-            // PLEEPLOG_DEBUG("Found bone: " + boneName);
 
             // find bone armature
             std::string armatureName = boneData->mArmature->mName.C_Str();
-            //PLEEPLOG_DEBUG("Found armature: " + armatureName);
             // TODO: empty armature name?
 
-            // check if armature exists (created earlier this import)
-            if (m_armatureMap.count(armatureName) == 0)
+            // check if armature exists (read earlier this import)
+            auto armatureIt = std::find_if(model.armatures.begin(), model.armatures.end(),
+                [&armatureName](const ModelData::ArmatureData& armature) { return armature.name == armatureName; });
+            auto boneIdMapIt = boneIdMapMap.find(armatureName);
+            if (armatureIt == model.armatures.end() || boneIdMapIt == boneIdMapMap.end())
             {
-                PLEEPLOG_WARN("Armature " + armatureName + " for bone doesn't exist?");
-                continue;
-            }
-
-            // check if armature is part of THIS import
-            if (receipt.armatureNames.count(armatureName) == 0)
-            {
-                PLEEPLOG_WARN("Armature " + armatureName + " isn't part of this import?");
+                PLEEPLOG_WARN("Armature " + armatureName + " for bone isn't part of this import?");
                 continue;
             }
 
             // check if bone exists in imported armature
-            auto boneIdIt = m_boneIdMapMap[armatureName].find(boneName);
-            if (boneIdIt == m_boneIdMapMap[armatureName].end())
+            auto boneIdIt = boneIdMapIt->second.find(boneName);
+            if (boneIdIt == boneIdMapIt->second.end())
             {
                 PLEEPLOG_WARN("Bone " + boneName + " does not exist in armature " + armatureName);
                 continue;
             }
             // get bone id
             unsigned int boneId = boneIdIt->second;
-            // PLEEPLOG_DEBUG("Which is Id: " + std::to_string(boneId));
 
             // while we're here, set mesh to bone transform in armature
-            // PLEEPLOG_DEBUG("Setting bone transform in armature: " + armatureName);
-            m_armatureMap[armatureName].m_bones[boneId].m_bindTransform = assimp_converters::convert_matrix4(boneData->mOffsetMatrix);
+            armatureIt->bones[boneId].m_bindTransform = assimp_converters::convert_matrix4(boneData->mOffsetMatrix);
 
             // now to actually set the weights...
             // fetch corresponding weight per vertex for *this* bone
             aiVertexWeight* vertexWeights = boneData->mWeights;
 
-            // PLEEPLOG_DEBUG("Setting weights: " + std::to_string(boneData->mNumWeights));
             for (unsigned int weightIndex = 0; weightIndex < boneData->mNumWeights; weightIndex++)
             {
                 // indices in our vertex array SHOULD match ai indices
@@ -682,71 +952,260 @@ namespace pleep
         }
     }
 
-    void ModelManager::_process_animations(const aiScene *scene, const ImportReceipt& receipt)
+    void ModelManager::_read_animations(const aiScene *scene, ModelData& dest)
     {
-        // load all animations from scene
+        // all animations should be directly in scene
         for (unsigned int i = 0; i < scene->mNumAnimations; i++)
         {
-            aiAnimation *animation = scene->mAnimations[i];
-            std::string animationName = animation->mName.C_Str();
-            if (animationName.empty())
+            const aiAnimation *animation = scene->mAnimations[i];
+            ModelData::AnimationData animationData;
+            animationData.name = animation->mName.C_Str();
+            if (animationData.name.empty())
             {
-                animationName = receipt.importName + "_animation_" + std::to_string(i);
+                animationData.name = dest.importName + "_animation_" + std::to_string(i);
             }
-            //PLEEPLOG_DEBUG("Loading anime-tion " + animationName);
+            animationData.duration = animation->mDuration;
+            animationData.frequency = animation->mTicksPerSecond;
 
-            m_animationMap[animationName] = _build_animation(animation);
+            // For each bone, extract each keyframe
+            for (unsigned int channelId = 0; channelId < animation->mNumChannels; channelId++)
+            {
+                const aiNodeAnim* nodeAnim = animation->mChannels[channelId];
+                ModelData::ChannelData channelData;
+                channelData.boneName = nodeAnim->mNodeName.C_Str();
 
-            // TODO: provide name, filepath, and ALL data required for serialization OUTSIDE of _build_animation, so that ModelManagerFaux's life is easy
-            m_animationMap[animationName]->m_name = animationName;
-            m_animationMap[animationName]->m_sourceFilepath = receipt.importSourceFilepath;
+                channelData.posKeyframes.reserve(nodeAnim->mNumPositionKeys);
+                for (unsigned int t = 0; t < nodeAnim->mNumPositionKeys; t++)
+                {
+                    channelData.posKeyframes.push_back({
+                        assimp_converters::convert_vec3(nodeAnim->mPositionKeys[t].mValue),
+                        nodeAnim->mPositionKeys[t].mTime
+                    });
+                }
+                channelData.rotKeyframes.reserve(nodeAnim->mNumRotationKeys);
+                for (unsigned int t = 0; t < nodeAnim->mNumRotationKeys; t++)
+                {
+                    channelData.rotKeyframes.push_back({
+                        assimp_converters::convert_quat(nodeAnim->mRotationKeys[t].mValue),
+                        nodeAnim->mRotationKeys[t].mTime
+                    });
+                }
+                channelData.sclKeyframes.reserve(nodeAnim->mNumScalingKeys);
+                for (unsigned int t = 0; t < nodeAnim->mNumScalingKeys; t++)
+                {
+                    channelData.sclKeyframes.push_back({
+                        assimp_converters::convert_vec3(nodeAnim->mScalingKeys[t].mValue),
+                        nodeAnim->mScalingKeys[t].mTime
+                    });
+                }
+                animationData.channels.push_back(std::move(channelData));
+            }
+
+            dest.animations.push_back(std::move(animationData));
         }
     }
 
-    std::shared_ptr<AnimationSkeletal> ModelManager::_build_animation(const aiAnimation *animation)
+    ModelManager::ImportReceipt ModelManager::_cache_model(const ModelData& model)
     {
-        std::shared_ptr<AnimationSkeletal> newAnimation = std::make_shared<AnimationSkeletal>();
-        newAnimation->m_duration = animation->mDuration;
-        newAnimation->m_frequency = animation->mTicksPerSecond;
+        ImportReceipt receipt;
+        receipt.importName = model.importName;
+        receipt.importSourceFilepath = model.sourceFilepath;
 
-        // For each boneId, extract each keyframe
-        for (unsigned int channelId = 0; channelId < animation->mNumChannels; channelId++)
+        // cache materials and armatures first for meshes and animations to reference
+        for (const ModelData::MaterialData& material : model.materials)
         {
-            const aiNodeAnim* nodeAnim = animation->mChannels[channelId];
-            //PLEEPLOG_DEBUG("Fetching channel " + std::to_string(channelId));
-            const std::string boneName = nodeAnim->mNodeName.C_Str();
-            //PLEEPLOG_DEBUG("Fetching bone " + boneName);
-            const std::string armatureName = m_boneArmatureMap[boneName];
-            //PLEEPLOG_DEBUG("Fetching armature " + armatureName);
+            receipt.materialNames.insert(material.name);
+            const bool isPlaceholder = m_materialPlaceholders.erase(material.name) > 0;
+            // check uniqueness
+            if (!isPlaceholder && m_materialMap.count(material.name))
+            {
+                PLEEPLOG_WARN("Could not import material " + material.name + ", it already exists");
+                // we could try to generate a default name here if file name is different
+                continue;
+            }
 
-            // channels indices do not align with bone indices
-            // so we need to lookup its real boneId
-            const unsigned int boneId = m_boneIdMapMap[armatureName][boneName];
+            std::shared_ptr<Material> newMaterial = _build_material(material);
+            if (isPlaceholder)
+            {
+                // fill in place for those already holding the placeholder (already named)
+                // other threads may be reading it, so only its guarded textures are touched
+                m_materialMap[material.name]->fill_textures(std::move(newMaterial->m_textures));
+            }
+            else
+            {
+                // apply name outside of _build_material for ModelManagerFaux
+                newMaterial->m_name = material.name;
+                newMaterial->m_sourceFilepath = model.sourceFilepath;
+                m_materialMap[material.name] = newMaterial;
+            }
+        }
 
-            //PLEEPLOG_DEBUG("Loading " + std::to_string(nodeAnim->mNumPositionKeys) + " position keyframes for: " + boneName);
-            for (unsigned int t = 0; t < nodeAnim->mNumPositionKeys; t++)
+        for (const ModelData::ArmatureData& armature : model.armatures)
+        {
+            receipt.armatureNames.insert(armature.name);
+            if (m_armatureMap.count(armature.name))
             {
-                newAnimation->m_posKeyframes[boneId].push_back({
-                    assimp_converters::convert_vec3(nodeAnim->mPositionKeys[t].mValue),
-                    nodeAnim->mPositionKeys[t].mTime
-                });
+                PLEEPLOG_WARN("Could not import armature " + armature.name + ", it already exists");
+                continue;
             }
-            //PLEEPLOG_DEBUG("Loading " + std::to_string(nodeAnim->mNumRotationKeys) + " rotation keyframes for: " + boneName);
-            for (unsigned int t = 0; t < nodeAnim->mNumRotationKeys; t++)
+
+            // apply name outside of _build_armature for ModelManagerFaux, then it is never modified again
+            std::shared_ptr<Armature> newArmature = std::make_shared<Armature>(_build_armature(armature));
+            newArmature->m_name = armature.name;
+            newArmature->m_sourceFilepath = model.sourceFilepath;
+            m_armatureMap[armature.name] = newArmature;
+
+            // link bones to armature (for animations, even if armature has no bones in ModelManagerFaux)
+            for (const Bone& bone : armature.bones)
             {
-                newAnimation->m_rotKeyframes[boneId].push_back({
-                    assimp_converters::convert_quat(nodeAnim->mRotationKeys[t].mValue),
-                    nodeAnim->mRotationKeys[t].mTime
-                });
+                m_boneIdMapMap[armature.name][bone.m_name] = bone.m_id;
+                m_boneArmatureMap[bone.m_name] = armature.name;
             }
-            //PLEEPLOG_DEBUG("Loading " + std::to_string(nodeAnim->mNumScalingKeys) + " scaling keyframes for: " + boneName);
-            for (unsigned int t = 0; t < nodeAnim->mNumScalingKeys; t++)
+        }
+
+        for (const ModelData::MeshData& mesh : model.meshes)
+        {
+            receipt.meshNames.insert(mesh.name);
+            const bool isPlaceholder = m_meshPlaceholders.erase(mesh.name) > 0;
+            if (!isPlaceholder && m_meshMap.count(mesh.name))
             {
-                newAnimation->m_sclKeyframes[boneId].push_back({
-                    assimp_converters::convert_vec3(nodeAnim->mScalingKeys[t].mValue),
-                    nodeAnim->mScalingKeys[t].mTime
-                });
+                PLEEPLOG_WARN("Could not import mesh " + mesh.name + ", it already exists");
+                continue;
             }
+
+            std::shared_ptr<Mesh> newMesh = _build_mesh(mesh);
+            if (isPlaceholder)
+            {
+                // fill in place for those already holding the placeholder (already named)
+                // other threads may be reading it, so only its guarded data is touched
+                m_meshMap[mesh.name]->swap_data(*newMesh);
+            }
+            else
+            {
+                // apply name outside of _build_mesh for ModelManagerFaux
+                newMesh->m_name = mesh.name;
+                newMesh->m_sourceFilepath = model.sourceFilepath;
+                m_meshMap[mesh.name] = newMesh;
+            }
+
+            // collider hierarchy is only built if fetch_collider_mesh asks for it
+            m_colliderMeshMap.erase(mesh.name);
+            m_colliderSourceMap[mesh.name] = _read_collider_source(mesh);
+            m_colliderSourceMap[mesh.name].sourceFilepath = model.sourceFilepath;
+        }
+
+        for (const ModelData::AnimationData& animation : model.animations)
+        {
+            receipt.animationNames.insert(animation.name);
+            // animations are replaced, keyframes may have changed with the same armature
+
+            m_animationMap[animation.name] = _build_animation(animation);
+            // provide name, filepath outside of _build_animation, so that ModelManagerFaux's life is easy
+            m_animationMap[animation.name]->m_name = animation.name;
+            m_animationMap[animation.name]->m_sourceFilepath = model.sourceFilepath;
+        }
+
+        //debug_receipt(receipt);
+        return receipt;
+    }
+
+    std::shared_ptr<Material> ModelManager::_build_material(const ModelData::MaterialData& material)
+    {
+        PLEEPLOG_DEBUG("Loading material: " + material.name);
+
+        std::unordered_map<TextureType, Texture> loadedTextures;
+        for (const ModelData::TextureData& texture : material.textures)
+        {
+            if (!texture.image.texels.empty())
+            {
+                // decoded by an async import
+                loadedTextures.emplace(
+                    std::piecewise_construct,
+                    std::forward_as_tuple(texture.type),
+                    std::forward_as_tuple(texture.type, texture.filepath, texture.image)
+                );
+            }
+            else if (texture.embedded.empty())
+            {
+                PLEEPLOG_DEBUG("Loading texture: " + texture.filepath);
+
+                // create Texture without copying
+                // weirdness to pass Texture constructor parameters
+                loadedTextures.emplace(
+                    std::piecewise_construct,
+                    std::forward_as_tuple(texture.type),
+                    std::forward_as_tuple(texture.type, texture.filepath)
+                );
+            }
+            else
+            {
+                PLEEPLOG_DEBUG("Loading EMBEDDED Texture: " + texture.filepath);
+
+                const unsigned int texChannels = 4; // TODO: add achFormatHint[5-7] as integers?
+                loadedTextures.emplace(
+                    std::piecewise_construct,
+                    std::forward_as_tuple(texture.type),
+                    std::forward_as_tuple(texture.type, texture.width, texture.height, texChannels, reinterpret_cast<const char*>(texture.embedded.data()))
+                );
+            }
+        }
+
+        return std::make_shared<Material>(std::move(loadedTextures));
+    }
+
+    Armature ModelManager::_build_armature(const ModelData::ArmatureData& armature)
+    {
+        PLEEPLOG_DEBUG("Loading armature: " + armature.name);
+        Armature newArmature{armature.bones};
+        newArmature.m_relativeTransform = armature.relativeTransform;
+        return newArmature;
+    }
+
+    std::shared_ptr<Mesh> ModelManager::_build_mesh(const ModelData::MeshData& mesh)
+    {
+        PLEEPLOG_DEBUG("Loading mesh " + mesh.name);
+        return std::make_shared<Mesh>(mesh.vertices, mesh.indices);
+    }
+
+    ModelManager::ColliderMeshSource ModelManager::_read_collider_source(const ModelData::MeshData& mesh)
+    {
+        // only positions are needed for collision
+        ColliderMeshSource source;
+        source.positions.reserve(mesh.vertices.size());
+        for (const Vertex& vertex : mesh.vertices)
+        {
+            source.positions.push_back(vertex.position);
+        }
+        source.indices = mesh.colliderIndices.empty() ? mesh.indices : mesh.colliderIndices;
+        return source;
+    }
+
+    std::shared_ptr<ColliderMesh> ModelManager::_build_collider_mesh(const ColliderMeshSource& source)
+    {
+        return std::make_shared<ColliderMesh>(source.positions, source.indices);
+    }
+
+    std::shared_ptr<AnimationSkeletal> ModelManager::_build_animation(const ModelData::AnimationData& animation)
+    {
+        std::shared_ptr<AnimationSkeletal> newAnimation = std::make_shared<AnimationSkeletal>();
+        newAnimation->m_duration = animation.duration;
+        newAnimation->m_frequency = animation.frequency;
+
+        for (const ModelData::ChannelData& channel : animation.channels)
+        {
+            // channels indices do not align with bone indices
+            // so we need to lookup its real boneId
+            auto armatureIt = m_boneArmatureMap.find(channel.boneName);
+            if (armatureIt == m_boneArmatureMap.end())
+            {
+                PLEEPLOG_WARN("Animation " + animation.name + " has keyframes for bone " + channel.boneName + " which is in no cached armature, ignoring them");
+                continue;
+            }
+            const unsigned int boneId = m_boneIdMapMap[armatureIt->second][channel.boneName];
+
+            newAnimation->m_posKeyframes[boneId] = channel.posKeyframes;
+            newAnimation->m_rotKeyframes[boneId] = channel.rotKeyframes;
+            newAnimation->m_sclKeyframes[boneId] = channel.sclKeyframes;
         }
         return newAnimation;
     }
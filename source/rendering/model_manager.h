@@ -6,6 +6,12 @@
 #include <unordered_set>
 #include <memory>
 #include <string>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <functional>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -14,6 +20,9 @@
 #include "rendering/material.h"
 #include "rendering/armature.h"
 #include "rendering/animation_skeletal.h"
+#include "physics/collider_mesh.h"
+#include "physics/collider_mesh_source.h"
+#include "rendering/asset_import_pool.h"
 
 namespace pleep
 {
@@ -35,9 +44,16 @@ namespace pleep
     // A static (global) access point to corrdinate memory for model objects
     //  (as multiple entities could want to use the same data)
     // Methods which allocate gpu memory must be virtual (for ModelManagerFaux)
-    class ModelManager
+    // Also the source physics fetches ColliderMeshes from (while it exists)
+    class ModelManager : public I_ColliderMeshSource
     {
     public:
+        ModelManager()
+        {
+            ColliderMeshes::set_source(this);
+        }
+        // waits for running async imports, futures of imports not yet cached throw runtime_error
+        virtual ~ModelManager();
     
         // List of assets for 1 "collection" from an import
         struct AssetReceipt
@@ -71,20 +87,125 @@ namespace pleep
             std::unordered_set<std::string> animationNames;
         };
 
+        // Every asset of one model file as plain cpu data, before any of it is cached (or given to the gpu)
+        // Read from the source file with Assimp, or directly out of its baked file (see set_bake_directory)
+        // Names have already been given to unnamed assets, and bone ids resolved within the file
+        struct ModelData
+        {
+            struct TextureData
+            {
+                TextureType type = TextureType::none;
+                // path of a separate texture file, or the name of an embedded texture
+                std::string filepath;
+                // embedded textures only (height is 0 if embedded is compressed)
+                unsigned int width = 0;
+                unsigned int height = 0;
+                std::vector<uint8_t> embedded;
+                // texels of filepath decoded ahead of time (only by async imports, never baked)
+                TextureImage image;
+            };
+            struct MaterialData
+            {
+                std::string name;
+                std::vector<TextureData> textures;
+            };
+            struct ArmatureData
+            {
+                std::string name;
+                glm::mat4 relativeTransform = glm::mat4(1.0f);
+                std::vector<Bone> bones;
+            };
+            struct MeshData
+            {
+                std::string name;
+                std::vector<Vertex> vertices;
+                std::vector<unsigned int> indices;
+                // only triangles of indices, empty if every face is already a triangle
+                std::vector<unsigned int> colliderIndices;
+            };
+            // keyframes for one bone, bone ids are resolved when cached (the armature may be from another import)
+            struct ChannelData
+            {
+                std::string boneName;
+                std::vector<PositionKeyframe> posKeyframes;
+                std::vector<RotationKeyframe> rotKeyframes;
+                std::vector<ScaleKeyframe>    sclKeyframes;
+            };
+            struct AnimationData
+            {
+                std::string name;
+                double duration = 0.0;
+                double frequency = 0.0;
+                std::vector<ChannelData> channels;
+            };
+
+            // Name of overall import (file name)
+            std::string importName;
+            // location import was read from
+            std::string sourceFilepath;
+            // other files the import read (eg. .mtl, .bin, separate textures), a baked file is stale if any change
+            std::vector<std::string> dependencies;
+
+            std::vector<MaterialData>  materials;
+            std::vector<ArmatureData>  armatures;
+            std::vector<MeshData>      meshes;
+            std::vector<AnimationData> animations;
+        };
+
 
         // Load all assets from given filepath into cache
+        // (from its baked file if there is an up to date one in the bake directory)
         ImportReceipt import(const std::string filepath);
 
+        // Directory to keep baked model files in (which must exist), empty (default) disables baking
+        // A baked file holds a model's ModelData ready to be memory mapped, keyed by source filepath
+        // and the contents of the source file and its dependencies, so imports can skip Assimp entirely.
+        // Imports of a model with no (up to date) baked file bake it after reading it with Assimp
+        void set_bake_directory(const std::string& directory);
+        // Read model file at filepath with Assimp and (re)write its baked file, without caching any assets
+        // for baking ahead of time, returns false if it could not be read or written
+        bool bake(const std::string& filepath);
+
+        // ***** Asynchronous Import *****
+        // Read the file at filepath (parse, and decode its textures) on an import worker thread,
+        // its assets are then cached (and given to the gpu) by a later process_async_imports call
+        // calls for a file already being imported share its receipt
+        std::shared_future<ImportReceipt> import_async(const std::string& filepath);
+        // Fetch, or if not cached return a placeholder (with no gpu data) and import_async its filepath
+        // the placeholder is filled in place once the import is cached, so holders don't need to fetch again
+        // returns nullptr if the import finished without the asset
+        std::shared_ptr<const Mesh>     fetch_mesh_async(const std::string& name, const std::string& filepath);
+        std::shared_ptr<const Material> fetch_material_async(const std::string& name, const std::string& filepath);
+        // Cache imports which workers have finished reading, must be called on the thread with the gl context
+        // stops once maxSeconds have passed (after at least one) so finished imports are spread over frames
+        // returns number of imports cached
+        size_t process_async_imports(double maxSeconds);
+        // number of import_async calls not yet cached
+        size_t get_pending_import_count() const;
+
+        // ***** Threading *****
+        // The cache can be used from any thread, but gpu data can only be made on the thread with the gl context
+        // Once the calling thread is set as the gl thread, calls from other threads which would make gpu data wait for it:
+        // import reads on an import worker, generating hardcoded meshes and create_material are run
+        // by the gl thread's next process_async_imports (so it must keep calling it while others may wait)
+        // Until then every thread is assumed to have the gl context
+        void set_gl_thread();
+
         // Tries to add Material to the cache, constructed with the given dict of texture filepaths
         virtual bool create_material(const std::string& name, const std::unordered_map<TextureType, std::string>& textureDict);
 
         // ***** Fetch Methods *****
         // if asset exists in library return shallow, const, shared instance from cache
-        // (or a deep copy for armatures)
         std::shared_ptr<const Mesh>              fetch_mesh(const std::string& name);
         std::shared_ptr<const Material>          fetch_material(const std::string& name);
-        Armature                                 fetch_armature(const std::string& name);
+        std::shared_ptr<const Armature>          fetch_armature(const std::string& name);
         std::shared_ptr<const AnimationSkeletal> fetch_animation(const std::string& name);
+        // collider meshes share the name of the imported mesh they are built from (on their first fetch)
+        std::shared_ptr<const ColliderMesh>      fetch_collider_mesh(const std::string& name) override;
+        void import_collider_meshes(const std::string& filepath) override
+        {
+            this->import(filepath);
+        }
         
         // hardcoded meshes
         enum class BasicMeshType
@@ -150,8 +271,8 @@ namespace pleep
         // Modifying materials across ALL entities can only be done through ModelCache methods.
         std::unordered_map<std::string, std::shared_ptr<Material>> m_materialMap;
         // armature node name -> Armature
-        // Armatures are individual to each entity and should be copied NOT shared
-        std::unordered_map<std::string, Armature> m_armatureMap;
+        // (Armatures are immutable once cached, entities keep their own pose of its bones)
+        std::unordered_map<std::string, std::shared_ptr<const Armature>> m_armatureMap;
         // armature node name + bone node name -> bone Id
         // bone Id == index in armature.m_bones
         std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>> m_boneIdMapMap;
@@ -160,38 +281,120 @@ namespace pleep
         // animation name -> AnimationSkeletal
         // (Distribute only shared_ptr<const Material> to not let copies modify keyframes)
         std::unordered_map<std::string, std::shared_ptr<AnimationSkeletal>> m_animationMap;
+        // mesh node name -> ColliderMesh
+        // (no gpu data, so these are also built by ModelManagerFaux for servers)
+        std::unordered_map<std::string, std::shared_ptr<ColliderMesh>> m_colliderMeshMap;
+        // Triangles of a cached mesh, kept until it is first fetched as a collider mesh
+        // (most meshes are only ever rendered, so their hierarchy is never built)
+        struct ColliderMeshSource
+        {
+            std::string sourceFilepath;
+            std::vector<glm::vec3> positions;
+            std::vector<unsigned int> indices;
+        };
+        // mesh node name -> triangles not yet built into m_colliderMeshMap
+        std::unordered_map<std::string, ColliderMeshSource> m_colliderSourceMap;
+
+        // Directory baked model files are read from and written to (empty if disabled)
+        std::string m_bakeDirectory;
+
+        // An import_async whose file is read by a worker, then cached by process_async_imports
+        struct AsyncImport
+        {
+            std::string filepath;
+            // only touched by the worker until it is queued in m_readImports
+            ModelData model;
+            bool isRead = false;
+            std::promise<ImportReceipt> promise;
+            std::shared_future<ImportReceipt> receipt;
+        };
+        // filepath -> imports not yet cached
+        std::unordered_map<std::string, std::shared_ptr<AsyncImport>> m_pendingImports;
+        // imports workers have finished reading (successfully or not)
+        std::deque<std::shared_ptr<AsyncImport>> m_readImports;
+        std::mutex m_readImportsMutex;
+        // names of placeholder assets (given by fetch_*_async) waiting for their import
+        std::unordered_set<std::string> m_meshPlaceholders;
+        std::unordered_set<std::string> m_materialPlaceholders;
+
+        // guards every map above (and the pending imports), so one thread can fetch while the gl thread caches
+        // recursive because public methods call each other (fetch_mesh -> import, fetch_*_async -> import_async)
+        mutable std::recursive_mutex m_cacheMutex;
 
-        // Check for possible assets (according to format assumptions above) and load into receipt
-        // if an asset has no name use nameDefault_assetType_x
-        //   where x is the index of that asset in its respective container
-        // if omitExisting == true, assets already in library will not be in receipt (to know which need to be loaded)
-        ImportReceipt _scan_scene(const aiScene* scene, const std::string& nameDefault = "Pleep", const bool omitExisting = false);
-        void _scan_node(const aiScene* scene, const aiNode* node, ImportReceipt& receipt, const bool omitExisting);
+        // thread given by set_gl_thread, default id if every thread may use gl
+        std::thread::id m_glThreadId;
+        // work from other threads waiting for the gl thread's process_async_imports
+        std::deque<std::function<void()>> m_glTasks;
+        std::mutex m_glTasksMutex;
+        // true if a gl thread is set and it isn't this one
+        bool _is_off_gl_thread() const;
+        void _queue_on_gl_thread(std::function<void()> task);
+        // queue work for the gl thread and wait for its result (or exception)
+        // never call with m_cacheMutex held, the gl thread will need it
+        template<typename T_Result>
+        T_Result _run_on_gl_thread(std::function<T_Result()> work)
+        {
+            std::shared_ptr<std::packaged_task<T_Result()>> task = std::make_shared<std::packaged_task<T_Result()>>(std::move(work));
+            std::future<T_Result> result = task->get_future();
+            this->_queue_on_gl_thread([task]() { (*task)(); });
+            return result.get();
+        }
+
+        // false -> import_async imports synchronously (for ModelManagerFaux)
+        virtual bool _is_async_import_enabled() const { return true; }
+        // read model file with the baked file if possible, and decode its textures (on a worker thread)
+        bool _read_model_async(const std::string& filepath, ModelData& dest);
+        // remove placeholders from filepath which its import did not fill
+        void _drop_placeholders(const std::string& filepath);
 
-        // Iterate through scene materials, load and emplace as new Material in m_materialMap
+        // Read all assets in model file at filepath into dest with Assimp
+        // returns false if Assimp could not read it
+        bool _read_model(const std::string& filepath, ModelData& dest);
+
+        // Iterate through scene materials, reading (only the first) texture of each type
         // can only search for textures contained exactly in given directory (no postfix / or \\)
-        void _process_materials(const aiScene* scene, const ImportReceipt& receipt, const std::string directory = "./");
-        virtual std::shared_ptr<Material> _build_material(const aiScene* scene, const aiMaterial* material, const std::string& materialName, const std::string& directory);
-
-        // Iterate through collection nodes for those in scanned receipt armatures,
-        //   emplace as Armaturse m_armatureMap named as node name
-        void _process_armatures(const aiNode* node, const ImportReceipt& receipt, const glm::mat4 parentTransform = glm::mat4(1.0f));
-        virtual Armature _build_armature(const aiNode* node);
-        void _extract_bones_from_node(const aiNode* node, std::vector<Bone>& armatureBones, std::string armatureName);
-
-        // Iterate through collection nodes for those in scanned receipt meshes,
-        //   emplace as Meshes m_meshMap named as node name
-        // use scanned armatures to set vertex bone weights
-        // use scanned materials to set receipt meshMaterialsNames
-        void _process_meshes(const aiScene* scene, const ImportReceipt& receipt);
-        virtual std::shared_ptr<Mesh> _build_mesh(const aiMesh* mesh, const ImportReceipt& receipt);
+        void _read_materials(const aiScene* scene, ModelData& dest, const std::string& directory = ".");
+
+        // Collect names of armatures referenced by bones of meshes in node or its descendants
+        void _scan_armature_names(const aiScene* scene, const aiNode* node, std::unordered_set<std::string>& dest);
+        // Iterate through nodes for those in armatureNames, reading each and all its descendants as an armature
+        // boneIdMapMap is filled with armature name + bone name -> bone id for meshes of this file to reference
+        void _read_armatures(const aiNode* node, const std::unordered_set<std::string>& armatureNames, ModelData& dest,
+            std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>>& boneIdMapMap,
+            const glm::mat4 parentTransform = glm::mat4(1.0f));
+        void _extract_bones_from_node(const aiNode* node, std::vector<Bone>& armatureBones, std::unordered_map<std::string, unsigned int>& boneIdMap);
+
+        // Iterate through scene meshes
+        // use read armatures to set vertex bone weights (and the armatures' bind transforms)
+        void _read_meshes(const aiScene* scene, ModelData& dest,
+            const std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>>& boneIdMapMap);
         void _extract_vertices(std::vector<Vertex>& dest, const aiMesh* src);
-        void _extract_indices(std::vector<unsigned int>& dest, const aiMesh* src);
-        void _extract_bone_weights_for_vertices(std::vector<Vertex>& dest, const aiMesh* src, const ImportReceipt& receipt);
+        void _extract_indices(std::vector<unsigned int>& dest, std::vector<unsigned int>& colliderDest, const aiMesh* src);
+        void _extract_bone_weights_for_vertices(std::vector<Vertex>& dest, const aiMesh* src, ModelData& model,
+            const std::unordered_map<std::string, std::unordered_map<std::string, unsigned int>>& boneIdMapMap);
+
+        // Iterate through scene animations, reading keyframes of each channel
+        void _read_animations(const aiScene* scene, ModelData& dest);
 
-        // Iterate through scene animations, load and emplace as new AnimationSkeletal in m_animationMap
-        void _process_animations(const aiScene* scene, const ImportReceipt& receipt);
-        virtual std::shared_ptr<AnimationSkeletal> _build_animation(const aiAnimation* animation);
+        // Baked model files (see model_manager_bake.cpp)
+        // path of the baked file for model at filepath in m_bakeDirectory
+        std::string _get_bake_path(const std::string& filepath) const;
+        // returns false if baking is disabled, or there is no baked file of the current contents of filepath
+        bool _read_baked_model(const std::string& filepath, ModelData& dest);
+        bool _write_baked_model(const ModelData& model);
+
+        // Emplace every asset of model into its map using the _build methods
+        // (materials, meshes, and armatures already cached are kept, animations are replaced)
+        // returns names of ALL assets in model, whether or not they were already cached
+        ImportReceipt _cache_model(const ModelData& model);
+        virtual std::shared_ptr<Material> _build_material(const ModelData::MaterialData& material);
+        virtual Armature _build_armature(const ModelData::ArmatureData& armature);
+        virtual std::shared_ptr<Mesh> _build_mesh(const ModelData::MeshData& mesh);
+        // Non-virtual, collision data is needed with or without a gpu
+        ColliderMeshSource _read_collider_source(const ModelData::MeshData& mesh);
+        std::shared_ptr<ColliderMesh> _build_collider_mesh(const ColliderMeshSource& source);
+        // resolves channel bone names with cached armatures
+        virtual std::shared_ptr<AnimationSkeletal> _build_animation(const ModelData::AnimationData& animation);
 
         // should be congruent with definition of SphereCollider (approximately)
         //virtual std::shared_ptr<Mesh> _build_sphere_mesh();
@@ -201,6 +404,9 @@ namespace pleep
         virtual std::shared_ptr<Mesh> _build_screen_mesh();
         virtual std::shared_ptr<Mesh> _build_icosahedron_mesh();
         virtual std::shared_ptr<Mesh> _build_vector_mesh();
+
+        // started on first import_async, last member so workers stop before anything they use is destroyed
+        std::unique_ptr<AssetImportPool> m_importPool;
     };
 }
 
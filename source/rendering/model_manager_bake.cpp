@@ -0,0 +1,355 @@
+#include "rendering/model_manager.h"
+
+#include <cstdio>
+
+#include "logging/pleep_log.h"
+#include "core/mapped_file.h"
+
+namespace pleep
+{
+    constexpr uint32_t BAKED_MODEL_MAGIC = 0x444D4C50; // "PLMD"
+    // increment whenever the layout below, ModelData, Vertex, or the Assimp import flags change
+    constexpr uint32_t BAKED_MODEL_VERSION = 2;
+
+    // File layout (native endianness and padding, baked files don't move between builds/machines):
+    // BakedModelHeader
+    // dependencyCount x (BakedDependencyRecord, string filepath), the first is the source file itself
+    // string importName
+    // materialCount  x (string name, uint32_t textureCount, textureCount x (BakedTextureRecord, string filepath, embedded bytes))
+    // armatureCount  x (string name, glm::mat4 relativeTransform, uint32_t boneCount, boneCount x (string name, BakedBoneRecord, childCount x uint32_t))
+    // meshCount      x (string name, BakedMeshRecord, Vertex array, index array, collider index array)
+    // animationCount x (string name, BakedAnimationRecord, channelCount x (string boneName, BakedChannelRecord, keyframe arrays))
+    // strings are uint32_t length then characters
+    struct BakedModelHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t dependencyCount;
+        uint32_t materialCount;
+        uint32_t armatureCount;
+        uint32_t meshCount;
+        uint32_t animationCount;
+    };
+    // a file the bake was made from, as it was when baked
+    struct BakedDependencyRecord
+    {
+        uint64_t size;
+        int64_t modified;
+        // FNV-1a of the file's contents
+        uint64_t hash;
+    };
+    struct BakedTextureRecord
+    {
+        uint32_t type;
+        uint32_t width;
+        uint32_t height;
+        uint32_t embeddedSize;
+    };
+    struct BakedBoneRecord
+    {
+        glm::mat4 relativeTransform;
+        glm::mat4 bindTransform;
+        uint32_t id;
+        uint32_t childCount;
+    };
+    struct BakedMeshRecord
+    {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t colliderIndexCount;
+    };
+    struct BakedAnimationRecord
+    {
+        double duration;
+        double frequency;
+        uint32_t channelCount;
+    };
+    struct BakedChannelRecord
+    {
+        uint32_t posCount;
+        uint32_t rotCount;
+        uint32_t sclCount;
+    };
+
+    static uint64_t _hash_fnv64(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Only hash the file if its size matches but its modified time doesn't (eg. after a checkout)
+    static bool _is_dependency_current(const std::string& filepath, const BakedDependencyRecord& record)
+    {
+        FileStamp stamp;
+        if (!stamp_file(filepath, stamp) || stamp.size != record.size) return false;
+        if (stamp.modified == record.modified) return true;
+
+        MappedFile file(filepath);
+        return file.size() == record.size && _hash_fnv64(file.data(), file.size()) == record.hash;
+    }
+
+    // false if filepath can't be read
+    static bool _append_dependency(std::vector<uint8_t>& data, const std::string& filepath)
+    {
+        FileStamp stamp;
+        MappedFile file(filepath);
+        if (!stamp_file(filepath, stamp) || !file.data()) return false;
+
+        append_mapped(data, BakedDependencyRecord{ file.size(), stamp.modified, _hash_fnv64(file.data(), file.size()) });
+        append_mapped_string(data, filepath);
+        return true;
+    }
+
+    std::string ModelManager::_get_bake_path(const std::string& filepath) const
+    {
+        // keep the stem readable, and the path hash so same named files in different directories don't collide
+        const size_t delimiterIndex = filepath.find_last_of("/\\");
+        const std::string filename = delimiterIndex == std::string::npos ? filepath : filepath.substr(delimiterIndex + 1);
+        const std::string filestem = filename.substr(0, filename.find_last_of("."));
+
+        char pathHash[17];
+        std::snprintf(pathHash, sizeof(pathHash), "%016llx",
+            static_cast<unsigned long long>(_hash_fnv64(reinterpret_cast<const uint8_t*>(filepath.data()), filepath.size())));
+
+        std::string path = m_bakeDirectory;
+        if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+        return path + filestem + "_" + pathHash + ".pleepmodel";
+    }
+
+    bool ModelManager::_read_baked_model(const std::string& filepath, ModelData& dest)
+    {
+        if (m_bakeDirectory.empty()) return false;
+
+        const std::string bakePath = _get_bake_path(filepath);
+        MappedFile file(bakePath);
+        if (!file.data())
+        {
+            PLEEPLOG_DEBUG("No baked model at " + bakePath);
+            return false;
+        }
+
+        try
+        {
+            MappedReader reader(file.data(), file.size());
+
+            BakedModelHeader header;
+            reader.read(header);
+            if (header.magic != BAKED_MODEL_MAGIC || header.version != BAKED_MODEL_VERSION)
+            {
+                PLEEPLOG_DEBUG("File " + bakePath + " is not a baked model of this version, ignoring it");
+                return false;
+            }
+
+            for (uint32_t d = 0; d < header.dependencyCount; d++)
+            {
+                BakedDependencyRecord record;
+                reader.read(record);
+                std::string dependency;
+                reader.read_string(dependency);
+
+                if (d == 0 && dependency != filepath)
+                {
+                    PLEEPLOG_WARN("Baked model " + bakePath + " was baked from " + dependency + " not " + filepath + ", ignoring it");
+                    dest = ModelData{};
+                    return false;
+                }
+                if (!_is_dependency_current(dependency, record))
+                {
+                    PLEEPLOG_DEBUG("Baked model " + bakePath + " is out of date with " + dependency + ", ignoring it");
+                    dest = ModelData{};
+                    return false;
+                }
+
+                if (d == 0) dest.sourceFilepath = dependency;
+                else dest.dependencies.push_back(dependency);
+            }
+            if (dest.sourceFilepath.empty())
+            {
+                PLEEPLOG_WARN("Baked model " + bakePath + " has no source file, ignoring it");
+                return false;
+            }
+            reader.read_string(dest.importName);
+
+            dest.materials.resize(header.materialCount);
+            for (ModelData::MaterialData& material : dest.materials)
+            {
+                reader.read_string(material.name);
+                uint32_t textureCount = 0;
+                reader.read(textureCount);
+                material.textures.resize(textureCount);
+                for (ModelData::TextureData& texture : material.textures)
+                {
+                    BakedTextureRecord record;
+                    reader.read(record);
+                    texture.type = static_cast<TextureType>(record.type);
+                    texture.width = record.width;
+                    texture.height = record.height;
+                    reader.read_string(texture.filepath);
+                    reader.read_bytes(texture.embedded, record.embeddedSize);
+                }
+            }
+
+            dest.armatures.resize(header.armatureCount);
+            for (ModelData::ArmatureData& armature : dest.armatures)
+            {
+                reader.read_string(armature.name);
+                reader.read(armature.relativeTransform);
+                uint32_t boneCount = 0;
+                reader.read(boneCount);
+                armature.bones.resize(boneCount);
+                for (Bone& bone : armature.bones)
+                {
+                    reader.read_string(bone.m_name);
+                    BakedBoneRecord record;
+                    reader.read(record);
+                    bone.m_relativeTransform = record.relativeTransform;
+                    bone.m_bindTransform = record.bindTransform;
+                    bone.m_id = record.id;
+                    reader.read_array(bone.m_childIds, record.childCount);
+                }
+            }
+
+            dest.meshes.resize(header.meshCount);
+            for (ModelData::MeshData& mesh : dest.meshes)
+            {
+                reader.read_string(mesh.name);
+                BakedMeshRecord record;
+                reader.read(record);
+                reader.read_array(mesh.vertices, record.vertexCount);
+                reader.read_array(mesh.indices, record.indexCount);
+                reader.read_array(mesh.colliderIndices, record.colliderIndexCount);
+            }
+
+            dest.animations.resize(header.animationCount);
+            for (ModelData::AnimationData& animation : dest.animations)
+            {
+                reader.read_string(animation.name);
+                BakedAnimationRecord record;
+                reader.read(record);
+                animation.duration = record.duration;
+                animation.frequency = record.frequency;
+                animation.channels.resize(record.channelCount);
+                for (ModelData::ChannelData& channel : animation.channels)
+                {
+                    reader.read_string(channel.boneName);
+                    BakedChannelRecord channelRecord;
+                    reader.read(channelRecord);
+                    reader.read_array(channel.posKeyframes, channelRecord.posCount);
+                    reader.read_array(channel.rotKeyframes, channelRecord.rotCount);
+                    reader.read_array(channel.sclKeyframes, channelRecord.sclCount);
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            PLEEPLOG_ERROR("Could not read baked model " + bakePath + ": " + e.what());
+            // don't leave a partial model for the Assimp fallback
+            dest = ModelData{};
+            return false;
+        }
+        return true;
+    }
+
+    bool ModelManager::_write_baked_model(const ModelData& model)
+    {
+        if (m_bakeDirectory.empty())
+        {
+            PLEEPLOG_WARN("Could not bake model " + model.sourceFilepath + ", no bake directory is set");
+            return false;
+        }
+
+        std::vector<uint8_t> dependencyData;
+        if (!_append_dependency(dependencyData, model.sourceFilepath))
+        {
+            PLEEPLOG_WARN("Could not bake model " + model.sourceFilepath + ", its source file could not be read to hash");
+            return false;
+        }
+        uint32_t dependencyCount = 1;
+        for (const std::string& dependency : model.dependencies)
+        {
+            // a dependency which is gone now would never be current, leave it out
+            if (_append_dependency(dependencyData, dependency)) dependencyCount++;
+        }
+
+        BakedModelHeader header;
+        header.magic = BAKED_MODEL_MAGIC;
+        header.version = BAKED_MODEL_VERSION;
+        header.dependencyCount = dependencyCount;
+        header.materialCount = static_cast<uint32_t>(model.materials.size());
+        header.armatureCount = static_cast<uint32_t>(model.armatures.size());
+        header.meshCount = static_cast<uint32_t>(model.meshes.size());
+        header.animationCount = static_cast<uint32_t>(model.animations.size());
+
+        std::vector<uint8_t> data;
+        append_mapped(data, header);
+        data.insert(data.end(), dependencyData.begin(), dependencyData.end());
+        append_mapped_string(data, model.importName);
+
+        for (const ModelData::MaterialData& material : model.materials)
+        {
+            append_mapped_string(data, material.name);
+            append_mapped(data, static_cast<uint32_t>(material.textures.size()));
+            for (const ModelData::TextureData& texture : material.textures)
+            {
+                append_mapped(data, BakedTextureRecord{
+                    static_cast<uint32_t>(texture.type), texture.width, texture.height, static_cast<uint32_t>(texture.embedded.size())
+                });
+                append_mapped_string(data, texture.filepath);
+                append_mapped_bytes(data, texture.embedded);
+            }
+        }
+
+        for (const ModelData::ArmatureData& armature : model.armatures)
+        {
+            append_mapped_string(data, armature.name);
+            append_mapped(data, armature.relativeTransform);
+            append_mapped(data, static_cast<uint32_t>(armature.bones.size()));
+            for (const Bone& bone : armature.bones)
+            {
+                append_mapped_string(data, bone.m_name);
+                append_mapped(data, BakedBoneRecord{
+                    bone.m_relativeTransform, bone.m_bindTransform, bone.m_id, static_cast<uint32_t>(bone.m_childIds.size())
+                });
+                append_mapped_array(data, bone.m_childIds);
+            }
+        }
+
+        for (const ModelData::MeshData& mesh : model.meshes)
+        {
+            append_mapped_string(data, mesh.name);
+            append_mapped(data, BakedMeshRecord{
+                static_cast<uint32_t>(mesh.vertices.size()), static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(mesh.colliderIndices.size())
+            });
+            append_mapped_array(data, mesh.vertices);
+            append_mapped_array(data, mesh.indices);
+            append_mapped_array(data, mesh.colliderIndices);
+        }
+
+        for (const ModelData::AnimationData& animation : model.animations)
+        {
+            append_mapped_string(data, animation.name);
+            append_mapped(data, BakedAnimationRecord{ animation.duration, animation.frequency, static_cast<uint32_t>(animation.channels.size()) });
+            for (const ModelData::ChannelData& channel : animation.channels)
+            {
+                append_mapped_string(data, channel.boneName);
+                append_mapped(data, BakedChannelRecord{
+                    static_cast<uint32_t>(channel.posKeyframes.size()), static_cast<uint32_t>(channel.rotKeyframes.size()), static_cast<uint32_t>(channel.sclKeyframes.size())
+                });
+                append_mapped_array(data, channel.posKeyframes);
+                append_mapped_array(data, channel.rotKeyframes);
+                append_mapped_array(data, channel.sclKeyframes);
+            }
+        }
+
+        const std::string bakePath = _get_bake_path(model.sourceFilepath);
+        if (!write_file_replacing(bakePath, data)) return false;
+
+        PLEEPLOG_DEBUG("Baked model " + model.sourceFilepath + " to " + bakePath + " (" + std::to_string(data.size()) + " bytes)");
+        return true;
+    }
+}
@@ -32,35 +32,31 @@ namespace pleep
         return true;
     }
     
-    std::shared_ptr<Material> ModelManagerFaux::_build_material(const aiScene* scene, const aiMaterial* material, const std::string& materialName, const std::string& directory) 
+    std::shared_ptr<Material> ModelManagerFaux::_build_material(const ModelData::MaterialData& material) 
     {
-        UNREFERENCED_PARAMETER(scene);
         UNREFERENCED_PARAMETER(material);
-        UNREFERENCED_PARAMETER(materialName);
-        UNREFERENCED_PARAMETER(directory);
 
         // Material will have no textures
         return std::make_shared<Material>();
     }
     
-    Armature ModelManagerFaux::_build_armature(const aiNode* node)
+    Armature ModelManagerFaux::_build_armature(const ModelData::ArmatureData& armature)
     {
-        UNREFERENCED_PARAMETER(node);
+        UNREFERENCED_PARAMETER(armature);
         
         // Armature will have no bones
         return Armature{};
     }
     
-    std::shared_ptr<Mesh> ModelManagerFaux::_build_mesh(const aiMesh* mesh, const ImportReceipt& receipt)
+    std::shared_ptr<Mesh> ModelManagerFaux::_build_mesh(const ModelData::MeshData& mesh)
     {
         UNREFERENCED_PARAMETER(mesh);
-        UNREFERENCED_PARAMETER(receipt);
 
         // Mesh will have no vertices & indices, and no bound gpu buffers
         return std::make_shared<Mesh>();
     }
     
-    std::shared_ptr<AnimationSkeletal> ModelManagerFaux::_build_animation(const aiAnimation *animation) 
+    std::shared_ptr<AnimationSkeletal> ModelManagerFaux::_build_animation(const ModelData::AnimationData& animation) 
     {
         UNREFERENCED_PARAMETER(animation);
 
@@ -16,14 +16,17 @@ namespace pleep
         bool create_material(const std::string& name, const std::unordered_map<TextureType, std::string>& textureDict) override;
         
     protected:
+        // Servers have no frame to stall, and need collider meshes as soon as entities are deserialized
+        bool _is_async_import_enabled() const override { return false; }
+
         // Create empty Material
-        std::shared_ptr<Material> _build_material(const aiScene* scene, const aiMaterial* material, const std::string& materialName, const std::string& directory) override;
+        std::shared_ptr<Material> _build_material(const ModelData::MaterialData& material) override;
         // Create empty Armature (Armatures have no gpu data so we _could_ safely populate them)
-        Armature _build_armature(const aiNode* node) override;
+        Armature _build_armature(const ModelData::ArmatureData& armature) override;
         // Create empty Mesh
-        std::shared_ptr<Mesh> _build_mesh(const aiMesh* mesh, const ImportReceipt& receipt) override;
+        std::shared_ptr<Mesh> _build_mesh(const ModelData::MeshData& mesh) override;
         // Create empty Animation (Animations have no gpu data so we _could_ safely populate them)
-        std::shared_ptr<AnimationSkeletal> _build_animation(const aiAnimation *animation) override;
+        std::shared_ptr<AnimationSkeletal> _build_animation(const ModelData::AnimationData& animation) override;
 
         // Create BasicMeshTypes with only name and filepath
         std::shared_ptr<Mesh> _build_cube_mesh() override;
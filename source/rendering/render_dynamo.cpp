@@ -1,6 +1,7 @@
 #include "render_dynamo.h"
 
 #include <exception>
+#include <algorithm>
 #include "logging/pleep_log.h"
 
 namespace pleep
@@ -31,7 +32,7 @@ namespace pleep
         _configure_relay_resources();
 
         // get screen initial size
-        read_viewport_size(m_viewportDims);
+        glGetIntegerv(GL_VIEWPORT, m_viewportDims);
         // init view dimensions with default screen size until camera sends update
 
         PLEEPLOG_TRACE("Done render pipeline setup");
@@ -53,49 +54,32 @@ namespace pleep
     
     void RenderDynamo::submit(RenderPacket data)
     {
-        // pass transform/mesh/material information to relays
-        // we need to dispatch to appropriate relays
-        // renderable could have "id" of relay type it wants (what shader it wants)
-        //   then if we have that relay in our pipeline we can submit to it
-        //   or otherwise use some default
-        
-        // For now just hardwire to forward relay
-        m_forwardPass->submit(data);
+        if (m_isPipelined) m_frames.get_back().add(data);
+        else this->_submit_to_relays(data);
     }
     
     void RenderDynamo::submit(DebugRenderPacket data)
     {
-        m_forwardPass->submit(data);
+        if (m_isPipelined) m_frames.get_back().add(data);
+        else this->_submit_to_relays(data);
     }
     
     void RenderDynamo::submit(LightSourcePacket data) 
     {
-        // again, can we implicitly know which relays want this info
-        m_forwardPass->submit(data);
+        if (m_isPipelined) m_frames.get_back().add(data);
+        else this->_submit_to_relays(data);
     }
     
     void RenderDynamo::submit(CameraPacket data) 
     {
-        // store CameraPacket for Uniform Buffer (every submittion overrides)
-        // the ECS references are volatile so our pointers shouldn't persist past the frame time
-        m_viewTransform = &(data.transform);
-        m_viewCamera    = &(data.camera);
-
-        // GL functions don't like height and width of 0
-        if (m_viewCamera->viewWidth == 0 || m_viewCamera->viewHeight == 0)
-        {
-            return;
-        }
-        // again, i don't know if this is the best solution but,
-        // ecs references are volatile so its probably necessary.
-        m_forwardPass->submit(data);
-        m_screenPass->submit(data);
-        m_bloomPass->submit(data);
+        if (m_isPipelined) m_frames.get_back().add(data);
+        else this->_submit_to_relays(data);
     }
     
     void RenderDynamo::submit(AnimationPacket data)
     {
-        m_animator->submit(data);
+        if (m_isPipelined) m_frames.get_back().add(data);
+        else this->_submit_to_relays(data);
     }
 
     
@@ -107,10 +91,13 @@ namespace pleep
         //   then render through each renderable it has been submitted
         //   then close the frame
 
+        int viewportDims[4];
+        this->read_viewport_size(viewportDims);
+
         // if there is no camera data then... exit early
         // make sure relays are still reset after!
         if (m_viewTransform == nullptr || m_viewCamera == nullptr
-            || m_viewportDims[2] == 0 || m_viewportDims[3] == 0
+            || viewportDims[2] == 0 || viewportDims[3] == 0
             || m_viewCamera->viewWidth == 0 || m_viewCamera->viewHeight == 0)
         {
             //PLEEPLOG_WARN("No camera data this frame, skipping without rendering.");
@@ -135,32 +122,29 @@ namespace pleep
         err = glGetError();
         if (err) { PLEEPLOG_ERROR("glError after animation pass: " + std::to_string(err)); }
 
-        m_forwardPass->engage(m_viewportDims);
+        m_forwardPass->engage(viewportDims);
         err = glGetError();
         if (err) { PLEEPLOG_ERROR("glError after forward pass: " + std::to_string(err)); }
 
-        m_bloomPass->engage(m_viewportDims);
+        m_bloomPass->engage(viewportDims);
         err = glGetError();
         if (err) { PLEEPLOG_ERROR("glError after bloom pass: " + std::to_string(err)); }
 
-        m_screenPass->engage(m_viewportDims);
+        m_screenPass->engage(viewportDims);
         err = glGetError();
         if (err) { PLEEPLOG_ERROR("glError after screen pass: " + std::to_string(err)); }
     }
     
     void RenderDynamo::reset_relays()
     {
-        // TODO: render relays are not setup to have fixed timestep (multiple iterations per frame)
-        // so they clear themselves automatically
-        m_animator->clear();
-        m_forwardPass->clear();
-        m_bloomPass->clear();
-        m_screenPass->clear();
-
-        // invalidate volatile camera data from ecs
-        m_viewTransform = nullptr;
-        m_viewCamera = nullptr;
+        // frame was either published, or is abandoned, gl thread flushes after drawing
+        if (m_isPipelined)
+        {
+            this->_retire_back_frame();
+            return;
+        }
 
+        this->_clear_relays();
         this->flush_frame();
     }
     
@@ -171,10 +155,69 @@ namespace pleep
     
     void RenderDynamo::read_viewport_size(int* viewportDims) 
     {
-        glGetIntegerv(GL_VIEWPORT, viewportDims);
+        std::lock_guard<std::mutex> viewportLock(m_viewportMutex);
+        std::copy(m_viewportDims, m_viewportDims + 4, viewportDims);
+    }
+
+    void RenderDynamo::set_pipelined(bool pipelined)
+    {
+        m_isPipelined = pipelined;
+    }
+
+    bool RenderDynamo::is_pipelined() const
+    {
+        return m_isPipelined;
+    }
+
+    bool RenderDynamo::publish_frame(uint16_t coherency)
+    {
+        m_frames.get_back().coherency = coherency;
+        const bool dropped = m_frames.publish();
+        // back is now whichever frame was recycled:
+        // a drawn frame was already cleared by the gl thread, a dropped one still holds its copies
+        if (dropped) this->_retire_back_frame();
+        return dropped;
+    }
+
+    bool RenderDynamo::draw_published_frame(double deltaTime, double maxWaitSeconds)
+    {
+        // release copies of dropped/abandoned frames here, their assets may be the last owners of gl objects
+        {
+            std::lock_guard<std::mutex> retiredLock(m_retiredFramesMutex);
+            m_retiredFrames.clear();
+        }
+
+        if (!m_frames.wait_acquire(maxWaitSeconds)) return false;
+
+        // front frame belongs to this thread until the next acquire, so packets can reference its copies
+        RenderFrame& frame = m_frames.get_front();
+        frame.for_each_packet([this](auto packet) { this->_submit_to_relays(packet); });
+        m_drawnCoherency = frame.coherency;
+
+        this->run_relays(deltaTime);
+        this->_clear_relays();
+        // clear copies on this thread so the frame is recycled to simulation already empty
+        frame.clear();
+        return true;
+    }
+
+    uint16_t RenderDynamo::get_drawn_coherency() const
+    {
+        return m_drawnCoherency;
+    }
+
+    void RenderDynamo::_retire_back_frame()
+    {
+        RenderFrame& back = m_frames.get_back();
+        if (back.empty()) return;
+
+        std::lock_guard<std::mutex> retiredLock(m_retiredFramesMutex);
+        m_retiredFrames.push_back(std::move(back));
+        // moved from vectors are valid but unspecified
+        back.clear();
     }
     
-    void RenderDynamo::_resize_handler(EventMessage resizeEvent) 
+    void RenderDynamo::_resize_handler(EventMessage& resizeEvent) 
     {
         events::window::RESIZE_params resizeParams;
         resizeEvent >> resizeParams;
@@ -190,12 +233,74 @@ namespace pleep
         unsigned int uHeight = (unsigned int)height;
 
         // relays will use this info to set viewport appropriately
+        std::lock_guard<std::mutex> viewportLock(m_viewportMutex);
         m_viewportDims[0] = 0;
         m_viewportDims[1] = 0;
         m_viewportDims[2] = uWidth;
         m_viewportDims[3] = uHeight;
     }
     
+    void RenderDynamo::_submit_to_relays(RenderPacket data)
+    {
+        // pass transform/mesh/material information to relays
+        // we need to dispatch to appropriate relays
+        // renderable could have "id" of relay type it wants (what shader it wants)
+        //   then if we have that relay in our pipeline we can submit to it
+        //   or otherwise use some default
+        
+        // For now just hardwire to forward relay
+        m_forwardPass->submit(data);
+    }
+    
+    void RenderDynamo::_submit_to_relays(DebugRenderPacket data)
+    {
+        m_forwardPass->submit(data);
+    }
+    
+    void RenderDynamo::_submit_to_relays(LightSourcePacket data) 
+    {
+        // again, can we implicitly know which relays want this info
+        m_forwardPass->submit(data);
+    }
+    
+    void RenderDynamo::_submit_to_relays(CameraPacket data) 
+    {
+        // store CameraPacket for Uniform Buffer (every submittion overrides)
+        // the ECS references are volatile so our pointers shouldn't persist past the frame time
+        m_viewTransform = &(data.transform);
+        m_viewCamera    = &(data.camera);
+
+        // GL functions don't like height and width of 0
+        if (m_viewCamera->viewWidth == 0 || m_viewCamera->viewHeight == 0)
+        {
+            return;
+        }
+        // again, i don't know if this is the best solution but,
+        // ecs references are volatile so its probably necessary.
+        m_forwardPass->submit(data);
+        m_screenPass->submit(data);
+        m_bloomPass->submit(data);
+    }
+    
+    void RenderDynamo::_submit_to_relays(AnimationPacket data)
+    {
+        m_animator->submit(data);
+    }
+
+    void RenderDynamo::_clear_relays()
+    {
+        // TODO: render relays are not setup to have fixed timestep (multiple iterations per frame)
+        // so they clear themselves automatically
+        m_animator->clear();
+        m_forwardPass->clear();
+        m_bloomPass->clear();
+        m_screenPass->clear();
+
+        // invalidate volatile camera data from ecs
+        m_viewTransform = nullptr;
+        m_viewCamera = nullptr;
+    }
+    
     void RenderDynamo::_configure_relay_resources() 
     {
         // forward pass needs nothing
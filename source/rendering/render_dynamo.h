@@ -5,6 +5,8 @@
 
 // external
 #include <memory>
+#include <mutex>
+#include <vector>
 // our "window api"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -23,6 +25,8 @@
 #include "rendering/screen_render_relay.h"
 #include "rendering/bloom_render_relay.h"
 #include "rendering/animation_relay.h"
+#include "rendering/render_frame.h"
+#include "core/triple_buffer.h"
 
 namespace pleep
 {
@@ -55,23 +59,60 @@ namespace pleep
         
         // get current viewport origin/sizes
         // viewportDims must be at least 4 int large
+        // (last size set by window, safe to call from any thread)
         void read_viewport_size(int* viewportDims);
 
+        // When pipelined, submit copies packets into a RenderFrame instead of passing them to relays
+        // and reset_relays only retires it (none of which touch gl), so simulation can run on another thread:
+        // simulation thread submits and then calls publish_frame,
+        // gl thread calls draw_published_frame and then flush_frame
+        void set_pipelined(bool pipelined);
+        bool is_pipelined() const;
+        // hand the frame submitted so far to the gl thread, replacing it if it hasn't been drawn yet
+        // returns true if an undrawn frame was dropped
+        bool publish_frame(uint16_t coherency);
+        // run relays on the newest published frame (waiting up to maxWaitSeconds for one)
+        // returns false if no new frame was published
+        bool draw_published_frame(double deltaTime, double maxWaitSeconds);
+        // coherency of the last frame drawn by draw_published_frame
+        uint16_t get_drawn_coherency() const;
+
     private:
         // Listening to events::window::RESIZE sent by InputDynamo
-        void _resize_handler(EventMessage resizeEvent);
+        void _resize_handler(EventMessage& resizeEvent);
         // viewport should be proportionally dependant on the window (respond to resize event)
         // note framebuffers/textures are dependant only on camera (in submit(CameraPacket))
         // (camera may then depend on window, indirectly linking framebuffers to window as well)
         void _resize_viewport(int width, int height);
         // link input/output textures between each relay
         void _configure_relay_resources();
+        // pass packets straight to their relays (only on the gl thread)
+        void _submit_to_relays(RenderPacket data);
+        void _submit_to_relays(DebugRenderPacket data);
+        void _submit_to_relays(LightSourcePacket data);
+        void _submit_to_relays(CameraPacket data);
+        void _submit_to_relays(AnimationPacket data);
+        // clear relays and invalidate camera data without flushing
+        void _clear_relays();
+        // hand the back frame's copies to the gl thread to be released there
+        // (dropping the last reference to a mesh/material/texture deletes its gl objects)
+        void _retire_back_frame();
 
         // window api is shared with AppGateway (and other dynamos)
         // hard-code windowApi to glfw for now
         GLFWwindow* m_windowApi;
         // track viewport size to update viewport after shadow passes
+        // set by resize events (on the simulation thread when pipelined), read when relays run
         int m_viewportDims[4];
+        mutable std::mutex m_viewportMutex;
+
+        bool m_isPipelined = false;
+        // frames built by simulation (back), waiting (ready), and being drawn (front)
+        TripleBuffer<RenderFrame> m_frames;
+        // undrawn frames from simulation thread, released by gl thread in draw_published_frame
+        std::vector<RenderFrame> m_retiredFrames;
+        std::mutex m_retiredFramesMutex;
+        uint16_t m_drawnCoherency = 0;
 
         // Relays encapsulate procedures for a render "pass"
         //   they should output to a framebuffer which can be passed to the next relay
@@ -114,8 +155,8 @@ namespace pleep
         // Camera data is not live (dynamo can't access ECS) so references can become invalid between frames
         // but synchro will update each frame, and relay reset should invalidate it at the end of the frame
         // (we'll store raw pointers instead of references for nullability and so they aren't cleaned by smart pointer RAII. They are still susceptible to segfault if ecs references become invalid)
-        TransformComponent* m_viewTransform = nullptr;
-        CameraComponent*    m_viewCamera    = nullptr;
+        const TransformComponent* m_viewTransform = nullptr;
+        const CameraComponent*    m_viewCamera    = nullptr;
     };
 }
 
@@ -0,0 +1,150 @@
+#ifndef RENDER_FRAME_H
+#define RENDER_FRAME_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "rendering/render_packet.h"
+#include "rendering/debug_render_packet.h"
+#include "rendering/light_source_packet.h"
+#include "rendering/camera_packet.h"
+#include "rendering/animation_packet.h"
+
+namespace pleep
+{
+    // Everything submitted to a RenderDynamo for one frame, with copies of the components packets reference
+    // so it can be drawn on another thread while simulation goes on changing the ECS.
+    // Components are stored by index while the frame is being built (vectors may reallocate),
+    // packets referencing them are only made once the frame is complete (see for_each_packet)
+    struct RenderFrame
+    {
+        // coherency of the cosmos state this frame was built from
+        uint16_t coherency = 0;
+
+        std::vector<TransformComponent> transforms;
+        std::vector<RenderableComponent> renderables;
+        std::vector<AnimationComponent> animatables;
+        std::vector<LightSourceComponent> lights;
+        std::vector<DebugRenderPacket> debugPackets;
+
+        // an entity's render and animation packets share one renderable copy
+        // so the pose animation writes is the one which gets drawn
+        std::unordered_map<const RenderableComponent*, size_t> renderableIndices;
+
+        // index pairs into the vectors above
+        struct ComponentPair
+        {
+            size_t first;
+            size_t second;
+        };
+        std::vector<ComponentPair> renderPackets;    // transform, renderable
+        std::vector<ComponentPair> lightPackets;     // transform, light
+        std::vector<ComponentPair> animationPackets; // renderable, animatable
+
+        // main camera (last submitted)
+        bool hasCamera = false;
+        TransformComponent cameraTransform;
+        CameraComponent camera;
+
+        void add(const RenderPacket& data)
+        {
+            transforms.push_back(data.transform);
+            renderPackets.push_back({ transforms.size() - 1, _copy_renderable(data.renderable) });
+        }
+
+        void add(const DebugRenderPacket& data)
+        {
+            debugPackets.push_back(data);
+        }
+
+        void add(const LightSourcePacket& data)
+        {
+            transforms.push_back(data.transform);
+            lights.push_back(data.light);
+            lightPackets.push_back({ transforms.size() - 1, lights.size() - 1 });
+        }
+
+        void add(const CameraPacket& data)
+        {
+            hasCamera = true;
+            cameraTransform = data.transform;
+            camera = data.camera;
+        }
+
+        void add(const AnimationPacket& data)
+        {
+            // only the current animation is needed to pose it
+            AnimationComponent animatable;
+            animatable.m_currentAnimation = data.animatable.m_currentAnimation;
+            animatable.m_currentTime = data.animatable.m_currentTime;
+            auto animationIt = data.animatable.animations.find(data.animatable.m_currentAnimation);
+            if (animationIt != data.animatable.animations.end())
+            {
+                animatable.animations.insert(*animationIt);
+            }
+            animatables.push_back(std::move(animatable));
+            animationPackets.push_back({ _copy_renderable(data.renderable), animatables.size() - 1 });
+        }
+
+        // call visitor with every packet, camera first (if there is one) then in the order relays expect them
+        // frame must not be added to until visitor is done with the packets
+        template<typename T_Visitor>
+        void for_each_packet(T_Visitor&& visitor)
+        {
+            if (hasCamera) visitor(CameraPacket{ cameraTransform, camera });
+            for (const ComponentPair& packet : animationPackets)
+            {
+                visitor(AnimationPacket{ renderables[packet.first], animatables[packet.second] });
+            }
+            for (const ComponentPair& packet : renderPackets)
+            {
+                visitor(RenderPacket{ transforms[packet.first], renderables[packet.second] });
+            }
+            for (const ComponentPair& packet : lightPackets)
+            {
+                visitor(LightSourcePacket{ transforms[packet.first], lights[packet.second] });
+            }
+            for (const DebugRenderPacket& packet : debugPackets)
+            {
+                visitor(packet);
+            }
+        }
+
+        bool empty() const
+        {
+            return !hasCamera && renderPackets.empty() && lightPackets.empty()
+                && animationPackets.empty() && debugPackets.empty();
+        }
+
+        // drop all copies, keeping capacity for the next frame
+        // (copies may hold the last reference to gl resources, so only clear on the gl thread)
+        void clear()
+        {
+            transforms.clear();
+            renderables.clear();
+            animatables.clear();
+            lights.clear();
+            debugPackets.clear();
+            renderableIndices.clear();
+            renderPackets.clear();
+            lightPackets.clear();
+            animationPackets.clear();
+            hasCamera = false;
+        }
+
+    private:
+        size_t _copy_renderable(const RenderableComponent& renderable)
+        {
+            auto indexIt = renderableIndices.find(&renderable);
+            if (indexIt != renderableIndices.end()) return indexIt->second;
+
+            renderables.push_back(renderable);
+            renderableIndices[&renderable] = renderables.size() - 1;
+            return renderables.size() - 1;
+        }
+    };
+}
+
+#endif // RENDER_FRAME_H
@@ -14,8 +14,9 @@ namespace pleep
     //   or smart pointers so that they can live beyond entity for the frame duration
     struct RenderPacket
     {
-        TransformComponent& transform;
-        RenderableComponent& renderable;
+        // only read by relays
+        const TransformComponent& transform;
+        const RenderableComponent& renderable;
         // instancing info?
         // scene-wide temporary options? pallete swap? outlines?
     };
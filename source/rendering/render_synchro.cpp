@@ -1,6 +1,7 @@
 #include "render_synchro.h"
 
 #include <exception>
+#include <algorithm>
 
 #include "logging/pleep_log.h"
 #include "core/cosmos.h"
@@ -11,9 +12,14 @@
 #include "rendering/render_packet.h"
 #include "rendering/debug_render_packet.h"
 #include "physics/collider_component.h"
+#include "rendering/model_cache.h"
 
 namespace pleep
 {
+    // animations move vertices away from their bind pose, so skinned mesh bounds are grown
+    // on every side by this fraction of their largest dimension before culling
+    constexpr float SKINNED_BOUNDS_PADDING = 0.5f;
+
     RenderSynchro::~RenderSynchro()
     {
         // clear attached dynamo & handlers
@@ -39,12 +45,19 @@ namespace pleep
 
         // update view info with registered camera
         // re-get camera each time because ECS pointers are volatile
+        // without a camera nothing is culled (dynamo won't render anyway)
+        ViewFrustum frustum;
         if (cosmos->entity_exists(m_mainCamera))
         {
-            m_attachedRenderDynamo->submit(CameraPacket {
-                cosmos->get_component<TransformComponent>(m_mainCamera),
-                cosmos->get_component<CameraComponent>(m_mainCamera)
-            });
+            // read only (as declared in derive_access), other synchros may read them concurrently
+            const TransformComponent& cameraTransform = cosmos->read_component<TransformComponent>(m_mainCamera);
+            const CameraComponent& camera = cosmos->read_component<CameraComponent>(m_mainCamera);
+            m_attachedRenderDynamo->submit(CameraPacket { cameraTransform, camera });
+
+            if (camera.viewWidth != 0 && camera.viewHeight != 0)
+            {
+                frustum = ViewFrustum(get_projection(camera) * get_lookAt(cameraTransform, camera));
+            }
         }
         else
         {
@@ -54,10 +67,11 @@ namespace pleep
 
         // feed components of m_entities to attached RenderDynamo
         // I should implicitly know my signature and therefore what components i can fetch
+        m_culledCount = 0;
         for (Entity const& entity : m_entities)
         {
-            TransformComponent& transform = cosmos->get_component<TransformComponent>(entity);
-            RenderableComponent& renderable = cosmos->get_component<RenderableComponent>(entity);
+            const TransformComponent& transform = cosmos->read_component<TransformComponent>(entity);
+            const RenderableComponent& renderable = cosmos->read_component<RenderableComponent>(entity);
             
             // catch empty mesh vector and don't even bother dynamo with it
             // except if render colliders is true
@@ -66,22 +80,25 @@ namespace pleep
             // Update renderable members based on other components...
 
             // DEBUG: set highlight based on timestream state
-            if (cosmos->get_timestream_state(entity).first == TimestreamState::superposition)
+            // (highlight is never replicated, so it doesn't flag the component as changed)
+            cosmos->get_component_unmarked<RenderableComponent>(entity).highlight =
+                cosmos->get_timestream_state(entity).first == TimestreamState::superposition;
+
+            // skip renderables entirely outside the main camera's view
+            if (is_visible(frustum, transform, renderable))
             {
-                renderable.highlight = true;
+                m_attachedRenderDynamo->submit(RenderPacket{ transform, renderable });
             }
             else
             {
-                renderable.highlight = false;
+                m_culledCount++;
             }
 
-            m_attachedRenderDynamo->submit(RenderPacket{ transform, renderable });
-
             // DEBUG: Look for collider components for debug rendering?
             // we only need base transform, collider transform, BasicMeshType, and maybe Entity for colour seed?
             if (cosmos->has_component<ColliderComponent>(entity))
             {
-                const ColliderComponent& comp = cosmos->get_component<ColliderComponent>(entity);
+                const ColliderComponent& comp = cosmos->read_component<ColliderComponent>(entity);
 
                 for (int i = 0; i < COLLIDERS_PER_ENTITY; i++)
                 {
@@ -118,6 +135,20 @@ namespace pleep
                         });
                     }
                     break;
+                    case ColliderType::mesh:
+                    {
+                        // draw the render mesh the collider's triangles were built from
+                        if (!collider.colliderMesh) break;
+                        m_attachedRenderDynamo->submit(DebugRenderPacket{
+                            entity,
+                            collider.compose_transform(transform),
+                            ModelManager::BasicMeshType::cube,
+                            ModelCache::fetch_mesh(collider.colliderMesh->m_name)
+                        });
+                    }
+                    break;
+                    default:
+                    break;
                     }
                 }
             }
@@ -127,6 +158,32 @@ namespace pleep
         // Other components (Context) may draw further and then Context will flush at frame end
     }
     
+    bool RenderSynchro::is_visible(const ViewFrustum& frustum, const TransformComponent& transform, const RenderableComponent& renderable)
+    {
+        if (!frustum.is_set()) return true;
+
+        const bool isSkinned = !renderable.pose.empty();
+        const glm::mat4 modelToWorld = transform.get_model_transform() * renderable.localTransform.get_model_transform();
+        glm::vec3 boundsMin, boundsMax;
+        for (const std::shared_ptr<const Mesh>& mesh : renderable.meshData)
+        {
+            if (!mesh) continue;
+            mesh->read_bounds(boundsMin, boundsMax);
+            if (isSkinned)
+            {
+                const glm::vec3 size = boundsMax - boundsMin;
+                const glm::vec3 padding(std::max(size.x, std::max(size.y, size.z)) * SKINNED_BOUNDS_PADDING);
+                boundsMin -= padding;
+                boundsMax += padding;
+            }
+            if (frustum.intersects_bounds(boundsMin, boundsMax, modelToWorld))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    
     Signature RenderSynchro::derive_signature() 
     {
         std::shared_ptr<Cosmos> cosmos = m_ownerCosmos.lock();
@@ -180,7 +237,7 @@ namespace pleep
         }
     }
     
-    void RenderSynchro::_set_main_camera_handler(EventMessage setCameraEvent) 
+    void RenderSynchro::_set_main_camera_handler(EventMessage& setCameraEvent) 
     {
         events::rendering::SET_MAIN_CAMERA_params setCameraParams;
         setCameraEvent >> setCameraParams;
@@ -218,7 +275,7 @@ namespace pleep
         _resize_main_camera(viewportSize[2], viewportSize[3]);
     }
     
-    void RenderSynchro::_resize_handler(EventMessage resizeEvent) 
+    void RenderSynchro::_resize_handler(EventMessage& resizeEvent) 
     {
         events::window::RESIZE_params resizeParams;
         resizeEvent >> resizeParams;
@@ -260,4 +317,16 @@ namespace pleep
 
         // on next camera submit these dimensions will be checked and render relays will resize themselves accordingly
     }
+    
+    StageAccess RenderSynchro::derive_access()
+    {
+        return this->_derive_dynamo_access(m_attachedRenderDynamo.get(), [](Cosmos& cosmos, StageAccess& access)
+        {
+            // sets renderable highlight, reads camera and (debug) colliders
+            access.reads.set(cosmos.get_component_type<TransformComponent>());
+            access.reads.set(cosmos.get_component_type<CameraComponent>());
+            access.reads.set(cosmos.get_component_type<ColliderComponent>());
+            access.writes.set(cosmos.get_component_type<RenderableComponent>());
+        });
+    }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "ecs/i_synchro.h"
 #include "rendering/render_dynamo.h"
+#include "rendering/view_frustum.h"
 
 
 namespace pleep
@@ -23,16 +24,25 @@ namespace pleep
 
         Signature derive_signature() override;
 
+        StageAccess derive_access() override;
+
         // synchro needs a RenderDynamo to operate on
         void attach_dynamo(std::shared_ptr<RenderDynamo> contextDynamo);
 
+        // number of renderables not submitted last update because they were outside the main camera's view
+        size_t get_culled_count() const { return m_culledCount; }
+
+        // false if none of renderable's meshes (at transform) can be inside frustum
+        // renderables with a pose are tested with padded bind pose bounds, as their bones move vertices outside them
+        static bool is_visible(const ViewFrustum& frustum, const TransformComponent& transform, const RenderableComponent& renderable);
+
     private:
         // Register Cosmos/CosmosBuilder setting the entity of the main camera
-        void _set_main_camera_handler(EventMessage setCameraEvent);
+        void _set_main_camera_handler(EventMessage& setCameraEvent);
         
         // handle any entity related resizing (m_mainCamera)
         // dynamo also handles this, making gl calls
-        void _resize_handler(EventMessage resizeEvent);
+        void _resize_handler(EventMessage& resizeEvent);
         
         void _resize_main_camera(int width, int height);
 
@@ -45,6 +55,8 @@ namespace pleep
         // Cosmos should register the current rendering camera
         // synchro will have to fetch data and update Dynamo each frame
         Entity m_mainCamera = NULL_ENTITY;
+
+        size_t m_culledCount = 0;
     };
 }
 
@@ -31,9 +31,11 @@ namespace pleep
         // excess materials are ignored, excess meshes reuse the last-most material
         std::vector<std::shared_ptr<const Material>> materials;
 
-        // mutable copy of armature data to store current bone state between frames
-        // (and after animation relay has set them for this frame)
-        Armature armature;
+        // skeleton shared with every entity using it (from the library cache)
+        std::shared_ptr<const Armature> armature;
+        // current transform (model space * inverse bind) of each armature bone, indexed by bone id
+        // set by the animation relay each frame, not serialized
+        std::vector<glm::mat4> pose;
 
         // Additional rendering options. should this be part of a material component?
 
@@ -60,7 +62,9 @@ namespace pleep
         // REMEMBER this is a STACK so reverse the order!!!
 
         // stack armature data first
-        msg << data.armature;
+        // only its name and source, the skeleton itself is never copied into messages
+        msg << (data.armature ? data.armature->m_sourceFilepath : std::string());
+        msg << (data.armature ? data.armature->m_name : std::string());
 
         // stack mat data second
         /// TODO: What if material has no sourceFilepath? (created manually)
@@ -69,12 +73,14 @@ namespace pleep
         for (size_t m = numMats - 1; m < numMats; m--)
         {
             // push texture map for material
-            for (auto texturesIt = data.materials[m]->m_textures.begin(); texturesIt != data.materials[m]->m_textures.end(); texturesIt++)
+            // (placeholder materials may be filled on the gl thread meanwhile, so copy their sources)
+            const std::unordered_map<TextureType, std::string> textureSources = data.materials[m]->get_texture_sources();
+            for (auto sourcesIt = textureSources.begin(); sourcesIt != textureSources.end(); sourcesIt++)
             {
-                msg << texturesIt->second.get_source_filepath();
-                msg << texturesIt->first;
+                msg << sourcesIt->second;
+                msg << sourcesIt->first;
             }
-            size_t numSources = data.materials[m]->m_textures.size();
+            size_t numSources = textureSources.size();
             
             // push number of sources (0 -> material-level source, or actually empty)
             msg << numSources;
@@ -157,24 +163,10 @@ namespace pleep
                 // then fetch from library
                 else if (data.meshData[m] == nullptr || data.meshData[m]->m_name != newMeshName)
                 {
-                    std::shared_ptr<const Mesh> libMesh = ModelCache::fetch_mesh(newMeshName);
-
-                    // check if fetch was not successful
-                    if (libMesh == nullptr)
-                    {
-                        // try to import file
-                        ModelCache::ImportReceipt meshReceipt = ModelCache::import(newMeshPath);
-
-                        // confirm the msg mesh name was imported
-                        if (std::find(meshReceipt.meshNames.begin(), meshReceipt.meshNames.end(), newMeshName) != meshReceipt.meshNames.end())
-                        {
-                            // try to fetch again
-                            libMesh = ModelCache::fetch_mesh(newMeshName);
-                        }
-                    }
-
+                    // if not cached, import file off-thread and use a placeholder (which draws nothing) until it is
+                    // (deserializing happens mid-frame, so don't stall it on a whole import)
                     // if import was empty or failed it will be nullptr, assign either way
-                    data.meshData[m] = libMesh;
+                    data.meshData[m] = ModelCache::fetch_mesh_async(newMeshName, newMeshPath);
                 }
                 // else names match, continue as-is
             }
@@ -250,15 +242,8 @@ namespace pleep
                 // check if early fetch was not successful
                 if (libMat == nullptr)
                 {
-                    // try to import file
-                    ModelCache::ImportReceipt materialReceipt = ModelCache::import(newMaterialPath);
-                    
-                    // confirm the msg material name was imported
-                    if (std::find(materialReceipt.materialNames.begin(), materialReceipt.materialNames.end(), newMaterialName) != materialReceipt.materialNames.end())
-                    {
-                        //try to fetch again
-                        libMat = ModelCache::fetch_material(newMaterialName);
-                    }
+                    // import file off-thread and use a placeholder (with no textures) until it is cached
+                    libMat = ModelCache::fetch_material_async(newMaterialName, newMaterialPath);
                 }
 
                 // if material was empty or failed it will be nullptr, insert anyway to maintain ordering
@@ -269,7 +254,30 @@ namespace pleep
         }
 
         // last stream out armature
-        msg >> data.armature;
+        std::string newArmatureName;
+        msg >> newArmatureName;
+        std::string newArmaturePath;
+        msg >> newArmaturePath;
+
+        if (newArmatureName == "")
+        {
+            data.armature = nullptr;
+            data.pose.clear();
+        }
+        else if (data.armature == nullptr || data.armature->m_name != newArmatureName)
+        {
+            // try to import armature...
+            data.armature = ModelCache::fetch_armature(newArmatureName);
+            if (data.armature == nullptr)
+            {
+                ModelCache::import(newArmaturePath);
+                // try again?
+                data.armature = ModelCache::fetch_armature(newArmatureName);
+            }
+            // new skeleton starts at its bind pose
+            data.pose.assign(data.armature ? data.armature->m_bones.size() : 0, glm::mat4(1.0f));
+        }
+        // else names match, keep current pose
 
         return msg;
     }
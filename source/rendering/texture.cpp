@@ -16,6 +16,21 @@ namespace pleep
         }
     }
 
+    bool TextureImage::decode(const std::string& filepath)
+    {
+        // the aiProcess_FlipUVs option to aiImporter.ReadFile() already does this?
+        //stbi_set_flip_vertically_on_load(true);
+        unsigned char *texData = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+        if (!texData)
+        {
+            texels.clear();
+            return false;
+        }
+        texels.assign(texData, texData + static_cast<size_t>(width) * height * channels);
+        stbi_image_free(texData);
+        return true;
+    }
+
     Texture::Texture(TextureType type, const std::string& filepath)
     {
         // Auxilary members
@@ -24,6 +39,35 @@ namespace pleep
 
         if (m_type == TextureType::none) return;
 
+        // texturing data
+        TextureImage image;
+        image.decode(filepath);
+        _upload(image);
+    }
+
+    Texture::Texture(TextureType type, const std::string& filepath, const TextureImage& image)
+    {
+        // Auxilary members
+        m_type = type;
+        m_sourceFilepath = filepath;
+
+        if (m_type == TextureType::none) return;
+
+        _upload(image);
+    }
+
+    void Texture::_upload(const TextureImage& image)
+    {
+        if (image.texels.empty())
+        {
+            PLEEPLOG_ERROR("Failed to load texture: " + m_sourceFilepath);
+            // set null values
+            m_id = 0;
+            m_type = TextureType::none;
+            m_sourceFilepath = "";
+            return;
+        }
+
         // Load GL texture handle
         glGenTextures(1, &m_id);
         glBindTexture(GL_TEXTURE_2D, m_id);
@@ -46,43 +90,25 @@ namespace pleep
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        // texturing data
-        int texWidth, texHeight, texChannels;
-        // the aiProcess_FlipUVs option to aiImporter.ReadFile() already does this?
-        //stbi_set_flip_vertically_on_load(true);
-        unsigned char *texData = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, 0);
-        if (texData)
+        GLenum internalFormat;
+        GLenum dataFormat;
+        if (image.channels == 3)
         {
-            GLenum internalFormat;
-            GLenum dataFormat;
-            if (texChannels == 3)
-            {
-                internalFormat = TEXTURETYPE_USE_GAMMA(m_type) ? GL_SRGB : GL_RGB;
-                dataFormat = GL_RGB;
-            }
-            else if (texChannels == 4)
-            {
-                internalFormat = TEXTURETYPE_USE_GAMMA(m_type) ? GL_SRGB_ALPHA : GL_RGBA;
-                dataFormat = GL_RGBA;
-            }
-            else // if (texChannels == 1)
-            {
-                internalFormat = dataFormat = GL_RED;
-            }
-
-            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, texWidth, texHeight, 0, dataFormat, GL_UNSIGNED_BYTE, texData);
-            glGenerateMipmap(GL_TEXTURE_2D);
+            internalFormat = TEXTURETYPE_USE_GAMMA(m_type) ? GL_SRGB : GL_RGB;
+            dataFormat = GL_RGB;
         }
-        else
+        else if (image.channels == 4)
         {
-            PLEEPLOG_ERROR("Failed to load texture: " + filepath);
-            // delete generated texture and set null values
-            glDeleteTextures(1, &m_id);
-            m_id = 0;
-            m_type = TextureType::none;
-            m_sourceFilepath = "";
+            internalFormat = TEXTURETYPE_USE_GAMMA(m_type) ? GL_SRGB_ALPHA : GL_RGBA;
+            dataFormat = GL_RGBA;
         }
-        stbi_image_free(texData);
+        else // if (image.channels == 1)
+        {
+            internalFormat = dataFormat = GL_RED;
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, dataFormat, GL_UNSIGNED_BYTE, image.texels.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
         
         // clear binds
         glBindTexture(GL_TEXTURE_2D, 0);
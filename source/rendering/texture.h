@@ -82,6 +82,19 @@ namespace pleep
         }
     }
 
+    // Texels decoded from an image file (by stbi) without any GPU memory
+    // so decoding can happen away from the thread with the gl context
+    struct TextureImage
+    {
+        // returns false (leaving texels empty) if filepath could not be decoded
+        bool decode(const std::string& filepath);
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::vector<unsigned char> texels;
+    };
+
     // Wrap/manage GL texture handle
     struct Texture
     {
@@ -89,6 +102,8 @@ namespace pleep
         // load texture from file into GPU memory using stbi
         // use TextureType::none to signal NO GPU MEMORY should be allocated
         Texture(TextureType type, const std::string& filepath);
+        // load image already decoded from filepath into GPU memory
+        Texture(TextureType type, const std::string& filepath, const TextureImage& image);
         // load cubemap texture from multiple files (ordered by GL_TEXTURE_CUBE_MAP_...)
         Texture(const std::vector<std::string> filepaths);
         // create texture from preloaded data
@@ -107,6 +122,9 @@ namespace pleep
         std::string get_source_filepath() const { return m_sourceFilepath; }
 
     private:
+        // create 2d gl texture from image, or reset to none if image has no texels
+        void _upload(const TextureImage& image);
+
         // gl handle
         unsigned int m_id = 0;                 
         // Do NOT allow changing type to none after construction, it will leak gpu memory 
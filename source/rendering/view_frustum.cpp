@@ -0,0 +1,55 @@
+#include "view_frustum.h"
+
+#include <cmath>
+
+namespace pleep
+{
+    ViewFrustum::ViewFrustum(const glm::mat4& worldToClip)
+        : m_isSet(true)
+    {
+        // Gribb & Hartmann: each plane is row 3 +/- another row of the matrix (glm is column major)
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++)
+        {
+            rows[i] = glm::vec4(worldToClip[0][i], worldToClip[1][i], worldToClip[2][i], worldToClip[3][i]);
+        }
+        m_planes[0] = rows[3] + rows[0];
+        m_planes[1] = rows[3] - rows[0];
+        m_planes[2] = rows[3] + rows[1];
+        m_planes[3] = rows[3] - rows[1];
+        m_planes[4] = rows[3] + rows[2];
+        m_planes[5] = rows[3] - rows[2];
+
+        for (glm::vec4& plane : m_planes)
+        {
+            const float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) plane = plane * (1.0f / length);
+        }
+    }
+
+    bool ViewFrustum::intersects_bounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& modelToWorld) const
+    {
+        if (!m_isSet) return true;
+
+        // transform box to world space as a center and (axis aligned) half extents
+        const glm::vec3 localCenter = (boundsMin + boundsMax) * 0.5f;
+        const glm::vec3 localExtent = (boundsMax - boundsMin) * 0.5f;
+        const glm::vec3 center = glm::vec3(modelToWorld * glm::vec4(localCenter, 1.0f));
+        glm::vec3 extent(0.0f);
+        for (int row = 0; row < 3; row++)
+        {
+            extent[row] = std::abs(modelToWorld[0][row]) * localExtent.x
+                        + std::abs(modelToWorld[1][row]) * localExtent.y
+                        + std::abs(modelToWorld[2][row]) * localExtent.z;
+        }
+
+        for (const glm::vec4& plane : m_planes)
+        {
+            const glm::vec3 normal(plane);
+            const float distance = glm::dot(normal, center) + plane.w;
+            const float radius = std::abs(normal.x) * extent.x + std::abs(normal.y) * extent.y + std::abs(normal.z) * extent.z;
+            if (distance + radius < 0.0f) return false;
+        }
+        return true;
+    }
+}
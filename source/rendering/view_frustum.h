@@ -0,0 +1,36 @@
+#ifndef VIEW_FRUSTUM_H
+#define VIEW_FRUSTUM_H
+
+//#include "intercession_pch.h"
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+namespace pleep
+{
+    // The six planes bounding a camera's view volume in world space, for culling on the cpu
+    // Only math, no gl context needed, so it can be tested and timed headless
+    class ViewFrustum
+    {
+    public:
+        // Init frustum which contains everything (nothing is culled)
+        ViewFrustum() = default;
+        // Extract planes from a camera's projection * world_to_view (clip space depth in [-1,1])
+        explicit ViewFrustum(const glm::mat4& worldToClip);
+        ~ViewFrustum() = default;
+
+        // false only if box (model space) transformed by modelToWorld is entirely outside one plane
+        // (conservative: boxes near the frustum's corners may still pass)
+        bool intersects_bounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& modelToWorld) const;
+
+        // false if this frustum was default constructed
+        bool is_set() const { return m_isSet; }
+
+    private:
+        // normalized (a,b,c,d) where a*x + b*y + c*z + d >= 0 is inside
+        // left, right, bottom, top, near, far
+        glm::vec4 m_planes[6];
+        bool m_isSet = false;
+    };
+}
+
+#endif // VIEW_FRUSTUM_H
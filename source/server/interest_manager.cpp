@@ -0,0 +1,306 @@
+#include "interest_manager.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "logging/pleep_log.h"
+#include "physics/transform_component.h"
+
+namespace pleep
+{
+    // size of spatial grid cells, roughly the radius entities interact within
+    constexpr float INTEREST_CELL_SIZE = 16.0f;
+    // entities within this distance of a client's focal entity are checked every tick,
+    // their send interval grows with distance until it reaches the maximum at this distance
+    constexpr float INTEREST_RADIUS = 96.0f;
+    // most ticks changes to an entity wait before being sent, however far it is
+    // (entities beyond INTEREST_RADIUS are swept over this many ticks)
+    constexpr uint32_t INTEREST_MAX_SEND_INTERVAL = 30;
+    // priority added to entities waiting longer than the maximum interval, so the budget can't starve them
+    constexpr float INTEREST_OVERDUE_PRIORITY = 1000.0f;
+    // distance at which an entity accumulates priority half as fast as one at the focal entity
+    constexpr float INTEREST_FALLOFF_DISTANCE = 16.0f;
+    // serialized update bytes each client may be sent per tick
+    // (the focal entity, and at least one other entity, is always sent)
+    constexpr size_t INTEREST_BYTES_PER_TICK = 16 * 1024;
+
+    // ticks between sends of an entity at distance from the focal entity
+    static uint32_t get_send_interval(float distance)
+    {
+        const float scale = std::min(distance / INTEREST_RADIUS, 1.0f);
+        return 1 + static_cast<uint32_t>(scale * (INTEREST_MAX_SEND_INTERVAL - 1));
+    }
+
+    InterestManager::InterestManager()
+        : m_grid(INTEREST_CELL_SIZE)
+    {
+    }
+
+    void InterestManager::update_clients(const std::unordered_map<Entity, uint32_t>& clientEntities, std::shared_ptr<Cosmos> cosmos)
+    {
+        // forget clients whose focal entity is gone
+        for (auto clientIt = m_clients.begin(); clientIt != m_clients.end();)
+        {
+            if (clientEntities.count(clientIt->first) == 0)
+            {
+                clientIt = m_clients.erase(clientIt);
+            }
+            else
+            {
+                clientIt++;
+            }
+        }
+
+        const Signature downstreamSign = cosmos->get_category_signature(ComponentCategory::downstream);
+        for (auto& clientEntity : clientEntities)
+        {
+            if (m_clients.count(clientEntity.first) != 0) continue;
+
+            PLEEPLOG_DEBUG("Tracking interest for client {} focused on entity {}", clientEntity.second, clientEntity.first);
+            ClientInterest& client = m_clients[clientEntity.first];
+            client.connectionId = clientEntity.second;
+
+            // client knows entities exist, but has none of their state
+            for (auto& signIt : cosmos->get_signatures_ref())
+            {
+                client.tracked[signIt.first].pending = signIt.second & downstreamSign;
+                client.unknown.push_back(signIt.first);
+            }
+        }
+    }
+
+    void InterestManager::add_changes(Entity entity, Signature changedSign)
+    {
+        if (changedSign.none()) return;
+
+        for (auto& clientIt : m_clients)
+        {
+            ClientInterest& client = clientIt.second;
+            auto trackedIt = client.tracked.find(entity);
+            if (trackedIt == client.tracked.end())
+            {
+                trackedIt = client.tracked.insert({ entity, TrackedEntity{} }).first;
+                client.unknown.push_back(entity);
+            }
+            trackedIt->second.pending |= changedSign;
+        }
+    }
+
+    void InterestManager::remove_entity(Entity entity)
+    {
+        for (auto& clientIt : m_clients)
+        {
+            // stale unknown entries are skipped when popped
+            clientIt.second.tracked.erase(entity);
+        }
+    }
+
+    void InterestManager::acknowledge_input(Entity focal, uint16_t inputCoherency)
+    {
+        auto clientIt = m_clients.find(focal);
+        if (clientIt == m_clients.end()) return;
+
+        ClientInterest& client = clientIt->second;
+        if (!client.inputAcknowledged || coherency_greater_or_equal(inputCoherency, client.inputCoherency))
+        {
+            client.inputAcknowledged = true;
+            client.inputCoherency = inputCoherency;
+        }
+    }
+
+    void InterestManager::send_updates(std::shared_ptr<Cosmos> cosmos, ServerNetworkApi& networkApi, uint16_t coherency)
+    {
+        if (m_clients.empty()) return;
+
+        m_tick++;
+        _build_grid(cosmos);
+
+        for (auto& clientIt : m_clients)
+        {
+            const Entity focal = clientIt.first;
+            ClientInterest& client = clientIt.second;
+
+            std::shared_ptr<net::Connection<EventId>> remote = networkApi.get_connection(client.connectionId);
+            if (!remote || !remote->is_connected()) continue;
+
+            // gather entities with pending changes whose send interval has passed, weighting priority by distance
+            m_candidates.clear();
+            auto consider = [&client, this](Entity entity, float distance)
+            {
+                auto trackedIt = client.tracked.find(entity);
+                if (trackedIt == client.tracked.end() || trackedIt->second.pending.none()) return;
+
+                TrackedEntity& tracked = trackedIt->second;
+                tracked.priority += 1.0f / (1.0f + distance / INTEREST_FALLOFF_DISTANCE);
+
+                const uint32_t waited = m_tick - tracked.lastSentTick;
+                if (waited < get_send_interval(distance)) return;
+                const float overdue = waited > INTEREST_MAX_SEND_INTERVAL ? INTEREST_OVERDUE_PRIORITY : 0.0f;
+                m_candidates.push_back({ tracked.priority + overdue, entity });
+            };
+
+            if (cosmos->entity_exists(focal) && cosmos->has_component<TransformComponent>(focal))
+            {
+                const glm::vec3 center = cosmos->read_component<TransformComponent>(focal).origin;
+                m_grid.query(center, INTEREST_RADIUS, consider);
+
+                _sweep_far_entities(cosmos, client, center);
+                for (size_t i = 0; i < client.farDue.size();)
+                {
+                    const Entity entity = client.farDue[i];
+                    auto trackedIt = client.tracked.find(entity);
+                    // gone, sent since it became due, or come near enough for the grid query to find
+                    if (trackedIt == client.tracked.end() || trackedIt->second.pending.none()
+                        || _get_distance(cosmos, entity, center) <= INTEREST_RADIUS)
+                    {
+                        if (trackedIt != client.tracked.end()) trackedIt->second.farDue = false;
+                        client.farDue[i] = client.farDue.back();
+                        client.farDue.pop_back();
+                        continue;
+                    }
+                    consider(entity, INTEREST_RADIUS);
+                    i++;
+                }
+            }
+            else
+            {
+                // no position to be interested around, fall back to everything
+                for (auto& trackedIt : client.tracked)
+                {
+                    consider(trackedIt.first, 0.0f);
+                }
+            }
+
+            // client's own entity always comes first
+            for (std::pair<float, Entity>& candidate : m_candidates)
+            {
+                if (candidate.second == focal) candidate.first = std::numeric_limits<float>::max();
+            }
+            std::sort(m_candidates.begin(), m_candidates.end(),
+                [](const std::pair<float, Entity>& lhs, const std::pair<float, Entity>& rhs)
+                {
+                    return lhs.first > rhs.first;
+                }
+            );
+
+            size_t bytesSent = 0;
+            size_t entitiesSent = 0;
+            for (const std::pair<float, Entity>& candidate : m_candidates)
+            {
+                // focal plus at least one other, so big entities can't starve forever
+                if (bytesSent >= INTEREST_BYTES_PER_TICK && entitiesSent >= 2) break;
+
+                // client predicts its own entity, it needs to know which of its inputs this state follows
+                const uint16_t stamp = candidate.second == focal && client.inputAcknowledged ? client.inputCoherency : coherency;
+                bytesSent += _send_entity(cosmos, remote, stamp, candidate.second, client.tracked[candidate.second]);
+                entitiesSent++;
+            }
+
+            // spend what's left giving far entities their first state
+            while (bytesSent < INTEREST_BYTES_PER_TICK && !client.unknown.empty())
+            {
+                const Entity entity = client.unknown.front();
+                client.unknown.pop_front();
+
+                auto trackedIt = client.tracked.find(entity);
+                if (trackedIt == client.tracked.end() || trackedIt->second.known) continue;
+
+                bytesSent += _send_entity(cosmos, remote, coherency, entity, trackedIt->second);
+            }
+        }
+    }
+
+    void InterestManager::_sweep_far_entities(std::shared_ptr<Cosmos> cosmos, ClientInterest& client, const glm::vec3& center)
+    {
+        if (client.farSweepCursor >= client.farSweep.size())
+        {
+            client.farSweep.clear();
+            client.farSweepCursor = 0;
+            for (auto& trackedIt : client.tracked)
+            {
+                client.farSweep.push_back(trackedIt.first);
+            }
+        }
+
+        // whole sweep takes the maximum interval
+        const size_t sliceSize = (client.farSweep.size() + INTEREST_MAX_SEND_INTERVAL - 1) / INTEREST_MAX_SEND_INTERVAL;
+        const size_t sliceEnd = std::min(client.farSweep.size(), client.farSweepCursor + sliceSize);
+        for (; client.farSweepCursor < sliceEnd; client.farSweepCursor++)
+        {
+            const Entity entity = client.farSweep[client.farSweepCursor];
+            auto trackedIt = client.tracked.find(entity);
+            if (trackedIt == client.tracked.end() || trackedIt->second.pending.none() || trackedIt->second.farDue) continue;
+            // nearer ones (and unplaced ones) are considered by the grid query
+            if (_get_distance(cosmos, entity, center) <= INTEREST_RADIUS) continue;
+
+            trackedIt->second.farDue = true;
+            client.farDue.push_back(entity);
+        }
+    }
+
+    float InterestManager::_get_distance(std::shared_ptr<Cosmos> cosmos, Entity entity, const glm::vec3& center)
+    {
+        // unplaced entities are visited by every grid query at distance 0
+        if (!cosmos->entity_exists(entity) || !cosmos->has_component<TransformComponent>(entity)) return 0.0f;
+        return glm::length(cosmos->read_component<TransformComponent>(entity).origin - center);
+    }
+
+    void InterestManager::_build_grid(std::shared_ptr<Cosmos> cosmos)
+    {
+        m_grid.clear();
+
+        // THROWS if cosmos has no transforms, but entities can't be simulated without them anyway
+        const ComponentType transformType = cosmos->get_component_type<TransformComponent>();
+
+        for (auto& signIt : cosmos->get_signatures_ref())
+        {
+            if (signIt.second.test(transformType))
+            {
+                m_grid.insert(signIt.first, cosmos->read_component<TransformComponent>(signIt.first).origin);
+            }
+            else
+            {
+                m_grid.insert_unplaced(signIt.first);
+            }
+        }
+    }
+
+    size_t InterestManager::_send_entity(std::shared_ptr<Cosmos> cosmos, std::shared_ptr<net::Connection<EventId>> remote, uint16_t coherency, Entity entity, TrackedEntity& tracked)
+    {
+        // components may have been removed since they were pending
+        Signature sendSign = tracked.pending & cosmos->get_entity_signature(entity);
+        // first state goes over tcp after ENTITY_CREATED, a datagram could arrive before the entity exists
+        // (or be lost) and the client would be left at default values
+        const bool unreliable = tracked.known && remote->is_datagram_associated();
+        // datagrams can be lost, so each one must carry the whole (downstream) entity
+        // for a newer one to completely replace it
+        if (unreliable || !tracked.known)
+        {
+            sendSign = cosmos->get_entity_signature(entity) & cosmos->get_category_signature(ComponentCategory::downstream);
+        }
+
+        tracked.pending.reset();
+        tracked.priority = 0.0f;
+        tracked.known = true;
+        tracked.lastSentTick = m_tick;
+
+        EventMessage updateMsg(events::cosmos::ENTITY_UPDATE, coherency);
+        events::cosmos::ENTITY_UPDATE_params updateInfo = {
+            entity,
+            sendSign,
+            ComponentCategory::downstream
+        };
+        cosmos->serialize_entity_components(updateInfo.entity, updateInfo.sign, updateMsg, updateInfo.category);
+        updateMsg << updateInfo;
+
+        if (unreliable)
+        {
+            remote->send_unreliable(updateMsg, entity);
+        }
+        else
+        {
+            remote->send(updateMsg);
+        }
+        return updateMsg.size();
+    }
+}
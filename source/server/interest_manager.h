@@ -0,0 +1,101 @@
+#ifndef INTEREST_MANAGER_H
+#define INTEREST_MANAGER_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+#include "ecs/ecs_types.h"
+#include "core/cosmos.h"
+#include "server/server_network_api.h"
+#include "server/spatial_grid.h"
+
+namespace pleep
+{
+    // Decides which entity updates each client receives every tick
+    // Changes to an entity are sent at an interval that grows with its distance from the client's focal entity
+    // (up to a maximum, however far away it is), nearer entities also accumulate priority faster,
+    // and each client has a byte budget per tick. Changes which didn't fit stay pending.
+    // Entities a client has never received state for are trickled out with leftover budget
+    // so far away entities don't stay at default values.
+    class InterestManager
+    {
+    public:
+        InterestManager();
+
+        // match tracked clients to focal entity -> connection id map
+        // new clients start with every existing entity pending
+        void update_clients(const std::unordered_map<Entity, uint32_t>& clientEntities, std::shared_ptr<Cosmos> cosmos);
+
+        // record downstream components of entity that changed this tick
+        void add_changes(Entity entity, Signature changedSign);
+
+        // stop tracking entity for all clients
+        void remove_entity(Entity entity);
+
+        // client focused on focal has sent us its input from (its) inputCoherency
+        // updates of focal sent to that client are stamped with the newest one instead of our coherency
+        void acknowledge_input(Entity focal, uint16_t inputCoherency);
+
+        // choose and send ENTITY_UPDATEs for each client within its budget
+        void send_updates(std::shared_ptr<Cosmos> cosmos, ServerNetworkApi& networkApi, uint16_t coherency);
+
+    private:
+        struct TrackedEntity
+        {
+            // downstream components changed since last sent to this client
+            Signature pending;
+            // grows while changes wait (faster when nearer), reset when sent
+            float priority = 0.0f;
+            // client has been sent a whole state for this entity over tcp (later ones may use datagrams)
+            bool known = false;
+            // send_updates tick this was last sent on
+            uint32_t lastSentTick = 0;
+            // in ClientInterest::farDue
+            bool farDue = false;
+        };
+
+        struct ClientInterest
+        {
+            uint32_t connectionId;
+            std::unordered_map<Entity, TrackedEntity> tracked;
+            // entities which have never been sent (may contain stale entries)
+            std::deque<Entity> unknown;
+            // newest client input applied to its focal entity (see acknowledge_input)
+            bool inputAcknowledged = false;
+            uint16_t inputCoherency = 0;
+
+            // entities beyond the interest radius, a slice is checked each tick
+            // so each is checked once per maximum send interval
+            std::vector<Entity> farSweep;
+            size_t farSweepCursor = 0;
+            // far entities with pending changes found by the sweep, considered every tick until sent
+            std::vector<Entity> farDue;
+        };
+
+        // place every entity with a transform into m_grid
+        void _build_grid(std::shared_ptr<Cosmos> cosmos);
+
+        // find far entities of client which are due to be sent (into client.farDue)
+        void _sweep_far_entities(std::shared_ptr<Cosmos> cosmos, ClientInterest& client, const glm::vec3& center);
+        // distance of entity from center (0 if it has no position)
+        static float _get_distance(std::shared_ptr<Cosmos> cosmos, Entity entity, const glm::vec3& center);
+
+        // serialize pending components and send, returns bytes sent
+        size_t _send_entity(std::shared_ptr<Cosmos> cosmos, std::shared_ptr<net::Connection<EventId>> remote, uint16_t coherency, Entity entity, TrackedEntity& tracked);
+
+        // focal entity -> client
+        std::unordered_map<Entity, ClientInterest> m_clients;
+
+        SpatialGrid m_grid;
+        // send_updates calls so far
+        uint32_t m_tick = 0;
+
+        // reused each tick
+        std::vector<std::pair<float, Entity>> m_candidates;
+    };
+}
+
+#endif // INTEREST_MANAGER_H
@@ -1,6 +1,9 @@
 #include "server_app_gateway.h"
 
 #include "networking/timeline_api.h"
+#include "networking/in_process_timeline_transport.h"
+#include "networking/socket_timeline_transport.h"
+#include "networking/shared_memory_timeline_transport.h"
 #include "spacetime/parallel_cosmos_context.h"
 #include "events/event_types.h"
 
@@ -13,9 +16,41 @@ namespace pleep
 
         // Build apis
 
+        // only some timeslices run here, the rest of the timeline is in other processes
+        if (!cfg.localTimeslices.empty())
+        {
+            PLEEPLOG_INFO("Constructing " + std::to_string(cfg.localTimeslices.size()) + " of " + std::to_string(cfg.numTimeslices) + " timeslices");
+            assert(m_contexts.empty());
+
+            for (TimesliceId i : cfg.localTimeslices)
+            {
+                PLEEPLOG_TRACE("Start constructing server context TimesliceId #" + std::to_string(i));
+
+                std::shared_ptr<I_TimelineTransport> transport = nullptr;
+                if (cfg.sharedMemoryTimeline)
+                {
+                    transport = std::make_shared<SharedMemoryTimelineTransport>(cfg, i);
+                }
+                else
+                {
+                    transport = std::make_shared<SocketTimelineTransport>(cfg, i);
+                }
+
+                std::unique_ptr<I_CosmosContext> ctx = std::make_unique<ServerCosmosContext>(
+                    TimelineApi(cfg, i, transport)
+                );
+
+                PLEEPLOG_TRACE("Done constructing server context TimesliceId #" + std::to_string(i));
+
+                m_contexts.push_back(std::move(ctx));
+            }
+            PLEEPLOG_TRACE("Done constructing server app gateway");
+            return;
+        }
+
         // "local temporal network" api
         // shared message queues for all instances of the ltn api
-        std::shared_ptr<TimelineApi::Multiplex> sharedMultiplex = generate_timeline_multiplex(cfg.numTimeslices);
+        std::shared_ptr<InProcessTimelineTransport::Multiplex> sharedMultiplex = generate_timeline_multiplex(cfg.numTimeslices);
         // Build contexts and pass apis
         PLEEPLOG_INFO("Constructing " + std::to_string(cfg.numTimeslices) + " timeslices");
         assert(m_contexts.empty());
@@ -27,7 +62,7 @@ namespace pleep
         // has access to timeslices via sharedMultiplex, and its own parallel timestream
         // NULL_TIMESLICEID is for clients, parallel must take on the id of whoever it is parallel to.
         std::shared_ptr<ParallelCosmosContext> parallelContext = std::make_shared<ParallelCosmosContext>(
-            TimelineApi(cfg, NULL_TIMESLICEID, sharedMultiplex, nullptr, nullptr, nullptr)
+            TimelineApi(cfg, NULL_TIMESLICEID, std::make_shared<InProcessTimelineTransport>(NULL_TIMESLICEID, sharedMultiplex))
         );
 
         // construct timeslices in reverse order so that origin/present (0) is created LAST
@@ -51,7 +86,7 @@ namespace pleep
             // Inside each context the TimelineConfig information will only be accessible 
             //   through the TimelineApi (to branch based on specific timesliceId)
             std::unique_ptr<I_CosmosContext> ctx = std::make_unique<ServerCosmosContext>(
-                TimelineApi(cfg, i, sharedMultiplex, pastTimestreams, futureTimestreams, parallelContext)
+                TimelineApi(cfg, i, std::make_shared<InProcessTimelineTransport>(i, sharedMultiplex, pastTimestreams, futureTimestreams, parallelContext))
             );
             
             PLEEPLOG_TRACE("Done constructing server context TimesliceId #" + std::to_string(i));
@@ -3,6 +3,7 @@
 #include "staging/test_cosmos.h"
 #include "staging/iceberg_cosmos.h"
 #include "staging/moon_cosmos.h"
+#include "staging/cosmos_snapshot.h"
 
 namespace pleep
 {
@@ -12,15 +13,28 @@ namespace pleep
         // I_CosmosContext() has setup broker (not shared between contexts)
         
         // construct dynamos
-        m_dynamoCluster.networker = std::make_shared<ServerNetworkDynamo>(m_eventBroker, localTimelineApi);
+        std::shared_ptr<ServerNetworkDynamo> networker = std::make_shared<ServerNetworkDynamo>(m_eventBroker, localTimelineApi);
+        m_dynamoCluster.networker = networker;
         m_dynamoCluster.behaver  = std::make_shared<BehaviorsDynamo>(m_eventBroker);
         m_dynamoCluster.physicser = std::make_shared<PhysicsDynamo>(m_eventBroker);
+        this->set_parallel_stages(localTimelineApi.is_parallel_stages());
         
+        // resume from our last checkpoint if there is one
+        if (!localTimelineApi.get_checkpoint_directory().empty())
+        {
+            std::shared_ptr<Cosmos> restoredCosmos = construct_hard_config_cosmos(m_eventBroker, m_dynamoCluster);
+            if (networker->restore_checkpoint(restoredCosmos)) m_currentCosmos = restoredCosmos;
+        }
+
         // build and populate starting cosmos
         // eventually we'll pass some cosmos config param here
-        if (m_dynamoCluster.networker->get_timeslice_id() == 0)
+        if (m_currentCosmos)
+        {
+            PLEEPLOG_TRACE("Resumed cosmos from checkpoint");
+        }
+        else if (m_dynamoCluster.networker->get_timeslice_id() == 0)
         {
-            _build_cosmos();
+            _build_cosmos(localTimelineApi.get_world_snapshot());
         }
         else
         {
@@ -60,9 +74,11 @@ namespace pleep
     {
         // TODO: give each dynamo a run "fixed" & variable method so we don't need to explicitly
         //   know which dynamos to call fixed and which to call on frametime
-        m_dynamoCluster.networker->run_relays(fixedTime);
-        m_dynamoCluster.behaver->run_relays(fixedTime);
-        m_dynamoCluster.physicser->run_relays(fixedTime);
+        this->_run_dynamos({
+            m_dynamoCluster.networker.get(),
+            m_dynamoCluster.behaver.get(),
+            m_dynamoCluster.physicser.get()
+        }, fixedTime);
     }
     
     void ServerCosmosContext::_on_frame(double deltaTime) 
@@ -78,8 +94,14 @@ namespace pleep
         m_dynamoCluster.physicser->reset_relays();
     }
 
-    void ServerCosmosContext::_build_cosmos()
+    void ServerCosmosContext::_build_cosmos(const std::string& worldSnapshot)
     {
+        if (!worldSnapshot.empty())
+        {
+            m_currentCosmos = cosmos_builder::load_snapshot(worldSnapshot, m_dynamoCluster, m_eventBroker);
+            if (m_currentCosmos) return;
+        }
+
         PLEEPLOG_TRACE("Start cosmos construction");
 
         // we need to build synchros and link them with dynamos
@@ -88,5 +110,8 @@ namespace pleep
         m_currentCosmos = build_moon_cosmos(m_eventBroker, m_dynamoCluster);
 
         PLEEPLOG_TRACE("Done cosmos construction");
+
+        // bake it so next time it can be loaded instead
+        if (!worldSnapshot.empty()) cosmos_builder::save_snapshot(m_currentCosmos, worldSnapshot);
     }
 }
\ No newline at end of file
@@ -31,7 +31,8 @@ namespace pleep
         // populate the cosmos with synchros, and entities
         // provide registered synchros with our related dynamos
         // for now this has no parameters (scene filename in future?)
-        void _build_cosmos();
+        // world is loaded from worldSnapshot (if not empty), and saved there if it didn't exist yet
+        void _build_cosmos(const std::string& worldSnapshot);
     };
 }
 
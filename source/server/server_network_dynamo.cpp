@@ -1,6 +1,8 @@
 #include "server_network_dynamo.h"
 
 #include "logging/pleep_log.h"
+#include "networking/block_compression.h"
+#include "networking/timestream_checksum.h"
 #include "ecs/ecs_types.h"
 #include "staging/cosmos_builder.h"
 #include "staging/client_focal_entity.h"
@@ -15,6 +17,10 @@ namespace pleep
     constexpr uint16_t FORKED_THRESHOLD = static_cast<uint16_t>(0.3 * pleep::FRAMERATE);
     // FORKING_THRESHOLD + FORKED_THREASHOLD == total time until an interception triggers resolution
 
+    // number of frames between sending every component of every entity (regardless of changes)
+    // so receivers can't drift from our state indefinitely
+    constexpr uint16_t REPLICATION_REFRESH_INTERVAL = 360;
+
     ServerNetworkDynamo::ServerNetworkDynamo(std::shared_ptr<EventBroker> sharedBroker, TimelineApi localTimelineApi)
         : I_NetworkDynamo(sharedBroker)
         , m_timelineApi(localTimelineApi)
@@ -75,8 +81,8 @@ namespace pleep
 
         uint16_t currentCoherency = 0;
         if (cosmos) currentCoherency = cosmos->get_coherency();
-        // sync coherency with child and clients, every ~5 seconds
-        if (currentCoherency % 360 == 0)
+        // sync coherency with child and clients
+        if (m_coherencySyncInterval.is_due(currentCoherency, m_timelineApi.get_coherency_sync_interval()))
         {
             EventMessage syncMessage(events::network::COHERENCY_SYNC, currentCoherency);
             events::network::COHERENCY_SYNC_params syncParams = { m_timelineApi.get_timeslice_id() };
@@ -163,6 +169,35 @@ namespace pleep
                 }
             }
             break;
+            case events::cosmos::TIMESTREAM_DESYNC:
+            {
+                // the past's re-simulation of an entity drifted from what we simulated
+                events::cosmos::TIMESTREAM_DESYNC_params data;
+                msg >> data;
+                // it is one link further into the past there
+                decrement_causal_chain_link(data.entity);
+                PLEEPLOG_DEBUG("Received TIMESTREAM_DESYNC for entity {}, pushing its full state", data.entity);
+
+                if (cosmos->entity_exists(data.entity)) m_pastKeyframeRequests.insert(data.entity);
+            }
+            break;
+            case events::network::TIMELINE_RESYNC:
+            {
+                // our transport gave up on messages to a timeslice which stopped accepting them
+                events::network::TIMELINE_RESYNC_params data;
+                msg >> data;
+
+                // only the past's timestream can't be recovered by what we send periodically anyway
+                if (!m_timelineApi.has_past() || data.peerId != m_timelineApi.get_timeslice_id() + 1U) break;
+                PLEEPLOG_WARN("Timestream to the past was dropped, pushing full state of every entity");
+
+                for (auto signIt : cosmos->get_signatures_ref())
+                {
+                    if (m_timelineApi.is_input_only_timestream()) m_pastKeyframeRequests.insert(signIt.first);
+                    else m_pendingPastChanges[signIt.first] = signIt.second;
+                }
+            }
+            break;
             case events::cosmos::TIMESTREAM_STATE_CHANGE:
             {
                 // we are signalled that an interception has occurred sometime/where from another timeslice
@@ -411,6 +446,8 @@ namespace pleep
                         {
                             // if non-divergent entity, then read update into Cosmos as normal
                             cosmos->deserialize_entity_components(updateInfo.entity, updateInfo.sign, evnt, updateInfo.category);
+                            // full state re-syncs our re-simulation
+                            if (updateInfo.category == ComponentCategory::all) m_desyncedEntities.erase(updateInfo.entity);
                         }
                         else
                         {
@@ -462,6 +499,35 @@ namespace pleep
                         }
                     }
                     break;
+                    case events::cosmos::TIMESTREAM_CHECKSUM:
+                    {
+                        // input-only timestreams leave us to re-simulate, check we still match
+                        events::cosmos::TIMESTREAM_CHECKSUM_params checksumInfo;
+                        evnt >> checksumInfo;
+                        assert(checksumInfo.entity == evntEntity);
+
+                        // divergent entities don't follow the timestream anyway
+                        // and only one keyframe request is needed until it arrives
+                        if (!cosmos->entity_exists(checksumInfo.entity)
+                            || is_divergent(cosmos->get_timestream_state(checksumInfo.entity).first)
+                            || m_desyncedEntities.count(checksumInfo.entity))
+                        {
+                            break;
+                        }
+
+                        if (checksum_entity_state(cosmos, checksumInfo.entity) != checksumInfo.checksum)
+                        {
+                            PLEEPLOG_DEBUG("Entity {} re-simulation desynced from timestream at {}, requesting keyframe", checksumInfo.entity, evnt.header.coherency);
+                            m_desyncedEntities.insert(checksumInfo.entity);
+
+                            EventMessage desyncMsg(events::cosmos::TIMESTREAM_DESYNC, currentCoherency);
+                            events::cosmos::TIMESTREAM_DESYNC_params desyncInfo = { checksumInfo.entity };
+                            desyncMsg << desyncInfo;
+                            // timesliceId decreases into the future
+                            m_timelineApi.send_message(m_timelineApi.get_timeslice_id() - 1, desyncMsg);
+                        }
+                    }
+                    break;
                     case events::network::JUMP_REQUEST:
                     {
                         // Just ignore this and wait for the subsiquent departure (if jump was successful)
@@ -531,7 +597,12 @@ namespace pleep
                 // TODO: Check updated entity matches client's assigned entity
 
                 // We should only be receiving upstream components...
-                if (cosmos) cosmos->deserialize_entity_components(updateInfo.entity, updateInfo.sign, remoteMsg.msg, ComponentCategory::upstream);
+                if (cosmos)
+                {
+                    cosmos->deserialize_entity_components(updateInfo.entity, updateInfo.sign, remoteMsg.msg, ComponentCategory::upstream);
+                    // client stamps its input with its coherency, echo it back with the resulting state
+                    m_interestManager.acknowledge_input(updateInfo.entity, remoteMsg.msg.header.coherency);
+                }
             }
             break;
             case events::network::NEW_CLIENT:
@@ -584,6 +655,7 @@ namespace pleep
                     //PLEEPLOG_DEBUG("Sending message: " + createMsg.info());
                     remoteMsg.remote->send(createMsg);
                 }
+                // entity state is sent by m_interestManager once the client is in m_clientEntities
 
                 
                 // check transfer codes for available entity
@@ -613,7 +685,7 @@ namespace pleep
                     cosmos->get_entity_signature(clientInfo.entity) & cosmos->get_category_signature(ComponentCategory::upstream),
                     ComponentCategory::upstream
                 };
-                cosmos->serialize_entity_components(updateInfo.entity, updateInfo.sign, updateMsg);
+                cosmos->serialize_entity_components(updateInfo.entity, updateInfo.sign, updateMsg, updateInfo.category);
 
                 updateMsg << updateInfo;
                 remoteMsg.remote->send(updateMsg);
@@ -640,41 +712,130 @@ namespace pleep
 
 
         // Fourth: After all ingesting is done, send/broadcast fresh downstream data to clients & children
+        // Only components changed since the last send are serialized, unless the entity's signature
+        // changed (children need the full signature to add/remove components) or it is time to refresh
+        // Changes are gathered every update, but only sent at the configured snapshot/timestream rates
         if (cosmos)
         {
+            const bool refreshAll = m_refreshInterval.is_due(currentCoherency, REPLICATION_REFRESH_INTERVAL);
+            const bool timestreamDue = m_timestreamInterval.is_due(currentCoherency, m_timelineApi.get_timestream_interval());
+            // input-only timestreams send the past what it can't simulate itself
+            const bool inputOnly = m_timelineApi.is_input_only_timestream();
+            m_interestManager.update_clients(m_clientEntities, cosmos);
+            const Signature downstreamSign = cosmos->get_category_signature(ComponentCategory::downstream);
+            const Signature upstreamSign = cosmos->get_category_signature(ComponentCategory::upstream);
+
+            const bool checkpointing = !m_timelineApi.get_checkpoint_directory().empty();
             for (auto signIt : cosmos->get_signatures_ref())
             {
-                // push to clients
-                EventMessage clientUpdateMsg(events::cosmos::ENTITY_UPDATE, currentCoherency);
-                events::cosmos::ENTITY_UPDATE_params clientUpdateInfo = {
-                    signIt.first,
-                    signIt.second & cosmos->get_category_signature(ComponentCategory::downstream),
-                    ComponentCategory::downstream
-                };
-                cosmos->serialize_entity_components(clientUpdateInfo.entity, clientUpdateInfo.sign, clientUpdateMsg);
+                Signature changedSign = cosmos->get_changed_signature(signIt.first);
+                // (before refreshes below, which didn't actually change anything)
+                if (checkpointing && changedSign.any()) m_checkpointCapturer.mark_changed(signIt.first);
+
+                auto replicatedIt = m_replicatedSignatures.find(signIt.first);
+                if (replicatedIt == m_replicatedSignatures.end() || replicatedIt->second != signIt.second)
+                {
+                    m_replicatedSignatures[signIt.first] = signIt.second;
+                    changedSign = signIt.second;
+                    // the past can't add/remove components by simulating
+                    if (inputOnly && m_timelineApi.has_past()) m_pastKeyframeRequests.insert(signIt.first);
+                }
+                else if (refreshAll)
+                {
+                    changedSign = signIt.second;
+                }
+
+                // nothing to tell anyone about
+                if (changedSign.none()) continue;
 
-                clientUpdateMsg << clientUpdateInfo;
-                m_networkApi.broadcast_message(clientUpdateMsg);
+                // clients are sent what is relevant to them after the loop
+                // (downstream category never removes components, so a subset is fine)
+                m_interestManager.add_changes(signIt.first, changedSign & downstreamSign);
 
+                // and for child timestream (except if there is not past to push to)
+                if (!m_timelineApi.has_past()) continue;
 
-                // and push to child timestream (except if there is not past to push to)
-                if (!m_timelineApi.has_past())
+                if (!inputOnly)
                 {
-                    continue;
+                    m_pendingPastChanges[signIt.first] |= changedSign;
                 }
+                else if ((changedSign & upstreamSign).any())
+                {
+                    // the past re-simulates from inputs, so they must arrive on the update they happened
+                    _push_past_update(cosmos, signIt.first, changedSign & upstreamSign & signIt.second, ComponentCategory::upstream, currentCoherency);
+                }
+            }
 
-                EventMessage childUpdateMsg(events::cosmos::ENTITY_UPDATE, currentCoherency);
-                events::cosmos::ENTITY_UPDATE_params childUpdateInfo = {
-                    signIt.first,
-                    signIt.second,  // full signature of components
-                    ComponentCategory::all
-                };
-                cosmos->serialize_entity_components(childUpdateInfo.entity, childUpdateInfo.sign, childUpdateMsg);
+            if (inputOnly && m_timelineApi.has_past())
+            {
+                // everything, periodically, so undetected drift can't last
+                if (currentCoherency % m_timelineApi.get_timestream_keyframe_interval() == 0)
+                {
+                    for (auto signIt : cosmos->get_signatures_ref())
+                    {
+                        m_pastKeyframeRequests.insert(signIt.first);
+                    }
+                }
+                for (Entity entity : m_pastKeyframeRequests)
+                {
+                    if (!cosmos->entity_exists(entity)) continue;
+                    _push_past_update(cosmos, entity, cosmos->get_entity_signature(entity), ComponentCategory::all, currentCoherency);
+                }
+                m_pastKeyframeRequests.clear();
 
-                // increment chain link (increase) when moving into the past
-                increment_causal_chain_link(childUpdateInfo.entity);
-                childUpdateMsg << childUpdateInfo;
-                m_timelineApi.push_past_timestream(childUpdateInfo.entity, childUpdateMsg);
+                // (after keyframes, so they are checked against the state they just set)
+                if (currentCoherency % m_timelineApi.get_timestream_checksum_interval() == 0)
+                {
+                    for (auto signIt : cosmos->get_signatures_ref())
+                    {
+                        Entity pastEntity = signIt.first;
+                        const uint32_t checksum = checksum_entity_state(cosmos, pastEntity);
+                        increment_causal_chain_link(pastEntity);
+
+                        EventMessage checksumMsg(events::cosmos::TIMESTREAM_CHECKSUM, currentCoherency);
+                        events::cosmos::TIMESTREAM_CHECKSUM_params checksumInfo = { pastEntity, checksum };
+                        checksumMsg << checksumInfo;
+                        m_timelineApi.push_past_timestream(pastEntity, checksumMsg);
+                    }
+                }
+            }
+            else if (timestreamDue)
+            {
+                for (auto& pendingIt : m_pendingPastChanges)
+                {
+                    // components may have been removed since they changed
+                    const Signature entitySign = cosmos->get_entity_signature(pendingIt.first);
+                    const Signature sendSign = pendingIt.second & entitySign;
+
+                    // only a full signature may remove components the child has
+                    _push_past_update(cosmos, pendingIt.first, sendSign, sendSign == entitySign ? ComponentCategory::all : ComponentCategory::partial, currentCoherency);
+                }
+                m_pendingPastChanges.clear();
+            }
+
+            if (m_snapshotInterval.is_due(currentCoherency, m_timelineApi.get_snapshot_interval()))
+            {
+                m_interestManager.send_updates(cosmos, m_networkApi, currentCoherency);
+            }
+
+            // everything changed has been sent (or is still pending in m_interestManager/m_pendingPastChanges)
+            cosmos->clear_changed_components();
+
+            // compression is shared by every timeslice in the process, so these are process wide totals since our last report
+            {
+                const CompressionTickMetrics networkTotals = get_network_compression().get_totals();
+                const CompressionTickMetrics timestreamTotals = get_timestream_compression().get_totals();
+                const CompressionTickMetrics networkMetrics = networkTotals.since(m_reportedNetworkCompression);
+                const CompressionTickMetrics timestreamMetrics = timestreamTotals.since(m_reportedTimestreamCompression);
+                m_reportedNetworkCompression = networkTotals;
+                m_reportedTimestreamCompression = timestreamTotals;
+                if (networkMetrics.rawBytes > 0 || timestreamMetrics.rawBytes > 0)
+                {
+                    PLEEPLOG_DEBUG("Compression at {} (timeslice {}): network {} -> {} bytes ({:.2f}x) in {:.3f}ms (+{:.3f}ms inflating), timestreams {} -> {} bytes ({:.2f}x) in {:.3f}ms (+{:.3f}ms inflating)",
+                        currentCoherency, m_timelineApi.get_timeslice_id(),
+                        networkMetrics.rawBytes, networkMetrics.storedBytes, networkMetrics.ratio(), networkMetrics.compressMs, networkMetrics.decompressMs,
+                        timestreamMetrics.rawBytes, timestreamMetrics.storedBytes, timestreamMetrics.ratio(), timestreamMetrics.compressMs, timestreamMetrics.decompressMs);
+                }
             }
         }
 
@@ -711,8 +872,64 @@ namespace pleep
                 m_timelineApi.parallel_retarget(cosmos->get_coherency() + 1);
             }
         }
+
+        // Sixth: Checkpoint
+        // offset by our delay so every timeslice captures at the same moment of the whole timeline
+        if (cosmos && !m_timelineApi.get_checkpoint_directory().empty())
+        {
+            const uint16_t timelineCoherency = static_cast<uint16_t>(currentCoherency
+                + m_timelineApi.get_timeslice_delay() * FRAMERATE * m_timelineApi.get_timeslice_id());
+            if (timelineCoherency % m_timelineApi.get_checkpoint_interval() == 0)
+            {
+                _capture_checkpoint(cosmos);
+            }
+        }
+    }
+
+    bool ServerNetworkDynamo::restore_checkpoint(std::shared_ptr<Cosmos> cosmos)
+    {
+        if (m_timelineApi.get_checkpoint_directory().empty()) return false;
+
+        m_isRestoring = true;
+        const bool restored = pleep::restore_checkpoint(
+            get_checkpoint_path(m_timelineApi.get_checkpoint_directory(), m_timelineApi.get_timeslice_id()),
+            cosmos,
+            m_timelineApi
+        );
+        m_isRestoring = false;
+
+        return restored;
+    }
+
+    void ServerNetworkDynamo::_capture_checkpoint(std::shared_ptr<Cosmos> cosmos)
+    {
+        if (m_checkpointWriter.is_writing())
+        {
+            PLEEPLOG_WARN("Previous checkpoint is still being written, skipping checkpoint at " + std::to_string(cosmos->get_coherency()));
+            return;
+        }
+
+        std::vector<uint8_t> checkpoint;
+        m_checkpointCapturer.capture(cosmos, m_timelineApi, checkpoint);
+        m_checkpointWriter.write(get_checkpoint_path(m_timelineApi.get_checkpoint_directory(), m_timelineApi.get_timeslice_id()), std::move(checkpoint));
     }
     
+    void ServerNetworkDynamo::_push_past_update(std::shared_ptr<Cosmos> cosmos, Entity entity, Signature sign, ComponentCategory category, uint16_t coherency)
+    {
+        EventMessage childUpdateMsg(events::cosmos::ENTITY_UPDATE, coherency);
+        events::cosmos::ENTITY_UPDATE_params childUpdateInfo = {
+            entity,
+            sign,
+            category
+        };
+        cosmos->serialize_entity_components(childUpdateInfo.entity, childUpdateInfo.sign, childUpdateMsg);
+
+        // increment chain link (increase) when moving into the past
+        increment_causal_chain_link(childUpdateInfo.entity);
+        childUpdateMsg << childUpdateInfo;
+        m_timelineApi.push_past_timestream(childUpdateInfo.entity, childUpdateMsg);
+    }
+
     void ServerNetworkDynamo::reset_relays() 
     {
         // clear our working cosmos
@@ -745,8 +962,11 @@ namespace pleep
         return appInfo;
     }
     
-    void ServerNetworkDynamo::_entity_created_handler(EventMessage creationEvent)
+    void ServerNetworkDynamo::_entity_created_handler(EventMessage& creationEvent)
     {   
+        // restored entities were already propagated (and counted) before the checkpoint
+        if (m_isRestoring) return;
+
         // Broadcast creation event to clients, the run_relays update will populate it
         m_networkApi.broadcast_message(creationEvent);
 
@@ -776,7 +996,7 @@ namespace pleep
         }
     }
     
-    void ServerNetworkDynamo::_entity_removed_handler(EventMessage removalEvent)
+    void ServerNetworkDynamo::_entity_removed_handler(EventMessage& removalEvent)
     {
         //PLEEPLOG_DEBUG("Handling ENTITY_REMOVED event");
         // REMEMBER: this is called AFTER the entity was destroyed so you can't lookup any of its data
@@ -794,6 +1014,14 @@ namespace pleep
 
         // if it was a client's focal entity, remove it from client map
         m_clientEntities.erase(removedEntityParams.entity);
+        m_replicatedSignatures.erase(removedEntityParams.entity);
+        m_interestManager.remove_entity(removedEntityParams.entity);
+        // client updates are keyed by their focal entity
+        if (m_networkApi.get_datagram_channel()) m_networkApi.get_datagram_channel()->forget_key(removedEntityParams.entity);
+        // removal is pushed below, no updates may follow it
+        m_pendingPastChanges.erase(removedEntityParams.entity);
+        m_pastKeyframeRequests.erase(removedEntityParams.entity);
+        m_desyncedEntities.erase(removedEntityParams.entity);
 
         // propagate further down the timeline
         if (m_timelineApi.has_past())
@@ -810,7 +1038,7 @@ namespace pleep
         }
     }
     
-    void ServerNetworkDynamo::_timestream_interception_handler(EventMessage interceptionEvent)
+    void ServerNetworkDynamo::_timestream_interception_handler(EventMessage& interceptionEvent)
     {
         // Something (like collision) has detected an interception between two entities
         PLEEPLOG_TRACE("Handling TIMESTREAM_INTERCEPTION event");
@@ -837,8 +1065,11 @@ namespace pleep
         // "Divergent" state (forking) now restricts reading downstream components from the timestream
     }
 
-    void ServerNetworkDynamo::_timestream_state_change_handler(EventMessage stateEvent)
+    void ServerNetworkDynamo::_timestream_state_change_handler(EventMessage& stateEvent)
     {
+        // restored states were already signalled before the checkpoint
+        if (m_isRestoring) return;
+
         // entity state has changed in our local cosmos
         events::cosmos::TIMESTREAM_STATE_CHANGE_params stateInfo;
         stateEvent >> stateInfo;
@@ -875,7 +1106,7 @@ namespace pleep
         }
     }
 
-    void ServerNetworkDynamo::_jump_request_handler(EventMessage jumpEvent)
+    void ServerNetworkDynamo::_jump_request_handler(EventMessage& jumpEvent)
     {
         std::shared_ptr<Cosmos> cosmos = m_workingCosmos.lock();
         if (m_workingCosmos.expired()) return;
@@ -937,7 +1168,7 @@ namespace pleep
         }
     }
 
-    void ServerNetworkDynamo::_jump_arrival_handler(EventMessage jumpEvent)
+    void ServerNetworkDynamo::_jump_arrival_handler(EventMessage& jumpEvent)
     {
         std::shared_ptr<Cosmos> cosmos = m_workingCosmos.lock();
         if (m_workingCosmos.expired()) return;
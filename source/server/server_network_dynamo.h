@@ -3,10 +3,14 @@
 
 //#include "intercession_pch.h"
 #include <memory>
+#include <unordered_set>
 
 #include "networking/i_network_dynamo.h"
 #include "server/server_network_api.h"
 #include "networking/timeline_api.h"
+#include "server/interest_manager.h"
+#include "server/timeline_checkpoint.h"
+#include "networking/block_compression.h"
 
 namespace pleep
 {
@@ -41,14 +45,42 @@ namespace pleep
         
         events::network::APP_INFO_params get_app_info() override;
 
+        // load our checkpoint (if checkpoints are enabled and one exists) into an entity-less cosmos
+        // without propagating any of its entities to the timeline or clients
+        // returns false if nothing was restored (cosmos should be discarded)
+        bool restore_checkpoint(std::shared_ptr<Cosmos> cosmos);
+
     private:
+        // Due once every interval updates since it was last due
+        // (coherency % interval would be irregular where coherency wraps around)
+        struct CoherencyInterval
+        {
+            bool started = false;
+            uint16_t lastDue = 0;
+
+            // call once per update, a coherency jump in either direction makes it due immediately
+            bool is_due(uint16_t coherency, uint16_t interval)
+            {
+                if (started && static_cast<uint16_t>(coherency - lastDue) < interval) return false;
+                started = true;
+                lastDue = coherency;
+                return true;
+            }
+        };
+
         // event handlers
-        void _entity_created_handler(EventMessage creationEvent);
-        void _entity_removed_handler(EventMessage removalEvent);
-        void _timestream_interception_handler(EventMessage interceptionEvent);
-        void _timestream_state_change_handler(EventMessage stateEvent);
-        void _jump_request_handler(EventMessage jumpEvent);
-        void _jump_arrival_handler(EventMessage jumpEvent);
+        void _entity_created_handler(EventMessage& creationEvent);
+        void _entity_removed_handler(EventMessage& removalEvent);
+        void _timestream_interception_handler(EventMessage& interceptionEvent);
+        void _timestream_state_change_handler(EventMessage& stateEvent);
+        void _jump_request_handler(EventMessage& jumpEvent);
+        void _jump_arrival_handler(EventMessage& jumpEvent);
+
+        // capture our whole state into a checkpoint and start writing it
+        void _capture_checkpoint(std::shared_ptr<Cosmos> cosmos);
+
+        // serialize sign components of entity and push them into the past timestream as of coherency
+        void _push_past_update(std::shared_ptr<Cosmos> cosmos, Entity entity, Signature sign, ComponentCategory category, uint16_t coherency);
 
         // TimelineApi (generated for us by AppGateway) to communicate with other servers
         TimelineApi m_timelineApi;
@@ -64,6 +96,36 @@ namespace pleep
 
         // temporary mapping between transfercodes and focal entities for soon-to-be connecting clients
         std::unordered_map<uint32_t, Entity> m_transferCache;
+
+        // signature each entity had when it was last replicated
+        // a different signature means the next update must contain all components
+        std::unordered_map<Entity, Signature> m_replicatedSignatures;
+
+        // chooses which changed entities each client is sent
+        InterestManager m_interestManager;
+
+        CoherencyInterval m_coherencySyncInterval;
+        CoherencyInterval m_snapshotInterval;
+        CoherencyInterval m_timestreamInterval;
+        CoherencyInterval m_refreshInterval;
+
+        // process wide compression totals at our last report
+        CompressionTickMetrics m_reportedNetworkCompression;
+        CompressionTickMetrics m_reportedTimestreamCompression;
+
+        // components changed since the last push to the past timestream
+        std::unordered_map<Entity, Signature> m_pendingPastChanges;
+        // (input-only timestreams) entities whose full state must be pushed to the past this update
+        std::unordered_set<Entity> m_pastKeyframeRequests;
+        // (input-only timestreams) entities we've requested a keyframe for, ignore checksums until it arrives
+        std::unordered_set<Entity> m_desyncedEntities;
+
+        // keeps entities serialized between checkpoints (only changed ones are serialized again)
+        CheckpointCapturer m_checkpointCapturer;
+        // writes captured checkpoints in the background
+        CheckpointWriter m_checkpointWriter;
+        // entities being restored already exist in the rest of the timeline, don't propagate them
+        bool m_isRestoring = false;
     };
 }
 
@@ -0,0 +1,124 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+//#include "intercession_pch.h"
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+#include "ecs/ecs_types.h"
+
+namespace pleep
+{
+    // Uniform hashed grid of entity positions, rebuilt each time it is used
+    // so nearby entities can be found without testing every entity in the cosmos
+    class SpatialGrid
+    {
+    public:
+        SpatialGrid(float cellSize)
+            : m_cellSize(cellSize)
+        {}
+
+        // forget all entities
+        // cells occupied by the last build keep their allocations for the next one (entities rarely move far),
+        // cells left empty by it are erased so the map only grows with what is occupied
+        void clear()
+        {
+            for (auto cellIt = m_cells.begin(); cellIt != m_cells.end();)
+            {
+                if (cellIt->second.empty())
+                {
+                    cellIt = m_cells.erase(cellIt);
+                }
+                else
+                {
+                    cellIt->second.clear();
+                    cellIt++;
+                }
+            }
+            m_unplaced.clear();
+        }
+
+        void insert(Entity entity, const glm::vec3& position)
+        {
+            m_cells[_cell_key(position)].push_back(Entry{ entity, position });
+        }
+
+        // entities without a position are returned by every query (at distance 0)
+        void insert_unplaced(Entity entity)
+        {
+            m_unplaced.push_back(entity);
+        }
+
+        // call visit(entity, distance) for each entity within radius of center
+        template<typename T_Visitor>
+        void query(const glm::vec3& center, float radius, T_Visitor visit) const
+        {
+            for (Entity entity : m_unplaced)
+            {
+                visit(entity, 0.0f);
+            }
+
+            const glm::ivec3 minCell = _cell_coord(center - glm::vec3(radius));
+            const glm::ivec3 maxCell = _cell_coord(center + glm::vec3(radius));
+            const float radiusSquared = radius * radius;
+
+            for (int x = minCell.x; x <= maxCell.x; x++)
+            {
+                for (int y = minCell.y; y <= maxCell.y; y++)
+                {
+                    for (int z = minCell.z; z <= maxCell.z; z++)
+                    {
+                        auto cellIt = m_cells.find(_pack_key(glm::ivec3(x, y, z)));
+                        if (cellIt == m_cells.end()) continue;
+
+                        for (const Entry& entry : cellIt->second)
+                        {
+                            const glm::vec3 offset = entry.position - center;
+                            const float distanceSquared = glm::dot(offset, offset);
+                            if (distanceSquared <= radiusSquared)
+                            {
+                                visit(entry.entity, std::sqrt(distanceSquared));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            Entity entity;
+            glm::vec3 position;
+        };
+
+        glm::ivec3 _cell_coord(const glm::vec3& position) const
+        {
+            return glm::ivec3(glm::floor(position / m_cellSize));
+        }
+
+        // 21 bits per axis
+        static uint64_t _pack_key(const glm::ivec3& cell)
+        {
+            const uint64_t mask = (1ULL << 21) - 1;
+            return  (static_cast<uint64_t>(cell.x) & mask)
+                | ((static_cast<uint64_t>(cell.y) & mask) << 21)
+                | ((static_cast<uint64_t>(cell.z) & mask) << 42);
+        }
+
+        uint64_t _cell_key(const glm::vec3& position) const
+        {
+            return _pack_key(_cell_coord(position));
+        }
+
+        float m_cellSize;
+        std::unordered_map<uint64_t, std::vector<Entry>> m_cells;
+        std::vector<Entity> m_unplaced;
+    };
+}
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,306 @@
+#include "timeline_checkpoint.h"
+
+#include <stdexcept>
+#include <utility>
+#include <chrono>
+
+#include "logging/pleep_log.h"
+#include "core/i_cosmos_context.h"
+#include "core/mapped_file.h"
+
+namespace pleep
+{
+    constexpr uint32_t TIMELINE_CHECKPOINT_MAGIC = 0x4B434C50; // "PLCK"
+    // increment whenever the layout below changes
+    constexpr uint32_t TIMELINE_CHECKPOINT_VERSION = 1;
+
+    // File layout (native endianness and padding, checkpoints don't move between builds/machines):
+    // CheckpointHeader
+    // entityCount     x (CheckpointEntityRecord + body bytes)
+    // hostedCount     x CheckpointHostedRecord
+    // availableCount  x Entity
+    // timestreamCount x (CheckpointTimestreamRecord + body bytes)
+    struct CheckpointHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        TimesliceId timesliceId;
+        uint16_t coherency;
+        // hash of component names (in registration order), serialized components are only readable by the same registry
+        uint32_t componentRegistryHash;
+        uint64_t entityCount;
+        uint64_t hostedCount;
+        uint64_t availableCount;
+        uint64_t nextGenesisId;
+        uint64_t timestreamCount;
+    };
+    struct CheckpointEntityRecord
+    {
+        Entity entity;
+        Signature sign;
+        TimestreamState state;
+        uint16_t stateCoherency;
+        uint32_t size;
+    };
+    struct CheckpointHostedRecord
+    {
+        Entity entity;
+        uint64_t count;
+    };
+    struct CheckpointTimestreamRecord
+    {
+        Entity entity;
+        MessageHeader<EventId> header;
+        uint32_t size;
+    };
+
+    // FNV-1a of all component names
+    static uint32_t _hash_component_registry(std::shared_ptr<Cosmos> cosmos)
+    {
+        uint32_t hash = 2166136261U;
+        for (const std::string& name : cosmos->stringify_component_registry())
+        {
+            // include terminator so names can't run together
+            for (size_t i = 0; i <= name.size(); i++)
+            {
+                hash ^= static_cast<uint8_t>(name.c_str()[i]);
+                hash *= 16777619U;
+            }
+        }
+        return hash;
+    }
+
+    std::string get_checkpoint_path(const std::string& directory, TimesliceId id)
+    {
+        std::string path = directory;
+        if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+        return path + "timeslice_" + std::to_string(id) + ".checkpoint";
+    }
+
+    void CheckpointCapturer::mark_changed(Entity entity)
+    {
+        m_changed.insert(entity);
+    }
+
+    void CheckpointCapturer::capture(std::shared_ptr<Cosmos> cosmos, TimelineApi& timelineApi, std::vector<uint8_t>& dest)
+    {
+        const std::chrono::steady_clock::time_point captureStart = std::chrono::steady_clock::now();
+
+        if (m_capturedCosmos.lock() != cosmos)
+        {
+            this->clear();
+            m_capturedCosmos = cosmos;
+        }
+
+        const EntityRegistry::HostedState hostedState = cosmos->get_hosted_state();
+        std::vector<std::pair<Entity, EventMessage>> timestreams;
+        timelineApi.copy_future_timestreams(timestreams);
+
+        CheckpointHeader header;
+        header.magic = TIMELINE_CHECKPOINT_MAGIC;
+        header.version = TIMELINE_CHECKPOINT_VERSION;
+        header.timesliceId = timelineApi.get_timeslice_id();
+        header.coherency = cosmos->get_coherency();
+        header.componentRegistryHash = _hash_component_registry(cosmos);
+        header.entityCount = cosmos->get_signatures_ref().size();
+        header.hostedCount = hostedState.counts.size();
+        header.availableCount = hostedState.availableIds.size();
+        header.nextGenesisId = hostedState.nextGenesisId;
+        header.timestreamCount = timestreams.size();
+        append_mapped(dest, header);
+
+        // entities destroyed since the last capture
+        for (auto capturedIt = m_captured.begin(); capturedIt != m_captured.end();)
+        {
+            if (!cosmos->entity_exists(capturedIt->first)) capturedIt = m_captured.erase(capturedIt);
+            else capturedIt++;
+        }
+
+        size_t serializedCount = 0;
+        EventMessage components;
+        for (auto& signIt : cosmos->get_signatures_ref())
+        {
+            CapturedEntity& captured = m_captured[signIt.first];
+            if (m_changed.count(signIt.first) || captured.sign != signIt.second)
+            {
+                components.body.clear();
+                cosmos->serialize_entity_components(signIt.first, signIt.second, components, ComponentCategory::all);
+                captured.sign = signIt.second;
+                captured.body.swap(components.body);
+                serializedCount++;
+            }
+
+            // timestream state isn't a component, it is always current
+            const std::pair<TimestreamState, uint16_t> state = cosmos->get_timestream_state(signIt.first);
+            CheckpointEntityRecord record;
+            record.entity = signIt.first;
+            record.sign = signIt.second;
+            record.state = state.first;
+            record.stateCoherency = state.second;
+            record.size = static_cast<uint32_t>(captured.body.size());
+            append_mapped(dest, record);
+            append_mapped_bytes(dest, captured.body);
+        }
+        m_changed.clear();
+
+        for (const std::pair<Entity, size_t>& count : hostedState.counts)
+        {
+            append_mapped(dest, CheckpointHostedRecord{ count.first, count.second });
+        }
+        for (Entity available : hostedState.availableIds)
+        {
+            append_mapped(dest, available);
+        }
+
+        for (const std::pair<Entity, EventMessage>& stored : timestreams)
+        {
+            CheckpointTimestreamRecord record;
+            record.entity = stored.first;
+            record.header = stored.second.header;
+            record.size = static_cast<uint32_t>(stored.second.body.size());
+            append_mapped(dest, record);
+            append_mapped_bytes(dest, stored.second.body);
+        }
+
+        PLEEPLOG_DEBUG("Captured checkpoint at " + std::to_string(header.coherency) + " (" + std::to_string(serializedCount) + " of "
+            + std::to_string(header.entityCount) + " entities serialized, " + std::to_string(dest.size()) + " bytes) in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - captureStart).count()) + "ms");
+    }
+
+    void CheckpointCapturer::clear()
+    {
+        m_captured.clear();
+        m_changed.clear();
+        m_capturedCosmos.reset();
+    }
+
+    bool restore_checkpoint(const std::string& path, std::shared_ptr<Cosmos> cosmos, TimelineApi& timelineApi)
+    {
+        MappedFile file(path);
+        if (!file.data())
+        {
+            PLEEPLOG_DEBUG("No checkpoint to restore at " + path);
+            return false;
+        }
+
+        try
+        {
+            MappedReader reader(file.data(), file.size());
+
+            CheckpointHeader header;
+            reader.read(header);
+            if (header.magic != TIMELINE_CHECKPOINT_MAGIC || header.version != TIMELINE_CHECKPOINT_VERSION)
+            {
+                PLEEPLOG_WARN("Checkpoint " + path + " is not a checkpoint of this version, ignoring it");
+                return false;
+            }
+            if (header.timesliceId != timelineApi.get_timeslice_id())
+            {
+                PLEEPLOG_WARN("Checkpoint " + path + " is of timeslice " + std::to_string(header.timesliceId) + ", ignoring it");
+                return false;
+            }
+            if (header.componentRegistryHash != _hash_component_registry(cosmos))
+            {
+                PLEEPLOG_WARN("Checkpoint " + path + " was captured with different components, ignoring it");
+                return false;
+            }
+
+            EventMessage components;
+            for (uint64_t i = 0; i < header.entityCount; i++)
+            {
+                CheckpointEntityRecord record;
+                reader.read(record);
+                reader.read_bytes(components.body, record.size);
+                components.header.size = record.size;
+
+                if (!cosmos->register_entity(record.entity, record.sign))
+                {
+                    PLEEPLOG_WARN("Checkpoint entity " + std::to_string(record.entity) + " could not be registered, skipping it");
+                    continue;
+                }
+                cosmos->deserialize_entity_components(record.entity, record.sign, components, ComponentCategory::all);
+
+                if (record.state != TimestreamState::merged)
+                {
+                    // state remembers when it was set
+                    cosmos->set_coherency(record.stateCoherency);
+                    cosmos->set_timestream_state(record.entity, record.state);
+                }
+            }
+
+            // after registering, which may have counted entities again
+            EntityRegistry::HostedState hostedState;
+            hostedState.nextGenesisId = static_cast<GenesisId>(header.nextGenesisId);
+            hostedState.counts.reserve(static_cast<size_t>(header.hostedCount));
+            for (uint64_t i = 0; i < header.hostedCount; i++)
+            {
+                CheckpointHostedRecord record;
+                reader.read(record);
+                hostedState.counts.emplace_back(record.entity, static_cast<size_t>(record.count));
+            }
+            hostedState.availableIds.reserve(static_cast<size_t>(header.availableCount));
+            for (uint64_t i = 0; i < header.availableCount; i++)
+            {
+                Entity available;
+                reader.read(available);
+                hostedState.availableIds.push_back(available);
+            }
+            cosmos->set_hosted_state(hostedState);
+
+            EventMessage stored;
+            for (uint64_t i = 0; i < header.timestreamCount; i++)
+            {
+                CheckpointTimestreamRecord record;
+                reader.read(record);
+                reader.read_bytes(stored.body, record.size);
+                stored.header = record.header;
+                timelineApi.restore_future_timestream(record.entity, stored);
+            }
+
+            cosmos->set_coherency(header.coherency);
+
+            PLEEPLOG_INFO("Restored timeslice " + std::to_string(header.timesliceId) + " at coherency " + std::to_string(header.coherency)
+                + " from " + path + " (" + std::to_string(header.entityCount) + " entities, " + std::to_string(header.timestreamCount) + " timestream messages)");
+        }
+        catch (const std::exception& e)
+        {
+            PLEEPLOG_ERROR("Could not restore checkpoint " + path + ": " + e.what());
+            return false;
+        }
+        return true;
+    }
+
+    CheckpointWriter::~CheckpointWriter()
+    {
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    bool CheckpointWriter::write(const std::string& path, std::vector<uint8_t>&& data)
+    {
+        if (m_isWriting.load(std::memory_order_acquire))
+        {
+            PLEEPLOG_WARN("Previous checkpoint is still being written, skipping this one");
+            return false;
+        }
+        // finished, but not yet joined
+        if (m_thread.joinable()) m_thread.join();
+
+        m_isWriting.store(true, std::memory_order_release);
+        m_thread = std::thread(&CheckpointWriter::_write_file, this, path, std::move(data));
+        return true;
+    }
+
+    bool CheckpointWriter::is_writing() const
+    {
+        return m_isWriting.load(std::memory_order_acquire);
+    }
+
+    void CheckpointWriter::_write_file(std::string path, std::vector<uint8_t> data)
+    {
+        if (write_file_replacing(path, data))
+        {
+            PLEEPLOG_DEBUG("Wrote checkpoint " + path + " (" + std::to_string(data.size()) + " bytes)");
+        }
+        m_isWriting.store(false, std::memory_order_release);
+    }
+}
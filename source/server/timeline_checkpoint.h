@@ -0,0 +1,88 @@
+#ifndef TIMELINE_CHECKPOINT_H
+#define TIMELINE_CHECKPOINT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "core/cosmos.h"
+#include "networking/timeline_api.h"
+
+namespace pleep
+{
+    // Everything a timeslice needs to resume where it left off:
+    // every entity (all components) and its timestream state, hosted entity counts, coherency,
+    // and the contents of its future timestream (what the timeslice ahead has already sent it)
+    // Each timeslice checkpoints into its own file, so it works the same for multi-process timelines
+
+    // file of timeslice id's checkpoint in directory
+    std::string get_checkpoint_path(const std::string& directory, TimesliceId id);
+
+    // Captures checkpoints incrementally: each entity's serialized components are kept between captures
+    // and only serialized again if they were marked changed or the entity's signature changed
+    // (a capture still copies every entity's bytes, but that is a fraction of serializing them)
+    class CheckpointCapturer
+    {
+    public:
+        // entity's components changed since the last capture
+        // (call for every changed entity before the cosmos clears its changed flags)
+        void mark_changed(Entity entity);
+
+        // write the whole state of cosmos and timelineApi's future timestream into dest
+        // (must be on the cosmos' thread, between updates)
+        void capture(std::shared_ptr<Cosmos> cosmos, TimelineApi& timelineApi, std::vector<uint8_t>& dest);
+
+        // forget all kept entities, next capture serializes all of them
+        void clear();
+
+    private:
+        struct CapturedEntity
+        {
+            Signature sign;
+            std::vector<uint8_t> body;
+        };
+        std::unordered_map<Entity, CapturedEntity> m_captured;
+        std::unordered_set<Entity> m_changed;
+        // captured entities are only valid for the cosmos they came from
+        std::weak_ptr<Cosmos> m_capturedCosmos;
+    };
+
+    // load the checkpoint at path into cosmos (registered components and synchros, but no entities)
+    // and timelineApi's (empty) future timestream.
+    // the file is memory mapped and read in place
+    // returns false if there is no checkpoint, or it is not for this cosmos/timeslice or is corrupted
+    // (then cosmos should be discarded, it may have been partially restored)
+    bool restore_checkpoint(const std::string& path, std::shared_ptr<Cosmos> cosmos, TimelineApi& timelineApi);
+
+    // Writes captured checkpoints to disk on its own thread so the frame loop never waits for the disk
+    // A new checkpoint is written next to the previous one and only replaces it once it is complete
+    class CheckpointWriter
+    {
+    public:
+        CheckpointWriter() = default;
+        // waits for any write in progress to finish
+        ~CheckpointWriter();
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        // start writing data to path in the background
+        // returns false (and drops data) if the previous write hasn't finished yet
+        bool write(const std::string& path, std::vector<uint8_t>&& data);
+
+        bool is_writing() const;
+
+    private:
+        void _write_file(std::string path, std::vector<uint8_t> data);
+
+        std::thread m_thread;
+        std::atomic<bool> m_isWriting{ false };
+    };
+}
+
+#endif // TIMELINE_CHECKPOINT_H
@@ -11,6 +11,7 @@
 #include "logging/pleep_log.h"
 #include "server/server_app_gateway.h"
 #include "networking/timeline_config.h"
+#include "rendering/model_cache.h"
 
 int main(int argc, char** argv)
 {
@@ -33,19 +34,104 @@ int main(int argc, char** argv)
     for (int i = 1; i < argc; i++)
         args.push_back(argv[i]);
 
-    if (!args.empty())
+    // TODO: Parse config options directly OR some config ini filename for server topology
+    pleep::TimelineConfig cfg;
+    cfg.numTimeslices = 4;
+
+    // run only some timeslices in this process (repeatable), the rest are reached over sockets:
+    //   --timeslice <id>
+    // address other processes' timeslices listen at (default timelineAddress):
+    //   --timeslice-host <id> <address>
+    // other timeslices are all on this host, use shared memory instead of sockets:
+    //   --shared-memory
+    // start the present from a world snapshot file (saved there first if it doesn't exist):
+    //   --world <file>
+    // checkpoint every timeslice into (existing) directory, and resume from it on startup:
+    //   --checkpoint <directory>
+    // read and write baked model files in (existing) directory, instead of importing models with Assimp every run:
+    //   --asset-cache <directory>
+    // only bake model file into --asset-cache and exit (repeatable):
+    //   --bake <file>
+    // update synchros one at a time in registration order:
+    //   --serial-stages
+    std::string assetCacheDirectory;
+    std::vector<std::string> bakeFiles;
+    std::string ignoredArgs;
+    try
     {
-        // just echo for now
-        std::string concat;
-        for (std::string a : args)
-            concat.append(a + " ");
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            if (args[i] == "--timeslice" && i + 1 < args.size())
+            {
+                cfg.localTimeslices.push_back(static_cast<pleep::TimesliceId>(std::stoul(args[++i])));
+            }
+            else if (args[i] == "--timeslice-host" && i + 2 < args.size())
+            {
+                const size_t id = std::stoul(args[++i]);
+                if (cfg.timesliceHosts.size() <= id) cfg.timesliceHosts.resize(id + 1, cfg.timelineAddress);
+                cfg.timesliceHosts[id] = args[++i];
+            }
+            else if (args[i] == "--shared-memory")
+            {
+                cfg.sharedMemoryTimeline = true;
+            }
+            else if (args[i] == "--world" && i + 1 < args.size())
+            {
+                cfg.worldSnapshot = args[++i];
+            }
+            else if (args[i] == "--checkpoint" && i + 1 < args.size())
+            {
+                cfg.checkpointDirectory = args[++i];
+            }
+            else if (args[i] == "--asset-cache" && i + 1 < args.size())
+            {
+                assetCacheDirectory = args[++i];
+            }
+            else if (args[i] == "--bake" && i + 1 < args.size())
+            {
+                bakeFiles.push_back(args[++i]);
+            }
+            else if (args[i] == "--serial-stages")
+            {
+                cfg.parallelStages = false;
+            }
+            else
+            {
+                ignoredArgs.append(args[i] + " ");
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        UNREFERENCED_PARAMETER(e);
+        PLEEPLOG_ERROR("Could not parse cmd args: ");
+        PLEEPLOG_ERROR(e.what());
+        DEINIT_PLEEPLOG();
+        return 1;
+    }
 
-        PLEEPLOG_WARN("Ignored cmd args: " + concat);
+    if (!ignoredArgs.empty())
+    {
+        PLEEPLOG_WARN("Ignored cmd args: " + ignoredArgs);
     }
 
-    // TODO: Parse config options directly OR some config ini filename for server topology
-    pleep::TimelineConfig cfg;
-    cfg.numTimeslices = 4;
+    pleep::ModelCache::set_bake_directory(assetCacheDirectory);
+    if (!bakeFiles.empty())
+    {
+        if (assetCacheDirectory.empty())
+        {
+            PLEEPLOG_ERROR("--bake needs an --asset-cache directory to bake into");
+            DEINIT_PLEEPLOG();
+            return 1;
+        }
+        bool allBaked = true;
+        for (const std::string& bakeFile : bakeFiles)
+        {
+            allBaked &= pleep::ModelCache::bake(bakeFile);
+        }
+        DEINIT_PLEEPLOG();
+        return allBaked ? 0 : 1;
+    }
 
     // TODO: Parse serialized cosmos (world) data and meta-data
     //pleep::CosmosConfig serializedCosmos;
@@ -82,6 +168,7 @@ int main(int argc, char** argv)
         UNREFERENCED_PARAMETER(e);
         PLEEPLOG_ERROR("The following uncaught exception occurred during ServerAppGateway startup: ");
         PLEEPLOG_ERROR(e.what());
+        DEINIT_PLEEPLOG();
         return 1;
     }
 
@@ -95,11 +182,14 @@ int main(int argc, char** argv)
         UNREFERENCED_PARAMETER(e);
         PLEEPLOG_ERROR("Uncaught exception during ServerAppGateway running");
         PLEEPLOG_ERROR(e.what());
+        DEINIT_PLEEPLOG();
         return 1;
     }
 
     // cleanup
     delete intercessionServerApp;
 
+    // flush any queued log messages
+    DEINIT_PLEEPLOG();
     return 0;
 }
@@ -3,8 +3,11 @@ set(COMMON_SOURCE_FILES
     source/core/i_app_gateway.cpp
     source/core/i_cosmos_context.cpp
     source/core/cosmos.cpp
+    source/core/stage_scheduler.cpp
+    source/core/mapped_file.cpp
 
     source/staging/cosmos_builder.cpp
+    source/staging/cosmos_snapshot.cpp
     source/staging/iceberg_cosmos.cpp
     source/staging/moon_cosmos.cpp
 
@@ -20,7 +23,12 @@ set(COMMON_SOURCE_FILES
     source/rendering/texture.cpp
     source/rendering/shader_manager.cpp
     source/rendering/model_manager.cpp
+    source/rendering/model_manager_bake.cpp
     source/rendering/model_manager_faux.cpp
+    source/rendering/asset_import_pool.cpp
+    source/rendering/animation_clip.cpp
+    source/rendering/view_frustum.cpp
+    source/rendering/draw_list.cpp
 
     source/inputting/input_dynamo.cpp
     source/inputting/spacial_input_synchro.cpp
@@ -29,9 +37,16 @@ set(COMMON_SOURCE_FILES
     source/physics/physics_synchro.cpp
     source/physics/collider_synchro.cpp
     source/physics/collision_procedures.cpp
+    source/physics/collider_mesh.cpp
 
     source/networking/network_synchro.cpp
     source/networking/timeline_api.cpp
+    source/networking/in_process_timeline_transport.cpp
+    source/networking/a_peer_timeline_transport.cpp
+    source/networking/socket_timeline_transport.cpp
+    source/networking/shared_memory_ring.cpp
+    source/networking/shared_memory_timeline_transport.cpp
+    source/networking/block_compression.cpp
 
     source/spacetime/parallel_cosmos_context.cpp
     source/spacetime/parallel_network_dynamo.cpp
@@ -50,6 +65,8 @@ set(CLIENT_SOURCE_FILES
     source/client/client_model_cache.cpp
 
     source/client/client_network_dynamo.cpp
+    source/client/snapshot_interpolator.cpp
+    source/client/focal_predictor.cpp
 )
 
 set(SERVER_SOURCE_FILES
@@ -60,4 +77,6 @@ set(SERVER_SOURCE_FILES
     source/server/server_model_cache.cpp
 
     source/server/server_network_dynamo.cpp
+    source/server/interest_manager.cpp
+    source/server/timeline_checkpoint.cpp
 )
\ No newline at end of file
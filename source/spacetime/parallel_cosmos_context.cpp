@@ -15,6 +15,7 @@ namespace pleep
         m_dynamoCluster.networker = std::make_shared<ParallelNetworkDynamo>(m_eventBroker, localTimelineApi);
         m_dynamoCluster.behaver   = std::make_shared<BehaviorsDynamo>(m_eventBroker);
         m_dynamoCluster.physicser = std::make_shared<PhysicsDynamo>(m_eventBroker);
+        this->set_parallel_stages(localTimelineApi.is_parallel_stages());
 
         // event handlers
         m_eventBroker->add_listener(METHOD_LISTENER(events::parallel::DIVERGENCE, ParallelCosmosContext::_divergence_handler));
@@ -387,7 +388,7 @@ namespace pleep
             {
                 PLEEPLOG_DEBUG("Finished extraction; starting recycle");
                 EventMessage initMessage(events::parallel::INIT);
-                events::parallel::INIT_params initInfo{ static_cast<uint16_t>(m_pastmostTimeslice) };
+                events::parallel::INIT_params initInfo{ static_cast<TimesliceId>(m_pastmostTimeslice) };
                 initMessage << initInfo;
                 m_eventBroker->send_event(initMessage);
 
@@ -422,7 +423,7 @@ namespace pleep
         return true;
     }
 
-    void ParallelCosmosContext::_divergence_handler(EventMessage divEvent)
+    void ParallelCosmosContext::_divergence_handler(EventMessage& divEvent)
     {
         events::parallel::DIVERGENCE_params divInfo;
         divEvent >> divInfo;
@@ -437,7 +438,7 @@ namespace pleep
             // send init request immediately via event to network dynamo
             EventMessage initMessage(events::parallel::INIT);
             // always start from beginning?
-            events::parallel::INIT_params initInfo{ static_cast<uint16_t>(m_pastmostTimeslice) }; 
+            events::parallel::INIT_params initInfo{ static_cast<TimesliceId>(m_pastmostTimeslice) }; 
             //events::parallel::INIT_params initInfo{ divInfo.sourceTimeslice };
             initMessage << initInfo;
             m_eventBroker->send_event(initMessage);
@@ -452,7 +453,7 @@ namespace pleep
         // if we are simulating the past of the divergent timeslice then we will get there in the current cycle
     }
 
-    void ParallelCosmosContext::_entity_removed_handler(EventMessage removalEvent)
+    void ParallelCosmosContext::_entity_removed_handler(EventMessage& removalEvent)
     {
         // This one is probably hard to avoid...
         // deletion of any non-null host ids will have to be stored
@@ -464,7 +465,7 @@ namespace pleep
         m_condemnedEntities.insert(removalInfo.entity);
     }
     
-    void ParallelCosmosContext::_entity_created_handler(EventMessage creationEvent)
+    void ParallelCosmosContext::_entity_created_handler(EventMessage& creationEvent)
     {
         // removed from running condemned list if it has been set
 
@@ -474,7 +475,7 @@ namespace pleep
         m_condemnedEntities.erase(creationInfo.entity);
     }
 
-    void ParallelCosmosContext::_worldline_shift_handler(EventMessage shiftEvent)
+    void ParallelCosmosContext::_worldline_shift_handler(EventMessage& shiftEvent)
     {
         events::parallel::WORLDLINE_SHIFT_params shiftInfo;
         shiftEvent >> shiftInfo;
@@ -482,7 +483,7 @@ namespace pleep
         m_readingSteinerEntities.insert(shiftInfo.entity);
     }
     
-    void ParallelCosmosContext::_timestream_interception_handler(EventMessage interceptionEvent)
+    void ParallelCosmosContext::_timestream_interception_handler(EventMessage& interceptionEvent)
     {
         events::cosmos::TIMESTREAM_INTERCEPTION_params interceptionInfo;
         interceptionEvent >> interceptionInfo;
@@ -540,9 +541,11 @@ namespace pleep
     
     void ParallelCosmosContext::_on_fixed(double fixedTime) 
     {
-        m_dynamoCluster.networker->run_relays(fixedTime);
-        m_dynamoCluster.behaver->run_relays(fixedTime);
-        m_dynamoCluster.physicser->run_relays(fixedTime);
+        this->_run_dynamos({
+            m_dynamoCluster.networker.get(),
+            m_dynamoCluster.behaver.get(),
+            m_dynamoCluster.physicser.get()
+        }, fixedTime);
     }
     
     void ParallelCosmosContext::_on_frame(double deltaTime) 
@@ -62,11 +62,11 @@ namespace pleep
 
     protected:
         // event handlers
-        void _divergence_handler(EventMessage divEvent);
-        void _entity_removed_handler(EventMessage removalEvent);
-        void _entity_created_handler(EventMessage creationEvent);
-        void _worldline_shift_handler(EventMessage shiftEvent);
-        void _timestream_interception_handler(EventMessage interceptionEvent);
+        void _divergence_handler(EventMessage& divEvent);
+        void _entity_removed_handler(EventMessage& removalEvent);
+        void _entity_created_handler(EventMessage& creationEvent);
+        void _worldline_shift_handler(EventMessage& shiftEvent);
+        void _timestream_interception_handler(EventMessage& interceptionEvent);
 
         void _prime_frame() override;
         void _on_fixed(double fixedTime) override;
@@ -365,8 +365,9 @@ namespace pleep
             }
         }
 
-        // After all ingesting is done, send/broadcast fresh downstream data to past
-        if (cosmos && m_timelineApi.has_past())
+        // After all ingesting is done, send/broadcast fresh downstream data to past (at the configured rate)
+        if (cosmos && m_timelineApi.has_past()
+            && currentCoherency % m_timelineApi.get_timestream_interval() == 0)
         {
             for (auto signIt : cosmos->get_signatures_ref())
             {
@@ -415,7 +416,7 @@ namespace pleep
         }
     }
 
-    void ParallelNetworkDynamo::_entity_created_handler(EventMessage creationEvent)
+    void ParallelNetworkDynamo::_entity_created_handler(EventMessage& creationEvent)
     {
         events::cosmos::ENTITY_CREATED_params creationParams;
         creationEvent >> creationParams;
@@ -435,7 +436,7 @@ namespace pleep
     }
 
 
-    void ParallelNetworkDynamo::_entity_removed_handler(EventMessage removalEvent)
+    void ParallelNetworkDynamo::_entity_removed_handler(EventMessage& removalEvent)
     {
         events::cosmos::ENTITY_REMOVED_params removalParams;
         removalEvent >> removalParams;
@@ -452,7 +453,7 @@ namespace pleep
         }
     }
     
-    void ParallelNetworkDynamo::_timestream_interception_handler(EventMessage interceptionEvent)
+    void ParallelNetworkDynamo::_timestream_interception_handler(EventMessage& interceptionEvent)
     {
         std::shared_ptr<Cosmos> cosmos = m_workingCosmos.lock();
         if (m_workingCosmos.expired()) return;
@@ -467,7 +468,7 @@ namespace pleep
     }
   
     
-    void ParallelNetworkDynamo::_parallel_init_handler(EventMessage initEvent)
+    void ParallelNetworkDynamo::_parallel_init_handler(EventMessage& initEvent)
     {
         events::parallel::INIT_params initInfo;
         initEvent >> initInfo;
@@ -476,7 +477,7 @@ namespace pleep
         m_timelineApi.send_message(initInfo.sourceTimeslice, initEvent);
     }
 
-    void ParallelNetworkDynamo::_parallel_finished_handler(EventMessage finishedEvent)
+    void ParallelNetworkDynamo::_parallel_finished_handler(EventMessage& finishedEvent)
     {
         events::parallel::FINISHED_params finishedInfo;
         finishedEvent >> finishedInfo;
@@ -485,7 +486,7 @@ namespace pleep
         m_timelineApi.send_message(finishedInfo.destinationTimeslice, finishedEvent);
     }
 
-    void ParallelNetworkDynamo::_jump_request_handler(EventMessage jumpEvent)
+    void ParallelNetworkDynamo::_jump_request_handler(EventMessage& jumpEvent)
     {
         std::shared_ptr<Cosmos> cosmos = m_workingCosmos.lock();
         if (m_workingCosmos.expired()) return;
@@ -36,12 +36,12 @@ namespace pleep
 
     private:
         // event handlers
-        void _entity_created_handler(EventMessage creationEvent);
-        void _entity_removed_handler(EventMessage removalEvent);
-        void _timestream_interception_handler(EventMessage interceptionEvent);
-        void _parallel_init_handler(EventMessage initEvent);
-        void _parallel_finished_handler(EventMessage finishedEvent);
-        void _jump_request_handler(EventMessage jumpEvent);
+        void _entity_created_handler(EventMessage& creationEvent);
+        void _entity_removed_handler(EventMessage& removalEvent);
+        void _timestream_interception_handler(EventMessage& interceptionEvent);
+        void _parallel_init_handler(EventMessage& initEvent);
+        void _parallel_finished_handler(EventMessage& finishedEvent);
+        void _jump_request_handler(EventMessage& jumpEvent);
 
         // TimelineApi (generated for us by AppGateway) to communicate with servers
         TimelineApi m_timelineApi;
@@ -44,6 +44,9 @@ namespace pleep
     {
         events::network::JUMP_params jumpInfo;
         data >> jumpInfo;
+        // serialized components are preceded (on the stack) by their encoding
+        WireEncoding encoding;
+        data >> encoding;
         
         TimejumpConditions jumpConditions { jumpInfo.tripId };
         
@@ -57,12 +60,12 @@ namespace pleep
             if (transformType == i)
             {
                 TransformComponent jumperTransform;
-                data >> jumperTransform;
+                decode_component(data, jumperTransform, encoding);
                 jumpConditions.origin = jumperTransform.origin;
             }
             else
             {
-                cosmos->discard_single_component(i, data);
+                cosmos->discard_single_component(i, data, encoding);
             }
         }
 
@@ -98,6 +98,16 @@ namespace pleep
                 return false;
             }
 
+            // names in order of registry
+            const std::vector<std::string>& get_components() const
+            {
+                return components;
+            }
+            const std::vector<std::string>& get_synchros() const
+            {
+                return synchros;
+            }
+
             void clear()
             {
                 components.clear();
@@ -0,0 +1,272 @@
+#include "cosmos_snapshot.h"
+
+#include <set>
+#include <vector>
+#include <chrono>
+
+#include "logging/pleep_log.h"
+#include "core/mapped_file.h"
+#include "rendering/model_cache.h"
+#include "staging/cosmos_builder.h"
+#include "staging/hard_config_cosmos.h"
+
+namespace pleep
+{
+    constexpr uint32_t COSMOS_SNAPSHOT_MAGIC = 0x53574C50; // "PLWS"
+    // increment whenever the layout below (or any component serialization) changes
+    constexpr uint32_t COSMOS_SNAPSHOT_VERSION = 1;
+
+    // File layout (native endianness and padding):
+    // SnapshotHeader
+    // componentCount x string (Config components in registry order)
+    // synchroCount   x string (Config synchros)
+    // assetCount     x string (asset filepaths to import before any entity is loaded)
+    // entityCount    x (SnapshotEntityRecord + body bytes)
+    // hostedCount    x SnapshotHostedRecord
+    // availableCount x Entity
+    // strings are uint32_t length then characters
+    struct SnapshotHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        TimesliceId hostId;
+        uint16_t coherency;
+        uint32_t componentCount;
+        uint32_t synchroCount;
+        uint32_t assetCount;
+        uint64_t entityCount;
+        uint64_t hostedCount;
+        uint64_t availableCount;
+        uint64_t nextGenesisId;
+    };
+    struct SnapshotEntityRecord
+    {
+        Entity entity;
+        Signature sign;
+        uint32_t size;
+    };
+    struct SnapshotHostedRecord
+    {
+        Entity entity;
+        uint64_t count;
+    };
+
+    // every asset file the components of cosmos would import when deserialized
+    static std::set<std::string> _collect_asset_paths(std::shared_ptr<Cosmos> cosmos)
+    {
+        std::set<std::string> paths;
+        auto insert_path = [&paths](const std::string& path)
+        {
+            if (!path.empty()) paths.insert(path);
+        };
+
+        for (auto& signIt : cosmos->get_signatures_ref())
+        {
+            if (cosmos->has_component<RenderableComponent>(signIt.first))
+            {
+                const RenderableComponent& renderable = cosmos->read_component<RenderableComponent>(signIt.first);
+                for (const std::shared_ptr<const Mesh>& mesh : renderable.meshData)
+                {
+                    if (mesh) insert_path(mesh->m_sourceFilepath);
+                }
+                for (const std::shared_ptr<const Material>& material : renderable.materials)
+                {
+                    if (material) insert_path(material->m_sourceFilepath);
+                }
+                if (renderable.armature) insert_path(renderable.armature->m_sourceFilepath);
+            }
+            if (cosmos->has_component<AnimationComponent>(signIt.first))
+            {
+                for (auto& animationIt : cosmos->read_component<AnimationComponent>(signIt.first).animations)
+                {
+                    if (animationIt.second) insert_path(animationIt.second->m_sourceFilepath);
+                }
+            }
+        }
+        return paths;
+    }
+
+    bool cosmos_builder::save_snapshot(std::shared_ptr<Cosmos> cosmos, const std::string& path)
+    {
+        const cosmos_builder::Config config = cosmos_builder::scan(cosmos);
+        const std::set<std::string> assetPaths = _collect_asset_paths(cosmos);
+        const EntityRegistry::HostedState hostedState = cosmos->get_hosted_state();
+
+        SnapshotHeader header;
+        header.magic = COSMOS_SNAPSHOT_MAGIC;
+        header.version = COSMOS_SNAPSHOT_VERSION;
+        header.hostId = cosmos->get_host_id();
+        header.coherency = cosmos->get_coherency();
+        header.componentCount = static_cast<uint32_t>(config.get_components().size());
+        header.synchroCount = static_cast<uint32_t>(config.get_synchros().size());
+        header.assetCount = static_cast<uint32_t>(assetPaths.size());
+        header.entityCount = cosmos->get_signatures_ref().size();
+        header.hostedCount = hostedState.counts.size();
+        header.availableCount = hostedState.availableIds.size();
+        header.nextGenesisId = hostedState.nextGenesisId;
+
+        std::vector<uint8_t> data;
+        append_mapped(data, header);
+        for (const std::string& component : config.get_components()) append_mapped_string(data, component);
+        for (const std::string& synchro : config.get_synchros()) append_mapped_string(data, synchro);
+        for (const std::string& assetPath : assetPaths) append_mapped_string(data, assetPath);
+
+        EventMessage components;
+        for (auto& signIt : cosmos->get_signatures_ref())
+        {
+            components.body.clear();
+            cosmos->serialize_entity_components(signIt.first, signIt.second, components, ComponentCategory::all);
+
+            append_mapped(data, SnapshotEntityRecord{ signIt.first, signIt.second, static_cast<uint32_t>(components.body.size()) });
+            append_mapped_bytes(data, components.body);
+        }
+
+        for (const std::pair<Entity, size_t>& count : hostedState.counts)
+        {
+            append_mapped(data, SnapshotHostedRecord{ count.first, count.second });
+        }
+        for (Entity available : hostedState.availableIds)
+        {
+            append_mapped(data, available);
+        }
+
+        if (!write_file_replacing(path, data)) return false;
+
+        PLEEPLOG_INFO("Saved world snapshot " + path + " (" + std::to_string(header.entityCount) + " entities, "
+            + std::to_string(header.assetCount) + " assets, " + std::to_string(data.size()) + " bytes)");
+        return true;
+    }
+
+    std::shared_ptr<Cosmos> cosmos_builder::load_snapshot(
+        const std::string& path,
+        DynamoCluster& callerDynamos,
+        std::shared_ptr<EventBroker> callerBroker
+    )
+    {
+        const std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+
+        MappedFile file(path);
+        if (!file.data())
+        {
+            PLEEPLOG_DEBUG("No world snapshot at " + path);
+            return nullptr;
+        }
+
+        // validate the whole file before constructing the cosmos:
+        // construction attaches synchros to the caller's dynamos and loading broadcasts entity events,
+        // neither can be undone if the snapshot turns out to be unusable
+        SnapshotHeader header;
+        size_t entitiesOffset = 0;
+        try
+        {
+            MappedReader reader(file.data(), file.size());
+
+            reader.read(header);
+            if (header.magic != COSMOS_SNAPSHOT_MAGIC || header.version != COSMOS_SNAPSHOT_VERSION)
+            {
+                PLEEPLOG_WARN("File " + path + " is not a world snapshot of this version, ignoring it");
+                return nullptr;
+            }
+
+            std::vector<std::string> componentNames(header.componentCount);
+            for (std::string& component : componentNames) reader.read_string(component);
+            std::vector<std::string> synchroNames(header.synchroCount);
+            for (std::string& synchro : synchroNames) reader.read_string(synchro);
+
+            if (!(get_hard_config() == cosmos_builder::Config(componentNames, synchroNames)))
+            {
+                PLEEPLOG_WARN("World snapshot " + path + " was saved with a different cosmos config, ignoring it");
+                return nullptr;
+            }
+
+            std::vector<std::string> assetPaths(header.assetCount);
+            for (std::string& assetPath : assetPaths) reader.read_string(assetPath);
+
+            entitiesOffset = reader.get_offset();
+            for (uint64_t i = 0; i < header.entityCount; i++)
+            {
+                SnapshotEntityRecord record;
+                reader.read(record);
+                if ((record.sign >> componentNames.size()).any())
+                {
+                    throw std::runtime_error("entity " + std::to_string(record.entity) + " has components outside the config");
+                }
+                reader.take(record.size);
+            }
+            for (uint64_t i = 0; i < header.hostedCount; i++) reader.take(sizeof(SnapshotHostedRecord));
+            for (uint64_t i = 0; i < header.availableCount; i++) reader.take(sizeof(Entity));
+            if (!reader.is_done())
+            {
+                throw std::runtime_error("unexpected bytes after the last section");
+            }
+
+            // import every asset once up front, so entities only fetch from the cache as they load
+            for (const std::string& assetPath : assetPaths) ModelCache::import(assetPath);
+        }
+        catch (const std::exception& e)
+        {
+            PLEEPLOG_ERROR("Could not load world snapshot " + path + ": " + e.what());
+            return nullptr;
+        }
+
+        // file is known to be complete, only individual component bodies can still fail from here
+        std::shared_ptr<Cosmos> cosmos = construct_hard_config_cosmos(callerBroker, callerDynamos);
+        if (cosmos->get_host_id() != header.hostId)
+        {
+            PLEEPLOG_WARN("World snapshot " + path + " was saved by timeslice " + std::to_string(header.hostId)
+                + ", its hosted entities will not be recognized by timeslice " + std::to_string(cosmos->get_host_id()));
+        }
+
+        MappedReader reader(file.data() + entitiesOffset, file.size() - entitiesOffset);
+
+        EventMessage components;
+        for (uint64_t i = 0; i < header.entityCount; i++)
+        {
+            SnapshotEntityRecord record;
+            reader.read(record);
+            reader.read_bytes(components.body, record.size);
+            components.header.size = record.size;
+
+            if (!cosmos->register_entity(record.entity, record.sign))
+            {
+                PLEEPLOG_WARN("World snapshot entity " + std::to_string(record.entity) + " could not be registered, skipping it");
+                continue;
+            }
+            try
+            {
+                cosmos->deserialize_entity_components(record.entity, record.sign, components, ComponentCategory::all);
+            }
+            catch (const std::exception& e)
+            {
+                // it has already been announced, so remove it the normal way
+                PLEEPLOG_WARN("World snapshot entity " + std::to_string(record.entity) + " could not be loaded (" + e.what() + "), condemning it");
+                cosmos->condemn_entity(record.entity);
+            }
+        }
+
+        EntityRegistry::HostedState hostedState;
+        hostedState.nextGenesisId = static_cast<GenesisId>(header.nextGenesisId);
+        hostedState.counts.reserve(static_cast<size_t>(header.hostedCount));
+        for (uint64_t i = 0; i < header.hostedCount; i++)
+        {
+            SnapshotHostedRecord record;
+            reader.read(record);
+            hostedState.counts.emplace_back(record.entity, static_cast<size_t>(record.count));
+        }
+        hostedState.availableIds.reserve(static_cast<size_t>(header.availableCount));
+        for (uint64_t i = 0; i < header.availableCount; i++)
+        {
+            Entity available;
+            reader.read(available);
+            hostedState.availableIds.push_back(available);
+        }
+        cosmos->set_hosted_state(hostedState);
+
+        cosmos->set_coherency(header.coherency);
+
+        PLEEPLOG_INFO("Loaded world snapshot " + path + " (" + std::to_string(header.entityCount) + " entities, "
+            + std::to_string(header.assetCount) + " assets) in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count()) + "ms");
+        return cosmos;
+    }
+}
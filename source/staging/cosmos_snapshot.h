@@ -0,0 +1,37 @@
+#ifndef COSMOS_SNAPSHOT_H
+#define COSMOS_SNAPSHOT_H
+
+//#include "intercession_pch.h"
+#include <memory>
+#include <string>
+
+#include "core/cosmos.h"
+#include "core/dynamo_cluster.h"
+#include "events/event_broker.h"
+
+namespace pleep
+{
+    namespace cosmos_builder
+    {
+        // A world snapshot is a versioned binary file of a whole cosmos:
+        // its Config (component and synchro registries), every entity's components, hosted entity ids,
+        // and every asset file its components reference.
+        // It is memory mapped and bulk loaded in one pass, instead of building the world entity by entity in code
+        // so large scenes can be authored offline and servers start without re-running their builders
+
+        // write cosmos as a snapshot to path (replacing any file there)
+        // returns false if it could not be written
+        bool save_snapshot(std::shared_ptr<Cosmos> cosmos, const std::string& path);
+
+        // build a cosmos (with the hard config registries) and load the snapshot at path into it
+        // returns nullptr if there is no snapshot at path, or it doesn't match the hard config or is corrupted
+        // (checked before the cosmos is constructed, so a rejected snapshot leaves callerDynamos and callerBroker untouched)
+        std::shared_ptr<Cosmos> load_snapshot(
+            const std::string& path,
+            DynamoCluster& callerDynamos,
+            std::shared_ptr<EventBroker> callerBroker
+        );
+    }
+}
+
+#endif // COSMOS_SNAPSHOT_H
@@ -3,6 +3,9 @@
 
 //#include "intercession_pch.h"
 #include <memory>
+#include <vector>
+#include <string>
+#include <algorithm>
 
 #include "events/event_broker.h"
 #include "core/dynamo_cluster.h"
@@ -10,6 +13,43 @@
 
 namespace pleep
 {
+    // the Config construct_hard_config_cosmos registers (keep them in the same order)
+    // as cosmos_builder::scan would return it, so saved configs can be compared without building a cosmos
+    inline const cosmos_builder::Config& get_hard_config()
+    {
+        static const cosmos_builder::Config hardConfig = []()
+        {
+            cosmos_builder::Config config;
+            config.insert_component<TransformComponent>();
+            config.insert_component<SpacialInputComponent>();
+            config.insert_component<RenderableComponent>();
+            config.insert_component<AnimationComponent>();
+            config.insert_component<CameraComponent>();
+            config.insert_component<LightSourceComponent>();
+            config.insert_component<PhysicsComponent>();
+            config.insert_component<ColliderComponent>();
+            config.insert_component<BehaviorsComponent>();
+            config.insert_component<OscillatorComponent>();
+            config.insert_component<ProjectileComponent>();
+            config.insert_component<BipedComponent>();
+
+            config.insert_synchro<SpacialInputSynchro>();
+            config.insert_synchro<LightingSynchro>();
+            config.insert_synchro<RenderSynchro>();
+            config.insert_synchro<AnimationSynchro>();
+            config.insert_synchro<PhysicsSynchro>();
+            config.insert_synchro<ColliderSynchro>();
+            config.insert_synchro<NetworkSynchro>();
+            config.insert_synchro<BehaviorsSynchro>();
+
+            // synchro registry is stringified alphabetically
+            std::vector<std::string> synchros = config.get_synchros();
+            std::sort(synchros.begin(), synchros.end());
+            return cosmos_builder::Config(config.get_components(), synchros);
+        }();
+        return hardConfig;
+    }
+
     inline std::shared_ptr<Cosmos> construct_hard_config_cosmos(
         std::shared_ptr<EventBroker> eventBroker,
         DynamoCluster& dynamoCluster
@@ -44,6 +84,8 @@ namespace pleep
 
         std::shared_ptr<Cosmos> newCosmos = std::make_shared<Cosmos>(eventBroker, localTimesliceId);
 
+        // registrations must match get_hard_config
+
         newCosmos->register_component<TransformComponent>();
         newCosmos->register_component<SpacialInputComponent>(ComponentCategory::upstream);
         newCosmos->register_component<RenderableComponent>();
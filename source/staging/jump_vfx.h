@@ -11,8 +11,9 @@
 
 namespace pleep
 {
-    // returns single entity launched from origin in direction
-    inline Entity create_jump_vfx(
+    // single entity launched from origin in direction
+    // created at the start of the next update (deferred), as jumps are handled while entities are being iterated
+    inline void create_jump_vfx(
         std::shared_ptr<Cosmos> cosmos,
         Entity jumper,
         glm::vec3 origin
@@ -20,20 +21,6 @@ namespace pleep
     {
         assert(cosmos);
 
-        Entity vfx = cosmos->create_entity(true, jumper);
-        if (vfx == NULL_ENTITY)
-        {
-            PLEEPLOG_DEBUG("VFX creation for source " + std::to_string(jumper) + " eschewed on this thread");
-            return vfx;
-        }
-        PLEEPLOG_DEBUG("VFX creation for source " + std::to_string(jumper) + " produced entity " + std::to_string(vfx) + " on this thread");
-
-        TransformComponent vfx_transform(origin);
-        //vfx_transform.scale = glm::vec3(0.2f, 0.2f, 0.2f);
-        cosmos->add_component(vfx, vfx_transform);
-        
-        RenderableComponent vfx_renderable;
-        vfx_renderable.meshData.push_back(ModelCache::fetch_mesh(ModelCache::BasicMeshType::icosahedron));
         if (ModelCache::fetch_material("vfx_mat") == nullptr)
         {
             ModelCache::create_material("vfx_mat", std::unordered_map<TextureType, std::string>{
@@ -44,31 +31,45 @@ namespace pleep
                 {TextureType::emissive, "resources/snow-packed12-Specular.png"}
             });
         }
-        vfx_renderable.materials.push_back(ModelCache::fetch_material("vfx_mat"));
-        cosmos->add_component(vfx, vfx_renderable);
 
-        
-        PhysicsComponent vfx_physics;
-        vfx_physics.angularVelocity = glm::sphericalRand(6.0f);;
-        vfx_physics.lockOrigin = true;
-        vfx_physics.lockedOrigin = origin;
-        cosmos->add_component(vfx, vfx_physics);
-        // no collider
+        // weak so a cosmos destroyed before flushing isn't kept alive by its own buffer
+        std::weak_ptr<Cosmos> weakCosmos = cosmos;
+        cosmos->defer_create_entity(true, jumper, [weakCosmos, jumper, origin](Entity vfx)
+        {
+            std::shared_ptr<Cosmos> cosmos = weakCosmos.lock();
+            if (!cosmos) return;
+            PLEEPLOG_DEBUG("VFX creation for source " + std::to_string(jumper) + " produced entity " + std::to_string(vfx) + " on this thread");
+
+            TransformComponent vfx_transform(origin);
+            //vfx_transform.scale = glm::vec3(0.2f, 0.2f, 0.2f);
+            cosmos->defer_add_component(vfx, vfx_transform);
+            
+            RenderableComponent vfx_renderable;
+            vfx_renderable.meshData.push_back(ModelCache::fetch_mesh(ModelCache::BasicMeshType::icosahedron));
+            vfx_renderable.materials.push_back(ModelCache::fetch_material("vfx_mat"));
+            cosmos->defer_add_component(vfx, vfx_renderable);
 
-        // Add behavior to timeout and disappear
-        ProjectileComponent vfx_projectile;
-        vfx_projectile.maxLifetime = 1.0;
-        vfx_projectile.hz = 4.0;
-        vfx_projectile.scaleMin = 0.0;
-        vfx_projectile.scaleMax = 2.0;
-        cosmos->add_component(vfx, vfx_projectile);
+            
+            PhysicsComponent vfx_physics;
+            vfx_physics.angularVelocity = glm::sphericalRand(6.0f);;
+            vfx_physics.lockOrigin = true;
+            vfx_physics.lockedOrigin = origin;
+            cosmos->defer_add_component(vfx, vfx_physics);
+            // no collider
 
-        BehaviorsComponent vfx_behaviors;
-        vfx_behaviors.drivetrain = BehaviorsLibrary::fetch_behaviors(BehaviorsLibrary::BehaviorsType::projectile);
-        vfx_behaviors.use_fixed_update = true;
-        cosmos->add_component(vfx, vfx_behaviors);
+            // Add behavior to timeout and disappear
+            ProjectileComponent vfx_projectile;
+            vfx_projectile.maxLifetime = 1.0;
+            vfx_projectile.hz = 4.0;
+            vfx_projectile.scaleMin = 0.0;
+            vfx_projectile.scaleMax = 2.0;
+            cosmos->defer_add_component(vfx, vfx_projectile);
 
-        return vfx;
+            BehaviorsComponent vfx_behaviors;
+            vfx_behaviors.drivetrain = BehaviorsLibrary::fetch_behaviors(BehaviorsLibrary::BehaviorsType::projectile);
+            vfx_behaviors.use_fixed_update = true;
+            cosmos->defer_add_component(vfx, vfx_behaviors);
+        });
     }
 }
 
@@ -0,0 +1,222 @@
+// Update latency of the datagram channel against the reliable stream, on loopback
+// A server sends one entity's state every tick to a client, under injected loss and delay, and the client
+// measures how long each update took to arrive. The datagram channel injects its own conditions; the tcp stream
+// can't lose anything on loopback, so a lost segment is modelled by holding it (and everything behind it)
+// for a retransmission timeout. Fails if datagrams don't beat the stream once there is loss.
+
+#include <cstdio>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "logging/pleep_log.h"
+#include "networking/net_i_server.h"
+#include "networking/net_i_client.h"
+
+using namespace pleep;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint16_t HARNESS_PORT = 47810;
+    constexpr uint32_t UPDATE_ID = 1;
+    constexpr uint64_t ENTITY_KEY = 1;
+    constexpr std::chrono::milliseconds TICK{ 16 };
+    constexpr unsigned RUN_TICKS = 180;
+    // linux minimum retransmission timeout
+    constexpr std::chrono::milliseconds TCP_RETRANSMIT_TIMEOUT{ 200 };
+    constexpr std::chrono::seconds ASSOCIATE_TIMEOUT{ 5 };
+
+    struct Conditions
+    {
+        float lossChance;
+        std::chrono::milliseconds delay;
+    };
+
+    struct Result
+    {
+        size_t sent = 0;
+        size_t delivered = 0;
+        double meanLatency = 0.0;
+        double p95Latency = 0.0;
+    };
+
+    class HarnessServer : public net::I_Server<uint32_t>
+    {
+    public:
+        HarnessServer(uint16_t port)
+            : net::I_Server<uint32_t>(port, true)
+        {}
+
+        std::shared_ptr<net::Connection<uint32_t>> get_validated()
+        {
+            std::lock_guard<std::mutex> validatedLock(m_validatedMux);
+            return m_validated;
+        }
+
+    protected:
+        bool on_remote_connect(std::shared_ptr<net::Connection<uint32_t>> remote) override
+        {
+            UNREFERENCED_PARAMETER(remote);
+            return true;
+        }
+        void on_remote_validated(std::shared_ptr<net::Connection<uint32_t>> remote) override
+        {
+            std::lock_guard<std::mutex> validatedLock(m_validatedMux);
+            m_validated = remote;
+        }
+
+    private:
+        std::mutex m_validatedMux;
+        std::shared_ptr<net::Connection<uint32_t>> m_validated;
+    };
+
+    class HarnessClient : public net::I_Client<uint32_t>
+    {
+    public:
+        HarnessClient()
+            : net::I_Client<uint32_t>(true)
+        {}
+
+        bool is_datagram_associated()
+        {
+            return m_connection && m_connection->is_datagram_associated();
+        }
+    };
+
+    double to_ms(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    Result run(HarnessServer& server, HarnessClient& client, std::shared_ptr<net::Connection<uint32_t>> remote, const Conditions& conditions, bool datagrams)
+    {
+        server.get_datagram_channel()->set_simulated_conditions(datagrams ? conditions.lossChance : 0.0f, datagrams ? conditions.delay : std::chrono::milliseconds(0));
+
+        // stream segments waiting out their simulated delay (in order, like the stream itself)
+        std::deque<std::pair<Clock::time_point, Message<uint32_t>>> held;
+        std::minstd_rand lossGenerator(7);
+        std::uniform_real_distribution<float> lossDistribution(0.0f, 1.0f);
+
+        Result result;
+        std::vector<double> latencies;
+        const Clock::time_point start = Clock::now();
+        // leave time for the last updates to arrive
+        const Clock::time_point end = start + TICK * RUN_TICKS + TCP_RETRANSMIT_TIMEOUT + conditions.delay * 2;
+
+        for (Clock::time_point nextTick = start; Clock::now() < end; std::this_thread::sleep_for(std::chrono::milliseconds(1)))
+        {
+            const Clock::time_point now = Clock::now();
+            if (result.sent < RUN_TICKS && now >= nextTick)
+            {
+                Message<uint32_t> update;
+                update.header.id = UPDATE_ID;
+                update << static_cast<int64_t>(now.time_since_epoch().count());
+                result.sent++;
+                nextTick += TICK;
+
+                if (datagrams)
+                {
+                    remote->send_unreliable(update, ENTITY_KEY);
+                }
+                else
+                {
+                    Clock::time_point release = now + conditions.delay;
+                    if (lossDistribution(lossGenerator) < conditions.lossChance) release += TCP_RETRANSMIT_TIMEOUT;
+                    // nothing overtakes a segment being retransmitted
+                    if (!held.empty()) release = std::max(release, held.back().first);
+                    held.push_back({ release, update });
+                }
+            }
+
+            while (!held.empty() && held.front().first <= now)
+            {
+                server.send_message(remote, held.front().second);
+                held.pop_front();
+            }
+
+            Message<uint32_t> received;
+            while (client.pop_message(received))
+            {
+                int64_t sentTicks = 0;
+                received >> sentTicks;
+                latencies.push_back(to_ms(Clock::now().time_since_epoch() - Clock::duration(sentTicks)));
+            }
+        }
+
+        result.delivered = latencies.size();
+        if (!latencies.empty())
+        {
+            for (double latency : latencies) result.meanLatency += latency;
+            result.meanLatency /= static_cast<double>(latencies.size());
+            std::sort(latencies.begin(), latencies.end());
+            result.p95Latency = latencies[latencies.size() * 95 / 100];
+        }
+        return result;
+    }
+}
+
+int main()
+{
+    INIT_PLEEPLOG();
+
+    HarnessServer server(HARNESS_PORT);
+    HarnessClient client;
+    if (!server.get_datagram_channel() || !server.start() || !client.connect("127.0.0.1", HARNESS_PORT))
+    {
+        std::printf("could not open loopback connection on port %u\n", HARNESS_PORT);
+        DEINIT_PLEEPLOG();
+        return 1;
+    }
+
+    // wait for validation and both ends of the datagram association
+    std::shared_ptr<net::Connection<uint32_t>> remote;
+    const Clock::time_point associateStart = Clock::now();
+    while (!(remote && remote->is_datagram_associated() && client.is_datagram_associated()))
+    {
+        if (Clock::now() - associateStart > ASSOCIATE_TIMEOUT)
+        {
+            std::printf("datagram channel did not associate\n");
+            DEINIT_PLEEPLOG();
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        remote = server.get_validated();
+    }
+
+    const Conditions conditionsList[] = {
+        { 0.0f, std::chrono::milliseconds(0) },
+        { 0.05f, std::chrono::milliseconds(20) },
+        { 0.2f, std::chrono::milliseconds(50) },
+    };
+    bool passed = true;
+
+    std::printf("loss | delay (ms) | transport | delivered | mean latency (ms) | p95 latency (ms)\n");
+    for (const Conditions& conditions : conditionsList)
+    {
+        const Result stream = run(server, client, remote, conditions, false);
+        const Result datagram = run(server, client, remote, conditions, true);
+        for (const std::pair<const char*, const Result*>& row : { std::make_pair("tcp", &stream), std::make_pair("udp", &datagram) })
+        {
+            std::printf("%4.2f | %10lld | %9s | %4zu/%4zu | %17.2f | %16.2f\n",
+                conditions.lossChance, static_cast<long long>(conditions.delay.count()), row.first,
+                row.second->delivered, row.second->sent, row.second->meanLatency, row.second->p95Latency);
+        }
+
+        // the stream never loses, datagrams only lose what was dropped (allow some margin for randomness)
+        if (stream.delivered != stream.sent) passed = false;
+        if (datagram.delivered < static_cast<size_t>(datagram.sent * (1.0f - conditions.lossChance * 2.0f))) passed = false;
+        // with loss, retransmission holds up every later update on the stream
+        if (conditions.lossChance > 0.0f && datagram.p95Latency >= stream.p95Latency) passed = false;
+    }
+
+    client.disconnect();
+    server.stop();
+    DEINIT_PLEEPLOG();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Perceived input latency of the focal entity with and without prediction
+// A client & server cosmos exchange focal input/state through queues held for half a simulated round trip
+// (what a loopback connection with that much latency would do), and we count the updates between an input
+// being pressed and the client's focal entity moving. Fails if prediction doesn't beat waiting for the server.
+
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "logging/pleep_log.h"
+#include "core/cosmos.h"
+#include "events/event_broker.h"
+#include "behaviors/behaviors_dynamo.h"
+#include "behaviors/behaviors_library.h"
+#include "physics/physics_dynamo.h"
+#include "client/focal_predictor.h"
+
+using namespace pleep;
+
+namespace
+{
+    constexpr double FIXED_DELTA = 1.0 / 60.0;
+    constexpr unsigned INPUT_FRAME = 10;
+    constexpr unsigned RUN_FRAMES = 120;
+    constexpr float MOVED_DISTANCE = 0.001f;
+
+    struct Delayed
+    {
+        unsigned deliverFrame;
+        EventMessage msg;
+    };
+
+    // a cosmos with only what the focal entity needs to be simulated
+    std::shared_ptr<Cosmos> build_cosmos(std::shared_ptr<EventBroker> broker, Entity& focal)
+    {
+        std::shared_ptr<Cosmos> cosmos = std::make_shared<Cosmos>(broker);
+        cosmos->register_component<TransformComponent>();
+        cosmos->register_component<SpacialInputComponent>(ComponentCategory::upstream);
+        cosmos->register_component<PhysicsComponent>();
+        cosmos->register_component<BehaviorsComponent>();
+
+        focal = cosmos->create_entity(false);
+        cosmos->add_component(focal, TransformComponent{});
+        cosmos->add_component(focal, SpacialInputComponent{});
+        cosmos->add_component(focal, PhysicsComponent{});
+        BehaviorsComponent behaviors;
+        behaviors.drivetrain = BehaviorsLibrary::fetch_behaviors(BehaviorsLibrary::BehaviorsType::fly_control);
+        behaviors.use_fixed_update = true;
+        cosmos->add_component(focal, behaviors);
+        return cosmos;
+    }
+
+    // what the behaviors & physics synchros would submit for the entity
+    void step(std::shared_ptr<Cosmos> cosmos, Entity entity, BehaviorsDynamo& behaver, PhysicsDynamo& physicser)
+    {
+        behaver.submit(BehaviorsPacket{ cosmos->get_component<BehaviorsComponent>(entity), entity, cosmos });
+        physicser.submit(PhysicsPacket{ cosmos->get_component<TransformComponent>(entity), cosmos->get_component<PhysicsComponent>(entity) });
+        behaver.run_relays(FIXED_DELTA);
+        physicser.run_relays(FIXED_DELTA);
+        behaver.reset_relays();
+        physicser.reset_relays();
+    }
+
+    struct Result
+    {
+        int latency = -1;
+        size_t corrections = 0;
+    };
+
+    Result run(unsigned roundTrip, bool predict)
+    {
+        std::shared_ptr<EventBroker> serverBroker = std::make_shared<EventBroker>();
+        std::shared_ptr<EventBroker> clientBroker = std::make_shared<EventBroker>();
+        BehaviorsDynamo serverBehaver(serverBroker);
+        PhysicsDynamo serverPhysicser(serverBroker);
+        BehaviorsDynamo clientBehaver(clientBroker);
+        PhysicsDynamo clientPhysicser(clientBroker);
+
+        Entity serverFocal = NULL_ENTITY;
+        Entity clientFocal = NULL_ENTITY;
+        std::shared_ptr<Cosmos> server = build_cosmos(serverBroker, serverFocal);
+        std::shared_ptr<Cosmos> client = build_cosmos(clientBroker, clientFocal);
+        client->set_focal_entity(clientFocal);
+
+        const Signature inputSign = client->get_category_signature(ComponentCategory::upstream);
+        const Signature stateSign = server->get_category_signature(ComponentCategory::downstream);
+        const glm::vec3 start = client->read_component<TransformComponent>(clientFocal).origin;
+
+        FocalPredictor predictor;
+        std::deque<Delayed> upstream;
+        std::deque<Delayed> downstream;
+        uint16_t serverInputCoherency = 0;
+        Result result;
+
+        for (unsigned frame = 0; frame < RUN_FRAMES; frame++)
+        {
+            // client reads input (held forward from INPUT_FRAME)
+            SpacialInputComponent& input = client->get_component<SpacialInputComponent>(clientFocal);
+            input.clear();
+            if (frame >= INPUT_FRAME) input.set(SpacialActions::moveParallel, true, 1.0);
+
+            if (predict)
+            {
+                predictor.record(client, FIXED_DELTA);
+                step(client, clientFocal, clientBehaver, clientPhysicser);
+            }
+            Delayed inputUpdate{ frame + roundTrip / 2, EventMessage(events::cosmos::ENTITY_UPDATE, client->get_coherency()) };
+            client->serialize_entity_components(clientFocal, inputSign, inputUpdate.msg, ComponentCategory::upstream);
+            upstream.push_back(inputUpdate);
+
+            // server applies whatever input has arrived, simulates, and echoes which input it used
+            while (!upstream.empty() && upstream.front().deliverFrame <= frame)
+            {
+                server->deserialize_entity_components(serverFocal, inputSign, upstream.front().msg, ComponentCategory::upstream);
+                serverInputCoherency = upstream.front().msg.header.coherency;
+                upstream.pop_front();
+            }
+            step(server, serverFocal, serverBehaver, serverPhysicser);
+            Delayed stateUpdate{ frame + roundTrip - roundTrip / 2, EventMessage(events::cosmos::ENTITY_UPDATE, serverInputCoherency) };
+            server->serialize_entity_components(serverFocal, stateSign, stateUpdate.msg, ComponentCategory::downstream);
+            downstream.push_back(stateUpdate);
+
+            // client receives authoritative state
+            while (!downstream.empty() && downstream.front().deliverFrame <= frame)
+            {
+                client->deserialize_entity_components(clientFocal, stateSign, downstream.front().msg, ComponentCategory::downstream);
+                if (predict)
+                {
+                    predictor.reconcile(client, downstream.front().msg.header.coherency, stateSign);
+                }
+                downstream.pop_front();
+            }
+
+            // what is drawn this update
+            if (result.latency < 0 && glm::length(client->read_component<TransformComponent>(clientFocal).origin - start) > MOVED_DISTANCE)
+            {
+                result.latency = static_cast<int>(frame) - static_cast<int>(INPUT_FRAME);
+            }
+
+            client->increment_coherency();
+            server->increment_coherency();
+        }
+
+        result.corrections = predictor.get_correction_count();
+        return result;
+    }
+}
+
+int main()
+{
+    INIT_PLEEPLOG();
+
+    const unsigned roundTrips[] = { 0, 6, 12, 30 };
+    bool passed = true;
+
+    std::printf("round trip (updates) | waiting latency | predicted latency | corrections\n");
+    for (unsigned roundTrip : roundTrips)
+    {
+        const Result waiting = run(roundTrip, false);
+        const Result predicted = run(roundTrip, true);
+        std::printf("%20u | %15d | %17d | %11zu\n", roundTrip, waiting.latency, predicted.latency, predicted.corrections);
+
+        if (predicted.latency < 0 || waiting.latency < 0 || predicted.latency > waiting.latency)
+        {
+            passed = false;
+        }
+        // a deterministic loopback server agrees with every prediction
+        if (predicted.corrections != 0)
+        {
+            passed = false;
+        }
+    }
+
+    DEINIT_PLEEPLOG();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// Culling and draw ordering without a gl context
+// ViewFrustum is checked against boxes in front of, behind, beside, and around a camera,
+// and DrawList against interleaved draws which must come out grouped and in a deterministic order.
+
+#include <cstdio>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "rendering/view_frustum.h"
+#include "rendering/draw_list.h"
+
+using namespace pleep;
+
+namespace
+{
+    bool check(bool passed, const char* what)
+    {
+        if (!passed) std::printf("FAILED: %s\n", what);
+        return passed;
+    }
+
+    // unit box centered at position (scaled by size)
+    bool box_visible(const ViewFrustum& frustum, const glm::vec3& position, float size = 1.0f)
+    {
+        const glm::mat4 modelToWorld = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size));
+        return frustum.intersects_bounds(glm::vec3(-0.5f), glm::vec3(0.5f), modelToWorld);
+    }
+
+    bool check_frustum()
+    {
+        bool passed = true;
+
+        const ViewFrustum unset;
+        passed = check(!unset.is_set() && box_visible(unset, glm::vec3(0.0f, 0.0f, 1000.0f)), "unset frustum culls nothing") && passed;
+
+        // camera at the origin looking down -z with a 90 degree field of view
+        const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+        const glm::mat4 worldToView = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const ViewFrustum frustum(projection * worldToView);
+        passed = check(frustum.is_set(), "frustum is set") && passed;
+
+        passed = check(box_visible(frustum, glm::vec3(0.0f, 0.0f, -10.0f)), "box in front") && passed;
+        passed = check(!box_visible(frustum, glm::vec3(0.0f, 0.0f, 10.0f)), "box behind") && passed;
+        passed = check(!box_visible(frustum, glm::vec3(-50.0f, 0.0f, -10.0f)), "box left") && passed;
+        passed = check(!box_visible(frustum, glm::vec3(50.0f, 0.0f, -10.0f)), "box right") && passed;
+        passed = check(!box_visible(frustum, glm::vec3(0.0f, 50.0f, -10.0f)), "box above") && passed;
+        passed = check(!box_visible(frustum, glm::vec3(0.0f, 0.0f, -200.0f)), "box past far plane") && passed;
+        // centered outside the left plane (x = z) but reaching over it
+        passed = check(box_visible(frustum, glm::vec3(-10.6f, 0.0f, -10.0f), 2.0f), "box straddling a plane") && passed;
+        passed = check(!box_visible(frustum, glm::vec3(-13.0f, 0.0f, -10.0f), 2.0f), "box just outside a plane") && passed;
+        passed = check(box_visible(frustum, glm::vec3(0.0f), 50.0f), "box around the camera") && passed;
+
+        // bounds away from the model's origin are moved with it
+        const glm::mat4 behind = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 10.0f));
+        passed = check(frustum.intersects_bounds(glm::vec3(-1.0f, -1.0f, -21.0f), glm::vec3(1.0f, 1.0f, -19.0f), behind), "offset bounds") && passed;
+
+        // rotation swaps which local axis is long
+        const glm::mat4 turned = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(-30.0f, 0.0f, -10.0f)), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        passed = check(!box_visible(frustum, glm::vec3(-30.0f, 0.0f, -10.0f)), "unrotated box outside") && passed;
+        passed = check(frustum.intersects_bounds(glm::vec3(-0.5f, -0.5f, -25.0f), glm::vec3(0.5f, 0.5f, 25.0f), turned), "rotated long box reaches in") && passed;
+
+        return passed;
+    }
+
+    bool check_draw_list()
+    {
+        bool passed = true;
+
+        // addresses are only identities, their values must not affect order
+        const int assets[4] = {};
+        const void* meshB = &assets[0];
+        const void* meshA = &assets[1];
+        const void* materialB = &assets[2];
+        const void* materialA = &assets[3];
+
+        DrawList list;
+        list.add(1, materialA, meshA, 0, 0);
+        list.add(0, materialB, meshB, 1, 0);
+        list.add(1, materialB, meshA, 2, 0);
+        list.add(1, materialA, meshB, 3, 0);
+        list.add(1, materialA, meshA, 4, 0);
+        list.add(1, nullptr, meshA, 5, 0);
+        list.add(1, materialA, meshA, 4, 1);
+        list.sort();
+
+        // shader, then material (in first added order: A, B, nullptr), then mesh (A, B), then source
+        const uint32_t expected[][2] = { { 1, 0 }, { 0, 0 }, { 4, 0 }, { 4, 1 }, { 3, 0 }, { 2, 0 }, { 5, 0 } };
+        const std::vector<DrawList::Draw>& draws = list.get_draws();
+        bool ordered = draws.size() == sizeof(expected) / sizeof(expected[0]);
+        for (size_t i = 0; ordered && i < draws.size(); i++)
+        {
+            ordered = draws[i].sourceIndex == expected[i][0] && draws[i].subIndex == expected[i][1];
+            if (i > 0) ordered = ordered && draws[i - 1].key <= draws[i].key;
+        }
+        passed = check(ordered, "draws sorted by shader, material, mesh, then source") && passed;
+        passed = check(draws.front().material == materialB && draws.front().mesh == meshB, "draws keep their assets") && passed;
+
+        // ranks start over after clear
+        list.clear();
+        passed = check(list.get_draws().empty(), "clear forgets draws") && passed;
+        list.add(0, materialB, meshB, 0, 0);
+        list.add(0, materialA, meshA, 1, 0);
+        list.sort();
+        passed = check(list.get_draws().front().sourceIndex == 0, "clear forgets ranks") && passed;
+
+        return passed;
+    }
+}
+
+int main()
+{
+    bool passed = check_frustum();
+    passed = check_draw_list() && passed;
+    std::printf(passed ? "passed\n" : "failed\n");
+    return passed ? 0 : 1;
+}
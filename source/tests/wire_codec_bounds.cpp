@@ -0,0 +1,168 @@
+// Error bounds and sizes of quantized component encodings
+// Random Transform and Physics components are encoded quantized, decoded, and compared to the originals.
+// Fails if any value is off by more than its quantization step allows (plus float rounding),
+// if values which should be sent exactly aren't, or if the encoded sizes grow.
+
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include "logging/pleep_log.h"
+#include "events/event_types.h"
+#include "physics/transform_component.h"
+#include "physics/physics_component.h"
+
+using namespace pleep;
+
+namespace
+{
+    constexpr unsigned SAMPLE_COUNT = 100000;
+    constexpr unsigned SEED = 36;
+
+    // exact encodings and what the component headers claim the quantized ones cost (with their packed length)
+    constexpr size_t TRANSFORM_EXACT_BYTES = sizeof(TransformComponent);
+    constexpr size_t TRANSFORM_QUANTIZED_BYTES = 17;
+    constexpr size_t PHYSICS_EXACT_BYTES = sizeof(PhysicsComponent);
+    constexpr size_t PHYSICS_VELOCITY_ONLY_BYTES = 10;
+    constexpr size_t PHYSICS_ALL_MOTION_BYTES = 28;
+
+    // half a step of a ranged value, plus the float rounding of the decoded result
+    float ranged_bound(float minValue, float maxValue, unsigned bits)
+    {
+        const float halfStep = (maxValue - minValue) / static_cast<float>((uint64_t(1) << bits) - 1) * 0.5f;
+        const float rounding = std::max(std::abs(minValue), std::abs(maxValue)) * std::pow(2.0f, -23.0f);
+        return halfStep + rounding;
+    }
+
+    float max_difference(const glm::vec3& a, const glm::vec3& b)
+    {
+        return std::max(std::abs(a.x - b.x), std::max(std::abs(a.y - b.y), std::abs(a.z - b.z)));
+    }
+
+    // q and -q are the same rotation
+    float max_difference(const glm::quat& a, const glm::quat& b)
+    {
+        const float sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+        float difference = 0.0f;
+        for (int i = 0; i < 4; i++) difference = std::max(difference, std::abs(a[i] - b[i] * sign));
+        return difference;
+    }
+
+    template<typename T_Data>
+    T_Data round_trip(const T_Data& data, WireEncoding encoding, size_t& encodedSize)
+    {
+        EventMessage msg;
+        encode_component(msg, data, encoding);
+        encodedSize = msg.size();
+
+        T_Data decoded;
+        decode_component(msg, decoded, encoding);
+        if (msg.size() != 0) encodedSize = SIZE_MAX;
+        return decoded;
+    }
+
+    bool check(bool passed, const char* what)
+    {
+        if (!passed) std::printf("FAILED: %s\n", what);
+        return passed;
+    }
+}
+
+int main()
+{
+    INIT_PLEEPLOG();
+
+    const WireQuantization& q = get_wire_quantization();
+    const float positionBound = ranged_bound(-q.worldHalfExtent, q.worldHalfExtent, q.positionBits);
+    // the implied component is rebuilt from the others, so it gathers their error
+    const float rotationBound = ranged_bound(-0.70710678f, 0.70710678f, q.rotationBits) * 4.0f;
+    const float velocityBound = ranged_bound(-q.maxSpeed, q.maxSpeed, q.velocityBits);
+    const float angularVelocityBound = ranged_bound(-q.maxAngularSpeed, q.maxAngularSpeed, q.velocityBits);
+
+    std::mt19937 generator(SEED);
+    std::uniform_real_distribution<float> positions(-q.worldHalfExtent, q.worldHalfExtent);
+    std::uniform_real_distribution<float> velocities(-q.maxSpeed, q.maxSpeed);
+    std::uniform_real_distribution<float> angularVelocities(-q.maxAngularSpeed, q.maxAngularSpeed);
+    std::normal_distribution<float> rotations(0.0f, 1.0f);
+
+    float positionError = 0.0f;
+    float rotationError = 0.0f;
+    float velocityError = 0.0f;
+    float angularVelocityError = 0.0f;
+    bool passed = true;
+
+    for (unsigned i = 0; i < SAMPLE_COUNT; i++)
+    {
+        TransformComponent transform;
+        transform.origin = glm::vec3(positions(generator), positions(generator), positions(generator));
+        transform.orientation = glm::normalize(glm::quat(rotations(generator), rotations(generator), rotations(generator), rotations(generator)));
+
+        size_t encodedSize = 0;
+        const TransformComponent decodedTransform = round_trip(transform, WireEncoding::quantized, encodedSize);
+        positionError = std::max(positionError, max_difference(transform.origin, decodedTransform.origin));
+        rotationError = std::max(rotationError, max_difference(transform.orientation, decodedTransform.orientation));
+        if (encodedSize != TRANSFORM_QUANTIZED_BYTES) passed = check(false, "quantized transform size");
+        if (decodedTransform.scale != transform.scale) passed = check(false, "unit scale is exact");
+
+        PhysicsComponent physics;
+        physics.velocity = glm::vec3(velocities(generator), velocities(generator), velocities(generator));
+        physics.angularVelocity = glm::vec3(angularVelocities(generator), angularVelocities(generator), angularVelocities(generator));
+
+        const PhysicsComponent decodedPhysics = round_trip(physics, WireEncoding::quantized, encodedSize);
+        velocityError = std::max(velocityError, max_difference(physics.velocity, decodedPhysics.velocity));
+        angularVelocityError = std::max(angularVelocityError, max_difference(physics.angularVelocity, decodedPhysics.angularVelocity));
+        if (decodedPhysics.acceleration != glm::vec3(0.0f) || decodedPhysics.angularAcceleration != glm::vec3(0.0f))
+        {
+            passed = check(false, "zero vectors are exact");
+        }
+        if (decodedPhysics.mass != physics.mass || decodedPhysics.linearDrag != physics.linearDrag
+            || decodedPhysics.lockOrigin != physics.lockOrigin || decodedPhysics.isAsleep != physics.isAsleep)
+        {
+            passed = check(false, "physics constants are exact");
+        }
+        if (!passed) break;
+    }
+
+    std::printf("value            | max error    | bound\n");
+    std::printf("position         | %12.8f | %12.8f\n", positionError, positionBound);
+    std::printf("rotation         | %12.8f | %12.8f\n", rotationError, rotationBound);
+    std::printf("velocity         | %12.8f | %12.8f\n", velocityError, velocityBound);
+    std::printf("angular velocity | %12.8f | %12.8f\n", angularVelocityError, angularVelocityBound);
+    passed = check(positionError <= positionBound, "position error") && passed;
+    passed = check(rotationError <= rotationBound, "rotation error") && passed;
+    passed = check(velocityError <= velocityBound, "velocity error") && passed;
+    passed = check(angularVelocityError <= angularVelocityBound, "angular velocity error") && passed;
+
+    // sizes
+    size_t encodedSize = 0;
+    const TransformComponent transform(glm::vec3(1.0f, 2.0f, 3.0f));
+    round_trip(transform, WireEncoding::exact, encodedSize);
+    passed = check(encodedSize == TRANSFORM_EXACT_BYTES, "exact transform size") && passed;
+    const TransformComponent scaled = [] { TransformComponent t; t.scale = glm::vec3(2.0f, 0.5f, 1.0f); return t; }();
+    passed = check(round_trip(scaled, WireEncoding::quantized, encodedSize).scale == scaled.scale, "non-unit scale is exact") && passed;
+
+    PhysicsComponent physics;
+    physics.velocity = glm::vec3(1.0f, 0.0f, -2.0f);
+    round_trip(physics, WireEncoding::exact, encodedSize);
+    passed = check(encodedSize == PHYSICS_EXACT_BYTES, "exact physics size") && passed;
+    round_trip(physics, WireEncoding::quantized, encodedSize);
+    std::printf("physics moving: %zu bytes (exact %zu)\n", encodedSize, PHYSICS_EXACT_BYTES);
+    passed = check(encodedSize == PHYSICS_VELOCITY_ONLY_BYTES, "quantized moving physics size") && passed;
+
+    physics.acceleration = glm::vec3(0.0f, -9.8f, 0.0f);
+    physics.angularVelocity = glm::vec3(0.5f);
+    physics.angularAcceleration = glm::vec3(0.1f);
+    round_trip(physics, WireEncoding::quantized, encodedSize);
+    std::printf("physics with every motion vector: %zu bytes\n", encodedSize);
+    passed = check(encodedSize == PHYSICS_ALL_MOTION_BYTES, "quantized physics size with every motion vector") && passed;
+
+    // locks are sent exactly as far as their own encoding allows
+    physics.lockOrigin = true;
+    physics.lockedOrigin = glm::vec3(10.0f, -20.0f, 30.0f);
+    const PhysicsComponent locked = round_trip(physics, WireEncoding::quantized, encodedSize);
+    passed = check(locked.lockOrigin && max_difference(locked.lockedOrigin, physics.lockedOrigin) <= positionBound, "locked origin") && passed;
+
+    DEINIT_PLEEPLOG();
+    return passed ? 0 : 1;
+}